@@ -6,7 +6,18 @@
 #include <windowsx.h>
 #include "myD2D.h"
 #include "helper.h"
+#include "timeBase.h"
 #include "controller.h"
+#include "renderStats.h"
+#include "latency.h"
+#include "memoryStats.h"
+#include "slowFrames.h"
+#include "qualityGovernor.h"
+#include "snapshot.h"
+#include "highScores.h"
+#include "telemetry.h"
+#include "spectator.h"
+#include "liveExport.h"
 
 #include "gameLogic.h"
 #include "drawLogic.h"
@@ -16,12 +27,19 @@ using help::hCheck;
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 void inbetweenFrames(HWND hwnd);
 
+namespace {
+	// started with -spectate: shows the game another instance plays instead of playing
+	bool spectating = false;
+} // namespace
+
 INT WINAPI wWinMain(
 	_In_ [[maybe_unused]] HINSTANCE instance,
 	_In_opt_ [[maybe_unused]] HINSTANCE prev_instance,
 	_In_ [[maybe_unused]] PWSTR cmd_line,
 	_In_ [[maybe_unused]] INT cmd_show
 ) {
+	spectating = cmd_line != nullptr && wcsstr(cmd_line, L"-spectate") != nullptr;
+
 	const wchar_t CLASS_NAME[] = L"Sample Window Class";
 	WNDCLASSEX window = {
 		.cbSize = sizeof(WNDCLASSEX),
@@ -81,12 +99,34 @@ INT WINAPI wWinMain(
 
 namespace {
 	bool initDone = false;
+
+	const wchar_t SNAPSHOT_PATH[] = L"apples.snapshot";
+	const timeBase::Ns CHECKPOINT_PERIOD_NS = 2 * timeBase::NS_PER_SECOND;
+	const wchar_t HIGH_SCORES_PATH[] = L"apples.scores";
+	const wchar_t TELEMETRY_DIRECTORY[] = L"telemetry";
+
+	const UINT64 MAX_FPS = 144;
+
+	// frames can't come any faster than MAX_FPS, nor than the display refreshes
+	double frameBudgetMs(HWND hwnd) {
+		HDC dc = GetDC(hwnd);
+		INT refreshHz = GetDeviceCaps(dc, VREFRESH); // 0 or 1 for the hardware default
+		ReleaseDC(hwnd, dc);
+		UINT64 fps = refreshHz > 1 ? min(MAX_FPS, static_cast<UINT64>(refreshHz)) : MAX_FPS;
+		return 1000.0 / fps;
+	}
 } // namepsace
 
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
 	static MyD2DObjectCollection myd2d;
 	static Controller controller;
 	static gamestate::GameState gameState;
+	static std::optional<snapshot::Checkpointer> checkpointer;
+	static std::optional<highScores::Store> highScoreStore;
+	static std::optional<spectator::Broadcaster> broadcaster;
+	static std::optional<spectator::Viewer> viewer;
+	static std::optional<liveExport::Publisher> livePublisher;
+	static qualityGovernor::Governor governor(1000.0 / MAX_FPS);
 
 	controller.processWindowMsg(hwnd, uMsg, wParam, lParam);
 
@@ -94,11 +134,31 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 	case WM_CREATE:
 		hCheck(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
 		myd2d.init(hwnd, rtd::ALL);
-		gameLogic::init(help::myTimer64ms(), gameState);
+		governor.setBudget(frameBudgetMs(hwnd));
+		gameLogic::setup();
+		if (spectating) {
+			// nothing of the player's is touched, the state comes from the pipe
+			gameLogic::init(timeBase::now(), gameState, nullptr);
+			viewer.emplace(spectator::DEFAULT_PIPE_NAME);
+			drawLogic::init(myd2d, rtd::ALL);
+			initDone = true;
+			return 0;
+		}
+		highScoreStore.emplace(HIGH_SCORES_PATH);
+		telemetry::start(TELEMETRY_DIRECTORY);
+		gameLogic::init(timeBase::now(), gameState, &*highScoreStore);
+		snapshot::loadFile(SNAPSHOT_PATH, gameState, timeBase::now()); // resume where the last run ended
+		checkpointer.emplace(SNAPSHOT_PATH);
+		broadcaster.emplace(spectator::DEFAULT_PIPE_NAME);
+		livePublisher.emplace(liveExport::DEFAULT_NAME);
 		drawLogic::init(myd2d, rtd::ALL);
 		initDone = true;
 	return 0;
 
+	case WM_DISPLAYCHANGE:
+		governor.setBudget(frameBudgetMs(hwnd));
+	return 0;
+
 	case WM_SIZE: {
 		UINT new_x = LOWORD(lParam);
 		UINT new_y = HIWORD(lParam);
@@ -106,13 +166,64 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 	} return 0;
 
 	case WM_PAINT: {
-		UINT64 timeMs = help::myTimer64ms();
-		
+		timeBase::Ns timeNs = timeBase::now();
+		memoryStats::beginFrame();
 
 		controller.pollAllKeys();
-		if (gameLogic::processFrame(controller, gameState, timeMs)) {
-			return WindowProc(hwnd, WM_CLOSE, wParam, lParam);
-		};
+		if (controller.keyJustDown(VK_F4)) {
+			OutputDebugStringA(memoryStats::formatReport().c_str());
+		}
+		if (spectating) {
+			if (controller.keyJustDown(VK_ESCAPE)) {
+				return WindowProc(hwnd, WM_CLOSE, wParam, lParam);
+			}
+			gameLogic::updateWindowTransform(controller, gameState);
+			viewer->update(gameState, timeNs);
+		} else {
+			static timeBase::Ns sessionStartNs = timeNs;
+			const gamestate::GameState::SingletonPlay& play = gameState.players[0];
+			bool playing = gameState.mode == gamestate::GameState::Mode::PLAYING;
+			slowFrames::Frame frame = {
+				.timeUs = (timeNs - sessionStartNs) / timeBase::NS_PER_US,
+				.boardSeed = playing ? play.boardSeed : 0,
+				.boardRevision = playing ? play.boardRevision : 0,
+				.appleCount = static_cast<uint32_t>(gameState.appleCountX * gameState.appleCountY),
+				.draggedApples = playing ? static_cast<uint32_t>(play.draggedApples.size()) : 0,
+				.fallingApples = playing ? static_cast<uint32_t>(play.fallingApples.size()) : 0,
+				.mode = static_cast<uint8_t>(gameState.mode),
+				.playerCount = static_cast<uint8_t>(gameState.playerCount),
+				.mouseDown = controller.keyDown(VK_LBUTTON),
+				.inDrag = playing && play.inDrag,
+			};
+
+			if (gameLogic::processFrame(controller, gameState, timeNs)) {
+				return WindowProc(hwnd, WM_CLOSE, wParam, lParam);
+			}
+
+			frame.logicUs = (timeBase::now() - timeNs) / timeBase::NS_PER_US;
+			frame.mouseX = gameState.logicalMouseX;
+			frame.mouseY = gameState.logicalMouseY;
+			slowFrames::record(frame);
+		}
+		if (broadcaster) {
+			broadcaster->frame(gameState);
+		}
+		if (livePublisher) {
+			livePublisher->frame(gameState);
+		}
+
+		// written in the background, skipped if the previous checkpoint is still being written
+		static timeBase::Ns lastCheckpointNs = timeNs;
+		if (checkpointer && timeNs - lastCheckpointNs >= CHECKPOINT_PERIOD_NS && checkpointer->tryCheckpoint(gameState, timeNs)) {
+			lastCheckpointNs = timeNs;
+		}
+		if (highScoreStore) {
+			highScoreStore->tryFlush(); // scores the worker was too busy to take when they were submitted
+		}
+
+		static UINT64 previousFrameUs = help::myTimer64us();
+		UINT64 frameUs = help::myTimer64us();
+		renderStats::beginFrame();
 
 		myd2d.d2d_render_target->BeginDraw();
 		drawLogic::drawFrame(myd2d, gameState);
@@ -131,6 +242,14 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 			}
 		}
 
+		// EndDraw returns once the frame is handed over for presentation
+		latency::framePresented(help::myTimer64us());
+		renderStats::endFrame((frameUs - previousFrameUs) / 1000.0);
+		if (governor.frame((frameUs - previousFrameUs) / 1000.0)) {
+			drawLogic::setQuality(governor.level());
+		}
+		previousFrameUs = frameUs;
+
 		ValidateRect(hwnd, nullptr);
 	} return 0;
 
@@ -139,8 +258,21 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 	return 0;
 
 	case WM_DESTROY:
+		OutputDebugStringA(latency::formatReport().c_str());
+		OutputDebugStringA(slowFrames::formatReport().c_str());
+		OutputDebugStringA(memoryStats::formatReport().c_str());
+		if (checkpointer) {
+			checkpointer->checkpointNow(gameState, timeBase::now());
+			checkpointer.reset();
+		}
+		broadcaster.reset();
+		livePublisher.reset();
+		viewer.reset();
 		myd2d.free(rtd::ALL);
+		gameLogic::stop(gameState);
 		gameLogic::free();
+		highScoreStore.reset(); // writes scores that are still pending
+		telemetry::stop();
 		drawLogic::free(rtd::ALL);
 		PostQuitMessage(0);
 	return 0;
@@ -153,11 +285,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 }
 
 void inbetweenFrames(HWND hwnd) {
-	const UINT64 MAX_FPS = 144;
 	static UINT64 lastFrame = 0;
 
-	UINT64 timeMs = help::myTimer64ms();
-	UINT64 currentFrame = (timeMs * MAX_FPS) / 1000;
+	UINT64 currentFrame = timeBase::now() / (timeBase::NS_PER_SECOND / MAX_FPS);
 
 	if (currentFrame != lastFrame && initDone) {
 		InvalidateRect(hwnd, nullptr, true);
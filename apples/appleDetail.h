@@ -0,0 +1,72 @@
+// How much of an apple is drawn, by the physical pixels it covers. Below a few dozen pixels the
+// leaf, stem and gradient are a blur nobody sees, but they cost as much as on a big apple. Doesn't
+// depend on any platform headers, so tier selection and its cost can be tested and benchmarked
+// without a window.
+#pragma once
+
+#include <iterator>
+#include "gameState.h"
+
+namespace appleDetail {
+    enum class Detail {
+        FULL,   // leaf, stem, gradient body and outline
+        SIMPLE, // gradient body and outline
+        FLAT,   // flat colored cell
+        COUNT
+    };
+
+    // in physical pixels per apple (cell pitch)
+    const FLOAT SIMPLE_APPLE_PIXELS = 40.0f;
+    const FLOAT FLAT_APPLE_PIXELS = 18.0f;
+
+    // apples further down have fallen out of sight and aren't drawn
+    const FLOAT OUT_OF_SIGHT_Y = 25000.0f;
+
+    // falling apples move and spin too fast to show detail, they are drawn as if this much smaller
+    const FLOAT FALLING_DETAIL_DIVISOR = 2.0f;
+
+    // Direct2D draw calls drawApple makes for one apple of each detail, the number included
+    const INT DRAW_CALLS[] = { 5, 3, 2 };
+    static_assert(std::size(DRAW_CALLS) == static_cast<size_t>(Detail::COUNT));
+
+    inline Detail select(FLOAT applePixels, bool falling) {
+        if (falling) {
+            applePixels /= FALLING_DETAIL_DIVISOR;
+        }
+        return applePixels >= SIMPLE_APPLE_PIXELS ? Detail::FULL :
+            applePixels >= FLAT_APPLE_PIXELS ? Detail::SIMPLE : Detail::FLAT;
+    }
+
+    // physical pixels an apple of the board covers at its current zoom and the window's scale
+    inline FLOAT applePixels(const gamestate::GameState& gameState, const gamestate::GameState::SingletonPlay& play) {
+        return gameState.appleSize * play.viewZoom * gameState.graphicalScale;
+    }
+
+    struct Cost {
+        INT apples[static_cast<size_t>(Detail::COUNT)] = {};
+        INT drawCalls = 0;
+
+        void add(Detail detail) {
+            apples[static_cast<size_t>(detail)]++;
+            drawCalls += DRAW_CALLS[static_cast<size_t>(detail)];
+        }
+    };
+
+    // What drawing the apples of a board costs: the settled ones in the chunks over the view, as the
+    // static layer draws them, and the falling ones
+    inline Cost boardCost(const gamestate::GameState& gameState, const gamestate::GameState::SingletonPlay& play) {
+        Cost cost;
+        const FLOAT pixels = applePixels(gameState, play);
+        INT minX, minY, maxX, maxY;
+        gameState.cellsOver(play, play.visibleBoardArea(), minX, minY, maxX, maxY);
+        const Detail settled = select(pixels, false);
+        play.apples.forEachInChunksOver(minX, minY, maxX, maxY, [&](const gamestate::Apple& apple, INT, INT) {
+            if (!apple.popped) { cost.add(settled); }
+        });
+        const Detail falling = select(pixels, true);
+        for (gamestate::CellXY cell : play.fallingApples) {
+            if (play.apples.at(cell).posY() <= OUT_OF_SIGHT_Y) { cost.add(falling); }
+        }
+        return cost;
+    }
+} // namespace appleDetail
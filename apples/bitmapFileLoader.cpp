@@ -57,3 +57,38 @@ ID2D1Bitmap* LoadBitmapFromFile(
 
     return ppBitmap;
 }
+
+imageScale::Image LoadImageFromFile(
+    IWICImagingFactory* pIWICFactory,
+    PCWSTR uri
+) {
+    IWICBitmapDecoder* pDecoder = nullptr;
+    IWICBitmapFrameDecode* pSource = nullptr;
+    IWICFormatConverter* pConverter = nullptr;
+
+    hCheck(pIWICFactory->CreateDecoderFromFilename(
+        uri, nullptr, GENERIC_READ,
+        WICDecodeMetadataCacheOnLoad, &pDecoder));
+
+    hCheck(pDecoder->GetFrame(0, &pSource));
+
+    // same format as the bitmaps, so the pixels can be copied into one as they are
+    hCheck(pIWICFactory->CreateFormatConverter(&pConverter));
+
+    hCheck(pConverter->Initialize(
+        pSource, GUID_WICPixelFormat32bppPBGRA,
+        WICBitmapDitherTypeNone,
+        nullptr, 0.f, WICBitmapPaletteTypeMedianCut));
+
+    UINT width = 0, height = 0;
+    hCheck(pConverter->GetSize(&width, &height));
+    imageScale::Image image(width, height);
+    hCheck(pConverter->CopyPixels(nullptr, width * 4, width * height * 4,
+        reinterpret_cast<BYTE*>(image.pixels.data())));
+
+    help::SafeRelease(pDecoder);
+    help::SafeRelease(pSource);
+    help::SafeRelease(pConverter);
+
+    return image;
+}
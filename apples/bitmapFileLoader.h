@@ -4,6 +4,7 @@
 #include "myD2D.h"
 #include "wincodec.h"
 #include "helper.h"
+#include "imageScale.h"
 
 ID2D1Bitmap* LoadBitmapFromFile(
     ID2D1RenderTarget* pRenderTarget,
@@ -18,3 +19,9 @@ ID2D1Bitmap* LoadBitmapFromFile(
     UINT destinationWidth,
     UINT destinationHeight
 );
+
+// Decoded pixels in 32bppPBGRA, for scaling on the CPU before creating a bitmap
+imageScale::Image LoadImageFromFile(
+    IWICImagingFactory* pIWICFactory,
+    PCWSTR uri
+);
@@ -0,0 +1,176 @@
+// Board storage split into fixed-size square chunks, so per-frame work can be
+// limited to the chunks intersecting some area (e.g. the visible part of a huge board).
+// Only standard C++, so the board code can also be compiled and benchmarked off Windows.
+#pragma once
+
+#include <algorithm>
+#include <execution>
+#include <memory>
+#include <vector>
+
+namespace gamestate {
+    struct CellXY {
+        int x, y;
+    };
+
+    // Allocator is used for the cells and the chunk list alike
+    template<typename T, typename Allocator = std::allocator<T>>
+    class ChunkedGrid {
+    public:
+        static constexpr int CHUNK_SIZE = 16;
+        // below this handing chunks over to other threads costs more than it saves
+        static constexpr size_t PARALLEL_MIN_CHUNKS = 16;
+
+        struct Chunk {
+            int originX, originY;
+            int sizeX, sizeY;
+            std::vector<T, Allocator> cells; // row major, sizeX * sizeY
+        };
+
+    private:
+        int m_sizeX = 0;
+        int m_sizeY = 0;
+        int m_chunksX = 0;
+        int m_chunksY = 0;
+        std::vector<Chunk, typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>> m_chunks;
+
+    public:
+        int sizeX() const { return m_sizeX; }
+        int sizeY() const { return m_sizeY; }
+        bool empty() const { return m_chunks.empty(); }
+
+        void clear() {
+            m_chunks.clear();
+            m_sizeX = m_sizeY = m_chunksX = m_chunksY = 0;
+        }
+
+        // Fills the grid chunk by chunk with makeCell(x, y). Cells are never moved afterwards,
+        // so references to them stay valid until the next generate() or clear().
+        template<typename F>
+        void generate(int sizeX, int sizeY, F makeCell) {
+            allocateChunks(sizeX, sizeY);
+            for (Chunk& chunk : m_chunks) {
+                fillChunk(chunk, makeCell);
+            }
+        }
+
+        // Same as generate(), but chunks are filled in parallel, so makeCell has to be safe
+        // to call concurrently and must not depend on the order cells are made in
+        template<typename F>
+        void generateParallel(int sizeX, int sizeY, F makeCell) {
+            allocateChunks(sizeX, sizeY);
+            if (m_chunks.size() < PARALLEL_MIN_CHUNKS) {
+                for (Chunk& chunk : m_chunks) {
+                    fillChunk(chunk, makeCell);
+                }
+                return;
+            }
+            std::for_each(std::execution::par, m_chunks.begin(), m_chunks.end(), [&makeCell](Chunk& chunk) {
+                fillChunk(chunk, makeCell);
+            });
+        }
+
+        T& at(int x, int y) {
+            Chunk& chunk = m_chunks[(y / CHUNK_SIZE) * m_chunksX + x / CHUNK_SIZE];
+            return chunk.cells[(y - chunk.originY) * chunk.sizeX + (x - chunk.originX)];
+        }
+        const T& at(int x, int y) const {
+            const Chunk& chunk = m_chunks[(y / CHUNK_SIZE) * m_chunksX + x / CHUNK_SIZE];
+            return chunk.cells[(y - chunk.originY) * chunk.sizeX + (x - chunk.originX)];
+        }
+        T& at(CellXY cell) { return at(cell.x, cell.y); }
+        const T& at(CellXY cell) const { return at(cell.x, cell.y); }
+
+        // chunks are row major, (sizeX + CHUNK_SIZE - 1) / CHUNK_SIZE of them per row
+        Chunk& chunk(int index) { return m_chunks[index]; }
+        const Chunk& chunk(int index) const { return m_chunks[index]; }
+
+        // Calls f(cell, x, y) for every cell of every chunk intersecting the inclusive
+        // cell range [minX, maxX] x [minY, maxY]. Cells of those chunks lying outside the range are
+        // visited as well, callers are expected to do their own precise tests.
+        template<typename F>
+        void forEachInChunksOver(int minX, int minY, int maxX, int maxY, F f) {
+            forEachInChunksOverImpl(*this, minX, minY, maxX, maxY, f);
+        }
+        template<typename F>
+        void forEachInChunksOver(int minX, int minY, int maxX, int maxY, F f) const {
+            forEachInChunksOverImpl(*this, minX, minY, maxX, maxY, f);
+        }
+
+        // Calls f(chunk) for every chunk intersecting the inclusive cell range [minX, maxX] x [minY, maxY],
+        // for kernels that work on a whole chunk's cells at once
+        template<typename F>
+        void forEachChunkOver(int minX, int minY, int maxX, int maxY, F f) {
+            forEachChunkOverImpl(*this, minX, minY, maxX, maxY, f);
+        }
+        template<typename F>
+        void forEachChunkOver(int minX, int minY, int maxX, int maxY, F f) const {
+            forEachChunkOverImpl(*this, minX, minY, maxX, maxY, f);
+        }
+
+        template<typename F>
+        void forEach(F f) {
+            forEachInChunksOverImpl(*this, 0, 0, m_sizeX - 1, m_sizeY - 1, f);
+        }
+        template<typename F>
+        void forEach(F f) const {
+            forEachInChunksOverImpl(*this, 0, 0, m_sizeX - 1, m_sizeY - 1, f);
+        }
+
+    private:
+        void allocateChunks(int sizeX, int sizeY) {
+            clear();
+            m_sizeX = sizeX;
+            m_sizeY = sizeY;
+            m_chunksX = (sizeX + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            m_chunksY = (sizeY + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            m_chunks.resize(m_chunksX * m_chunksY);
+
+            for (int cy = 0; cy < m_chunksY; cy++) {
+                for (int cx = 0; cx < m_chunksX; cx++) {
+                    Chunk& chunk = m_chunks[cy * m_chunksX + cx];
+                    chunk.originX = cx * CHUNK_SIZE;
+                    chunk.originY = cy * CHUNK_SIZE;
+                    chunk.sizeX = std::min<int>(CHUNK_SIZE, sizeX - chunk.originX);
+                    chunk.sizeY = std::min<int>(CHUNK_SIZE, sizeY - chunk.originY);
+                }
+            }
+        }
+
+        template<typename F>
+        static void fillChunk(Chunk& chunk, F& makeCell) {
+            chunk.cells.reserve(chunk.sizeX * chunk.sizeY);
+            for (int y = 0; y < chunk.sizeY; y++) {
+                for (int x = 0; x < chunk.sizeX; x++) {
+                    chunk.cells.push_back(makeCell(chunk.originX + x, chunk.originY + y));
+                }
+            }
+        }
+
+        template<typename Self, typename F>
+        static void forEachChunkOverImpl(Self& self, int minX, int minY, int maxX, int maxY, F&& f) {
+            minX = std::max<int>(minX, 0);
+            minY = std::max<int>(minY, 0);
+            maxX = std::min<int>(maxX, self.m_sizeX - 1);
+            maxY = std::min<int>(maxY, self.m_sizeY - 1);
+            if (minX > maxX || minY > maxY) { return; }
+
+            for (int cy = minY / CHUNK_SIZE; cy <= maxY / CHUNK_SIZE; cy++) {
+                for (int cx = minX / CHUNK_SIZE; cx <= maxX / CHUNK_SIZE; cx++) {
+                    f(self.m_chunks[cy * self.m_chunksX + cx]);
+                }
+            }
+        }
+
+        template<typename Self, typename F>
+        static void forEachInChunksOverImpl(Self& self, int minX, int minY, int maxX, int maxY, F& f) {
+            forEachChunkOverImpl(self, minX, minY, maxX, maxY, [&f](auto& chunk) {
+                for (int y = 0; y < chunk.sizeY; y++) {
+                    for (int x = 0; x < chunk.sizeX; x++) {
+                        f(chunk.cells[y * chunk.sizeX + x], chunk.originX + x, chunk.originY + y);
+                    }
+                }
+            });
+        }
+    };
+} // namespace gamestate
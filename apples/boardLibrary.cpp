@@ -0,0 +1,292 @@
+#include "boardLibrary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <execution>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using boards::Difficulty;
+
+namespace {
+    // Layout (little endian):
+    //   FileHeader | GroupRecord[groupCount] sorted by key | BoardRecord[boardCount] by group | values
+    const uint32_t MAGIC = 0x4C425041; // "APBL"
+    const uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t groupCount;
+        uint32_t reserved;
+        uint64_t boardCount;
+    };
+
+    struct GroupRecord {
+        uint16_t sizeX;
+        uint16_t sizeY;
+        uint8_t variant;
+        uint8_t difficulty;
+        uint16_t reserved;
+        uint32_t boardCount;
+        uint32_t reserved2;
+        uint64_t firstBoard;
+    };
+
+    struct BoardRecord {
+        uint64_t seed;
+        uint64_t valuesOffset; // from the start of the file
+        int32_t solverScore;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 24);
+    static_assert(sizeof(GroupRecord) == 24);
+    static_assert(sizeof(BoardRecord) == 24);
+
+    uint64_t groupKey(int sizeX, int sizeY, rules::Variant variant, Difficulty difficulty) {
+        return (static_cast<uint64_t>(sizeX) << 32) | (static_cast<uint64_t>(sizeY) << 16) |
+            (static_cast<uint64_t>(variant) << 8) | static_cast<uint64_t>(difficulty);
+    }
+
+    uint64_t groupKey(const GroupRecord& group) {
+        return groupKey(group.sizeX, group.sizeY, static_cast<rules::Variant>(group.variant),
+            static_cast<Difficulty>(group.difficulty));
+    }
+
+    // binary search over the group records, nullptr if there is no such group or it's empty
+    const GroupRecord* findGroup(const uint8_t* data, uint64_t key) {
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const GroupRecord* first = reinterpret_cast<const GroupRecord*>(data + sizeof(FileHeader));
+        const GroupRecord* last = first + header.groupCount;
+
+        const GroupRecord* group = std::lower_bound(first, last, key, [](const GroupRecord& group, uint64_t key) {
+            return groupKey(group) < key;
+        });
+        if (group == last || groupKey(*group) != key || group->boardCount == 0) { return nullptr; }
+        return group;
+    }
+
+    // Share of apples the greedy solver clears, at least. Terciles of default 17x10 classic boards,
+    // bigger boards clear more so they lean easy.
+    const double EASY_CLEARED = 0.72;
+    const double NORMAL_CLEARED = 0.64;
+
+    struct Candidate {
+        const boards::BuildSpec* spec;
+        uint64_t seed;
+        std::vector<uint8_t> values;
+        boards::SolverResult solved;
+        Difficulty difficulty;
+    };
+} // namespace
+
+const wchar_t* boards::difficultyName(Difficulty difficulty) {
+    switch (difficulty) {
+    case Difficulty::EASY: return L"Easy";
+    case Difficulty::NORMAL: return L"Normal";
+    default: return L"Hard";
+    }
+}
+
+Difficulty boards::classify(int clearedApples, int appleCount) {
+    double cleared = appleCount > 0 ? static_cast<double>(clearedApples) / appleCount : 0.0;
+    if (cleared >= EASY_CLEARED) { return Difficulty::EASY; }
+    if (cleared >= NORMAL_CLEARED) { return Difficulty::NORMAL; }
+    return Difficulty::HARD;
+}
+
+uint64_t boards::dailySeed(int64_t daysSinceEpoch) {
+    return rng::mix(static_cast<uint64_t>(daysSinceEpoch) ^ 0xDA11C4A11E46E5EEull);
+}
+
+boards::Library::~Library() {
+    close();
+}
+
+bool boards::Library::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    // the mapping keeps the file open
+    CloseHandle(file);
+    if (mapping == nullptr) { return false; }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) { return false; }
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    FileHeader header;
+    bool valid = m_size >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, m_data, sizeof(header));
+        // divided rather than multiplied, counts from a damaged file would overflow the sizes
+        size_t records = m_size - sizeof(header);
+        valid = header.magic == MAGIC && header.version == VERSION &&
+            header.groupCount <= records / sizeof(GroupRecord) &&
+            header.boardCount <= (records - header.groupCount * sizeof(GroupRecord)) / sizeof(BoardRecord);
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void boards::Library::close() {
+    if (m_data == nullptr) { return; }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+}
+
+size_t boards::Library::boardCount(int sizeX, int sizeY, rules::Variant variant, Difficulty difficulty) const {
+    if (m_data == nullptr) { return 0; }
+    const GroupRecord* group = findGroup(m_data, groupKey(sizeX, sizeY, variant, difficulty));
+    return group ? group->boardCount : 0;
+}
+
+bool boards::Library::pick(int sizeX, int sizeY, rules::Variant variant, Difficulty difficulty, uint64_t choice,
+    BoardInfo& board) const {
+    if (m_data == nullptr) { return false; }
+    const GroupRecord* group = findGroup(m_data, groupKey(sizeX, sizeY, variant, difficulty));
+    if (group == nullptr) { return false; }
+
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    uint64_t index = group->firstBoard + choice % group->boardCount;
+    if (index >= header.boardCount) { return false; }
+
+    BoardRecord record;
+    std::memcpy(&record, m_data + sizeof(FileHeader) + header.groupCount * sizeof(GroupRecord) + index * sizeof(BoardRecord),
+        sizeof(record));
+    if (record.valuesOffset > m_size || static_cast<uint64_t>(sizeX) * sizeY > m_size - record.valuesOffset) { return false; }
+
+    board = {
+        .seed = record.seed,
+        .solverScore = record.solverScore,
+        .values = m_data + record.valuesOffset,
+    };
+    return true;
+}
+
+bool boards::build(const std::filesystem::path& path, const std::vector<BuildSpec>& specs, uint64_t baseSeed) {
+    std::vector<Candidate> candidates;
+    rng::Stream buildRng(baseSeed);
+    for (size_t s = 0; s < specs.size(); s++) {
+        rng::Stream specRng = buildRng.split(s);
+        for (int i = 0; i < specs[s].candidates; i++) {
+            candidates.push_back({ .spec = &specs[s], .seed = specRng.split(static_cast<uint64_t>(i)).next() });
+        }
+    }
+
+    std::for_each(std::execution::par, candidates.begin(), candidates.end(), [](Candidate& candidate) {
+        const BuildSpec& spec = *candidate.spec;
+        candidate.values.resize(static_cast<size_t>(spec.sizeX) * spec.sizeY);
+        rules::visit(spec.variant, [&](auto variant) {
+            using R = decltype(variant);
+            generateValues<R>(spec.sizeX, spec.sizeY, candidate.seed, candidate.values.data());
+            candidate.solved = solveGreedy<R>(spec.sizeX, spec.sizeY, candidate.values.data());
+        });
+        candidate.difficulty = classify(candidate.solved.clearedApples, spec.sizeX * spec.sizeY);
+    });
+
+    // stable, so boards of a group keep the order their seeds were drawn in
+    auto keyOf = [](const Candidate& candidate) {
+        return groupKey(candidate.spec->sizeX, candidate.spec->sizeY, candidate.spec->variant, candidate.difficulty);
+    };
+    std::stable_sort(candidates.begin(), candidates.end(), [&keyOf](const Candidate& a, const Candidate& b) {
+        return keyOf(a) < keyOf(b);
+    });
+
+    std::vector<GroupRecord> groupRecords;
+    std::vector<BoardRecord> boardRecords;
+    uint64_t valuesOffset = 0; // relative to the values section until the sections are counted
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const Candidate& candidate = candidates[i];
+        if (i == 0 || keyOf(candidate) != keyOf(candidates[i - 1])) {
+            groupRecords.push_back({
+                .sizeX = static_cast<uint16_t>(candidate.spec->sizeX),
+                .sizeY = static_cast<uint16_t>(candidate.spec->sizeY),
+                .variant = static_cast<uint8_t>(candidate.spec->variant),
+                .difficulty = static_cast<uint8_t>(candidate.difficulty),
+                .firstBoard = i,
+            });
+        }
+        groupRecords.back().boardCount++;
+
+        boardRecords.push_back({
+            .seed = candidate.seed,
+            .valuesOffset = valuesOffset,
+            .solverScore = candidate.solved.score,
+        });
+        valuesOffset += candidate.values.size();
+    }
+
+    uint64_t valuesStart = sizeof(FileHeader) + groupRecords.size() * sizeof(GroupRecord) + boardRecords.size() * sizeof(BoardRecord);
+    for (BoardRecord& record : boardRecords) {
+        record.valuesOffset += valuesStart;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) { return false; }
+
+    FileHeader header = {
+        .magic = MAGIC,
+        .version = VERSION,
+        .groupCount = static_cast<uint32_t>(groupRecords.size()),
+        .reserved = 0,
+        .boardCount = boardRecords.size(),
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(groupRecords.data()), groupRecords.size() * sizeof(GroupRecord));
+    out.write(reinterpret_cast<const char*>(boardRecords.data()), boardRecords.size() * sizeof(BoardRecord));
+    for (const Candidate& candidate : candidates) {
+        out.write(reinterpret_cast<const char*>(candidate.values.data()), candidate.values.size());
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,161 @@
+// Library of pre-generated boards. Boards are built offline (in parallel), each tagged with a
+// greedy solver's score and a difficulty, and written sorted into groups by board size, rule
+// variant and difficulty. The game memory maps the file and picks a board of a group in
+// O(log groups) without reading the rest. Board values are a pure function of the seed, so a
+// daily challenge is the same board for everyone even without a library.
+// Standard C++ apart from the file mapping, so libraries can be built on any OS.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "rng.h"
+#include "rules.h"
+
+namespace boards {
+    enum class Difficulty : uint8_t {
+        EASY,
+        NORMAL,
+        HARD,
+        COUNT
+    };
+
+    const wchar_t* difficultyName(Difficulty difficulty);
+
+    // Values of a board, row major. Apples are drawn from their own split of the seed, so boards
+    // can be generated in any order or in parallel. The sum is then made divisible by the target.
+    // Same values as the game generates from the seed.
+    template<typename R>
+    void generateValues(int sizeX, int sizeY, uint64_t seed, uint8_t* values) {
+        rng::Stream boardRng(seed);
+        rng::Stream appleRngs = boardRng.split(0);
+        int count = sizeX * sizeY;
+        int valueSum = 0;
+        for (int i = 0; i < count; i++) {
+            rng::Stream appleRng = appleRngs.split(static_cast<uint64_t>(i));
+            values[i] = static_cast<uint8_t>(appleRng.nextInt(R::MIN_VALUE, R::MAX_VALUE));
+            valueSum += values[i];
+        }
+
+        // make sum of values divisible by the target sum to make board more clearable
+        rng::Stream fixUpRng = boardRng.split(1);
+        int antiLockProtection = 10000; // in very impropable case that only minimal values are on the apples
+        while (valueSum % R::TARGET_SUM != 0 && antiLockProtection-- > 0) {
+            int x = fixUpRng.nextInt(0, sizeX - 1);
+            int y = fixUpRng.nextInt(0, sizeY - 1);
+            int i = y * sizeX + x;
+            if (values[i] != R::MIN_VALUE) {
+                values[i]--;
+                valueSum--;
+            }
+        }
+    }
+
+    struct SolverResult {
+        int score = 0;
+        int clearedApples = 0;
+    };
+
+    // Repeatedly makes the valid move clearing the fewest apples until there is none. A lower
+    // bound of the best score, used to rank boards, not an exact solution.
+    template<typename R>
+    SolverResult solveGreedy(int sizeX, int sizeY, const uint8_t* values) {
+        std::vector<int> remaining(values, values + sizeX * sizeY);
+        // prefix sums of values and apple counts, (sizeX + 1) x (sizeY + 1)
+        std::vector<int> sums((sizeX + 1) * (sizeY + 1));
+        std::vector<int> counts((sizeX + 1) * (sizeY + 1));
+        auto rect = [sizeX](const std::vector<int>& prefix, int x0, int y0, int x1, int y1) {
+            int w = sizeX + 1;
+            return prefix[y1 * w + x1] - prefix[y0 * w + x1] - prefix[y1 * w + x0] + prefix[y0 * w + x0];
+        };
+
+        SolverResult result;
+        for (;;) {
+            for (int y = 0; y < sizeY; y++) {
+                for (int x = 0; x < sizeX; x++) {
+                    int i = (y + 1) * (sizeX + 1) + (x + 1);
+                    int value = remaining[y * sizeX + x];
+                    sums[i] = value + sums[i - 1] + sums[i - sizeX - 1] - sums[i - sizeX - 2];
+                    counts[i] = (value > 0) + counts[i - 1] + counts[i - sizeX - 1] - counts[i - sizeX - 2];
+                }
+            }
+
+            int best = 0, bestX0 = 0, bestY0 = 0, bestX1 = 0, bestY1 = 0;
+            for (int y0 = 0; y0 < sizeY; y0++) {
+                for (int y1 = y0 + 1; y1 <= sizeY; y1++) {
+                    for (int x0 = 0; x0 < sizeX; x0++) {
+                        for (int x1 = x0 + 1; x1 <= sizeX; x1++) {
+                            if constexpr (R::SELECTION_SHAPE == rules::SelectionShape::LINE) {
+                                if (x1 - x0 > 1 && y1 - y0 > 1) { break; }
+                            }
+                            int sum = rect(sums, x0, y0, x1, y1);
+                            if (sum > R::TARGET_SUM) { break; } // only grows with x1
+                            if (sum != R::TARGET_SUM) { continue; }
+                            int count = rect(counts, x0, y0, x1, y1);
+                            if (best == 0 || count < best) {
+                                best = count;
+                                bestX0 = x0; bestY0 = y0; bestX1 = x1; bestY1 = y1;
+                            }
+                        }
+                    }
+                }
+            }
+            if (best == 0) { return result; }
+
+            for (int y = bestY0; y < bestY1; y++) {
+                for (int x = bestX0; x < bestX1; x++) {
+                    remaining[y * sizeX + x] = 0;
+                }
+            }
+            result.score += R::SCORING_TYPE == rules::Scoring::PER_MOVE ? 1 : best;
+            result.clearedApples += best;
+        }
+    }
+
+    // by the share of apples the greedy solver clears
+    Difficulty classify(int clearedApples, int appleCount);
+
+    // same seed for everyone on the same (UTC) day
+    uint64_t dailySeed(int64_t daysSinceEpoch);
+
+    struct BoardInfo {
+        uint64_t seed;
+        int32_t solverScore;
+        const uint8_t* values; // row major, sizeX * sizeY
+    };
+
+    // Read only view of a memory mapped library file
+    class Library {
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_mapping = nullptr; // platform handle kept until close()
+
+    public:
+        Library() = default;
+        ~Library();
+
+        Library(const Library&) = delete;
+        Library& operator=(const Library&) = delete;
+
+        // false if the file doesn't exist or is not a valid library
+        bool open(const std::filesystem::path& path);
+        void close();
+
+        size_t boardCount(int sizeX, int sizeY, rules::Variant variant, Difficulty difficulty) const;
+        // choice-th board of the group (modulo its size), false if the group is empty
+        bool pick(int sizeX, int sizeY, rules::Variant variant, Difficulty difficulty, uint64_t choice,
+            BoardInfo& board) const;
+    };
+
+    struct BuildSpec {
+        int sizeX;
+        int sizeY;
+        rules::Variant variant;
+        int candidates; // boards generated and sorted into the difficulties
+    };
+
+    // Generates, solves and classifies the boards of all specs in parallel and writes the library.
+    // Seeds of a spec are drawn from baseSeed, so the same arguments build the same file.
+    bool build(const std::filesystem::path& path, const std::vector<BuildSpec>& specs, uint64_t baseSeed);
+} // namespace boards
@@ -1,18 +1,33 @@
 #include "controller.h"
 
 #include <utility>
+#ifdef _WIN32
 #include <Windowsx.h>
+#endif
+#include "helper.h"
+
+namespace {
+    void capturePendingKey(UINT64* pendingTimes, size_t keycode) {
+        if (keycode < 256 && pendingTimes[keycode] == 0) {
+            pendingTimes[keycode] = help::myTimer64us();
+        }
+    }
+} // namespace
 
 Controller::Controller() {
     for (int i = 0; i < 256; i++) {
         m_keyStates[0][i] = false;
         m_keyStates[1][i] = false;
+        m_keyEventTimesUs[i] = 0;
+        m_pendingKeyTimesUs[i] = 0;
+        m_heldKeys[i] = false;
     }
 
     m_currKeyStates = m_keyStates[0];
     m_prevKeyStates = m_keyStates[1];
 }
 
+#ifdef _WIN32
 void Controller::processWindowMsg(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
     case WM_SETFOCUS:
@@ -27,11 +42,50 @@ void Controller::processWindowMsg(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lP
         m_mousePos = PairXY<INT>(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
     } break;
 
+    case WM_LBUTTONDOWN:
+    case WM_LBUTTONUP:
+        capturePendingKey(m_pendingKeyTimesUs, VK_LBUTTON);
+    break;
+
+    case WM_RBUTTONDOWN:
+    case WM_RBUTTONUP:
+        capturePendingKey(m_pendingKeyTimesUs, VK_RBUTTON);
+    break;
+
+    case WM_KEYDOWN:
+    case WM_KEYUP:
+        capturePendingKey(m_pendingKeyTimesUs, wParam);
+    break;
+
+    case WM_MOUSEWHEEL: {
+        m_wheelAccumulated += GET_WHEEL_DELTA_WPARAM(wParam);
+    } break;
+
     case WM_SIZE: {
         m_windowSize = PairXY<INT>(LOWORD(lParam), HIWORD(lParam));
     } break;
     }
 }
+#endif
+
+void Controller::setKeyDown(UINT8 keycode, bool down) {
+    if (m_heldKeys[keycode] != down) {
+        capturePendingKey(m_pendingKeyTimesUs, keycode);
+    }
+    m_heldKeys[keycode] = down;
+}
+
+void Controller::setMousePos(INT x, INT y) {
+    m_mousePos = PairXY<INT>(x, y);
+}
+
+void Controller::setWindowSize(INT x, INT y) {
+    m_windowSize = PairXY<INT>(x, y);
+}
+
+void Controller::addWheelDelta(INT delta) {
+    m_wheelAccumulated += delta;
+}
 
 
 Controller::PairXY<INT> Controller::mousePos() const {
@@ -42,12 +96,31 @@ Controller::PairXY<INT> Controller::windowSize() const {
     return m_windowSize;
 }
 
+INT Controller::wheelDelta() const {
+    return m_wheelDelta;
+}
+
 
 void Controller::pollAllKeys(bool onlyIfInFocus) {
     std::swap(m_currKeyStates, m_prevKeyStates);
 
+    m_wheelDelta = (m_inFocus || !onlyIfInFocus) ? m_wheelAccumulated : 0;
+    m_wheelAccumulated = 0;
+
+    UINT64 pollTimeUs = help::myTimer64us();
     for (int i = 0; i < 256; i++) {
-        m_currKeyStates[i] = (m_inFocus || !onlyIfInFocus) ? (GetAsyncKeyState(i) < 0) : false;
+#ifdef _WIN32
+        bool down = GetAsyncKeyState(i) < 0 || m_heldKeys[i];
+#else
+        bool down = m_heldKeys[i];
+#endif
+        m_currKeyStates[i] = (m_inFocus || !onlyIfInFocus) ? down : false;
+
+        if (m_currKeyStates[i] != m_prevKeyStates[i]) {
+            m_keyEventTimesUs[i] = (m_pendingKeyTimesUs[i] != 0) ? m_pendingKeyTimesUs[i] : pollTimeUs;
+        }
+        m_pendingKeyTimesUs[i] = 0; // press and release both between polls is never seen as a transition
+
     }
 }
 
@@ -62,3 +135,7 @@ bool Controller::keyJustDown(UINT8 keycode) const {
 bool Controller::keyJustUp(UINT8 keycode) const {
     return !m_currKeyStates[keycode] && m_prevKeyStates[keycode];
 }
+
+UINT64 Controller::keyEventTimeUs(UINT8 keycode) const {
+    return m_keyEventTimesUs[keycode];
+}
@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <Windows.h>
+#include "platform.h"
 
 class Controller {
 public:
@@ -30,18 +30,38 @@ private:
     bool* m_currKeyStates;
     bool* m_prevKeyStates;
 
+    // capture times of key transitions (help::myTimer64us), for latency measurement
+    UINT64 m_keyEventTimesUs[256];
+    UINT64 m_pendingKeyTimesUs[256]; // from window messages, not yet seen by polling
+    bool m_heldKeys[256]; // set down with setKeyDown
+
     bool m_inFocus = true;
 
     PairXY<INT> m_windowSize = PairXY(0, 0);
     PairXY<INT> m_mousePos = PairXY(0, 0);
+
+    INT m_wheelAccumulated = 0;
+    INT m_wheelDelta = 0;
 public:
     Controller();
     
+#ifdef _WIN32
     void processWindowMsg(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+#endif
+
+    // Input without a window (tests, benchmarks, servers), seen by pollAllKeys like window messages.
+    // Keys set down here are down in addition to the ones held on the keyboard and mouse.
+    void setKeyDown(UINT8 keycode, bool down);
+    void setMousePos(INT x, INT y);
+    void setWindowSize(INT x, INT y);
+    void addWheelDelta(INT delta);
 
     PairXY<INT> mousePos() const;
     PairXY<INT> windowSize() const;
 
+    // Mouse wheel movement since the previous pollAllKeys, in WHEEL_DELTA units (120 per notch)
+    INT wheelDelta() const;
+
     // Checks all 256 keycodes if they are down. If onlyIfInFocus is true,
     // and the window is out of focus registers all keys as up.
     void pollAllKeys(bool onlyIfInFocus = true);
@@ -50,4 +70,8 @@ public:
     bool keyJustDown(UINT8 keycode) const;
     bool keyJustUp(UINT8 keycode) const;
 
+    // Time the last down/up transition of the key was captured at. That is when its window
+    // message arrived if there was one, otherwise when the transition was seen by polling.
+    UINT64 keyEventTimeUs(UINT8 keycode) const;
+
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "dirtyRegions.h"
+
+#include <algorithm>
+
+using Rect = DirtyRegionTracker::Rect;
+
+float Rect::area() const {
+    return (right > left && bottom > top) ? (right - left) * (bottom - top) : 0.0f;
+}
+
+bool Rect::intersects(const Rect& other) const {
+    return left < other.right && other.left < right &&
+        top < other.bottom && other.top < bottom;
+}
+
+Rect Rect::united(const Rect& other) const {
+    return {
+        .left = std::min(left, other.left),
+        .top = std::min(top, other.top),
+        .right = std::max(right, other.right),
+        .bottom = std::max(bottom, other.bottom),
+    };
+}
+
+Rect Rect::inflated(float by) const {
+    return { .left = left - by, .top = top - by, .right = right + by, .bottom = bottom + by };
+}
+
+
+DirtyRegionTracker::DirtyRegionTracker(Rect screen, size_t maxRects) {
+    m_screen = screen;
+    m_maxRects = std::max<size_t>(maxRects, 1);
+}
+
+void DirtyRegionTracker::invalidateAll() {
+    m_allDirty = true;
+}
+
+void DirtyRegionTracker::invalidate(const Rect& rect) {
+    m_dirty.push_back(rect);
+}
+
+void DirtyRegionTracker::addItem(uint64_t id, const Rect& bounds, uint64_t state) {
+    m_currItems.push_back({ .id = id, .bounds = bounds, .state = state });
+}
+
+const std::vector<Rect>& DirtyRegionTracker::finishFrame() {
+    std::sort(m_currItems.begin(), m_currItems.end(),
+        [](const Item& a, const Item& b) { return a.id < b.id; });
+
+    // walk both sorted lists at once:
+    size_t p = 0, c = 0;
+    while (p < m_prevItems.size() || c < m_currItems.size()) {
+        if (c == m_currItems.size() || (p < m_prevItems.size() && m_prevItems[p].id < m_currItems[c].id)) {
+            m_dirty.push_back(m_prevItems[p++].bounds); // removed
+        } else if (p == m_prevItems.size() || m_currItems[c].id < m_prevItems[p].id) {
+            m_dirty.push_back(m_currItems[c++].bounds); // added
+        } else {
+            const Item& prev = m_prevItems[p++];
+            const Item& curr = m_currItems[c++];
+            if (prev.state != curr.state || std::memcmp(&prev.bounds, &curr.bounds, sizeof(Rect)) != 0) {
+                m_dirty.push_back(prev.bounds);
+                m_dirty.push_back(curr.bounds);
+            }
+        }
+    }
+
+    std::swap(m_prevItems, m_currItems);
+    m_currItems.clear();
+
+    if (m_allDirty) {
+        m_dirty.clear();
+        m_dirty.push_back(m_screen);
+    } else {
+        mergeDirty();
+    }
+    m_fullRedraw = m_allDirty;
+    m_allDirty = false;
+
+    // returned by reference, so it's cleared at the start of next frame's collection instead
+    m_currDirty.swap(m_dirty);
+    m_dirty.clear();
+    return m_currDirty;
+}
+
+float DirtyRegionTracker::dirtyArea() const {
+    float area = 0.0f;
+    for (const Rect& rect : m_currDirty) {
+        area += rect.area();
+    }
+    return area;
+}
+
+void DirtyRegionTracker::mergeDirty() {
+    // clip to screen and drop empty rects:
+    for (Rect& rect : m_dirty) {
+        rect.left = std::max(rect.left, m_screen.left);
+        rect.top = std::max(rect.top, m_screen.top);
+        rect.right = std::min(rect.right, m_screen.right);
+        rect.bottom = std::min(rect.bottom, m_screen.bottom);
+    }
+    std::erase_if(m_dirty, [](const Rect& rect) { return rect.area() <= 0.0f; });
+
+    // with lots of rects (e.g. many falling apples) first bin them into horizontal bands,
+    // so the pairwise merging below stays cheap:
+    if (m_dirty.size() > 4 * m_maxRects) {
+        float bandHeight = (m_screen.bottom - m_screen.top) / m_maxRects;
+        std::vector<Rect> bands;
+        std::vector<bool> bandUsed(m_maxRects, false);
+        bands.resize(m_maxRects);
+        for (const Rect& rect : m_dirty) {
+            float center = (rect.top + rect.bottom) / 2.0f;
+            size_t band = std::min(m_maxRects - 1, static_cast<size_t>(std::max(0.0f, (center - m_screen.top) / bandHeight)));
+            bands[band] = bandUsed[band] ? bands[band].united(rect) : rect;
+            bandUsed[band] = true;
+        }
+        m_dirty.clear();
+        for (size_t i = 0; i < m_maxRects; i++) {
+            if (bandUsed[i]) { m_dirty.push_back(bands[i]); }
+        }
+    }
+
+    // merge overlapping rects, and then the pairs wasting least area, until there are few enough:
+    bool merged = true;
+    while (merged && m_dirty.size() > 1) {
+        merged = false;
+
+        size_t bestA = 0, bestB = 0;
+        float bestWaste = 0.0f;
+        bool bestFound = false;
+        for (size_t a = 0; a < m_dirty.size(); a++) {
+            for (size_t b = a + 1; b < m_dirty.size(); b++) {
+                float waste = m_dirty[a].united(m_dirty[b]).area() - m_dirty[a].area() - m_dirty[b].area();
+                if (!bestFound || waste < bestWaste) {
+                    bestA = a;
+                    bestB = b;
+                    bestWaste = waste;
+                    bestFound = true;
+                }
+            }
+        }
+
+        if (bestFound && (bestWaste <= 0.0f || m_dirty.size() > m_maxRects)) {
+            m_dirty[bestA] = m_dirty[bestA].united(m_dirty[bestB]);
+            m_dirty.erase(m_dirty.begin() + bestB);
+            merged = true;
+        }
+    }
+
+    // redrawing everything at once is cheaper than many rects covering most of the screen
+    float area = 0.0f;
+    for (const Rect& rect : m_dirty) {
+        area += rect.area();
+    }
+    if (area > 0.6f * m_screen.area()) {
+        m_dirty.clear();
+        m_dirty.push_back(m_screen);
+    }
+}
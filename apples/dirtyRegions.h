@@ -0,0 +1,77 @@
+// Tracks which parts of the screen changed between frames, so only those have to be redrawn.
+// Every frame the drawing code reports its changing ("dynamic") items with bounds and a hash
+// of everything that affects their look; finishFrame() compares them with the previous frame.
+// Doesn't depend on any platform headers, so it can be built and tested on any OS.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class DirtyRegionTracker {
+public:
+    struct Rect {
+        float left, top, right, bottom;
+
+        float area() const;
+        bool intersects(const Rect& other) const;
+        Rect united(const Rect& other) const;
+        Rect inflated(float by) const;
+    };
+
+private:
+    struct Item {
+        uint64_t id;
+        Rect bounds;
+        uint64_t state;
+    };
+
+    std::vector<Item> m_prevItems; // sorted by id
+    std::vector<Item> m_currItems;
+    std::vector<Rect> m_dirty;     // collected for the next finishFrame()
+    std::vector<Rect> m_currDirty; // returned by the last finishFrame()
+
+    Rect m_screen;
+    size_t m_maxRects;
+    bool m_allDirty = true;
+    bool m_fullRedraw = true;
+
+public:
+    // Dirty rects are clipped to screen, and if they would cover most of it
+    // or there would be more than maxRects of them, they get merged.
+    DirtyRegionTracker(Rect screen, size_t maxRects = 8);
+
+    // Next finishFrame() reports whole screen as dirty, e.g. after the static layer was redrawn.
+    void invalidateAll();
+    void invalidate(const Rect& rect);
+
+    // Item ids must be unique within a frame. Items that are added, removed, moved
+    // or change their state between frames mark both their old and new bounds as dirty.
+    void addItem(uint64_t id, const Rect& bounds, uint64_t state);
+
+    // Returns regions to redraw this frame and starts collecting items for the next one.
+    const std::vector<Rect>& finishFrame();
+
+    // True if the last finishFrame() reported the whole screen
+    bool fullRedraw() const { return m_fullRedraw; }
+    // Area covered by the rects returned from the last finishFrame()
+    float dirtyArea() const;
+
+    // Hashes raw bytes of all arguments (plain values without padding), used to build item states
+    template<typename... Ts>
+    static uint64_t stateHash(const Ts&... values) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        (hashBytes(hash, &values, sizeof(values)), ...);
+        return hash;
+    }
+
+private:
+    static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+
+    void mergeDirty();
+};
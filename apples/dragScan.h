@@ -0,0 +1,95 @@
+// The drag test: which apples of a board a drag selects. Board sizes almost every game is played on
+// are compiled for their size, so the chunk layout and cell indexing are constants and only the cells
+// of the dragged over range are visited. Other sizes, huge boards among them, run whole chunks through
+// the vectorized kernels. Both select the same apples in the same order.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include "gameState.h"
+#include "simd.h"
+
+namespace dragScan {
+    // apple positions are read in place
+    const simd::PointLayout APPLE_POINTS = {
+        .stride = sizeof(gamestate::Apple),
+        .xOffset = offsetof(gamestate::Apple, fixedX),
+        .yOffset = offsetof(gamestate::Apple, fixedY),
+        .skipOffset = offsetof(gamestate::Apple, popped),
+        .unit = gamestate::FALL_UNIT,
+    };
+    static_assert(offsetof(gamestate::Apple, popped) + 4 <= sizeof(gamestate::Apple));
+    const INT CHUNK_CELLS = gamestate::AppleGrid::CHUNK_SIZE * gamestate::AppleGrid::CHUNK_SIZE;
+
+    template<INT X, INT Y>
+    struct FixedExtents {
+        static constexpr INT SIZE_X = X;
+        static constexpr INT SIZE_Y = Y;
+    };
+    struct RuntimeExtents {};
+
+    // the default board and the biggest regular one
+    using FixedSizes = std::tuple<FixedExtents<gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y>,
+        FixedExtents<gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y>>;
+
+    // Calls f with the FixedSizes entry of the board's size, RuntimeExtents if there is none
+    template<size_t I = 0, typename F>
+    void visitExtents(const gamestate::AppleGrid& apples, F f) {
+        if constexpr (I == std::tuple_size_v<FixedSizes>) {
+            f(RuntimeExtents());
+        } else {
+            using Extents = std::tuple_element_t<I, FixedSizes>;
+            if (apples.sizeX() == Extents::SIZE_X && apples.sizeY() == Extents::SIZE_Y) {
+                f(Extents());
+            } else {
+                visitExtents<I + 1>(apples, f);
+            }
+        }
+    }
+
+    // Calls select(apple, x, y) for the unpopped apples in bounds among the cells of [minX, maxX] x
+    // [minY, maxY], in the order forEachChunkOver visits them. The range has to cover the cells under
+    // bounds, as GameState::cellsOver does, and margin is less than half an apple.
+    template<typename Extents, typename F>
+    void selectInBounds(gamestate::AppleGrid& apples, INT minX, INT minY, INT maxX, INT maxY, const simd::Bounds& bounds, F select) {
+        if constexpr (std::is_same_v<Extents, RuntimeExtents>) {
+            apples.forEachChunkOver(minX, minY, maxX, maxY, [&](gamestate::AppleGrid::Chunk& chunk) {
+                UINT64 selected[CHUNK_CELLS / 64];
+                simd::selectInBounds(chunk.cells.data(), chunk.cells.size(), APPLE_POINTS, bounds, selected);
+                for (size_t word = 0; word * 64 < chunk.cells.size(); word++) {
+                    for (UINT64 bits = selected[word]; bits != 0; bits &= bits - 1) {
+                        INT i = static_cast<INT>(word * 64) + std::countr_zero(bits);
+                        select(chunk.cells[i], chunk.originX + i % chunk.sizeX, chunk.originY + i / chunk.sizeX);
+                    }
+                }
+            });
+        } else {
+            constexpr INT CHUNK = gamestate::AppleGrid::CHUNK_SIZE;
+            constexpr INT CHUNKS_X = (Extents::SIZE_X + CHUNK - 1) / CHUNK;
+            minX = max(minX, 0);
+            minY = max(minY, 0);
+            maxX = min(maxX, Extents::SIZE_X - 1);
+            maxY = min(maxY, Extents::SIZE_Y - 1);
+
+            for (INT cy = minY / CHUNK; cy <= maxY / CHUNK; cy++) {
+                for (INT cx = minX / CHUNK; cx <= maxX / CHUNK; cx++) {
+                    gamestate::Apple* cells = apples.chunk(cy * CHUNKS_X + cx).cells.data();
+                    INT chunkSizeX = min(CHUNK, Extents::SIZE_X - cx * CHUNK);
+                    // apples sit in the middle of their cells, none outside of the range is in bounds
+                    for (INT y = max(minY, cy * CHUNK); y <= min(maxY, cy * CHUNK + CHUNK - 1); y++) {
+                        for (INT x = max(minX, cx * CHUNK); x <= min(maxX, cx * CHUNK + CHUNK - 1); x++) {
+                            gamestate::Apple& apple = cells[(y - cy * CHUNK) * chunkSizeX + (x - cx * CHUNK)];
+                            if (!apple.popped &&
+                                apple.posX() + bounds.margin >= bounds.left && apple.posX() - bounds.margin <= bounds.right &&
+                                apple.posY() + bounds.margin >= bounds.top && apple.posY() - bounds.margin <= bounds.bottom) {
+                                select(apple, x, y);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+} // namespace dragScan
@@ -2,6 +2,13 @@
 
 #include "helper.h"
 #include "bitmapFileLoader.h"
+#include "dirtyRegions.h"
+#include "renderStats.h"
+#include "latency.h"
+#include "memoryStats.h"
+#include "qualityGovernor.h"
+#include "scaledBitmap.h"
+#include "appleDetail.h"
 
 using D2D1::Point2F;
 using D2D1::ColorF;
@@ -9,6 +16,7 @@ using D2D1::Matrix3x2F;
 using help::hCheck;
 using gamestate::GameState;
 using gamestate::Apple;
+using SingletonPlay = gamestate::GameState::SingletonPlay;
 
 static_assert(gamestate::LOGICAL_WINDOW_SIZE_X == 1920.0f);
 static_assert(gamestate::LOGICAL_WINDOW_SIZE_Y == 1080.0f);
@@ -23,19 +31,92 @@ namespace {
     ID2D1PathGeometry* appleGeometry = nullptr;
     ID2D1PathGeometry* leafGeometry = nullptr;
     ID2D1RadialGradientBrush* appleGradientBrush = nullptr;
-    ID2D1Bitmap* mainMenuBgBitmap = nullptr;
     ID2D1Bitmap* dragBitmap = nullptr;
-    ID2D1Bitmap* tutorialBitmap = nullptr;
-    ID2D1Bitmap* houseBitmap = nullptr;
+    // decoded once, device bitmaps of them are render target dependent
+    ScaledBitmap mainMenuBgBitmap;
+    ScaledBitmap tutorialBitmap;
+    ScaledBitmap houseBitmap;
+
+    // Retained layer with everything that doesn't change from frame to frame (background, border,
+    // texts, settled apples...). It's redrawn only when its inputs change, otherwise each frame only
+    // the dirty regions around dynamic items are recomposed from it.
+    ID2D1BitmapRenderTarget* staticLayer = nullptr;
+    ID2D1Bitmap* staticLayerBitmap = nullptr;
+    D2D1_SIZE_U staticLayerPixelSize = {};
+    UINT64 staticLayerKey = 0;
+    bool staticLayerValid = false;
+
+    struct DynamicItem {
+        enum class Kind {
+            BUTTON,
+            TIMER,
+            DRAGGED_APPLE,
+            FALLING_APPLE,
+            DRAG_RECT,
+            GAME_OVER,
+            STATS_OVERLAY,
+        };
+        Kind kind;
+        INT player = 0;
+        const gamestate::Button* button = nullptr;
+        gamestate::CellXY cell = {};
+        DirtyRegionTracker::Rect bounds;
+    };
+    std::vector<DynamicItem> dynamicItems; // in drawing order
+    DirtyRegionTracker dirtyTracker({ 0.0f, 0.0f, gamestate::LOGICAL_WINDOW_SIZE_X, gamestate::LOGICAL_WINDOW_SIZE_Y });
+
+    // Forwards drawing calls to the current render target, counting them for render stats
+    class CountingTarget {
+    public:
+        ID2D1RenderTarget* target = nullptr; // main render target or static layer
+
+        void Clear(const D2D1_COLOR_F& color) { renderStats::countDrawCall(); target->Clear(color); }
+        void SetTransform(const Matrix3x2F& transform) { renderStats::countTransform(); target->SetTransform(transform); }
+        void PushAxisAlignedClip(const D2D1_RECT_F& rect, D2D1_ANTIALIAS_MODE mode) { target->PushAxisAlignedClip(rect, mode); }
+        void PopAxisAlignedClip() { target->PopAxisAlignedClip(); }
+
+        template<typename... Args> void DrawTextW(Args... args) { renderStats::countText(); target->DrawTextW(args...); }
+        template<typename... Args> void DrawBitmap(Args... args) { renderStats::countDrawCall(); target->DrawBitmap(args...); }
+        template<typename... Args> void DrawGeometry(Args... args) { renderStats::countDrawCall(); target->DrawGeometry(args...); }
+        template<typename... Args> void FillGeometry(Args... args) { renderStats::countDrawCall(); target->FillGeometry(args...); }
+        template<typename... Args> void DrawLine(Args... args) { renderStats::countDrawCall(); target->DrawLine(args...); }
+        template<typename... Args> void DrawRectangle(Args... args) { renderStats::countDrawCall(); target->DrawRectangle(args...); }
+        template<typename... Args> void FillRectangle(Args... args) { renderStats::countDrawCall(); target->FillRectangle(args...); }
+        template<typename... Args> void DrawRoundedRectangle(Args... args) { renderStats::countDrawCall(); target->DrawRoundedRectangle(args...); }
+        template<typename... Args> void FillRoundedRectangle(Args... args) { renderStats::countDrawCall(); target->FillRoundedRectangle(args...); }
+        template<typename... Args> void FillEllipse(Args... args) { renderStats::countDrawCall(); target->FillEllipse(args...); }
+    };
+    CountingTarget countingTarget;
+
+    void setBrushColor(const D2D1_COLOR_F& color) {
+        renderStats::countBrushColor();
+        solidBrush->SetColor(color);
+    }
+
+    // lowered by the frame loop when frames miss their budget
+    INT qualityLevel = 0;
+    qualityGovernor::Settings quality = qualityGovernor::settingsFor(0);
+
+    // stats overlay text is refreshed a few times per second to stay readable
+    std::wstring statsOverlayText;
+    timeBase::Ns statsOverlayUpdatedNs = 0;
 
     // universal arguments to helper functions (no point in typing them for each helper function):
     const MyD2DObjectCollection* p_myd2d;
     const GameState* p_gameState;
+    const SingletonPlay* p_play; // board being drawn
+    CountingTarget* const p_target = &countingTarget;
     Matrix3x2F finalTransform;
 
+    D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode();
+    void updateStaticLayer();
+    void collectDynamicItems();
+    void composeRegion(const DirtyRegionTracker::Rect& rect, bool fullRedraw);
+
     void mainMenu();
     void helpMenu();
     void playing();
+    void drawBoard(const SingletonPlay& play);
 } // namespace
 
 void drawLogic::init(const MyD2DObjectCollection& myd2d, rtd rtdv) {
@@ -75,6 +156,11 @@ void drawLogic::init(const MyD2DObjectCollection& myd2d, rtd rtdv) {
 
             help::SafeRelease(font_collection);
         }
+
+        // load images:
+        mainMenuBgBitmap.setSource(LoadImageFromFile(myd2d.imaging_factory, L"assets/images/bigTree.png"));
+        tutorialBitmap.setSource(LoadImageFromFile(myd2d.imaging_factory, L"assets/images/tutorial.png"));
+        houseBitmap.setSource(LoadImageFromFile(myd2d.imaging_factory, L"assets/images/house.png"));
     }
 
     if (rtdv == rtd::ONLY_RENDER_TARGET_DEPENDENT || rtdv == rtd::ALL) {
@@ -126,14 +212,6 @@ void drawLogic::init(const MyD2DObjectCollection& myd2d, rtd rtdv) {
 
         }
 
-        // load images:
-        mainMenuBgBitmap = LoadBitmapFromFile(myd2d.d2d_render_target, myd2d.imaging_factory,
-            L"assets/images/bigTree.png");
-        tutorialBitmap = LoadBitmapFromFile(myd2d.d2d_render_target, myd2d.imaging_factory,
-            L"assets/images/tutorial.png");
-        houseBitmap = LoadBitmapFromFile(myd2d.d2d_render_target, myd2d.imaging_factory,
-            L"assets/images/house.png");
-
         // create bitmap for dragging over apples:
         {
             const BYTE BMP_DATA[4] = {0x00, 0x30, 0x40, 0x40};
@@ -150,70 +228,162 @@ void drawLogic::init(const MyD2DObjectCollection& myd2d, rtd rtdv) {
     }
 }
 
-void drawLogic::drawFrame(const MyD2DObjectCollection& myd2d, const GameState& gameState) {
-    myd2d.d2d_render_target->Clear(BG_COLOR);
+void drawLogic::setQuality(INT level) {
+    qualityLevel = level;
+    quality = qualityGovernor::settingsFor(level);
+}
 
+void drawLogic::drawFrame(const MyD2DObjectCollection& myd2d, const GameState& gameState) {
     p_myd2d = &myd2d;
     p_gameState = &gameState;
     finalTransform = Matrix3x2F::Scale(gameState.graphicalScale, gameState.graphicalScale)
         * Matrix3x2F::Translation(gameState.graphicalOffsetX, gameState.grpahicalOffsetY);
-    myd2d.d2d_render_target->SetTransform(finalTransform);
 
+    updateStaticLayer();
+    collectDynamicItems();
 
-    if (gameState.mode == GameState::Mode::TITLE_MENU ||
-        gameState.mode == GameState::Mode::MAIN_MENU) {
-        p_myd2d->d2d_render_target->DrawBitmap(mainMenuBgBitmap,
-            D2D1::Rect(30.0f, 30.0f, 1890.0f, 1050.0f), 1.0f,
-            D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+    countingTarget.target = myd2d.d2d_render_target;
+    myd2d.d2d_render_target->SetTextAntialiasMode(textAntialiasMode());
+    for (const DirtyRegionTracker::Rect& rect : dirtyTracker.finishFrame()) {
+        composeRegion(rect, dirtyTracker.fullRedraw());
+    }
 
-        D2D1_RECT_F textRect = D2D1::Rect(230.0f, 120.0f, 1920.0f, 1080.0f);
+    p_myd2d = nullptr;
+    p_gameState = nullptr;
+    countingTarget.target = nullptr;
+}
 
-        std::wstring text = L"Apple";
-        solidBrush->SetColor(ColorF(ColorF::DarkRed));
-        p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
-            textFormatComicSans, textRect, solidBrush);
 
-        textRect.left = 820.0f;
-        text = L"Container";
-        solidBrush->SetColor(ColorF(ColorF::LawnGreen));
-        p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
-            textFormatComicSans, textRect, solidBrush);
+namespace {
+    D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode() {
+        return quality.textAntialiasing ? D2D1_TEXT_ANTIALIAS_MODE_DEFAULT : D2D1_TEXT_ANTIALIAS_MODE_ALIASED;
     }
 
-    // draw border:
-    solidBrush->SetColor(ColorF(ColorF::Green));
-    myd2d.d2d_render_target->DrawRoundedRectangle(
-        D2D1::RoundedRect(D2D1::Rect(30.0f, 30.0f, 1890.0f, 1050.0f), 30.0f, 30.0f),
-        solidBrush, 40.0f);
+    D2D1_BITMAP_INTERPOLATION_MODE imageInterpolation() {
+        return quality.smoothImages ? D2D1_BITMAP_INTERPOLATION_MODE_LINEAR : D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR;
+    }
 
+    // Bitmap for drawing into rect (logical, with the transform's extra scale), prescaled to the
+    // pixel size it covers when that's smaller than the image
+    ID2D1Bitmap* scaledFor(ScaledBitmap& bitmap, const D2D1_RECT_F& rect, FLOAT scale) {
+        FLOAT pixelScale = scale * p_gameState->graphicalScale;
+        return bitmap.get(p_myd2d->d2d_render_target,
+            static_cast<UINT32>((rect.right - rect.left) * pixelScale + 0.5f),
+            static_cast<UINT32>((rect.bottom - rect.top) * pixelScale + 0.5f));
+    }
+
+    // everything that goes into the static layer:
+    void drawStaticContent() {
+        renderStats::setSection(renderStats::Section::MENU);
+        p_target->Clear(BG_COLOR);
+        p_target->SetTransform(finalTransform);
+
+        if (p_gameState->mode == GameState::Mode::TITLE_MENU ||
+            p_gameState->mode == GameState::Mode::MAIN_MENU) {
+            D2D1_RECT_F bgRect = D2D1::Rect(30.0f, 30.0f, 1890.0f, 1050.0f);
+            p_target->DrawBitmap(scaledFor(mainMenuBgBitmap, bgRect, 1.0f),
+                bgRect, 1.0f,
+                imageInterpolation());
+
+            renderStats::setSection(renderStats::Section::TEXT);
+            D2D1_RECT_F textRect = D2D1::Rect(230.0f, 120.0f, 1920.0f, 1080.0f);
+
+            std::wstring text = L"Apple";
+            setBrushColor(ColorF(ColorF::DarkRed));
+            p_target->DrawTextW(text.data(), text.size(),
+                textFormatComicSans, textRect, solidBrush);
+
+            textRect.left = 820.0f;
+            text = L"Container";
+            setBrushColor(ColorF(ColorF::LawnGreen));
+            p_target->DrawTextW(text.data(), text.size(),
+                textFormatComicSans, textRect, solidBrush);
+        }
+
+        // draw border:
+        renderStats::setSection(renderStats::Section::MENU);
+        setBrushColor(ColorF(ColorF::Green));
+        p_target->DrawRoundedRectangle(
+            D2D1::RoundedRect(D2D1::Rect(30.0f, 30.0f, 1890.0f, 1050.0f), 30.0f, 30.0f),
+            solidBrush, 40.0f);
 
-    switch (gameState.mode) {
-    case GameState::Mode::MAIN_MENU:
-        mainMenu();
-        break;
 
-    case GameState::Mode::HELP_MENU:
-        helpMenu();
-        break;
+        switch (p_gameState->mode) {
+        case GameState::Mode::MAIN_MENU:
+            mainMenu();
+            break;
 
-    case GameState::Mode::PLAYING:
-        playing();
-        break;
+        case GameState::Mode::HELP_MENU:
+            helpMenu();
+            break;
+
+        case GameState::Mode::PLAYING:
+            playing();
+            break;
+        }
+    }
+
+    void releaseStaticLayer() {
+        if (staticLayer != nullptr) {
+            memoryStats::freed(memoryStats::Tag::DEVICE_BITMAPS,
+                static_cast<size_t>(staticLayerPixelSize.width) * staticLayerPixelSize.height * 4);
+        }
+        help::SafeRelease(staticLayerBitmap);
+        help::SafeRelease(staticLayer);
     }
-    p_myd2d = nullptr;
-    p_gameState = nullptr;
-}
 
+    void updateStaticLayer() {
+        ID2D1HwndRenderTarget* renderTarget = p_myd2d->d2d_render_target;
+        D2D1_SIZE_U pixelSize = renderTarget->GetPixelSize();
+
+        if (staticLayer == nullptr ||
+            pixelSize.width != staticLayerPixelSize.width || pixelSize.height != staticLayerPixelSize.height) {
+            releaseStaticLayer();
+            hCheck(renderTarget->CreateCompatibleRenderTarget(renderTarget->GetSize(), pixelSize, &staticLayer));
+            hCheck(staticLayer->GetBitmap(&staticLayerBitmap));
+            staticLayerPixelSize = pixelSize;
+            memoryStats::allocated(memoryStats::Tag::DEVICE_BITMAPS,
+                static_cast<size_t>(pixelSize.width) * pixelSize.height * 4);
+            staticLayerValid = false;
+        }
+
+        // scaled images that finished in the background since the last frame
+        mainMenuBgBitmap.update(renderTarget);
+        tutorialBitmap.update(renderTarget);
+        houseBitmap.update(renderTarget);
+
+        const GameState& gs = *p_gameState;
+        UINT64 boardsKey = 0;
+        for (INT i = 0; i < gs.playerCount; i++) {
+            const SingletonPlay& play = gs.players[i];
+            boardsKey = boardsKey * 31 + DirtyRegionTracker::stateHash(play.boardRevision,
+                play.viewZoom, play.viewCenterX, play.viewCenterY);
+        }
+        UINT64 key = DirtyRegionTracker::stateHash(gs.mode,
+            gs.graphicalScale, gs.graphicalOffsetX, gs.grpahicalOffsetY,
+            gs.highScore, gs.appleCountX, gs.appleCountY, gs.playTime, gs.hugeBoard, gs.ruleVariant,
+            gs.boardChoice, gs.playerCount, boardsKey, mainMenuBgBitmap.revision(), tutorialBitmap.revision(), qualityLevel);
+        if (staticLayerValid && key == staticLayerKey) { return; }
+
+        countingTarget.target = staticLayer;
+        staticLayer->SetTextAntialiasMode(textAntialiasMode());
+        staticLayer->BeginDraw();
+        drawStaticContent();
+        // on failure the main render target fails as well and all of it gets recreated
+        staticLayerValid = staticLayer->EndDraw() >= 0;
+        staticLayerKey = key;
+
+        dirtyTracker.invalidateAll();
+    }
 
-namespace {
     void drawButton(const gamestate::Button& buttonData) {
         D2D1_RECT_F thisRect = D2D1::Rect(buttonData.left, buttonData.top,
             buttonData.right, buttonData.bottom);
 
 
-        solidBrush->SetColor(buttonData.hoverOver(p_gameState->logicalMouseX, p_gameState->logicalMouseY) ?
+        setBrushColor(buttonData.hoverOver(p_gameState->logicalMouseX, p_gameState->logicalMouseY) ?
             ColorF(0.2f, 0.8f, 0.2f) : ColorF(0.05f, 0.20f, 0.05f));
-        p_myd2d->d2d_render_target->FillRoundedRectangle(
+        p_target->FillRoundedRectangle(
             D2D1::RoundedRect(thisRect, 5.0f, 5.0f),
             solidBrush);
 
@@ -221,109 +391,164 @@ namespace {
         FLOAT centerX = (thisRect.left + thisRect.right) / 2.0f;
         FLOAT centerY = (thisRect.top + thisRect.bottom) / 2.0f;
         FLOAT textScale = (thisRect.bottom - thisRect.top) / 80.0f; // text is scalled with button height
-        p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(textScale, textScale, D2D1::Point2F(centerX, centerY)) *
+        p_target->SetTransform(Matrix3x2F::Scale(textScale, textScale, D2D1::Point2F(centerX, centerY)) *
             finalTransform);
 
-        solidBrush->SetColor(ColorF(ColorF::White));
-        p_myd2d->d2d_render_target->DrawTextW(
+        setBrushColor(ColorF(ColorF::White));
+        p_target->DrawTextW(
             buttonData.text.data(), buttonData.text.size(),
             textFormatVCR,
             thisRect,
             solidBrush);
 
-        p_myd2d->d2d_render_target->SetTransform(finalTransform);
+        p_target->SetTransform(finalTransform);
+    }
+
+    // VCR text centered in rect, scaled around the rect's center
+    void drawTextScaled(const std::wstring& text, const D2D1_RECT_F& rect, FLOAT scale) {
+        FLOAT centerX = (rect.left + rect.right) / 2.0f;
+        FLOAT centerY = (rect.top + rect.bottom) / 2.0f;
+        p_target->SetTransform(Matrix3x2F::Scale(scale, scale, Point2F(centerX, centerY)) * finalTransform);
+
+        D2D1_RECT_F scaledRect = D2D1::Rect(
+            centerX - (centerX - rect.left) / scale, centerY - (centerY - rect.top) / scale,
+            centerX + (rect.right - centerX) / scale, centerY + (rect.bottom - centerY) / scale);
+        p_target->DrawTextW(text.data(), text.size(),
+            textFormatVCR, scaledRect, solidBrush);
+
+        p_target->SetTransform(finalTransform);
+    }
+
+    // versus mode tile header above a board, split into player, score and time thirds
+    D2D1_RECT_F versusHeaderPart(const SingletonPlay& play, INT part) {
+        FLOAT third = (play.area.right - play.area.left) / 3.0f;
+        return D2D1::Rect(play.area.left + third * part, play.area.top - gamestate::VERSUS_HEADER_HEIGHT,
+            play.area.left + third * (part + 1), play.area.top - 4.0f);
+    }
+
+    const FLOAT APPLE_OUTLINE_WIDTH = 24.0f;
+
+    void fillAppleBody() {
+        if (quality.appleGradient) {
+            p_target->FillGeometry(appleGeometry, appleGradientBrush);
+            return;
+        }
+        setBrushColor(ColorF(ColorF::Red));
+        p_target->FillGeometry(appleGeometry, solidBrush);
     }
 
     void drawAppleGeometry(D2D1::ColorF lineColor) {
-        solidBrush->SetColor(ColorF(ColorF::ForestGreen));
-        p_myd2d->d2d_render_target->FillGeometry(leafGeometry, solidBrush);
+        setBrushColor(ColorF(ColorF::ForestGreen));
+        p_target->FillGeometry(leafGeometry, solidBrush);
 
-        solidBrush->SetColor(ColorF(0.17f, 0.05f, 0.05f));
-        p_myd2d->d2d_render_target->DrawLine(Point2F(0, -95), Point2F(40, -170), solidBrush, 24.0f);
+        setBrushColor(ColorF(0.17f, 0.05f, 0.05f));
+        p_target->DrawLine(Point2F(0, -95), Point2F(40, -170), solidBrush, 24.0f);
 
-        solidBrush->SetColor(ColorF(ColorF::Red));
-        p_myd2d->d2d_render_target->FillGeometry(appleGeometry, appleGradientBrush);
+        fillAppleBody();
 
-        solidBrush->SetColor(lineColor);
-        p_myd2d->d2d_render_target->DrawGeometry(appleGeometry, solidBrush, 24.0f);
+        setBrushColor(lineColor);
+        p_target->DrawGeometry(appleGeometry, solidBrush, APPLE_OUTLINE_WIDTH * quality.outlineScale);
     }
 
-    void drawApple(const Apple& apple, bool popped, bool withText = true) {
-        if (apple.popped != popped) { return; }
-        if (apple.posY > 25000.0f) { return; }
+    void drawApple(const Apple& apple, bool highlighted, bool falling = false) {
+        if (apple.posY() > appleDetail::OUT_OF_SIGHT_Y) { return; }
 
         D2D1_RECT_F thisRect = D2D1::Rect(-150.0f, -150.0f, 150.0f, 150.0f);
-        
-        Matrix3x2F appleTransform = Matrix3x2F::Scale(p_gameState->appleSize / 400.0f, p_gameState->appleSize / 400.0f) * 
-            Matrix3x2F::Rotation(apple.angle) * 
-            Matrix3x2F::Translation(apple.posX, apple.posY) * 
+
+        const SingletonPlay& play = *p_play;
+        FLOAT scale = p_gameState->appleSize * play.viewZoom / 400.0f;
+        Matrix3x2F appleTransform = Matrix3x2F::Scale(scale, scale) *
+            Matrix3x2F::Rotation(apple.angle()) * 
+            Matrix3x2F::Translation(play.toLogicalX(apple.posX()), play.toLogicalY(apple.posY())) *
             finalTransform;
-        p_myd2d->d2d_render_target->SetTransform(appleTransform);
+        p_target->SetTransform(appleTransform);
+
+        ColorF lineColor = highlighted ? ColorF(ColorF::Goldenrod) : ColorF(ColorF::SaddleBrown);
+        switch (appleDetail::select(appleDetail::applePixels(*p_gameState, play), falling)) {
+        case appleDetail::Detail::FULL:
+            drawAppleGeometry(lineColor);
+            break;
+
+        case appleDetail::Detail::SIMPLE:
+            fillAppleBody();
+            setBrushColor(lineColor);
+            p_target->DrawGeometry(appleGeometry, solidBrush, APPLE_OUTLINE_WIDTH * quality.outlineScale);
+            break;
+
+        case appleDetail::Detail::FLAT: {
+            // the outline is a pixel or two wide at this size, the highlight colors the whole cell instead
+            D2D1_ROUNDED_RECT cell = D2D1::RoundedRect(D2D1::Rect(-160.0f, -120.0f, 160.0f, 120.0f), 60.0f, 60.0f);
+            setBrushColor(highlighted ? ColorF(ColorF::DarkGoldenrod) : ColorF(ColorF::Firebrick));
+            p_target->FillRoundedRectangle(cell, solidBrush);
+        } break;
+        }
 
-        drawAppleGeometry(apple.inDrag ? ColorF(ColorF::Goldenrod) : ColorF(ColorF::SaddleBrown));
+        // the number is what the game is played by, so every tier has it
+        p_target->SetTransform(Matrix3x2F::Scale(4.0f, 4.0f) * appleTransform);
 
+        std::wstring text = std::to_wstring(apple.value);
+        setBrushColor(ColorF(ColorF::White));
+        p_target->DrawTextW(
+            text.data(), text.size(),
+            textFormatVCR,
+            thisRect,
+            solidBrush);
 
-        if (withText) {
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(4.0f, 4.0f) * appleTransform);
+        p_target->SetTransform(finalTransform);
+    }
 
-            std::wstring text = std::to_wstring(apple.value);
-            solidBrush->SetColor(ColorF(ColorF::White));
-            p_myd2d->d2d_render_target->DrawTextW(
-                text.data(), text.size(),
-                textFormatVCR,
-                thisRect,
-                solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(finalTransform);
+    std::wstring boardChoiceName(GameState::BoardChoice choice) {
+        switch (choice) {
+        case GameState::BoardChoice::EASY: return L"Easy";
+        case GameState::BoardChoice::NORMAL: return L"Normal";
+        case GameState::BoardChoice::HARD: return L"Hard";
+        case GameState::BoardChoice::DAILY: return L"Daily";
+        default: return L"Random";
         }
     }
 
-
+    // static part of the main menu, buttons are dynamic items
     void mainMenu() {
-        drawButton(gamestate::buttonMainMenuStart);
-        drawButton(gamestate::buttonMainMenuHelp);
-
-        solidBrush->SetColor(ColorF(ColorF::Black));
+        renderStats::setSection(renderStats::Section::TEXT);
+        setBrushColor(ColorF(ColorF::Black));
 
         // high score display:
         {
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(1.0f, 1.0f) *
+            p_target->SetTransform(Matrix3x2F::Scale(1.0f, 1.0f) *
                 Matrix3x2F::Translation(300.0f, 450.0f) *
                 finalTransform);
 
             D2D1_RECT_F textRect = D2D1::Rect(-1000.0f, -1000.0f, 1000.0f, 1000.0f);
             std::wstring text = L"High Score:";
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            p_target->DrawTextW(text.data(), text.size(),
                 textFormatVCR, textRect, solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(2.0f, 2.0f) *
+            p_target->SetTransform(Matrix3x2F::Scale(2.0f, 2.0f) *
                 Matrix3x2F::Translation(300.0f, 550.0f) *
                 finalTransform);
 
             text = std::to_wstring(p_gameState->highScore);
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            p_target->DrawTextW(text.data(), text.size(),
                 textFormatVCR, textRect, solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(0.3f, 0.3f) *
+            p_target->SetTransform(Matrix3x2F::Scale(0.3f, 0.3f) *
                 Matrix3x2F::Translation(300.0f, 490.0f) *
                 finalTransform);
 
-            text = std::wstring(L"(") + std::to_wstring(gamestate::DEFAULT_APPLES_X) +
-                L" x " + std::to_wstring(gamestate::DEFAULT_APPLES_Y) +
-                L" x " + std::to_wstring(gamestate::DEFAULT_PLAY_TIME_SECONDS) + L"s only)";
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            // scores are kept for each combination of settings
+            text = std::wstring(L"(") + std::to_wstring(p_gameState->appleCountX) +
+                L" x " + std::to_wstring(p_gameState->appleCountY) +
+                L" x " + std::to_wstring(p_gameState->playTime) + L"s, " +
+                rules::variantName(p_gameState->ruleVariant) + L")";
+            p_target->DrawTextW(text.data(), text.size(),
                 textFormatVCR, textRect, solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(finalTransform);
+            p_target->SetTransform(finalTransform);
         }
 
         // game settings:
         {
-            for (INT i = 0; i < 6; i++) {
-                drawButton(gamestate::mainMenuSettingsButtons[i]);
-            }
-            drawButton(gamestate::buttonMainMenuReset);
-
             for (int i = 0; i < 3; i++) {
                 D2D1_RECT_F rect = D2D1::Rect(
                     gamestate::mainMenuSettingsButtons[i].left - 40.0f,
@@ -331,43 +556,83 @@ namespace {
                     gamestate::mainMenuSettingsButtons[i].right + 40.0f,
                     gamestate::mainMenuSettingsButtons[i].bottom + 150.0f);
 
-                solidBrush->SetColor(ColorF(ColorF::Wheat));
-                p_myd2d->d2d_render_target->FillRoundedRectangle(
+                setBrushColor(ColorF(ColorF::Wheat));
+                p_target->FillRoundedRectangle(
                     D2D1::RoundedRect(rect, 10.0f, 10.0f), solidBrush);
 
-                solidBrush->SetColor(ColorF(ColorF::Black));
+                setBrushColor(ColorF(ColorF::Black));
                 std::wstring text;
                 if (i == 0) { text = std::to_wstring(p_gameState->appleCountX); }
                 if (i == 1) { text = std::to_wstring(p_gameState->appleCountY); }
                 if (i == 2) { text = std::to_wstring(p_gameState->playTime) + L"s"; }
 
-                p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+                p_target->DrawTextW(text.data(), text.size(),
+                    textFormatVCR, rect, solidBrush);
+            }
+
+            if (p_gameState->hugeBoard) {
+                D2D1_RECT_F rect = D2D1::Rect(
+                    gamestate::mainMenuSettingsButtons[0].left - 40.0f, 440.0f,
+                    gamestate::mainMenuSettingsButtons[2].right + 40.0f, 520.0f);
+
+                setBrushColor(ColorF(ColorF::DarkRed));
+                std::wstring text = L"Huge board";
+                p_target->DrawTextW(text.data(), text.size(),
+                    textFormatVCR, rect, solidBrush);
+            }
+
+            if (p_gameState->playerCount > 1) {
+                D2D1_RECT_F rect = D2D1::Rect(60.0f, 660.0f, 540.0f, 740.0f);
+
+                setBrushColor(ColorF(ColorF::DarkRed));
+                std::wstring text = L"Versus: " + std::to_wstring(p_gameState->playerCount) + L" players";
+                p_target->DrawTextW(text.data(), text.size(),
+                    textFormatVCR, rect, solidBrush);
+            }
+
+            if (p_gameState->boardChoice != GameState::BoardChoice::RANDOM) {
+                D2D1_RECT_F rect = D2D1::Rect(60.0f, 740.0f, 540.0f, 820.0f);
+
+                setBrushColor(ColorF(ColorF::DarkRed));
+                std::wstring text = L"Board: " + boardChoiceName(p_gameState->boardChoice);
+                p_target->DrawTextW(text.data(), text.size(),
+                    textFormatVCR, rect, solidBrush);
+            }
+
+            if (p_gameState->ruleVariant != rules::Variant::CLASSIC) {
+                D2D1_RECT_F rect = D2D1::Rect(
+                    gamestate::mainMenuSettingsButtons[0].left - 40.0f, 360.0f,
+                    gamestate::mainMenuSettingsButtons[2].right + 40.0f, 440.0f);
+
+                setBrushColor(ColorF(ColorF::DarkRed));
+                std::wstring text = rules::variantName(p_gameState->ruleVariant);
+                p_target->DrawTextW(text.data(), text.size(),
                     textFormatVCR, rect, solidBrush);
             }
         }
     }
 
     void helpMenu() {
-        drawButton(gamestate::buttonHelpMenuBack);
-
+        renderStats::setSection(renderStats::Section::TEXT);
         FLOAT imgLeft = 1260.0f;
         FLOAT imgTop = 270.0f;
-        p_myd2d->d2d_render_target->DrawBitmap(tutorialBitmap,
-            D2D1::Rect(imgLeft, imgTop, imgLeft + 550.0f, imgTop + 475.0f), 1.0f,
-            D2D1_BITMAP_INTERPOLATION_MODE_LINEAR);
+        D2D1_RECT_F imgRect = D2D1::Rect(imgLeft, imgTop, imgLeft + 550.0f, imgTop + 475.0f);
+        p_target->DrawBitmap(scaledFor(tutorialBitmap, imgRect, 1.0f),
+            imgRect, 1.0f,
+            imageInterpolation());
 
-        solidBrush->SetColor(ColorF(ColorF::Black));
+        setBrushColor(ColorF(ColorF::Black));
 
-        p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(0.7f, 0.7f) *
+        p_target->SetTransform(Matrix3x2F::Scale(0.7f, 0.7f) *
             Matrix3x2F::Translation(100.0f, 0.0f) *
             finalTransform);
 
         D2D1_RECT_F textRect = D2D1::Rect(130.0f, 70.0f, 19200.0f, 10800.0f);
         std::wstring text = L"How to play";
-        p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+        p_target->DrawTextW(text.data(), text.size(),
             textFormatComicSans, textRect, solidBrush);
 
-        p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(0.25f, 0.25f) *
+        p_target->SetTransform(Matrix3x2F::Scale(0.25f, 0.25f) *
             Matrix3x2F::Translation(70.0f, 250.0f) *
             finalTransform);
 
@@ -376,132 +641,449 @@ namespace {
             L"mouse over them so sum of their values euqals 10.\n"
             L"You get 1 point for each apple cleared, regardless\n"
             L"of its value.\n\n"
-            L"Keybinds:\nEsc: previous menu\nR: reset game";
-        p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            L"Keybinds:\nEsc: previous menu\nR: reset game\nH: huge board mode\nV: rule variant\nP: players (versus)\nD: board difficulty / daily\nF3: performance stats";
+        p_target->DrawTextW(text.data(), text.size(),
             textFormatComicSans, textRect, solidBrush);
 
-        p_myd2d->d2d_render_target->SetTransform(finalTransform);
+        p_target->SetTransform(finalTransform);
     }
 
+    // static part of the play screen: score, play field and settled apples
     void playing() {
+        renderStats::setSection(renderStats::Section::PLAY_FIELD);
+
+        if (p_gameState->playerCount > 1) {
+            // versus tiles, each with a header with the player and score, the time is dynamic
+            for (INT i = 0; i < p_gameState->playerCount; i++) {
+                const SingletonPlay& play = p_gameState->players[i];
+                renderStats::setSection(renderStats::Section::PLAY_FIELD);
+
+                setBrushColor(ColorF(ColorF::Wheat));
+                p_target->FillRoundedRectangle(D2D1::RoundedRect(
+                    D2D1::Rect(play.area.left, play.area.top - gamestate::VERSUS_HEADER_HEIGHT, play.area.right, play.area.top - 4.0f),
+                    6.0f, 6.0f), solidBrush);
+
+                renderStats::setSection(renderStats::Section::TEXT);
+                setBrushColor(ColorF(ColorF::DarkRed));
+                drawTextScaled(L"P" + std::to_wstring(i + 1), versusHeaderPart(play, 0), 0.5f);
+                setBrushColor(ColorF(ColorF::Black));
+                drawTextScaled(std::to_wstring(play.score), versusHeaderPart(play, 1), 0.5f);
+
+                drawBoard(play);
+            }
+            return;
+        }
+
         // draw score:
         {
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(0.8f, 0.8f) *
+            p_target->SetTransform(Matrix3x2F::Scale(0.8f, 0.8f) *
                 Matrix3x2F::Translation(230.0f, 250.0f) *
                 finalTransform);
 
             drawAppleGeometry(ColorF(ColorF::SaddleBrown));
 
-            solidBrush->SetColor(ColorF(ColorF::White));
+            setBrushColor(ColorF(ColorF::White));
 
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(1.05f, 1.05f) *
+            p_target->SetTransform(Matrix3x2F::Scale(1.05f, 1.05f) *
                 Matrix3x2F::Translation(233.0f, 130.0f) *
                 finalTransform);
 
             D2D1_RECT_F textRect = D2D1::Rect(-400.0f, -50.0f, 400.0f, 150.0f);
             std::wstring text = L"Score";
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            p_target->DrawTextW(text.data(), text.size(),
                 textFormatVCR, textRect, solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(2.05f, 2.05f) *
+            p_target->SetTransform(Matrix3x2F::Scale(2.05f, 2.05f) *
                 Matrix3x2F::Translation(231.0f, 165.0f) *
                 finalTransform);
 
-            text = std::to_wstring(p_gameState->play.score);
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
+            text = std::to_wstring(p_gameState->players[0].score);
+            p_target->DrawTextW(text.data(), text.size(),
                 textFormatVCR, textRect, solidBrush);
 
-            p_myd2d->d2d_render_target->SetTransform(finalTransform);
+            p_target->SetTransform(finalTransform);
         }
 
-        // draw timer: 
-        {
-            D2D1_POINT_2F clockCenter = Point2F(230.0f, 500.0f);
-            FLOAT clockRadius = 100.0f;
+        drawBoard(p_gameState->players[0]);
+    }
 
-            solidBrush->SetColor(ColorF(ColorF::ForestGreen));
-            p_myd2d->d2d_render_target->FillEllipse(
-                D2D1::Ellipse(clockCenter, clockRadius, clockRadius), solidBrush
-            );
+    // play field and settled apples of one board
+    void drawBoard(const SingletonPlay& play) {
+        p_play = &play;
 
-            FLOAT rotationAngle = 360.0f * static_cast<FLOAT>(p_gameState->currentTimeMs - p_gameState->play.startTimeMs) /
-                1000.0f / static_cast<FLOAT>(p_gameState->playTime);
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Rotation(rotationAngle, clockCenter) *
-                finalTransform);
+        // draw play field:
+        renderStats::setSection(renderStats::Section::PLAY_FIELD);
+        setBrushColor(ColorF(0.75f, 0.6f, 0.3f));
+        p_target->DrawRectangle(play.area,
+            solidBrush, 2.0f);
 
-            solidBrush->SetColor(ColorF(ColorF::DarkGreen));
-            p_myd2d->d2d_render_target->DrawLine(clockCenter, D2D1::Point2F(clockCenter.x, clockCenter.y - clockRadius), solidBrush, 5.0f);
+        // zoomed in view must not spill outside of the play field
+        bool clipped = play.zoomedIn();
+        if (clipped) {
+            p_target->PushAxisAlignedClip(play.area,
+                D2D1_ANTIALIAS_MODE_ALIASED);
+        }
 
-            p_myd2d->d2d_render_target->SetTransform(finalTransform);
+        // only chunks intersecting the view are submitted:
+        renderStats::setSection(renderStats::Section::APPLES);
+        D2D1_RECT_F view = play.visibleBoardArea();
+        INT minX, minY, maxX, maxY;
+        p_gameState->cellsOver(play, view, minX, minY, maxX, maxY);
+        play.apples.forEachInChunksOver(minX, minY, maxX, maxY, [](const Apple& apple, INT, INT) {
+            if (!apple.popped) {
+                drawApple(apple, false);
+            }
+        });
 
-            D2D1_RECT_F textRect = D2D1::Rect(clockCenter.x - clockRadius, clockCenter.y - clockRadius,
-                clockCenter.x + clockRadius, clockCenter.y + clockRadius);
+        if (clipped) {
+            p_target->PopAxisAlignedClip();
+        }
+    }
 
-            // to prevent flashing digit when restting and for number to stop at 0:
-            UINT64 endTime = p_gameState->play.startTimeMs + 1000 * p_gameState->playTime;
-            INT displayedTime = (p_gameState->currentTimeMs < endTime) ? (min(p_gameState->playTime - 1, (endTime - p_gameState->currentTimeMs) / 1000)) : 0;
-            solidBrush->SetColor(ColorF(ColorF::White));
-            std::wstring text = std::to_wstring(displayedTime);
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
-                textFormatVCR, textRect, solidBrush);
+    // seconds left on the clock, stops at 0
+    INT displayedTime(const SingletonPlay& play) {
+        // to prevent flashing digit when restting and for number to stop at 0:
+        timeBase::Ns endTime = play.startTimeNs + timeBase::NS_PER_SECOND * p_gameState->playTime;
+        return (p_gameState->currentTimeNs < endTime) ? (min(p_gameState->playTime - 1, (endTime - p_gameState->currentTimeNs) / timeBase::NS_PER_SECOND)) : 0;
+    }
+
+    void drawTimer() {
+        if (p_gameState->playerCount > 1) {
+            setBrushColor(ColorF(ColorF::DarkGreen));
+            drawTextScaled(std::to_wstring(displayedTime(*p_play)) + L"s", versusHeaderPart(*p_play, 2), 0.5f);
+            return;
         }
 
-        // draw buttons:
-        drawButton(gamestate::buttonPlayingMenu);
-        drawButton(gamestate::buttonPlayingReset);
+        D2D1_POINT_2F clockCenter = Point2F(230.0f, 500.0f);
+        FLOAT clockRadius = 100.0f;
 
-        // draw play field:
-        solidBrush->SetColor(ColorF(0.75f, 0.6f, 0.3f));
-        p_myd2d->d2d_render_target->DrawRectangle(gamestate::APPLES_PLAY_AREA,
-            solidBrush, 2.0f);
+        setBrushColor(ColorF(ColorF::ForestGreen));
+        p_target->FillEllipse(
+            D2D1::Ellipse(clockCenter, clockRadius, clockRadius), solidBrush
+        );
 
-        for (bool popped : {false, true}) {
-            for (const std::vector<Apple>& appleRow : p_gameState->play.apples) {
-                for (const Apple& apple : appleRow) {
-                    drawApple(apple, popped);
-                }
-            }
+        FLOAT rotationAngle = 360.0f * timeBase::toSeconds(p_gameState->currentTimeNs - p_play->startTimeNs) /
+            static_cast<FLOAT>(p_gameState->playTime);
+        p_target->SetTransform(Matrix3x2F::Rotation(rotationAngle, clockCenter) *
+            finalTransform);
+
+        setBrushColor(ColorF(ColorF::DarkGreen));
+        p_target->DrawLine(clockCenter, D2D1::Point2F(clockCenter.x, clockCenter.y - clockRadius), solidBrush, 5.0f);
+
+        p_target->SetTransform(finalTransform);
+
+        D2D1_RECT_F textRect = D2D1::Rect(clockCenter.x - clockRadius, clockCenter.y - clockRadius,
+            clockCenter.x + clockRadius, clockCenter.y + clockRadius);
+
+        setBrushColor(ColorF(ColorF::White));
+        std::wstring text = std::to_wstring(displayedTime(*p_play));
+        p_target->DrawTextW(text.data(), text.size(),
+            textFormatVCR, textRect, solidBrush);
+    }
+
+    void drawDragRect() {
+        const SingletonPlay& play = *p_play;
+
+        D2D1_RECT_F dragRect = D2D1::Rect(
+            p_gameState->logicalMouseX, p_gameState->logicalMouseY,
+            play.toLogicalX(play.dragStartX), play.toLogicalY(play.dragStartY));
+
+        // a single pixel stretched, the same with any interpolation
+        p_target->DrawBitmap(dragBitmap,
+            dragRect, 1.0f,
+            D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+
+        setBrushColor(ColorF(0.5f, 0.375f, 0.0f));
+        p_target->DrawRectangle(dragRect, solidBrush, 4.0f);
+    }
+
+    void drawGameOver() {
+        D2D1_RECT_F rect = D2D1::Rect(-352.0f, -264.0f, 352.0f, 264.0f);
+
+        FLOAT scale = 0.75f * p_play->areaScale();
+        p_target->SetTransform(Matrix3x2F::Scale(scale, scale) *
+            Matrix3x2F::Translation((p_play->area.left + p_play->area.right) / 2.0f,
+                (p_play->area.top + p_play->area.bottom) / 2.0f) *
+            finalTransform);
+
+        p_target->DrawBitmap(scaledFor(houseBitmap, rect, scale), rect, 1.0f,
+            imageInterpolation());
+
+        setBrushColor(ColorF(ColorF::White));
+        std::wstring text = L"Game Over";
+        rect.bottom = -150.0f;
+        p_target->DrawTextW(text.data(), text.size(),
+            textFormatVCR, rect, solidBrush);
+
+        setBrushColor(ColorF(ColorF::Black));
+        text = std::to_wstring(p_play->score);
+        rect = D2D1::Rect(-300.0f, -60.0f, 00.0f, 40.0f);
+        p_target->DrawTextW(text.data(), text.size(),
+            textFormatVCR, rect, solidBrush);
+
+
+        p_target->SetTransform(finalTransform);
+    }
+
+    // apples drawn over the static layer must not spill outside of zoomed in play field either
+    void drawDynamicApple(const Apple& apple, bool highlighted, bool falling = false) {
+        bool clipped = p_play->zoomedIn();
+        if (clipped) {
+            p_target->PushAxisAlignedClip(p_play->area, D2D1_ANTIALIAS_MODE_ALIASED);
+        }
+        drawApple(apple, highlighted, falling);
+        if (clipped) {
+            p_target->PopAxisAlignedClip();
         }
+    }
+
+    const D2D1_RECT_F STATS_OVERLAY_RECT = D2D1::Rect(1380.0f, 50.0f, 1868.0f, 112.0f);
 
-        if (p_gameState->play.inDrag) {
-            D2D1_RECT_F dragRect = D2D1::Rect(
-                p_gameState->logicalMouseX, p_gameState->logicalMouseY,
-                p_gameState->play.dragStartX, p_gameState->play.dragStartY);
+    void updateStatsOverlayText() {
+        if (p_gameState->currentTimeNs < statsOverlayUpdatedNs + 250 * timeBase::NS_PER_MS && !statsOverlayText.empty()) { return; }
 
-            p_myd2d->d2d_render_target->DrawBitmap(dragBitmap,
-                dragRect, 1.0f,
-                D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        renderStats::Counters total = renderStats::lastFrame().total();
 
-            solidBrush->SetColor(ColorF(0.5f, 0.375f, 0.0f));
-            p_myd2d->d2d_render_target->DrawRectangle(dragRect, solidBrush, 4.0f);
+        wchar_t buffer[128];
+        const latency::Histogram& popLatency = latency::captureToPresent(latency::Action::POP);
+        swprintf(buffer, 128, L"FPS %5.1f  p99 %5.1fms\ndraws %4u  text %4u  q%d\npop lat p50 %4.1f p99 %4.1f",
+            renderStats::averageFps(), renderStats::frameTimePercentileMs(99.0),
+            total.drawCalls, total.textDraws, qualityLevel,
+            popLatency.percentileUs(50.0) / 1000.0, popLatency.percentileUs(99.0) / 1000.0);
+        statsOverlayText = buffer;
+        statsOverlayUpdatedNs = p_gameState->currentTimeNs;
+    }
+
+    void drawStatsOverlay() {
+        setBrushColor(ColorF(0.0f, 0.0f, 0.0f, 0.6f));
+        p_target->FillRectangle(STATS_OVERLAY_RECT, solidBrush);
+
+        D2D1_RECT_F textRect = D2D1::Rect(-800.0f, -100.0f, 800.0f, 100.0f);
+        p_target->SetTransform(Matrix3x2F::Scale(0.28f, 0.28f) *
+            Matrix3x2F::Translation((STATS_OVERLAY_RECT.left + STATS_OVERLAY_RECT.right) / 2.0f,
+                (STATS_OVERLAY_RECT.top + STATS_OVERLAY_RECT.bottom) / 2.0f) *
+            finalTransform);
+
+        setBrushColor(ColorF(ColorF::White));
+        p_target->DrawTextW(statsOverlayText.data(), statsOverlayText.size(),
+            textFormatVCR, textRect, solidBrush);
+
+        p_target->SetTransform(finalTransform);
+    }
+
+    void drawDynamicItem(const DynamicItem& item) {
+        p_play = &p_gameState->players[item.player];
+
+        switch (item.kind) {
+        case DynamicItem::Kind::BUTTON:
+            renderStats::setSection(renderStats::Section::MENU);
+            drawButton(*item.button);
+            break;
+
+        case DynamicItem::Kind::TIMER:
+            renderStats::setSection(renderStats::Section::PLAY_FIELD);
+            drawTimer();
+            break;
+
+        case DynamicItem::Kind::DRAGGED_APPLE:
+            renderStats::setSection(renderStats::Section::APPLES);
+            drawDynamicApple(p_play->apples.at(item.cell), true);
+            break;
+
+        case DynamicItem::Kind::FALLING_APPLE:
+            renderStats::setSection(renderStats::Section::APPLES);
+            drawDynamicApple(p_play->apples.at(item.cell), false, true);
+            break;
+
+        case DynamicItem::Kind::DRAG_RECT:
+            renderStats::setSection(renderStats::Section::OVERLAYS);
+            drawDragRect();
+            break;
+
+        case DynamicItem::Kind::GAME_OVER:
+            renderStats::setSection(renderStats::Section::OVERLAYS);
+            drawGameOver();
+            break;
+
+        case DynamicItem::Kind::STATS_OVERLAY:
+            renderStats::setSection(renderStats::Section::OVERLAYS);
+            drawStatsOverlay();
+            break;
         }
+    }
+
+    void addDynamicItem(const DynamicItem& item, UINT64 index, UINT64 state) {
+        dynamicItems.push_back(item);
+        dirtyTracker.addItem((static_cast<UINT64>(item.kind) << 40) | index, item.bounds, state);
+    }
 
-        // draw game over screen:
-        if (p_gameState->play.timesOver) {
-            D2D1_RECT_F rect = D2D1::Rect(-352.0f, -264.0f, 352.0f, 264.0f);
+    void addButtonItem(const gamestate::Button& button, UINT64 index) {
+        addDynamicItem({
+                .kind = DynamicItem::Kind::BUTTON,
+                .button = &button,
+                .bounds = { button.left - 1.0f, button.top - 1.0f, button.right + 1.0f, button.bottom + 1.0f },
+            }, index,
+            DirtyRegionTracker::stateHash(button.hoverOver(p_gameState->logicalMouseX, p_gameState->logicalMouseY)));
+    }
 
-            p_myd2d->d2d_render_target->SetTransform(Matrix3x2F::Scale(0.75f, 0.75f) *
-                Matrix3x2F::Translation((gamestate::APPLES_PLAY_AREA.left + gamestate::APPLES_PLAY_AREA.right) / 2.0f,
-                    (gamestate::APPLES_PLAY_AREA.top + gamestate::APPLES_PLAY_AREA.bottom) / 2.0f) *
-                finalTransform);
+    UINT64 appleIndex(INT player, gamestate::CellXY cell) {
+        return (static_cast<UINT64>(player) << 36) | (static_cast<UINT64>(cell.x) << 20) | static_cast<UINT64>(cell.y);
+    }
+
+    DirtyRegionTracker::Rect appleBounds(const SingletonPlay& play, const Apple& apple) {
+        FLOAT x = play.toLogicalX(apple.posX());
+        FLOAT y = play.toLogicalY(apple.posY());
+        FLOAT r = 0.6f * p_gameState->appleSize * play.viewZoom; // leaf and outline included, at any rotation
+        return { x - r, y - r, x + r, y + r };
+    }
+
+    // everything drawn over the static layer, in drawing order
+    void collectDynamicItems() {
+        dynamicItems.clear();
+
+        switch (p_gameState->mode) {
+        case GameState::Mode::TITLE_MENU:
+            break;
+
+        case GameState::Mode::MAIN_MENU:
+            addButtonItem(gamestate::buttonMainMenuStart, 0);
+            addButtonItem(gamestate::buttonMainMenuHelp, 1);
+            for (INT i = 0; i < 6; i++) {
+                addButtonItem(gamestate::mainMenuSettingsButtons[i], 2 + i);
+            }
+            addButtonItem(gamestate::buttonMainMenuReset, 8);
+            break;
+
+        case GameState::Mode::HELP_MENU:
+            addButtonItem(gamestate::buttonHelpMenuBack, 0);
+            break;
+
+        case GameState::Mode::PLAYING: {
+            bool versus = p_gameState->playerCount > 1;
+            if (!versus) {
+                addButtonItem(gamestate::buttonPlayingMenu, 0);
+                addButtonItem(gamestate::buttonPlayingReset, 1);
+            }
+
+            for (INT i = 0; i < p_gameState->playerCount; i++) {
+                const SingletonPlay& play = p_gameState->players[i];
+
+                if (versus) {
+                    // only the number of seconds is shown in the header
+                    D2D1_RECT_F timeRect = versusHeaderPart(play, 2);
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::TIMER,
+                            .player = i,
+                            .bounds = { timeRect.left, timeRect.top, timeRect.right, timeRect.bottom },
+                        }, i,
+                        DirtyRegionTracker::stateHash(displayedTime(play)));
+                } else {
+                    // clock hand moves every frame
+                    FLOAT rotationAngle = 360.0f * timeBase::toSeconds(p_gameState->currentTimeNs - play.startTimeNs) /
+                        static_cast<FLOAT>(p_gameState->playTime);
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::TIMER,
+                            .bounds = { 125.0f, 395.0f, 335.0f, 605.0f },
+                        }, 0,
+                        DirtyRegionTracker::stateHash(rotationAngle));
+                }
+
+                // settled apples are in the static layer without highlight
+                for (gamestate::CellXY cell : play.draggedApples) {
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::DRAGGED_APPLE,
+                            .player = i,
+                            .cell = cell,
+                            .bounds = appleBounds(play, play.apples.at(cell)),
+                        }, appleIndex(i, cell), 0);
+                }
+
+                D2D1_RECT_F view = play.visibleBoardArea();
+                FLOAT margin = p_gameState->appleSize;
+                UINT32 fallingDrawn = 0;
+                for (gamestate::CellXY cell : play.fallingApples) {
+                    if (fallingDrawn == quality.maxFallingApples) { break; }
+                    const Apple& apple = play.apples.at(cell);
+                    if (apple.posY() > 25000.0f) { continue; }
+                    if (play.zoomedIn() &&
+                        (apple.posX() + margin < view.left || apple.posX() - margin > view.right ||
+                        apple.posY() + margin < view.top || apple.posY() - margin > view.bottom)) {
+                        continue;
+                    }
+
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::FALLING_APPLE,
+                            .player = i,
+                            .cell = cell,
+                            .bounds = appleBounds(play, apple),
+                        }, appleIndex(i, cell),
+                        DirtyRegionTracker::stateHash(apple.angle()));
+                    fallingDrawn++;
+                }
+
+                if (play.inDrag) {
+                    FLOAT startX = play.toLogicalX(play.dragStartX);
+                    FLOAT startY = play.toLogicalY(play.dragStartY);
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::DRAG_RECT,
+                            .player = i,
+                            .bounds = {
+                                min(startX, p_gameState->logicalMouseX) - 3.0f, min(startY, p_gameState->logicalMouseY) - 3.0f,
+                                max(startX, p_gameState->logicalMouseX) + 3.0f, max(startY, p_gameState->logicalMouseY) + 3.0f },
+                        }, i, 0);
+                }
 
-            p_myd2d->d2d_render_target->DrawBitmap(houseBitmap, rect, 1.0f,
-                D2D1_BITMAP_INTERPOLATION_MODE_LINEAR);
+                if (play.timesOver) {
+                    FLOAT centerX = (play.area.left + play.area.right) / 2.0f;
+                    FLOAT centerY = (play.area.top + play.area.bottom) / 2.0f;
+                    FLOAT scale = play.areaScale();
+                    addDynamicItem({
+                            .kind = DynamicItem::Kind::GAME_OVER,
+                            .player = i,
+                            .bounds = { centerX - 265.0f * scale, centerY - 199.0f * scale, centerX + 265.0f * scale, centerY + 199.0f * scale },
+                        }, i,
+                        DirtyRegionTracker::stateHash(houseBitmap.revision()));
+                }
+            }
+        } break;
+        }
+
+        // on top of everything else
+        if (p_gameState->showRenderStats) {
+            updateStatsOverlayText();
+            addDynamicItem({
+                    .kind = DynamicItem::Kind::STATS_OVERLAY,
+                    .bounds = { STATS_OVERLAY_RECT.left, STATS_OVERLAY_RECT.top, STATS_OVERLAY_RECT.right, STATS_OVERLAY_RECT.bottom },
+                }, 0,
+                DirtyRegionTracker::stateHash(statsOverlayUpdatedNs));
+        }
+    }
 
-            solidBrush->SetColor(ColorF(ColorF::White));
-            std::wstring text = L"Game Over";
-            rect.bottom = -150.0f;
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
-                textFormatVCR, rect, solidBrush);
+    // restores a region from the static layer and draws dynamic items touching it over it
+    void composeRegion(const DirtyRegionTracker::Rect& rect, bool fullRedraw) {
+        renderStats::setSection(renderStats::Section::OVERLAYS);
+        if (!fullRedraw) {
+            p_target->SetTransform(finalTransform);
+            p_target->PushAxisAlignedClip(D2D1::Rect(rect.left, rect.top, rect.right, rect.bottom),
+                D2D1_ANTIALIAS_MODE_ALIASED);
+        }
 
-            solidBrush->SetColor(ColorF(ColorF::Black));
-            text = std::to_wstring(p_gameState->play.score);
-            rect = D2D1::Rect(-300.0f, -60.0f, 00.0f, 40.0f);
-            p_myd2d->d2d_render_target->DrawTextW(text.data(), text.size(),
-                textFormatVCR, rect, solidBrush);
+        // pixel for pixel, there is nothing to interpolate whatever the quality level
+        D2D1_SIZE_F layerSize = staticLayerBitmap->GetSize();
+        p_target->SetTransform(Matrix3x2F::Identity());
+        p_target->DrawBitmap(staticLayerBitmap,
+            D2D1::Rect(0.0f, 0.0f, layerSize.width, layerSize.height), 1.0f,
+            D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        p_target->SetTransform(finalTransform);
 
+        for (const DynamicItem& item : dynamicItems) {
+            if (fullRedraw || item.bounds.intersects(rect)) {
+                drawDynamicItem(item);
+            }
+        }
 
-            p_myd2d->d2d_render_target->SetTransform(finalTransform);
+        if (!fullRedraw) {
+            p_target->PopAxisAlignedClip();
         }
     }
 } // namespace
@@ -517,9 +1099,11 @@ void drawLogic::free(rtd rtdv) {
         help::SafeRelease(appleGeometry);
         help::SafeRelease(leafGeometry);
         help::SafeRelease(appleGradientBrush);
-        help::SafeRelease(mainMenuBgBitmap);
+        mainMenuBgBitmap.releaseDeviceBitmaps();
         help::SafeRelease(dragBitmap);
-        help::SafeRelease(tutorialBitmap);
-        help::SafeRelease(houseBitmap);
+        tutorialBitmap.releaseDeviceBitmaps();
+        houseBitmap.releaseDeviceBitmaps();
+        releaseStaticLayer();
+        staticLayerValid = false;
     }
 }
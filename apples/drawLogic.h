@@ -6,5 +6,7 @@
 namespace drawLogic {
     void init(const MyD2DObjectCollection& myd2d, rtd rtdv);
     void drawFrame(const MyD2DObjectCollection& myd2d, const gamestate::GameState& gameState);
+    // qualityGovernor level the following frames are drawn at
+    void setQuality(INT level);
     void free(rtd rtdv);
 } // namespace drawLogic
@@ -1,49 +1,77 @@
 #include "gameLogic.h"
 
-#include<random>
+#include <algorithm>
+#include <chrono>
+#include <execution>
+#include "boardLibrary.h"
+#include "dragScan.h"
 #include "helper.h"
+#include "latency.h"
+#include "simd.h"
+#include "telemetry.h"
 
 using gamestate::GameState;
 using gamestate::Apple;
+using SingletonPlay = gamestate::GameState::SingletonPlay;
 
 namespace {
-    // random floats:
-    std::mt19937_64 rng;
-    FLOAT randomFloat(FLOAT v_min, FLOAT v_max) {
-        const INT v = 0x8'0000;
-        std::uniform_int_distribution unidist(0, v);
-        INT rng_result = unidist(rng);
-        FLOAT result = static_cast<FLOAT>(rng_result) / static_cast<FLOAT>(v);
-        return result * (v_max - v_min) + v_min;
+    // pre-generated boards by difficulty, boards are generated from the seed without it.
+    // Shared by all games, only read after setup.
+    boards::Library boardLibrary;
+
+    void recordTelemetry(const GameState& gameState, const telemetry::Event& event) {
+        if (gameState.instrumented) {
+            telemetry::record(event);
+        }
     }
-    FLOAT randomFloat(FLOAT v_max = 1.0f) {
-        return randomFloat(0.0f, v_max);
+
+    void recordLatency(const GameState& gameState, latency::Action action, UINT64 captureUs, UINT64 stateUs) {
+        if (gameState.instrumented) {
+            latency::recordAction(action, captureUs, stateUs);
+        }
     }
 
     bool titleMenu(GameState& gameState, const Controller& controller);
-    void mainMenu(GameState& gameState, const Controller& controller, UINT64 timeMs);
+    void mainMenu(GameState& gameState, const Controller& controller, timeBase::Ns timeNs);
     void helpMenu(GameState& gameState, const Controller& controller);
-    void playing(GameState& gameState, const Controller& controller, UINT64 timeMs);
+    void playing(GameState& gameState, const Controller& controller, timeBase::Ns timeNs);
+    void updateView(GameState& gameState, SingletonPlay& play, const Controller& controller, timeBase::Ns deltaTimeNs);
+    void prepareNextBoard(GameState& gameState);
 
 } // namespace
 
-void gameLogic::init(UINT64 timeMs, GameState& gameState) {
-    rng.seed(timeMs);
+void gameLogic::setup() {
+    boardLibrary.open(L"assets/boards.lib");
+}
+
+void gameLogic::init(timeBase::Ns timeNs, GameState& gameState, highScores::Store* highScoreStore, bool instrumented) {
+    gameState.sessionRng = rng::Stream(timeNs);
+    gameState.nextSeed = gameState.sessionRng.next();
+    gameState.highScoreStore = highScoreStore;
+    gameState.instrumented = instrumented;
 
     gameState.mode = GameState::Mode::TITLE_MENU;
+    gameState.recordedMode = gameState.mode;
 
     gameState.appleCountX = gamestate::DEFAULT_APPLES_X;
     gameState.appleCountY = gamestate::DEFAULT_APPLES_Y;
     gameState.playTime = gamestate::DEFAULT_PLAY_TIME_SECONDS;
+    gameState.hugeBoard = false;
+    gameState.ruleVariant = rules::Variant::CLASSIC;
+    gameState.boardChoice = GameState::BoardChoice::RANDOM;
+    gameState.playerCount = 1;
+    for (SingletonPlay& play : gameState.players) {
+        play.boardRevision = 0;
+        play.area = gamestate::APPLES_PLAY_AREA;
+    }
+    gameState.showRenderStats = false;
 
-    gameState.previousTimeMs = timeMs;
+    gameState.previousTimeNs = timeNs;
 
     gameState.highScore = 0;
 }
 
-bool gameLogic::processFrame(const Controller& controller, GameState& gameState, UINT64 timeMs) {
-    gameState.currentTimeMs = timeMs;
-
+void gameLogic::updateWindowTransform(const Controller& controller, GameState& gameState) {
     // assume the game plays in an 1920x1080 window
     Controller::PairXY<INT> windowSize = controller.windowSize();
     FLOAT windowRatio = static_cast<FLOAT>(windowSize.x) / static_cast<FLOAT>(windowSize.y);
@@ -52,17 +80,41 @@ bool gameLogic::processFrame(const Controller& controller, GameState& gameState,
 
     gameState.graphicalOffsetX = (windowSize.x - 1920 * gameState.graphicalScale) / 2.0f;
     gameState.grpahicalOffsetY = (windowSize.y - 1080 * gameState.graphicalScale) / 2.0f;
+}
+
+bool gameLogic::processFrame(const Controller& controller, GameState& gameState, timeBase::Ns timeNs) {
+    gameState.currentTimeNs = timeNs;
+
+    updateWindowTransform(controller, gameState);
+    Controller::PairXY<INT> windowSize = controller.windowSize();
 
     Controller::PairXY<INT> mousePos = controller.mousePos();
     gameState.logicalMouseX = (mousePos.x - windowSize.x / 2.0f) / gameState.graphicalScale + gamestate::LOGICAL_WINDOW_SIZE_X / 2.0f;
     gameState.logicalMouseY = (mousePos.y - windowSize.y / 2.0f) / gameState.graphicalScale + gamestate::LOGICAL_WINDOW_SIZE_Y / 2.0f;
-    
+
+    if (controller.keyJustDown(VK_F3)) {
+        gameState.showRenderStats = !gameState.showRenderStats;
+    }
+
+    // mode changes in many places, it's recorded when it's first seen
+    if (gameState.instrumented && gameState.mode != gameState.recordedMode) {
+        gameState.recordedMode = gameState.mode;
+        telemetry::record({
+            .timeUs = help::myTimer64us(),
+            .type = telemetry::EventType::MODE_CHANGE,
+            .count = static_cast<uint16_t>(gameState.mode),
+        });
+    }
+
+    // settings can change anywhere, the lookup is cheap enough to do every frame
+    gameState.highScore = gameState.highScoreStore ? gameState.highScoreStore->best(highScores::Key::of(gameState)) : 0;
+
     switch (gameState.mode) {
     case GameState::Mode::TITLE_MENU:
         return titleMenu(gameState, controller);
 
     case GameState::Mode::MAIN_MENU:
-        mainMenu(gameState, controller, timeMs);
+        mainMenu(gameState, controller, timeNs);
         break;
 
     case GameState::Mode::HELP_MENU:
@@ -70,86 +122,315 @@ bool gameLogic::processFrame(const Controller& controller, GameState& gameState,
         break;
 
     case GameState::Mode::PLAYING:
-        playing(gameState, controller, timeMs);
+        playing(gameState, controller, timeNs);
         break;
     }
 
-    gameState.previousTimeMs = timeMs;
+    // Start and Reset are a click away
+    if (gameState.mode == GameState::Mode::MAIN_MENU || gameState.mode == GameState::Mode::PLAYING) {
+        prepareNextBoard(gameState);
+    }
+
+    gameState.previousTimeNs = timeNs;
 
     return false;
 }
 
-gamestate::Apple::Apple(INT value, FLOAT posX, FLOAT posY) {
+gamestate::Apple::Apple(INT value, FLOAT posX, FLOAT posY, rng::Stream random) {
     this->value = value;
 
-    this->posX = posX;
-    this->posY = posY;
+    fixedX = static_cast<INT32>(lroundf(posX * (1 << FALL_FRACTION_BITS)));
+    fixedY = static_cast<INT32>(lroundf(posY * (1 << FALL_FRACTION_BITS)));
 
-    velX = randomFloat(-247.1f, 247.1f);
-    velY = randomFloat(-643.1f, -656.9f);
-    accY = randomFloat(1261.2f, 1395.3f);
-    velAngular = randomFloat(-82.8f, 82.8f);
+    velX = random.nextInt(toFixed(-247.1), toFixed(247.1));
+    velY = random.nextInt(toFixed(-656.9), toFixed(-643.1));
+    accY = random.nextInt(toFixed(1261.2), toFixed(1395.3));
+    velAngular = random.nextInt(toFixed(-82.8), toFixed(82.8));
 }
 
-void gamestate::Apple::animate(UINT64 deltaTimeMs) {
-    if (!popped) { return; }
-    if (posY > 30000.0f) { return; }
+namespace {
+    // rounds towards minus infinity, the same on every platform
+    INT32 stepped(INT32 perSecond, INT64 step) {
+        return static_cast<INT32>((perSecond * step) >> gamestate::STEP_FRACTION_BITS);
+    }
+} // namespace
 
-    FLOAT deltaTimeSec = deltaTimeMs / 1000.0f;
+void gamestate::Apple::animate(INT64 step) {
+    if (!popped) { return; }
+    if (fallen()) { return; }
 
-    posX += velX * deltaTimeSec;
+    fixedX += stepped(velX, step);
 
-    posY += velY * deltaTimeSec;
-    velY += accY * deltaTimeSec;
+    fixedY += stepped(velY, step);
+    velY += stepped(accY, step);
 
-    angle += velAngular * deltaTimeSec;
+    fixedAngle += stepped(velAngular, step);
 }
 
 namespace {
-    void initPlaying(GameState& gameState, UINT64 timeMs) {
-        gameState.play.timesOver = false;
-        gameState.play.startTimeMs = timeMs;
-        gameState.play.score = 0;
-        gameState.play.inDrag = false;
+    // zoom limits keep the apple size on screen within limits, the whole board is visible at areaScale()
+    FLOAT minViewZoom(const GameState& gameState, const SingletonPlay& play) {
+        return gameState.hugeBoard ? max(play.areaScale(), gamestate::MIN_VIEW_APPLE_SIZE / gameState.appleSize) : play.areaScale();
+    }
+
+    FLOAT maxViewZoom(const GameState& gameState, const SingletonPlay& play) {
+        return gameState.hugeBoard ? max(minViewZoom(gameState, play), gamestate::MAX_VIEW_APPLE_SIZE / gameState.appleSize) : play.areaScale();
+    }
+
+    // keeps zoom within limits and the view inside the board
+    void clampView(GameState& gameState, SingletonPlay& play) {
+        play.viewZoom = min(max(play.viewZoom, minViewZoom(gameState, play)), maxViewZoom(gameState, play));
 
+        FLOAT halfViewX = (play.area.right - play.area.left) / 2.0f / play.viewZoom;
+        FLOAT halfViewY = (play.area.bottom - play.area.top) / 2.0f / play.viewZoom;
+        play.viewCenterX = min(max(play.viewCenterX, gamestate::APPLES_PLAY_AREA.left + halfViewX),
+            gamestate::APPLES_PLAY_AREA.right - halfViewX);
+        play.viewCenterY = min(max(play.viewCenterY, gamestate::APPLES_PLAY_AREA.top + halfViewY),
+            gamestate::APPLES_PLAY_AREA.bottom - halfViewY);
+    }
+
+    // where the apples of a board of this size are, in board space
+    struct BoardLayout {
+        FLOAT appleSize;
+        FLOAT appleMinX; // top left corner of the apple grid
+        FLOAT appleMinY;
+    };
+
+    BoardLayout boardLayout(INT appleCountX, INT appleCountY) {
         FLOAT playAreaSizeX = gamestate::APPLES_PLAY_AREA.right - gamestate::APPLES_PLAY_AREA.left;
         FLOAT playAreaSizeY = gamestate::APPLES_PLAY_AREA.bottom - gamestate::APPLES_PLAY_AREA.top;
-        gameState.appleSize = min(playAreaSizeX / gameState.appleCountX, playAreaSizeY / gameState.appleCountY);
+        FLOAT appleSize = min(playAreaSizeX / appleCountX, playAreaSizeY / appleCountY);
 
         FLOAT playAreaCenterX = (gamestate::APPLES_PLAY_AREA.right + gamestate::APPLES_PLAY_AREA.left) / 2.0f;
-        FLOAT appleMinX = playAreaCenterX - (gameState.appleCountX / 2.0f) * gameState.appleSize;
         FLOAT playAreaCenterY = (gamestate::APPLES_PLAY_AREA.bottom + gamestate::APPLES_PLAY_AREA.top) / 2.0f;
-        FLOAT appleMinY = playAreaCenterY - (gameState.appleCountY / 2.0f) * gameState.appleSize;
+        return {
+            .appleSize = appleSize,
+            .appleMinX = playAreaCenterX - (appleCountX / 2.0f) * appleSize,
+            .appleMinY = playAreaCenterY - (appleCountY / 2.0f) * appleSize,
+        };
+    }
+
+    // Every apple only depends on the seed and its position, so the board is the same
+    // regardless of how many threads generate it. Values of a library board are the ones the seed
+    // generates, they just don't have to be generated again.
+    template<typename R>
+    void generateApples(gamestate::AppleGrid& apples, const GameState::BoardRequest& request) {
+        BoardLayout layout = boardLayout(request.appleCountX, request.appleCountY);
+        FLOAT appleMinX = layout.appleMinX;
+        FLOAT appleMinY = layout.appleMinY;
+        FLOAT appleSize = layout.appleSize;
+        INT appleCountX = request.appleCountX;
+        const uint8_t* values = request.values;
+
+        rng::Stream boardRng(request.seed);
+        rng::Stream appleRngs = boardRng.split(0);
+        apples.generateParallel(request.appleCountX, request.appleCountY, [=](INT x, INT y) {
+            rng::Stream appleRng = appleRngs.split(static_cast<UINT64>(y) * appleCountX + x);
+            // drawn either way, falling physics come from the rest of the stream
+            INT value = appleRng.nextInt(R::MIN_VALUE, R::MAX_VALUE);
+            if (values != nullptr) { value = values[y * appleCountX + x]; }
+
+            return Apple(value,
+                appleMinX + appleSize * (x + 0.5f),
+                appleMinY + appleSize * (y + 0.5f),
+                appleRng);
+        });
+
+        if (values != nullptr) { return; }
 
-        std::uniform_int_distribution appleDistr(1, 9);
         INT valueSum = 0;
-        for (INT x = 0; x < gameState.appleCountX; x++) {
-            gameState.play.apples.push_back(std::vector<Apple>());
-            for (INT y = 0; y < gameState.appleCountY; y++) {
-                INT value = appleDistr(rng);
-                valueSum += value;
-
-                gameState.play.apples.back().push_back(Apple(value,
-                    appleMinX + gameState.appleSize * (x + 0.5f),
-                    appleMinY + gameState.appleSize * (y + 0.5f)));
+        apples.forEach([&](const Apple& apple, INT, INT) {
+            valueSum += apple.value;
+        });
+
+        // make sum of values divisible by the target sum to make board more clearable
+        rng::Stream fixUpRng = boardRng.split(1);
+        INT antiLockProtection = 10000; // in very impropable case that only minimal values are on the apples
+        while (valueSum % R::TARGET_SUM != 0 && antiLockProtection-- > 0) {
+            INT x = fixUpRng.nextInt(0, request.appleCountX - 1);
+            INT y = fixUpRng.nextInt(0, request.appleCountY - 1);
+
+            if (apples.at(x, y).value != R::MIN_VALUE) {
+                apples.at(x, y).value--;
+                valueSum--;
             }
         }
+    }
+
+    gamestate::AppleGrid generateApples(const GameState::BoardRequest& request) {
+        gamestate::AppleGrid apples;
+        rules::visit(request.ruleVariant, [&](auto variant) {
+            generateApples<decltype(variant)>(apples, request);
+        });
+        return apples;
+    }
 
-        // make sum of values divisible by 10 to make board more clearable
-        INT antiLockProtection = 10000; // in very impropable case that only 1s are on the apples
-        while (valueSum % 10 != 0 && antiLockProtection-- > 0) {
-            INT x = std::uniform_int_distribution(0, gameState.appleCountX - 1)(rng);
-            INT y = std::uniform_int_distribution(0, gameState.appleCountY - 1)(rng);
+    // Board area of a player: the whole play area, or in versus mode a tile of the grid
+    // (with the column count giving the biggest boards) below the tile's header
+    D2D1_RECT_F boardArea(INT player, INT playerCount) {
+        if (playerCount <= 1) { return gamestate::APPLES_PLAY_AREA; }
 
-            if (gameState.play.apples[x][y].value != 1) {
-                gameState.play.apples[x][y].value--;
-                valueSum--;
+        const D2D1_RECT_F& versus = gamestate::VERSUS_AREA;
+        FLOAT playAreaSizeX = gamestate::APPLES_PLAY_AREA.right - gamestate::APPLES_PLAY_AREA.left;
+        FLOAT playAreaSizeY = gamestate::APPLES_PLAY_AREA.bottom - gamestate::APPLES_PLAY_AREA.top;
+        const FLOAT GAP = 16.0f;
+
+        INT columns = 1;
+        FLOAT scale = 0.0f;
+        for (INT c = 1; c <= playerCount; c++) {
+            INT r = (playerCount + c - 1) / c;
+            FLOAT tileX = (versus.right - versus.left) / c - GAP;
+            FLOAT tileY = (versus.bottom - versus.top) / r - GAP - gamestate::VERSUS_HEADER_HEIGHT;
+            FLOAT s = min(tileX / playAreaSizeX, tileY / playAreaSizeY);
+            if (s > scale) {
+                scale = s;
+                columns = c;
+            }
+        }
+
+        INT rows = (playerCount + columns - 1) / columns;
+        FLOAT tileSizeX = (versus.right - versus.left) / columns;
+        FLOAT tileSizeY = (versus.bottom - versus.top) / rows;
+        FLOAT centerX = versus.left + tileSizeX * (player % columns + 0.5f);
+        FLOAT centerY = versus.top + tileSizeY * (player / columns + 0.5f) + gamestate::VERSUS_HEADER_HEIGHT / 2.0f;
+        return {
+            .left = centerX - playAreaSizeX * scale / 2.0f,
+            .top = centerY - playAreaSizeY * scale / 2.0f,
+            .right = centerX + playAreaSizeX * scale / 2.0f,
+            .bottom = centerY + playAreaSizeY * scale / 2.0f,
+        };
+    }
+
+    // Seed and, if the library has boards of the settings, values of the next board
+    UINT64 chooseBoard(const GameState& gameState, const uint8_t*& values) {
+        values = nullptr;
+        UINT64 seed = gameState.nextSeed;
+        boards::Difficulty difficulty = boards::Difficulty::NORMAL;
+        switch (gameState.boardChoice) {
+        case GameState::BoardChoice::RANDOM:
+            return seed;
+        case GameState::BoardChoice::EASY:
+            difficulty = boards::Difficulty::EASY;
+            break;
+        case GameState::BoardChoice::HARD:
+            difficulty = boards::Difficulty::HARD;
+            break;
+        case GameState::BoardChoice::DAILY: {
+            // from the date alone, so players with different libraries (or none) get the same board
+            auto today = std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+            return boards::dailySeed(today.time_since_epoch().count());
+        }
+        default:
+            break;
+        }
+
+        boards::BoardInfo board;
+        if (boardLibrary.pick(gameState.appleCountX, gameState.appleCountY, gameState.ruleVariant, difficulty, seed, board)) {
+            values = board.values;
+            return board.seed;
+        }
+        return seed;
+    }
+
+    GameState::BoardRequest nextBoardRequest(const GameState& gameState) {
+        GameState::BoardRequest request = {
+            .appleCountX = gameState.appleCountX,
+            .appleCountY = gameState.appleCountY,
+            .ruleVariant = gameState.ruleVariant,
+        };
+        request.seed = chooseBoard(gameState, request.values);
+        return request;
+    }
+
+    template<typename T>
+    bool isReady(const std::future<T>& job) {
+        return job.valid() && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Keeps the board of the next game generated in the background for the current settings.
+    // After a settings change the new board is started once the outdated one is done.
+    void prepareNextBoard(GameState& gameState) {
+        if (gameState.preparedBoard.valid() && !isReady(gameState.preparedBoard)) { return; }
+
+        GameState::BoardRequest request = nextBoardRequest(gameState);
+        if (gameState.preparedBoard.valid() && gameState.preparedRequest == request) { return; }
+
+        gameState.preparedRequest = request;
+        gameState.preparedBoard = std::async(std::launch::async, [request]() {
+            return generateApples(request);
+        });
+    }
+
+    gamestate::AppleGrid takeNextBoard(GameState& gameState, const GameState::BoardRequest& request) {
+        // still being generated it's waited for, that's still sooner than starting over
+        if (gameState.preparedBoard.valid() && gameState.preparedRequest == request) {
+            return gameState.preparedBoard.get();
+        }
+        return generateApples(request);
+    }
+
+    void initPlaying(GameState& gameState, timeBase::Ns timeNs) {
+        GameState::BoardRequest request = nextBoardRequest(gameState);
+        gameState.nextSeed = gameState.sessionRng.next();
+
+        BoardLayout layout = boardLayout(gameState.appleCountX, gameState.appleCountY);
+        gameState.appleSize = layout.appleSize;
+        FLOAT playAreaCenterX = (gamestate::APPLES_PLAY_AREA.right + gamestate::APPLES_PLAY_AREA.left) / 2.0f;
+        FLOAT playAreaCenterY = (gamestate::APPLES_PLAY_AREA.bottom + gamestate::APPLES_PLAY_AREA.top) / 2.0f;
+
+        recordTelemetry(gameState, {
+            .timeUs = help::myTimer64us(),
+            .type = telemetry::EventType::GAME_START,
+            .width = static_cast<uint16_t>(gameState.appleCountX),
+            .height = static_cast<uint16_t>(gameState.appleCountY),
+            .count = static_cast<uint16_t>(gameState.ruleVariant),
+            .value = gameState.playTime,
+        });
+
+        // in versus mode everyone plays the same board
+        for (INT i = 0; i < gameState.playerCount; i++) {
+            SingletonPlay& play = gameState.players[i];
+            play.timesOver = false;
+            play.startTimeNs = timeNs;
+            play.score = 0;
+            play.inDrag = false;
+            play.inPan = false;
+            play.boardRevision++;
+            play.area = boardArea(i, gameState.playerCount);
+            play.appleMinX = layout.appleMinX;
+            play.appleMinY = layout.appleMinY;
+            play.boardSeed = request.seed;
+
+            if (i == 0) {
+                play.apples = takeNextBoard(gameState, request);
+            } else {
+                play.apples = gameState.players[0].apples;
             }
+
+            // huge boards start zoomed in as far out as allowed, centered on the board
+            play.viewZoom = minViewZoom(gameState, play);
+            play.viewCenterX = playAreaCenterX;
+            play.viewCenterY = playAreaCenterY;
+            clampView(gameState, play);
         }
     }
 
     void endPlaying(GameState& gameState) {
-        gameState.play.apples.clear();
+        for (SingletonPlay& play : gameState.players) {
+            play.apples.clear();
+            play.fallingApples.clear();
+            play.poppedApples.clear();
+            play.draggedApples.clear();
+        }
+    }
+
+    // settings step is 1 normally, but in huge board mode sizes change by ~25% per click
+    INT increasedBoardSize(INT count, INT maxCount, bool hugeBoard) {
+        return min(maxCount, count + (hugeBoard ? max(1, count / 4) : 1));
+    }
+
+    INT decreasedBoardSize(INT count, bool hugeBoard) {
+        return max(gamestate::MIN_APPLES, count - (hugeBoard ? max(1, count / 5) : 1));
     }
 
     bool titleMenu(GameState& gameState, const Controller& controller) {
@@ -165,7 +446,7 @@ namespace {
     }
 
 
-    void mainMenu(GameState& gameState, const Controller& controller, UINT64 timeMs) {
+    void mainMenu(GameState& gameState, const Controller& controller, timeBase::Ns timeNs) {
         if (controller.keyJustDown(VK_ESCAPE)) {
             gameState.mode = GameState::Mode::TITLE_MENU;
             return;
@@ -174,7 +455,7 @@ namespace {
         if (gamestate::buttonMainMenuStart.hoverOver(gameState.logicalMouseX, gameState.logicalMouseY) &&
             controller.keyJustDown(VK_LBUTTON)) {
             gameState.mode = GameState::Mode::PLAYING;
-            initPlaying(gameState, timeMs);
+            initPlaying(gameState, timeNs);
             return;
         }
 
@@ -189,6 +470,33 @@ namespace {
             gameState.appleCountX = gamestate::DEFAULT_APPLES_X;
             gameState.appleCountY = gamestate::DEFAULT_APPLES_Y;
             gameState.playTime = gamestate::DEFAULT_PLAY_TIME_SECONDS;
+            gameState.hugeBoard = false;
+            gameState.ruleVariant = rules::Variant::CLASSIC;
+            gameState.boardChoice = GameState::BoardChoice::RANDOM;
+            gameState.playerCount = 1;
+            return;
+        }
+
+        if (controller.keyJustDown('D')) {
+            gameState.boardChoice = static_cast<GameState::BoardChoice>(
+                (static_cast<INT>(gameState.boardChoice) + 1) % static_cast<INT>(GameState::BoardChoice::COUNT));
+            return;
+        }
+
+        if (controller.keyJustDown('P')) {
+            gameState.playerCount = gameState.playerCount % gamestate::MAX_PLAYERS + 1;
+            return;
+        }
+
+        if (controller.keyJustDown('V')) {
+            gameState.ruleVariant = rules::nextVariant(gameState.ruleVariant);
+            return;
+        }
+
+        if (controller.keyJustDown('H')) {
+            gameState.hugeBoard = !gameState.hugeBoard;
+            gameState.appleCountX = min(gameState.appleCountX, gameState.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_X);
+            gameState.appleCountY = min(gameState.appleCountY, gameState.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_Y);
             return;
         }
 
@@ -201,24 +509,27 @@ namespace {
         }
 
         if (settingMenuSelected != -1 && controller.keyJustDown(VK_LBUTTON)) {
+            INT maxApplesX = gameState.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_X;
+            INT maxApplesY = gameState.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_Y;
+
             switch (settingMenuSelected) {
             case 0:
-                if (gameState.appleCountX < 32) { gameState.appleCountX++; }
+                gameState.appleCountX = increasedBoardSize(gameState.appleCountX, maxApplesX, gameState.hugeBoard);
                 break;
             case 3:
-                if (gameState.appleCountX > 4) { gameState.appleCountX--; }
+                gameState.appleCountX = decreasedBoardSize(gameState.appleCountX, gameState.hugeBoard);
                 break;
             case 1:
-                if (gameState.appleCountY < 20) { gameState.appleCountY++; }
+                gameState.appleCountY = increasedBoardSize(gameState.appleCountY, maxApplesY, gameState.hugeBoard);
                 break;
             case 4:
-                if (gameState.appleCountY > 4) { gameState.appleCountY--; }
+                gameState.appleCountY = decreasedBoardSize(gameState.appleCountY, gameState.hugeBoard);
                 break;
             case 2:
-                if (gameState.playTime < 900 ) { gameState.playTime += 5; }
+                if (gameState.playTime < gamestate::MAX_PLAY_TIME_SECONDS) { gameState.playTime += 5; }
                 break;
             case 5:
-                if (gameState.playTime > 5) { gameState.playTime -= 5; }
+                if (gameState.playTime > gamestate::MIN_PLAY_TIME_SECONDS) { gameState.playTime -= 5; }
                 break;
             }
             return;
@@ -234,9 +545,87 @@ namespace {
         }
     }
 
-    void playing(GameState& gameState, const Controller& controller, UINT64 timeMs) {
+    // selecting apples by dragging and popping them if the selection is a valid move
+    template<typename R>
+    void dragApples(GameState& gameState, SingletonPlay& play, const Controller& controller) {
+        rules::Selection<R> selection;
+        FLOAT dragWidth = 0.0f, dragHeight = 0.0f;
+        if (play.inDrag) {
+            for (gamestate::CellXY cell : play.draggedApples) {
+                play.apples.at(cell).inDrag = false;
+            }
+            play.draggedApples.clear();
+
+            FLOAT mouseBoardX = play.toBoardX(gameState.logicalMouseX);
+            FLOAT mouseBoardY = play.toBoardY(gameState.logicalMouseY);
+
+            // apples outside of the view can't be selected
+            D2D1_RECT_F view = play.visibleBoardArea();
+            FLOAT dragAreaLeft =   max(view.left,   min(mouseBoardX, play.dragStartX));
+            FLOAT dragAreaRight =  min(view.right,  max(mouseBoardX, play.dragStartX));
+            FLOAT dragAreaTop =    max(view.top,    min(mouseBoardY, play.dragStartY));
+            FLOAT dragAreaBottom = min(view.bottom, max(mouseBoardY, play.dragStartY));
+
+            dragWidth = max(0.0f, dragAreaRight - dragAreaLeft);
+            dragHeight = max(0.0f, dragAreaBottom - dragAreaTop);
+
+            INT minX, minY, maxX, maxY;
+            gameState.cellsOver(play, D2D1::RectF(dragAreaLeft, dragAreaTop, dragAreaRight, dragAreaBottom), minX, minY, maxX, maxY);
+
+            // apple.posX() + d >= dragAreaLeft && apple.posX() - d <= dragAreaRight, likewise for y
+            simd::Bounds bounds = {
+                .left = dragAreaLeft, .top = dragAreaTop, .right = dragAreaRight, .bottom = dragAreaBottom,
+                .margin = 0.05f * gameState.appleSize,
+            };
+            dragScan::visitExtents(play.apples, [&](auto extents) {
+                dragScan::selectInBounds<decltype(extents)>(play.apples, minX, minY, maxX, maxY, bounds, [&](Apple& apple, INT x, INT y) {
+                    apple.inDrag = true;
+                    selection.add(apple.value, x, y);
+                    play.draggedApples.push_back({ x, y });
+                });
+            });
+        }
+
+        // finish dragging:
+        if (play.inDrag && controller.keyJustUp(VK_LBUTTON)) {
+            play.inDrag = false;
+
+            bool pop = selection.valid();
+            if (pop) {
+                play.boardRevision++;
+                play.score += selection.score();
+            }
+            recordLatency(gameState, pop ? latency::Action::POP : latency::Action::DRAG_END,
+                controller.keyEventTimeUs(VK_LBUTTON), help::myTimer64us());
+            recordTelemetry(gameState, {
+                .timeUs = help::myTimer64us(),
+                .type = pop ? telemetry::EventType::POP : telemetry::EventType::DRAG_END,
+                .player = static_cast<uint8_t>(&play - gameState.players.data()),
+                .width = static_cast<uint16_t>(dragWidth / gameState.appleSize + 0.5f),
+                .height = static_cast<uint16_t>(dragHeight / gameState.appleSize + 0.5f),
+                .count = static_cast<uint16_t>(selection.count()),
+                .value = selection.sum(),
+            });
+
+            for (gamestate::CellXY cell : play.draggedApples) {
+                Apple& apple = play.apples.at(cell);
+                if (pop) {
+                    apple.pop();
+                    play.fallingApples.push_back(cell);
+                    play.poppedApples.push_back(cell);
+                }
+                apple.inDrag = false;
+            }
+            play.draggedApples.clear();
+        }
+    }
+
+    void playing(GameState& gameState, const Controller& controller, timeBase::Ns timeNs) {
+        // versus boards cover the side panel, so there are no buttons, only keys
+        bool buttons = gameState.playerCount == 1;
+
         if (controller.keyJustDown(VK_ESCAPE) ||
-            (gamestate::buttonPlayingMenu.hoverOver(gameState.logicalMouseX, gameState.logicalMouseY) &&
+            (buttons && gamestate::buttonPlayingMenu.hoverOver(gameState.logicalMouseX, gameState.logicalMouseY) &&
             controller.keyJustDown(VK_LBUTTON))) {
             gameState.mode = GameState::Mode::MAIN_MENU;
             endPlaying(gameState);
@@ -244,93 +633,162 @@ namespace {
         }
 
         if (controller.keyJustDown('R') ||
-            (gamestate::buttonPlayingReset.hoverOver(gameState.logicalMouseX, gameState.logicalMouseY) &&
+            (buttons && gamestate::buttonPlayingReset.hoverOver(gameState.logicalMouseX, gameState.logicalMouseY) &&
             controller.keyJustDown(VK_LBUTTON))) {
+            recordTelemetry(gameState, {
+                .timeUs = help::myTimer64us(),
+                .type = telemetry::EventType::RESET,
+                .value = gameState.players[0].score,
+            });
             endPlaying(gameState);
-            initPlaying(gameState, timeMs);
+            initPlaying(gameState, timeNs);
             return;
         }
 
-        if (gameState.currentTimeMs > gameState.play.startTimeMs + gameState.playTime * 1000) {
-            gameState.play.timesOver = true;
-            gameState.play.inDrag = false;
-            for (std::vector<Apple>& appleRow : gameState.play.apples) {
-                for (Apple& apple : appleRow) {
-                    apple.inDrag = false;
+        std::array<bool, gamestate::MAX_PLAYERS> wasOver;
+        for (INT i = 0; i < gameState.playerCount; i++) {
+            wasOver[i] = gameState.players[i].timesOver;
+        }
+
+        // boards don't share anything, so they are simulated in parallel
+        timeBase::Ns deltaTimeNs = timeNs - gameState.previousTimeNs;
+        INT64 step = gamestate::fallStep(deltaTimeNs);
+        auto simulate = [&gameState, step](SingletonPlay& play) {
+            if (gameState.currentTimeNs > play.startTimeNs + gameState.playTime * timeBase::NS_PER_SECOND) {
+                play.timesOver = true;
+                play.inDrag = false;
+                for (gamestate::CellXY cell : play.draggedApples) {
+                    play.apples.at(cell).inDrag = false;
                 }
+                play.draggedApples.clear();
             }
 
-            if (gameState.play.score > gameState.highScore &&
-                gameState.appleCountX == gamestate::DEFAULT_APPLES_X &&
-                gameState.appleCountY == gamestate::DEFAULT_APPLES_Y &&
-                gameState.playTime == gamestate::DEFAULT_PLAY_TIME_SECONDS) {
-                gameState.highScore = gameState.play.score;
+            // only popped apples move, so there is no need to visit the rest of the board:
+            std::erase_if(play.fallingApples, [&](gamestate::CellXY cell) {
+                Apple& apple = play.apples.at(cell);
+                apple.animate(step);
+                return apple.fallen();
+            });
+        };
+        auto players = gameState.players.begin();
+        if (gameState.playerCount > 1) {
+            std::for_each(std::execution::par, players, players + gameState.playerCount, simulate);
+        } else {
+            simulate(*players);
+        }
+
+        for (INT i = 0; i < gameState.playerCount; i++) {
+            if (!wasOver[i] && gameState.players[i].timesOver) {
+                recordTelemetry(gameState, {
+                    .timeUs = help::myTimer64us(),
+                    .type = telemetry::EventType::TIME_OVER,
+                    .player = static_cast<uint8_t>(i),
+                    .value = gameState.players[i].score,
+                });
             }
         }
 
-        for (std::vector<Apple>& appleRow : gameState.play.apples) {
-            for (Apple& apple : appleRow) {
-                apple.animate(timeMs - gameState.previousTimeMs);
+        // the score is submitted once, in the frame the time runs out
+        if (gameState.playerCount == 1 && !wasOver[0] && gameState.players[0].timesOver && gameState.highScoreStore) {
+            gameState.highScoreStore->submit(highScores::Key::of(gameState), gameState.players[0].score);
+            gameState.highScore = gameState.highScoreStore->best(highScores::Key::of(gameState));
+        }
+
+        // there is one mouse, it controls the board being dragged on or else the one under it
+        SingletonPlay* focused = &gameState.players[0];
+        for (INT i = 0; i < gameState.playerCount; i++) {
+            SingletonPlay& play = gameState.players[i];
+            if (play.inDrag || play.inPan) {
+                focused = &play;
+                break;
+            }
+            if (play.contains(gameState.logicalMouseX, gameState.logicalMouseY)) {
+                focused = &play;
             }
         }
+        SingletonPlay& play = *focused;
+
+        updateView(gameState, play, controller, deltaTimeNs);
 
         // start dragging:
         if (controller.keyJustDown(VK_LBUTTON) &&
-            gameState.logicalMouseX > gamestate::APPLES_PLAY_AREA.left &&
-            gameState.logicalMouseX < gamestate::APPLES_PLAY_AREA.right &&
-            gameState.logicalMouseY > gamestate::APPLES_PLAY_AREA.top &&
-            gameState.logicalMouseY < gamestate::APPLES_PLAY_AREA.bottom) {
-            gameState.play.inDrag = true;
-            gameState.play.dragStartX = gameState.logicalMouseX;
-            gameState.play.dragStartY = gameState.logicalMouseY;
-        }
-
-        INT dragSum = 0;
-        if (gameState.play.inDrag) {
-            FLOAT dragAreaLeft =   min(gameState.logicalMouseX, gameState.play.dragStartX);
-            FLOAT dragAreaRight =  max(gameState.logicalMouseX, gameState.play.dragStartX);
-            FLOAT dragAreaTop =    min(gameState.logicalMouseY, gameState.play.dragStartY);
-            FLOAT dragAreaBottom = max(gameState.logicalMouseY, gameState.play.dragStartY);
-
-            for (std::vector<Apple>& appleRow : gameState.play.apples) {
-                for (Apple& apple : appleRow) {
-                    FLOAT d = 0.05f * gameState.appleSize;
-                    if (!apple.popped &&
-                        apple.posX + d >= dragAreaLeft && apple.posX - d <= dragAreaRight &&
-                        apple.posY + d >= dragAreaTop  && apple.posY - d <= dragAreaBottom) {
-                        apple.inDrag = true;
-                        dragSum += apple.value;
-                    } else {
-                        apple.inDrag = false;
-                    }
-                }
-            }
+            play.contains(gameState.logicalMouseX, gameState.logicalMouseY)) {
+            play.inDrag = true;
+            play.dragStartX = play.toBoardX(gameState.logicalMouseX);
+            play.dragStartY = play.toBoardY(gameState.logicalMouseY);
+
+            recordLatency(gameState, latency::Action::DRAG_START, controller.keyEventTimeUs(VK_LBUTTON), help::myTimer64us());
+            recordTelemetry(gameState, {
+                .timeUs = help::myTimer64us(),
+                .type = telemetry::EventType::DRAG_START,
+                .player = static_cast<uint8_t>(&play - gameState.players.data()),
+            });
         }
 
-        // finish dragging:
-        if (gameState.play.inDrag && controller.keyJustUp(VK_LBUTTON)) {
-            gameState.play.inDrag = false;
-
-            if (dragSum == 10) {
-                for (std::vector<Apple>& appleRow : gameState.play.apples) {
-                    for (Apple& apple : appleRow) {
-                        if (apple.inDrag) {
-                            apple.pop();
-                            gameState.play.score++;
-                        }
-                    }
-                }
-            }
+        rules::visit(gameState.ruleVariant, [&](auto variant) {
+            dragApples<decltype(variant)>(gameState, play, controller);
+        });
+    }
 
-            for (std::vector<Apple>& appleRow : gameState.play.apples) {
-                for (Apple& apple : appleRow) {
-                    apple.inDrag = false;
-                }
-            }
+    // zooming with mouse wheel and panning with right mouse button or arrows, only in huge board mode
+    void updateView(GameState& gameState, SingletonPlay& play, const Controller& controller, timeBase::Ns deltaTimeNs) {
+        if (!gameState.hugeBoard) { return; }
+
+        bool mouseInPlayArea = play.contains(gameState.logicalMouseX, gameState.logicalMouseY);
+
+        if (controller.wheelDelta() != 0 && mouseInPlayArea) {
+            // zoom around the point under the cursor:
+            FLOAT anchorX = play.toBoardX(gameState.logicalMouseX);
+            FLOAT anchorY = play.toBoardY(gameState.logicalMouseY);
+
+            play.viewZoom *= powf(1.25f, static_cast<FLOAT>(controller.wheelDelta()) / WHEEL_DELTA);
+            play.viewZoom = min(max(play.viewZoom, minViewZoom(gameState, play)), maxViewZoom(gameState, play));
+
+            play.viewCenterX += anchorX - play.toBoardX(gameState.logicalMouseX);
+            play.viewCenterY += anchorY - play.toBoardY(gameState.logicalMouseY);
+        }
+
+        if (controller.keyJustDown(VK_RBUTTON) && mouseInPlayArea) {
+            play.inPan = true;
+            play.panLastX = gameState.logicalMouseX;
+            play.panLastY = gameState.logicalMouseY;
+        }
+        if (play.inPan) {
+            play.viewCenterX -= (gameState.logicalMouseX - play.panLastX) / play.viewZoom;
+            play.viewCenterY -= (gameState.logicalMouseY - play.panLastY) / play.viewZoom;
+            play.panLastX = gameState.logicalMouseX;
+            play.panLastY = gameState.logicalMouseY;
+            play.inPan = controller.keyDown(VK_RBUTTON);
         }
+
+        FLOAT arrowStep = 800.0f * timeBase::toSeconds(deltaTimeNs) / play.viewZoom;
+        if (controller.keyDown(VK_LEFT))  { play.viewCenterX -= arrowStep; }
+        if (controller.keyDown(VK_RIGHT)) { play.viewCenterX += arrowStep; }
+        if (controller.keyDown(VK_UP))    { play.viewCenterY -= arrowStep; }
+        if (controller.keyDown(VK_DOWN))  { play.viewCenterY += arrowStep; }
+
+        clampView(gameState, play);
     }
 }
 
-void gameLogic::free() {
+void gameLogic::generateBoard(const GameState& gameState, SingletonPlay& play, UINT64 seed, const uint8_t* values) {
+    play.boardSeed = seed;
+    play.apples = generateApples({
+        .seed = seed,
+        .values = values,
+        .appleCountX = gameState.appleCountX,
+        .appleCountY = gameState.appleCountY,
+        .ruleVariant = gameState.ruleVariant,
+    });
+}
 
+void gameLogic::stop(GameState& gameState) {
+    if (gameState.preparedBoard.valid()) {
+        gameState.preparedBoard.wait();
+    }
+    gameState.preparedBoard = {};
+}
+
+void gameLogic::free() {
+    boardLibrary.close();
 }
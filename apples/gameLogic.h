@@ -2,9 +2,27 @@
 
 #include "controller.h"
 #include "gameState.h"
+#include "highScores.h"
 
 namespace gameLogic {
-    void init(UINT64 timeMs, gamestate::GameState& gameState);
-    bool processFrame(const Controller& controller, gamestate::GameState& gameState, UINT64 timeMs);
+    // Loads what all games share read only (the board library), before the first init
+    void setup();
+
+    // Scores are looked up in and submitted to highScoreStore, which has to outlive the game.
+    // Telemetry and latency stats are process wide and single threaded, only the game a window
+    // shows is instrumented.
+    void init(timeBase::Ns timeNs, gamestate::GameState& gameState, highScores::Store* highScoreStore,
+        bool instrumented = true);
+    bool processFrame(const Controller& controller, gamestate::GameState& gameState, timeBase::Ns timeNs);
+    // graphical scale and offset for the window size, processFrame does it every frame
+    void updateWindowTransform(const Controller& controller, gamestate::GameState& gameState);
+
+    // Fills play's board from seed, at play's position and gameState's settings. values (from the
+    // board library) are the ones the seed generates anyway, nullptr generates them.
+    void generateBoard(const gamestate::GameState& gameState, gamestate::GameState::SingletonPlay& play,
+        UINT64 seed, const uint8_t* values);
+    // Waits for the game's background work, before the game is destroyed or free() is called
+    void stop(gamestate::GameState& gameState);
+    // after the last game
     void free();
 } // namespaace gameLogic
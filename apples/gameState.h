@@ -2,7 +2,17 @@
 
 #include<string>
 #include<vector>
-#include<d2d1.h>
+#include<cmath>
+#include<array>
+#include<future>
+#include "board.h"
+#include "memoryStats.h"
+#include "platform.h"
+#include "rules.h"
+#include "rng.h"
+#include "timeBase.h"
+
+namespace highScores { class Store; }
 
 namespace gamestate {
     const FLOAT LOGICAL_WINDOW_SIZE_X = 1920.0f;
@@ -11,6 +21,21 @@ namespace gamestate {
     const INT DEFAULT_APPLES_X = 17;
     const INT DEFAULT_APPLES_Y = 10;
     const INT DEFAULT_PLAY_TIME_SECONDS = 120;
+    const INT MIN_PLAY_TIME_SECONDS = 5;
+    const INT MAX_PLAY_TIME_SECONDS = 900;
+
+    const INT MIN_APPLES = 4;
+    const INT MAX_APPLES_X = 32;
+    const INT MAX_APPLES_Y = 20;
+    const INT HUGE_MAX_APPLES = 1000;
+
+    // versus mode: every player gets their own board tiled across the window
+    const INT MAX_PLAYERS = 8;
+
+    // in huge board mode the view can't be zoomed out further than this apple size (in logical pixels),
+    // keeping the number of visible apples (and so frame time) bounded regardless of board size
+    const FLOAT MIN_VIEW_APPLE_SIZE = 24.0f;
+    const FLOAT MAX_VIEW_APPLE_SIZE = 160.0f;
 
     const D2D1_RECT_F APPLES_PLAY_AREA = {
         .left = 400.0f,
@@ -19,28 +44,62 @@ namespace gamestate {
         .bottom = 955.0f,
     };
 
+    // versus mode boards are tiled over this area, each tile with a score header above its board
+    const D2D1_RECT_F VERSUS_AREA = {
+        .left = 70.0f,
+        .top = 60.0f,
+        .right = 1850.0f,
+        .bottom = 1020.0f,
+    };
+    const FLOAT VERSUS_HEADER_HEIGHT = 44.0f;
+
+    // Falling physics are in fixed point with this many fractional bits. Integer steps give the same
+    // trajectory on every compiler, CPU and optimization level, so replays and viewers stay bit exact.
+    const INT FALL_FRACTION_BITS = 12;
+    const FLOAT FALL_UNIT = 1.0f / (1 << FALL_FRACTION_BITS);
+    constexpr INT32 toFixed(double value) {
+        return static_cast<INT32>(value * (1 << FALL_FRACTION_BITS) + (value < 0.0 ? -0.5 : 0.5));
+    }
+
+    // Time steps are in 1/2^20 s. Longer steps than a second are cut, by then the apple is long gone.
+    const INT STEP_FRACTION_BITS = 20;
+    constexpr INT64 fallStep(timeBase::Ns deltaTimeNs) {
+        return static_cast<INT64>((deltaTimeNs < timeBase::NS_PER_SECOND ? deltaTimeNs : timeBase::NS_PER_SECOND) *
+            (1ull << STEP_FRACTION_BITS) / timeBase::NS_PER_SECOND);
+    }
+
     struct Apple {
         INT value;
         bool popped = false;
         bool inDrag = false;
 
-        FLOAT posX;
-        FLOAT posY;
-        FLOAT angle = false;
-
-        FLOAT velX;
-        FLOAT velY;
-        FLOAT accY;
-        FLOAT velAngular;
+        // board space position and rotation in degrees
+        INT32 fixedX;
+        INT32 fixedY;
+        INT32 fixedAngle = 0;
+        INT32 velX; // per second
+        INT32 velY;
+        INT32 accY; // per second squared
+        INT32 velAngular;
 
-        Apple(INT value, FLOAT posX, FLOAT posY);
+        // falling physics are drawn from random, the position is rounded to the fixed point grid
+        Apple(INT value, FLOAT posX, FLOAT posY, rng::Stream random);
         void pop() { popped = true; }
-        void animate(UINT64 deltaTimeMs);
+        // step from fallStep(), the same for all apples of a frame
+        void animate(INT64 step);
+
+        FLOAT posX() const { return fixedX * FALL_UNIT; }
+        FLOAT posY() const { return fixedY * FALL_UNIT; }
+        FLOAT angle() const { return fixedAngle * FALL_UNIT; }
+        // out of sight below the board, done animating
+        bool fallen() const { return fixedY > toFixed(30000.0); }
     };
 
+    using AppleGrid = ChunkedGrid<Apple, memoryStats::Allocator<Apple, memoryStats::Tag::BOARD>>;
+
     struct GameState {
-        UINT64 previousTimeMs;
-        UINT64 currentTimeMs;
+        timeBase::Ns previousTimeNs;
+        timeBase::Ns currentTimeNs;
 
         FLOAT graphicalScale;
         FLOAT graphicalOffsetX;
@@ -60,20 +119,123 @@ namespace gamestate {
         INT appleCountX;
         INT appleCountY;
         INT playTime;
+        bool hugeBoard;
+        rules::Variant ruleVariant;
         FLOAT appleSize;
 
+        // where the board of the next game comes from
+        enum class BoardChoice {
+            RANDOM,
+            EASY, // from the board library, by difficulty
+            NORMAL,
+            HARD,
+            DAILY, // the same board for everyone on the same day
+            COUNT
+        };
+        BoardChoice boardChoice;
+
         INT highScore;
 
+        bool showRenderStats; // performance overlay, toggled with F3
+
+        // Game logic's own bookkeeping. All of a game is in its GameState, so any number of
+        // games can be run side by side, each on one thread at a time.
+        rng::Stream sessionRng; // each board is generated from its own seed drawn from this stream
+        UINT64 nextSeed; // drawn from sessionRng for the next game, whether its board is prepared or not
+        highScores::Store* highScoreStore; // nullptr keeps no scores
+        bool instrumented; // reports to the process wide telemetry and latency stats
+        Mode recordedMode; // mode the last MODE_CHANGE telemetry event was recorded for
+
+        // what a board is generated from
+        struct BoardRequest {
+            UINT64 seed;
+            const uint8_t* values; // from the board library, nullptr generates them from the seed
+            INT appleCountX;
+            INT appleCountY;
+            rules::Variant ruleVariant;
+
+            bool operator==(const BoardRequest&) const = default;
+        };
+        // Board of the next game generated in the background, so Start and Reset only take it over.
+        // Being generated while not ready, so it's only replaced when ready.
+        BoardRequest preparedRequest;
+        std::future<AppleGrid> preparedBoard;
+
         struct SingletonPlay {
             BOOL timesOver;
             INT score;
-            UINT64 startTimeMs;
-            std::vector<std::vector<Apple>> apples;
+            timeBase::Ns startTimeNs;
+            AppleGrid apples;
+            UINT64 boardSeed; // apples are generated from it, values and falling physics
+            FLOAT appleMinX; // board space position of the top left corner of the apple grid
+            FLOAT appleMinY;
+            std::vector<CellXY> fallingApples; // popped apples that are still animating
+            std::vector<CellXY> poppedApples; // every apple popped this game, in the order they popped
+            std::vector<CellXY> draggedApples; // apples with inDrag set
+            UINT32 boardRevision; // changes whenever the set of settled (unpopped) apples changes
+
             bool inDrag;
-            float dragStartX;
+            float dragStartX; // board space
             float dragStartY;
+
+            // Logical rectangle the board is shown in: APPLES_PLAY_AREA, or a tile of it in versus mode.
+            // Board space is the logical space of APPLES_PLAY_AREA, so boards are laid out the same
+            // regardless of where and how big they are shown.
+            D2D1_RECT_F area;
+
+            // View of the board inside area. With zoom equal to areaScale() centered on the play area
+            // the whole board is visible; for a single player that's zoom 1 and both spaces are identical.
+            FLOAT viewZoom;
+            FLOAT viewCenterX;
+            FLOAT viewCenterY;
+            bool inPan;
+            FLOAT panLastX; // logical space
+            FLOAT panLastY;
+
+            FLOAT areaScale() const {
+                return (area.right - area.left) / (APPLES_PLAY_AREA.right - APPLES_PLAY_AREA.left);
+            }
+            bool zoomedIn() const { return viewZoom > areaScale(); }
+            bool contains(FLOAT logicalX, FLOAT logicalY) const {
+                return logicalX > area.left && logicalX < area.right &&
+                    logicalY > area.top && logicalY < area.bottom;
+            }
+
+            FLOAT toLogicalX(FLOAT boardX) const {
+                return (boardX - viewCenterX) * viewZoom + (area.left + area.right) / 2.0f;
+            }
+            FLOAT toLogicalY(FLOAT boardY) const {
+                return (boardY - viewCenterY) * viewZoom + (area.top + area.bottom) / 2.0f;
+            }
+            FLOAT toBoardX(FLOAT logicalX) const {
+                return (logicalX - (area.left + area.right) / 2.0f) / viewZoom + viewCenterX;
+            }
+            FLOAT toBoardY(FLOAT logicalY) const {
+                return (logicalY - (area.top + area.bottom) / 2.0f) / viewZoom + viewCenterY;
+            }
+
+            // part of the board space visible inside area
+            D2D1_RECT_F visibleBoardArea() const {
+                return {
+                    .left = toBoardX(area.left),
+                    .top = toBoardY(area.top),
+                    .right = toBoardX(area.right),
+                    .bottom = toBoardY(area.bottom),
+                };
+            }
         };
-        SingletonPlay play;
+
+        // One session per player, only the first playerCount are in use. Boards exist only while PLAYING.
+        std::array<SingletonPlay, MAX_PLAYERS> players;
+        INT playerCount;
+
+        // Inclusive range of grid cells whose (unpopped) apples can touch the given board space rectangle.
+        void cellsOver(const SingletonPlay& play, const D2D1_RECT_F& rect, INT& minX, INT& minY, INT& maxX, INT& maxY) const {
+            minX = static_cast<INT>(floorf((rect.left - play.appleMinX) / appleSize)) - 1;
+            minY = static_cast<INT>(floorf((rect.top - play.appleMinY) / appleSize)) - 1;
+            maxX = static_cast<INT>(floorf((rect.right - play.appleMinX) / appleSize)) + 1;
+            maxY = static_cast<INT>(floorf((rect.bottom - play.appleMinY) / appleSize)) + 1;
+        }
     };
 
 
@@ -1,8 +1,10 @@
 // general purpose helper library
 #pragma once
 
-#include <Windows.h>
+#include "platform.h"
+#ifdef _WIN32
 #include <d2d1_3.h>
+#endif
 #include <utility>
 #include <vector>
 #include <exception>
@@ -22,6 +24,7 @@ namespace help {
 		}
 	}
 
+#ifdef _WIN32
 	HRESULT hCheck(HRESULT hresultVal);
 	class hresultNotOk : std::exception {
 	public:
@@ -31,7 +34,8 @@ namespace help {
 			this->hresult = hresultVal;
 		}
 	};
+#endif
 
-	UINT64 myTimer64ms();
+	// microseconds of timeBase::now(), for measurements that don't need more
 	UINT64 myTimer64us();
 } // namespace help
@@ -0,0 +1,367 @@
+#include "highScores.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Layout (little endian): FileHeader | Record[] in the order the scores were submitted
+    const UINT32 MAGIC = 0x53485041; // "APHS"
+    const UINT32 VERSION = 1;
+
+    struct FileHeader {
+        UINT32 magic;
+        UINT32 version;
+        UINT32 recordSize;
+        UINT32 reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 16);
+
+    // The index is reserved for a key per record up to this many. A file of few settings gets its
+    // table once; one of many isn't given a bucket array that no longer fits in the cache (4M records
+    // over 100k settings: 234 ms with no reserve, 447 ms with a bucket per record, 164 ms with this).
+    const size_t MAX_RESERVED_KEYS = 65536;
+
+    UINT32 fnv1a(const BYTE* data, size_t size) {
+        UINT32 hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // The file is used through these, Windows file handles or POSIX descriptors
+#ifdef _WIN32
+    using File = HANDLE;
+    const File NO_FILE = INVALID_HANDLE_VALUE;
+
+    File openFile(const std::filesystem::path& path) {
+        return CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+
+    void closeFile(File file) {
+        CloseHandle(file);
+    }
+
+    // -1 if it can't be told
+    INT64 fileSize(File file) {
+        LARGE_INTEGER size;
+        return GetFileSizeEx(file, &size) ? size.QuadPart : -1;
+    }
+
+    // Calls read(view) with the whole file mapped read only. False if it couldn't be mapped (out of
+    // memory or address space), read isn't called then.
+    template<typename F>
+    bool readMapped(File file, F read) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) { return false; }
+        const BYTE* view = static_cast<const BYTE*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view != nullptr) {
+            read(view);
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+        return view != nullptr;
+    }
+
+    // cuts the file off at size, writes continue from there
+    bool truncateFile(File file, INT64 size) {
+        LARGE_INTEGER position;
+        position.QuadPart = size;
+        return SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    }
+
+    // bytes written, fewer than size if the write failed part way
+    size_t writeFile(File file, const void* data, size_t size) {
+        DWORD done = 0;
+        WriteFile(file, data, static_cast<DWORD>(size), &done, nullptr);
+        return done;
+    }
+
+    void flushFile(File file) {
+        FlushFileBuffers(file);
+    }
+#else
+    using File = int;
+    const File NO_FILE = -1;
+
+    File openFile(const std::filesystem::path& path) {
+        return ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+
+    void closeFile(File file) {
+        ::close(file);
+    }
+
+    INT64 fileSize(File file) {
+        struct stat st;
+        return fstat(file, &st) == 0 ? static_cast<INT64>(st.st_size) : -1;
+    }
+
+    template<typename F>
+    bool readMapped(File file, F read) {
+        INT64 size = fileSize(file);
+        if (size <= 0) { return false; }
+        void* view = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, file, 0);
+        if (view == MAP_FAILED) { return false; }
+        read(static_cast<const BYTE*>(view));
+        munmap(view, static_cast<size_t>(size));
+        return true;
+    }
+
+    bool truncateFile(File file, INT64 size) {
+        return ftruncate(file, static_cast<off_t>(size)) == 0 && lseek(file, static_cast<off_t>(size), SEEK_SET) == size;
+    }
+
+    size_t writeFile(File file, const void* data, size_t size) {
+        ssize_t done = ::write(file, data, size);
+        return done > 0 ? static_cast<size_t>(done) : 0;
+    }
+
+    void flushFile(File file) {
+        fsync(file);
+    }
+#endif
+} // namespace
+
+bool highScores::Top::insert(INT score) {
+    if (count == TOP_COUNT && score <= scores[TOP_COUNT - 1]) { return false; }
+
+    // the last score drops out when full, equal scores stay in the order they were achieved
+    INT i = min(count, TOP_COUNT - 1);
+    while (i > 0 && scores[i - 1] < score) {
+        scores[i] = scores[i - 1];
+        i--;
+    }
+    scores[i] = score;
+    count = min(count + 1, TOP_COUNT);
+    return true;
+}
+
+
+highScores::Store::Store(const std::filesystem::path& path) {
+    static_assert(sizeof(Record) == 16);
+
+    m_file = openFile(path);
+    // without the file the scores are still kept for this run
+    if (m_file != NO_FILE) {
+        load(path);
+    }
+    m_worker = std::thread(&Store::workerLoop, this);
+}
+
+highScores::Store::~Store() {
+    int state = m_state.load();
+    while (state == PENDING) {
+        m_state.wait(PENDING);
+        state = m_state.load();
+    }
+    m_state = STOPPING;
+    m_state.notify_all();
+    m_worker.join();
+
+    // whatever was submitted while the worker was busy
+    m_writing.swap(m_pending);
+    writeRecords();
+    if (m_file != NO_FILE) {
+        closeFile(m_file);
+    }
+}
+
+std::filesystem::path highScores::Store::setAsidePath(const std::filesystem::path& path) {
+    for (INT i = 0; i < 100; i++) {
+        std::filesystem::path aside = path;
+        if (i > 0) {
+            aside += ".";
+            aside += std::to_string(i);
+        }
+        aside += ".bad";
+        std::error_code error;
+        if (!std::filesystem::exists(aside, error) && !error) { return aside; }
+    }
+    return {};
+}
+
+void highScores::Store::load(const std::filesystem::path& path) {
+    const FileHeader expected = {
+        .magic = MAGIC,
+        .version = VERSION,
+        .recordSize = sizeof(Record),
+        .reserved = 0,
+    };
+    INT64 size = fileSize(m_file);
+    if (size < 0) {
+        closeFile(m_file);
+        m_file = NO_FILE;
+        return;
+    }
+
+    // end of the last intact record, a torn tail after it is cut off
+    INT64 validEnd = 0;
+    bool ours = true;
+    bool mapped = true;
+    if (size >= static_cast<INT64>(sizeof(FileHeader))) {
+        mapped = readMapped(m_file, [&](const BYTE* view) {
+            FileHeader header;
+            std::memcpy(&header, view, sizeof(header));
+            if (header.magic != MAGIC || header.version != VERSION || header.recordSize != sizeof(Record)) {
+                ours = false;
+                return;
+            }
+
+            size_t count = static_cast<size_t>(size - sizeof(FileHeader)) / sizeof(Record);
+            // at most a key per record, a big file isn't rehashed over and over while it's read
+            m_index.reserve(std::min(count, MAX_RESERVED_KEYS));
+            const BYTE* p = view + sizeof(FileHeader);
+            size_t i = 0;
+            for (; i < count; i++, p += sizeof(Record)) {
+                Record record;
+                std::memcpy(&record, p, sizeof(record));
+                if (record.checksum != fnv1a(p, offsetof(Record, checksum))) { break; }
+
+                Key key = { record.appleCountX, record.appleCountY, record.playTime,
+                    static_cast<rules::Variant>(record.ruleVariant) };
+                m_index[key.packed()].insert(record.score);
+            }
+            validEnd = sizeof(FileHeader) + i * sizeof(Record);
+        });
+    } else if (size > 0) {
+        // only the start of our header, the first write of a new file was torn
+        std::vector<BYTE> start(static_cast<size_t>(size));
+        mapped = readMapped(m_file, [&](const BYTE* view) { std::memcpy(start.data(), view, start.size()); });
+        ours = std::memcmp(start.data(), &expected, start.size()) == 0;
+    }
+
+    // A file that couldn't be read is left alone, it may well hold all the scores. They're neither
+    // shown nor saved this run, the next one will likely read it.
+    if (!mapped) {
+        closeFile(m_file);
+        m_file = NO_FILE;
+        return;
+    }
+
+    // Another program's file or one of another version: it's kept under another name and
+    // a new file is started. If it can't be moved the scores aren't saved at all.
+    if (!ours) {
+        closeFile(m_file);
+        m_file = NO_FILE;
+        std::filesystem::path aside = setAsidePath(path);
+        std::error_code error;
+        if (aside.empty() || (std::filesystem::rename(path, aside, error), error)) { return; }
+        m_file = openFile(path);
+        if (m_file == NO_FILE) { return; }
+    }
+
+    if (!truncateFile(m_file, validEnd)) {
+        closeFile(m_file);
+        m_file = NO_FILE;
+        return;
+    }
+    m_fileEnd = validEnd;
+
+    if (validEnd == 0) {
+        if (writeFile(m_file, &expected, sizeof(expected)) != sizeof(expected)) {
+            closeFile(m_file);
+            m_file = NO_FILE;
+            return;
+        }
+        m_fileEnd = sizeof(expected);
+    }
+}
+
+void highScores::Store::writeRecords() {
+    if (m_file != NO_FILE && !m_writing.empty()) {
+        const BYTE* data = reinterpret_cast<const BYTE*>(m_writing.data());
+        const size_t size = sizeof(Record) * m_writing.size();
+        size_t written = 0;
+        INT failures = 0;
+        while (written < size) {
+            size_t done = writeFile(m_file, data + written, size - written);
+            if (done > 0) {
+                written += done;
+                continue;
+            }
+
+            // Cut back to the last complete record and write again from there. A record
+            // that keeps failing is dropped with the ones after it, its score stays in the
+            // index for this run.
+            written -= written % sizeof(Record);
+            if (!truncateFile(m_file, m_fileEnd + static_cast<INT64>(written))) {
+                // a torn record would hide every record written after it
+                closeFile(m_file);
+                m_file = NO_FILE;
+                break;
+            }
+            if (++failures > MAX_WRITE_RETRIES) { break; }
+        }
+        if (m_file != NO_FILE) {
+            m_fileEnd += static_cast<INT64>(written);
+            flushFile(m_file);
+        }
+    }
+    m_writing.clear();
+}
+
+void highScores::Store::workerLoop() {
+    for (;;) {
+        m_state.wait(IDLE);
+        int state = m_state.load();
+        if (state == STOPPING) { return; }
+        if (state != PENDING) { continue; }
+
+        writeRecords();
+
+        m_state = IDLE;
+        m_state.notify_all();
+    }
+}
+
+INT highScores::Store::best(const Key& key) const {
+    const Top* scores = top(key);
+    return scores ? scores->scores[0] : 0;
+}
+
+const highScores::Top* highScores::Store::top(const Key& key) const {
+    auto it = m_index.find(key.packed());
+    return it != m_index.end() ? &it->second : nullptr;
+}
+
+bool highScores::Store::submit(const Key& key, INT score) {
+    if (!m_index[key.packed()].insert(score)) { return false; }
+
+    // only scores that made it to the top are worth keeping
+    Record record = {
+        .appleCountX = static_cast<UINT16>(key.appleCountX),
+        .appleCountY = static_cast<UINT16>(key.appleCountY),
+        .playTime = static_cast<UINT16>(key.playTime),
+        .ruleVariant = static_cast<UINT8>(key.ruleVariant),
+        .reserved = 0,
+        .score = score,
+        .checksum = 0,
+    };
+    record.checksum = fnv1a(reinterpret_cast<const BYTE*>(&record), offsetof(Record, checksum));
+    m_pending.push_back(record);
+
+    tryFlush();
+    return true;
+}
+
+void highScores::Store::tryFlush() {
+    if (m_pending.empty() || m_state.load() != IDLE) { return; }
+
+    // m_writing was emptied by the worker, so swapping keeps both buffers allocated
+    m_writing.swap(m_pending);
+    m_state = PENDING;
+    m_state.notify_all();
+}
@@ -0,0 +1,102 @@
+// Persistent high scores, the best TOP_COUNT scores for every combination of board size, play time
+// and rule variant. Scores are kept in an append-only file of checksummed records, so a crash can
+// at most lose the records being written, and in a hash index built from it on load.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "gameState.h"
+#include "platform.h"
+
+namespace highScores {
+    const INT TOP_COUNT = 10;
+
+    // settings the scores are kept separately for
+    struct Key {
+        INT appleCountX;
+        INT appleCountY;
+        INT playTime;
+        rules::Variant ruleVariant;
+
+        static Key of(const gamestate::GameState& gameState) {
+            return { gameState.appleCountX, gameState.appleCountY, gameState.playTime, gameState.ruleVariant };
+        }
+
+        UINT64 packed() const {
+            return (static_cast<UINT64>(appleCountX & 0xFFFF) << 48) | (static_cast<UINT64>(appleCountY & 0xFFFF) << 32) |
+                (static_cast<UINT64>(playTime & 0xFFFF) << 16) | static_cast<UINT64>(ruleVariant);
+        }
+    };
+
+    // best scores first
+    struct Top {
+        std::array<INT, TOP_COUNT> scores;
+        INT count = 0;
+
+        // false if the score is not good enough to be kept
+        bool insert(INT score);
+    };
+
+    // Scores are only read and submitted on the frame thread. The index is updated immediately,
+    // the records are appended to the file by a background thread.
+    class Store {
+    private:
+        enum State { IDLE, PENDING, STOPPING };
+        static const INT MAX_WRITE_RETRIES = 3;
+
+        // one submitted score as it's stored in the file
+        struct Record {
+            UINT16 appleCountX;
+            UINT16 appleCountY;
+            UINT16 playTime;
+            UINT8 ruleVariant;
+            UINT8 reserved;
+            INT32 score;
+            UINT32 checksum; // FNV-1a of the fields above
+        };
+
+        std::unordered_map<UINT64, Top> m_index;
+#ifdef _WIN32
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+        int m_file = -1;
+#endif
+        INT64 m_fileEnd = 0; // end of the last complete record, only used by the worker after load
+        std::vector<Record> m_pending; // not handed to the worker yet
+        std::vector<Record> m_writing; // belongs to the worker while PENDING
+        std::atomic<int> m_state = IDLE;
+        std::thread m_worker;
+
+        // first free "<path>.bad", "<path>.1.bad", ... to keep a file that isn't ours, empty if none is
+        static std::filesystem::path setAsidePath(const std::filesystem::path& path);
+        void load(const std::filesystem::path& path);
+        void writeRecords();
+        void workerLoop();
+
+    public:
+        // Opens or creates the file and indexes it. Records after the first damaged one
+        // (a torn write) are dropped and overwritten by the next scores. A file that isn't a high
+        // score file of this version is renamed to <path>.bad and a new one is started. A file that
+        // can't be read (e.g. no address space to map it) is left as it is, and this run's scores
+        // aren't saved.
+        Store(const std::filesystem::path& path);
+        ~Store();
+
+        Store(const Store&) = delete;
+        Store& operator=(const Store&) = delete;
+
+        // best score for the settings, 0 if there is none
+        INT best(const Key& key) const;
+        // nullptr if there are no scores for the settings
+        const Top* top(const Key& key) const;
+
+        // Never blocks. Returns true if the score made it into the top scores of its settings.
+        bool submit(const Key& key, INT score);
+        // Hands submitted scores over to the worker if it's not busy with the previous ones
+        void tryFlush();
+    };
+} // namespace highScores
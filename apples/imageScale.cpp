@@ -0,0 +1,196 @@
+#include "imageScale.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE_SCALE_SSE2
+#include <emmintrin.h>
+#endif
+
+using imageScale::Image;
+
+namespace {
+    uint32_t channel(uint32_t pixel, int i) {
+        return (pixel >> (8 * i)) & 0xFF;
+    }
+
+    // average of 4 pixels, rounded
+    uint32_t average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+        uint32_t result = 0;
+        for (int i = 0; i < 4; i++) {
+            uint32_t sum = channel(a, i) + channel(b, i) + channel(c, i) + channel(d, i) + 2;
+            result |= (sum >> 2) << (8 * i);
+        }
+        return result;
+    }
+
+    // Bilinear interpolation weights are 7 bit, so (b - a) * weight fits in 16 bit lanes
+    const int WEIGHT_BITS = 7;
+
+    int32_t lerp(int32_t a, int32_t b, int32_t weight) {
+        return a + (((b - a) * weight) >> WEIGHT_BITS);
+    }
+
+    uint32_t bilinear(uint32_t p00, uint32_t p10, uint32_t p01, uint32_t p11, int32_t fx, int32_t fy) {
+        uint32_t result = 0;
+        for (int i = 0; i < 4; i++) {
+            int32_t left = lerp(channel(p00, i), channel(p01, i), fy);
+            int32_t right = lerp(channel(p10, i), channel(p11, i), fy);
+            result |= static_cast<uint32_t>(lerp(left, right, fx)) << (8 * i);
+        }
+        return result;
+    }
+
+    // source coordinates of a destination row or column, at pixel centers
+    struct Sample {
+        uint32_t i0;
+        uint32_t i1;
+        int32_t weight; // of i1
+    };
+
+    std::vector<Sample> samples(uint32_t sourceSize, uint32_t size) {
+        std::vector<Sample> result(size);
+        double ratio = static_cast<double>(sourceSize) / size;
+        for (uint32_t i = 0; i < size; i++) {
+            double position = (i + 0.5) * ratio - 0.5;
+            if (position < 0.0) { position = 0.0; }
+            uint32_t i0 = static_cast<uint32_t>(position);
+            if (i0 > sourceSize - 1) { i0 = sourceSize - 1; }
+            result[i] = {
+                .i0 = i0,
+                .i1 = i0 + 1 < sourceSize ? i0 + 1 : i0,
+                .weight = static_cast<int32_t>((position - i0) * (1 << WEIGHT_BITS) + 0.5),
+            };
+        }
+        return result;
+    }
+
+#ifdef IMAGE_SCALE_SSE2
+    // count output pixels from a pair of rows, 2 per iteration, returns how many were done
+    uint32_t halveRowSse2(const uint32_t* row0, const uint32_t* row1, uint32_t* out, uint32_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        uint32_t x = 0;
+        for (; x + 2 <= count; x += 2) {
+            __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x));
+            __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x));
+            // vertical sums as 16 bit, two source pixels per register
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+            // horizontal sums of the pixel pairs
+            __m128i a = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            __m128i b = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(a, b), rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sum, zero));
+        }
+        return x;
+    }
+
+    uint32_t bilinearSse2(uint32_t p00, uint32_t p10, uint32_t p01, uint32_t p11, __m128i fx, __m128i fy) {
+        const __m128i zero = _mm_setzero_si128();
+        // left column pixel in the low lanes, right column pixel in the high lanes
+        __m128i top = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, static_cast<int>(p10), static_cast<int>(p00)), zero);
+        __m128i bottom = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, static_cast<int>(p11), static_cast<int>(p01)), zero);
+        __m128i column = _mm_add_epi16(top,
+            _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(bottom, top), fy), WEIGHT_BITS));
+        __m128i right = _mm_srli_si128(column, 8);
+        __m128i result = _mm_add_epi16(column,
+            _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(right, column), fx), WEIGHT_BITS));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(result, zero)));
+    }
+#endif
+
+    template<bool SIMD>
+    Image halveImpl(const Image& source) {
+        Image result(source.width > 1 ? source.width / 2 : 1, source.height > 1 ? source.height / 2 : 1);
+        for (uint32_t y = 0; y < result.height; y++) {
+            const uint32_t* row0 = source.pixels.data() + static_cast<size_t>(2 * y < source.height ? 2 * y : source.height - 1) * source.width;
+            const uint32_t* row1 = source.pixels.data() + static_cast<size_t>(2 * y + 1 < source.height ? 2 * y + 1 : source.height - 1) * source.width;
+            uint32_t* out = result.pixels.data() + static_cast<size_t>(y) * result.width;
+
+            uint32_t x = 0;
+#ifdef IMAGE_SCALE_SSE2
+            // the last output pixels may need clamping on odd widths, those are done below
+            if constexpr (SIMD) {
+                if (source.width >= 2) {
+                    x = halveRowSse2(row0, row1, out, source.width / 2);
+                }
+            }
+#endif
+            for (; x < result.width; x++) {
+                uint32_t x0 = 2 * x < source.width ? 2 * x : source.width - 1;
+                uint32_t x1 = 2 * x + 1 < source.width ? 2 * x + 1 : source.width - 1;
+                out[x] = average4(row0[x0], row0[x1], row1[x0], row1[x1]);
+            }
+        }
+        return result;
+    }
+
+    template<bool SIMD>
+    Image resizeImpl(const Image& source, uint32_t width, uint32_t height) {
+        Image result(width, height);
+        if (source.width == 0 || source.height == 0) { return result; }
+
+        std::vector<Sample> columns = samples(source.width, width);
+        std::vector<Sample> rows = samples(source.height, height);
+
+        for (uint32_t y = 0; y < height; y++) {
+            const Sample& row = rows[y];
+            const uint32_t* row0 = source.pixels.data() + static_cast<size_t>(row.i0) * source.width;
+            const uint32_t* row1 = source.pixels.data() + static_cast<size_t>(row.i1) * source.width;
+            uint32_t* out = result.pixels.data() + static_cast<size_t>(y) * width;
+
+#ifdef IMAGE_SCALE_SSE2
+            if constexpr (SIMD) {
+                __m128i fy = _mm_set1_epi16(static_cast<short>(row.weight));
+                for (uint32_t x = 0; x < width; x++) {
+                    const Sample& column = columns[x];
+                    out[x] = bilinearSse2(row0[column.i0], row0[column.i1], row1[column.i0], row1[column.i1],
+                        _mm_set1_epi16(static_cast<short>(column.weight)), fy);
+                }
+                continue;
+            }
+#endif
+            for (uint32_t x = 0; x < width; x++) {
+                const Sample& column = columns[x];
+                out[x] = bilinear(row0[column.i0], row0[column.i1], row1[column.i0], row1[column.i1],
+                    column.weight, row.weight);
+            }
+        }
+        return result;
+    }
+} // namespace
+
+Image imageScale::halve(const Image& source) {
+    return halveImpl<true>(source);
+}
+
+Image imageScale::halveScalar(const Image& source) {
+    return halveImpl<false>(source);
+}
+
+Image imageScale::resize(const Image& source, uint32_t width, uint32_t height) {
+    return resizeImpl<true>(source, width, height);
+}
+
+Image imageScale::resizeScalar(const Image& source, uint32_t width, uint32_t height) {
+    return resizeImpl<false>(source, width, height);
+}
+
+std::vector<Image> imageScale::buildMips(const Image& source) {
+    std::vector<Image> mips;
+    const Image* previous = &source;
+    while (previous->width > 1 || previous->height > 1) {
+        mips.push_back(halve(*previous));
+        previous = &mips.back();
+    }
+    return mips;
+}
+
+Image imageScale::scaleTo(const Image& source, const std::vector<Image>& mips, uint32_t width, uint32_t height) {
+    const Image* best = &source;
+    for (const Image& mip : mips) {
+        if (mip.width < width || mip.height < height) { break; }
+        best = &mip;
+    }
+    if (best->width == width && best->height == height) { return *best; }
+    return resize(*best, width, height);
+}
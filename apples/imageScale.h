@@ -0,0 +1,35 @@
+// Downscaling of premultiplied 32 bit BGRA images: a 2x2 box filter for building mip levels and a
+// bilinear resize from the nearest larger mip level to an exact size. Kernels use SSE2 where it's
+// available and fall back to the scalar versions, which are kept as the reference to compare and
+// benchmark against. Doesn't depend on any platform headers, so it can be built and tested on any OS.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "memoryStats.h"
+
+namespace imageScale {
+    // premultiplied BGRA, rows without padding
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t, memoryStats::Allocator<uint32_t, memoryStats::Tag::IMAGES>> pixels;
+
+        Image() = default;
+        Image(uint32_t width, uint32_t height) : width(width), height(height), pixels(width * height) {}
+    };
+
+    // Half the size (rounded down, at least 1), every pixel the average of a 2x2 block
+    Image halve(const Image& source);
+    Image halveScalar(const Image& source);
+
+    // Bilinear resize, meant for at most halving, for more build mip levels first
+    Image resize(const Image& source, uint32_t width, uint32_t height);
+    Image resizeScalar(const Image& source, uint32_t width, uint32_t height);
+
+    // every level half of the previous one, the first is half of source, down to 1x1
+    std::vector<Image> buildMips(const Image& source);
+
+    // Exact size image resampled from the smallest level still at least as big as the size
+    Image scaleTo(const Image& source, const std::vector<Image>& mips, uint32_t width, uint32_t height);
+} // namespace imageScale
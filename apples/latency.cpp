@@ -0,0 +1,124 @@
+#include "latency.h"
+
+#include <bit>
+#include <cstdio>
+
+using latency::Action;
+using latency::Histogram;
+
+namespace {
+    struct PendingAction {
+        Action action;
+        uint64_t captureUs;
+    };
+
+    const int ACTION_COUNT = static_cast<int>(Action::COUNT);
+    Histogram stateHistograms[ACTION_COUNT];
+    Histogram presentHistograms[ACTION_COUNT];
+    std::vector<PendingAction> pending; // acted on, waiting for the frame to be presented
+} // namespace
+
+int Histogram::bucketOf(uint64_t us) {
+    if (us < 4) { return static_cast<int>(us); }
+
+    // top 2 bits below the highest set bit select one of 4 sub buckets
+    int highBit = 63 - std::countl_zero(us);
+    int sub = static_cast<int>((us >> (highBit - 2)) & 3);
+    int bucket = 4 * (highBit - 1) + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint64_t Histogram::bucketUpperBoundUs(int bucket) {
+    if (bucket < 4) { return static_cast<uint64_t>(bucket); }
+
+    int highBit = bucket / 4 + 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % 4);
+    return ((4 + sub + 1) << (highBit - 2)) - 1;
+}
+
+void Histogram::add(uint64_t us) {
+    m_buckets[bucketOf(us)]++;
+    m_count++;
+    m_sumUs += us;
+    if (us > m_maxUs) { m_maxUs = us; }
+}
+
+void Histogram::clear() {
+    *this = Histogram();
+}
+
+uint64_t Histogram::percentileUs(double percentile) const {
+    if (m_count == 0) { return 0; }
+
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * (m_count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            uint64_t bound = bucketUpperBoundUs(i);
+            return bound < m_maxUs ? bound : m_maxUs;
+        }
+    }
+    return m_maxUs;
+}
+
+
+void latency::recordAction(Action action, uint64_t captureUs, uint64_t stateUs) {
+    // events captured before the clock could be read (e.g. first frame) are ignored
+    if (captureUs == 0 || stateUs < captureUs) { return; }
+
+    stateHistograms[static_cast<int>(action)].add(stateUs - captureUs);
+    pending.push_back({ action, captureUs });
+}
+
+void latency::framePresented(uint64_t presentUs) {
+    for (const PendingAction& p : pending) {
+        if (presentUs >= p.captureUs) {
+            presentHistograms[static_cast<int>(p.action)].add(presentUs - p.captureUs);
+        }
+    }
+    pending.clear();
+}
+
+const Histogram& latency::captureToState(Action action) {
+    return stateHistograms[static_cast<int>(action)];
+}
+
+const Histogram& latency::captureToPresent(Action action) {
+    return presentHistograms[static_cast<int>(action)];
+}
+
+void latency::reset() {
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        stateHistograms[i].clear();
+        presentHistograms[i].clear();
+    }
+    pending.clear();
+}
+
+const char* latency::actionName(Action action) {
+    switch (action) {
+    case Action::DRAG_START: return "drag start";
+    case Action::DRAG_END: return "drag end";
+    case Action::POP: return "pop";
+    default: return "?";
+    }
+}
+
+std::string latency::formatReport() {
+    std::string report = "input latency [ms]       count    mean     p50     p90     p99     max\n";
+
+    char line[160];
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        for (bool toPresent : { false, true }) {
+            const Histogram& h = toPresent ? presentHistograms[i] : stateHistograms[i];
+            std::snprintf(line, sizeof(line), "%-10s %-9s %10llu %7.2f %7.2f %7.2f %7.2f %7.2f\n",
+                actionName(static_cast<Action>(i)), toPresent ? "->present" : "->state",
+                static_cast<unsigned long long>(h.count()), h.meanUs() / 1000.0,
+                h.percentileUs(50.0) / 1000.0, h.percentileUs(90.0) / 1000.0,
+                h.percentileUs(99.0) / 1000.0, h.maxUs() / 1000.0);
+            report += line;
+        }
+    }
+    return report;
+}
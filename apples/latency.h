@@ -0,0 +1,57 @@
+// Input latency measurement: input events carry the time they were captured at (see
+// Controller::keyEventTimeUs), gameLogic reports when it acted on them, and the frame loop
+// reports when the frame showing the result was presented. Both delays are kept in histograms.
+// All times are passed in explicitly (in microseconds), so it can be fed synthetic event
+// streams. Doesn't depend on any platform headers, so it can be built and tested on any OS.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace latency {
+    enum class Action {
+        DRAG_START, // left button press starting a drag
+        DRAG_END,   // release that didn't pop anything
+        POP,        // release that popped apples
+        COUNT
+    };
+
+    // Log-scale histogram of durations in microseconds, 4 buckets per power of two
+    class Histogram {
+    public:
+        static const int BUCKETS = 4 * 32;
+
+    private:
+        uint64_t m_buckets[BUCKETS] = {};
+        uint64_t m_count = 0;
+        uint64_t m_sumUs = 0;
+        uint64_t m_maxUs = 0;
+
+    public:
+        void add(uint64_t us);
+        void clear();
+
+        uint64_t count() const { return m_count; }
+        double meanUs() const { return m_count ? static_cast<double>(m_sumUs) / m_count : 0.0; }
+        uint64_t maxUs() const { return m_maxUs; }
+        // Upper bound of the bucket containing given percentile
+        uint64_t percentileUs(double percentile) const;
+
+        static int bucketOf(uint64_t us);
+        static uint64_t bucketUpperBoundUs(int bucket);
+    };
+
+    // Logic acted on an input event captured at captureUs, while processing a frame at stateUs
+    void recordAction(Action action, uint64_t captureUs, uint64_t stateUs);
+    // Frame with the results of all actions recorded since the previous call was presented
+    void framePresented(uint64_t presentUs);
+
+    const Histogram& captureToState(Action action);
+    const Histogram& captureToPresent(Action action);
+    void reset();
+
+    const char* actionName(Action action);
+    // Human readable table of all histograms
+    std::string formatReport();
+} // namespace latency
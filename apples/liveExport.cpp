@@ -0,0 +1,149 @@
+#include "liveExport.h"
+
+#include <cstring>
+
+using gamestate::GameState;
+using SingletonPlay = gamestate::GameState::SingletonPlay;
+
+static_assert(gamestate::MAX_PLAYERS <= liveState::MAX_PLAYERS);
+static_assert(gamestate::HUGE_MAX_APPLES * gamestate::HUGE_MAX_APPLES <= liveState::MAX_CELLS);
+static_assert(static_cast<int>(GameState::Mode::PLAYING) == 3);
+
+#ifdef _WIN32
+namespace {
+    // A process that exited can't be writing. One that can't be opened (another user's) may be.
+    bool processAlive(uint32_t id) {
+        HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, id);
+        if (process == nullptr) { return GetLastError() == ERROR_ACCESS_DENIED; }
+        bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return alive;
+    }
+} // namespace
+
+liveExport::Publisher::Publisher(const wchar_t* name) {
+    // pages the boards don't reach are never touched, so they take no memory
+    const UINT64 size = liveState::blockSize();
+    m_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), name);
+    if (m_mapping == nullptr) { return; }
+    // readers keep the section of an earlier run open, and another instance of the game has it too
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    m_view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(size));
+    if (m_view == nullptr) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+
+    // a game of another version lays the block out differently and doesn't know about claims
+    const liveState::Header& header = *static_cast<const liveState::Header*>(m_view);
+    const bool otherVersion = existed && header.magic == liveState::MAGIC && header.version != liveState::VERSION;
+    if (otherVersion || !liveState::claim(m_view, GetCurrentProcessId(), processAlive)) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+    m_writer.emplace(m_view, GetCurrentProcessId());
+}
+#endif
+
+liveExport::Publisher::Publisher(void* block, uint32_t owner) {
+    // anyone holding it is alive, nothing here outlives its caller
+    if (liveState::claim(block, owner, [](uint32_t) { return true; })) {
+        m_writer.emplace(block, owner);
+    }
+}
+
+liveExport::Publisher::~Publisher() {
+    m_writer.reset();
+#ifdef _WIN32
+    if (m_view != nullptr) {
+        UnmapViewOfFile(m_view);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+#endif
+}
+
+void liveExport::Publisher::frame(const GameState& gameState) {
+    if (!m_writer) { return; }
+
+    liveState::Header& header = m_writer->header();
+    m_writer->begin();
+    header.mode = static_cast<uint8_t>(gameState.mode);
+    header.playerCount = static_cast<uint8_t>(gameState.playerCount);
+    header.ruleVariant = static_cast<uint8_t>(gameState.ruleVariant);
+    header.width = gameState.appleCountX;
+    header.height = gameState.appleCountY;
+
+    for (INT i = 0; i < gameState.playerCount; i++) {
+        const SingletonPlay& play = gameState.players[i];
+        liveState::Player& player = header.players[i];
+
+        player.score = play.score;
+        timeBase::Ns endNs = play.startTimeNs + gameState.playTime * timeBase::NS_PER_SECOND;
+        player.remainingMs = gameState.currentTimeNs < endNs ?
+            static_cast<int32_t>((endNs - gameState.currentTimeNs) / timeBase::NS_PER_MS) : 0;
+        player.boardRevision = play.boardRevision;
+        player.timesOver = play.timesOver ? 1 : 0;
+        player.inDrag = play.inDrag ? 1 : 0;
+        if (play.inDrag) {
+            FLOAT startX = (play.dragStartX - play.appleMinX) / gameState.appleSize;
+            FLOAT startY = (play.dragStartY - play.appleMinY) / gameState.appleSize;
+            FLOAT mouseX = (play.toBoardX(gameState.logicalMouseX) - play.appleMinX) / gameState.appleSize;
+            FLOAT mouseY = (play.toBoardY(gameState.logicalMouseY) - play.appleMinY) / gameState.appleSize;
+            player.dragLeft = min(startX, mouseX);
+            player.dragTop = min(startY, mouseY);
+            player.dragRight = max(startX, mouseX);
+            player.dragBottom = max(startY, mouseY);
+        }
+
+        if (gameState.mode == GameState::Mode::PLAYING) {
+            publishBoard(i, play);
+        }
+    }
+    m_writer->end();
+}
+
+void liveExport::Publisher::publishBoard(UINT32 player, const SingletonPlay& play) {
+    std::optional<PublishedBoard>& published = m_boards[player];
+    INT width = play.apples.sizeX();
+    INT height = play.apples.sizeY();
+    uint8_t* popped = m_writer->popped(player);
+
+    // a new game, even on the same board (e.g. the daily one), is written in full
+    if (!published || published->boardSeed != play.boardSeed || published->startTimeNs != play.startTimeNs ||
+        published->width != width || published->height != height) {
+        uint8_t* values = m_writer->values(player);
+        std::memset(popped, 0, (static_cast<size_t>(width) * height + 7) / 8);
+        play.apples.forEach([&](const gamestate::Apple& apple, INT x, INT y) {
+            size_t index = static_cast<size_t>(y) * width + x;
+            values[index] = static_cast<uint8_t>(apple.value);
+            if (apple.popped) {
+                popped[index / 8] |= static_cast<uint8_t>(1 << (index % 8));
+            }
+        });
+        published = PublishedBoard{
+            .boardSeed = play.boardSeed,
+            .startTimeNs = play.startTimeNs,
+            .width = width,
+            .height = height,
+            .boardRevision = play.boardRevision,
+        };
+        return;
+    }
+
+    // apples popped since the last frame are falling, the ones published before are set again
+    if (play.boardRevision != published->boardRevision) {
+        for (gamestate::CellXY cell : play.fallingApples) {
+            size_t index = static_cast<size_t>(cell.y) * width + cell.x;
+            popped[index / 8] |= static_cast<uint8_t>(1 << (index % 8));
+        }
+        published->boardRevision = play.boardRevision;
+    }
+}
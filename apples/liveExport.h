@@ -0,0 +1,55 @@
+// Publishes the live game state (see liveState.h) in a named shared memory section, for tools that
+// open it by DEFAULT_NAME and read it in place. Anywhere else it publishes in a block it's given,
+// which is what tests and benchmarks use.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include "gameState.h"
+#include "liveState.h"
+#include "platform.h"
+
+namespace liveExport {
+    const wchar_t DEFAULT_NAME[] = L"Local\\apples-live-state";
+
+    class Publisher {
+    private:
+        // board of a player as last published
+        struct PublishedBoard {
+            UINT64 boardSeed;
+            timeBase::Ns startTimeNs;
+            INT width;
+            INT height;
+            UINT32 boardRevision;
+        };
+
+#ifdef _WIN32
+        HANDLE m_mapping = nullptr;
+        void* m_view = nullptr;
+#endif
+        std::optional<liveState::Writer> m_writer;
+        std::array<std::optional<PublishedBoard>, liveState::MAX_PLAYERS> m_boards;
+
+        void publishBoard(UINT32 player, const gamestate::GameState::SingletonPlay& play);
+
+    public:
+#ifdef _WIN32
+        // Doesn't publish if the section can't be created or another running game publishes in it
+        explicit Publisher(const wchar_t* name);
+#endif
+        // In a zeroed block of liveState::blockSize() bytes the caller keeps, as owner, if no one else
+        // has claimed it
+        Publisher(void* block, uint32_t owner);
+        ~Publisher();
+
+        Publisher(const Publisher&) = delete;
+        Publisher& operator=(const Publisher&) = delete;
+
+        bool publishing() const { return m_writer.has_value(); }
+
+        // Once per frame after the game logic. Never blocks, writes the header and what changed on
+        // the boards, a new board in full.
+        void frame(const gamestate::GameState& gameState);
+    };
+} // namespace liveExport
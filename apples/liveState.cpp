@@ -0,0 +1,47 @@
+#include "liveState.h"
+
+using liveState::Header;
+
+liveState::Writer::Writer(void* block, uint32_t owner) : m_header(static_cast<Header*>(block)), m_owner(owner) {
+    // a block left over from an earlier run that readers kept open goes on from its sequence
+    m_sequence = m_header->sequence.load(std::memory_order_relaxed) | 1;
+    m_header->sequence.store(m_sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_header->magic = MAGIC;
+    m_header->version = VERSION;
+    m_header->size = blockSize();
+
+    size_t offset = sizeof(Header);
+    for (Player& player : m_header->players) {
+        player.valuesOffset = static_cast<uint32_t>(offset);
+        player.poppedOffset = static_cast<uint32_t>(offset + MAX_CELLS);
+        offset += MAX_CELLS + MAX_CELLS / 8;
+    }
+    m_header->sequence.store(++m_sequence, std::memory_order_release);
+}
+
+liveState::Writer::~Writer() {
+    // only if it's still ours, a block whose writer seemed gone may have been taken over
+    uint32_t owner = m_owner;
+    m_header->writer.compare_exchange_strong(owner, 0, std::memory_order_release, std::memory_order_relaxed);
+}
+
+void liveState::Writer::begin() {
+    m_header->sequence.store(++m_sequence, std::memory_order_relaxed);
+    // the odd sequence is seen before any of the writes
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void liveState::Writer::end() {
+    m_header->frame++;
+    m_header->sequence.store(++m_sequence, std::memory_order_release);
+}
+
+uint8_t* liveState::Writer::values(uint32_t player) {
+    return reinterpret_cast<uint8_t*>(m_header) + m_header->players[player].valuesOffset;
+}
+
+uint8_t* liveState::Writer::popped(uint32_t player) {
+    return reinterpret_cast<uint8_t*>(m_header) + m_header->players[player].poppedOffset;
+}
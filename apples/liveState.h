@@ -0,0 +1,122 @@
+// Live game state for external tools (stream overlays, analytics): every frame the game publishes
+// mode, scores, timers, drag rectangles and the boards into a block of shared memory, and readers
+// in other processes read it in place. The block is guarded by a sequence counter (a seqlock): it's
+// odd while the game writes, and a reader whose read overlapped a write sees it changed and reads
+// again, so the game never waits for readers and readers need no copies. Only changes are written:
+// a frame is the header, board values are written once per game and popped bits as apples pop.
+// A block has one writer at a time, which claims it in the header before it writes anything.
+// This is the layout and the protocol only, no platform headers, so tools can include it as is.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace liveState {
+    const uint32_t MAGIC = 0x4c505041; // "APPL"
+    // changes with any change of the layout below
+    const uint32_t VERSION = 2;
+
+    const uint32_t MAX_PLAYERS = 8;
+    const uint32_t MAX_CELLS = 1000 * 1000; // biggest board
+
+    struct Player {
+        int32_t score;
+        int32_t remainingMs;    // 0 once the time is over
+        uint32_t boardRevision; // changes whenever apples pop
+        uint8_t timesOver;
+        uint8_t inDrag;
+        uint8_t reserved[2];
+        // in cells, cell (x, y) covers [x, x + 1) x [y, y + 1), only valid while inDrag
+        float dragLeft;
+        float dragTop;
+        float dragRight;
+        float dragBottom;
+        // from the start of the block
+        uint32_t valuesOffset; // width * height bytes, row major
+        uint32_t poppedOffset; // cell i is bit i % 8 of byte i / 8
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t size; // of the whole block
+        std::atomic<uint32_t> sequence; // odd while a frame is being written
+        std::atomic<uint32_t> writer; // process id of the game writing the block, 0 if none
+        uint64_t frame;
+        uint8_t mode; // 0 title menu, 1 main menu, 2 help, 3 playing
+        uint8_t playerCount; // boards are only valid while playing
+        uint8_t ruleVariant;
+        uint8_t reserved2;
+        int32_t width; // of the boards, in cells
+        int32_t height;
+        Player players[MAX_PLAYERS];
+    };
+
+    // shared memory has to work across processes, that needs lock free atomics
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    // header and the board of every player
+    constexpr size_t blockSize() {
+        return sizeof(Header) + MAX_PLAYERS * (MAX_CELLS + MAX_CELLS / 8);
+    }
+
+    // Claims a block for owner (not 0, e.g. the process id) if no writer holds it or the one that does
+    // is gone, which isAlive(holder) tells: a game that crashed never let go. False if another writer
+    // holds it (a second instance of the game), then the block mustn't be written.
+    template<typename F>
+    bool claim(void* block, uint32_t owner, F isAlive) {
+        std::atomic<uint32_t>& writer = static_cast<Header*>(block)->writer;
+        uint32_t holder = writer.load(std::memory_order_acquire);
+        do {
+            if (holder != 0 && isAlive(holder)) { return false; }
+        } while (!writer.compare_exchange_weak(holder, owner, std::memory_order_acq_rel, std::memory_order_acquire));
+        return true;
+    }
+
+    // The game's side, one writer per block
+    class Writer {
+    private:
+        Header* m_header;
+        uint32_t m_owner;
+        uint32_t m_sequence = 0;
+
+    public:
+        // Sets up the header of a block of blockSize() bytes, zeroed or left over from an earlier run,
+        // that owner claimed. Lets go of the claim when destroyed.
+        Writer(void* block, uint32_t owner);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Everything written between begin() and end() is seen by readers together
+        void begin();
+        void end();
+
+        Header& header() { return *m_header; }
+        uint8_t* values(uint32_t player);
+        uint8_t* popped(uint32_t player);
+    };
+
+    const int MAX_READ_ATTEMPTS = 1000;
+
+    // Reader side. Calls read(header, block) on the block in place until it ran without a write
+    // in between, read has to cope with torn data of attempts that get thrown away (e.g. take the
+    // board size once and check it against MAX_CELLS). Returns false while the game kept writing
+    // (a new board is being written), that's worth trying again a little later.
+    template<typename F>
+    bool read(const void* block, F read) {
+        const Header& header = *static_cast<const Header*>(block);
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+            uint32_t before = header.sequence.load(std::memory_order_acquire);
+            if (before & 1) { continue; }
+
+            read(header, static_cast<const uint8_t*>(block));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header.sequence.load(std::memory_order_relaxed) == before) { return true; }
+        }
+        return false;
+    }
+} // namespace liveState
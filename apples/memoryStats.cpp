@@ -0,0 +1,54 @@
+#include "memoryStats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using memoryStats::Counters;
+using memoryStats::Tag;
+
+namespace {
+    const int TAG_COUNT = static_cast<int>(Tag::COUNT);
+    uint64_t maxFrame[TAG_COUNT] = {};
+} // namespace
+
+Counters memoryStats::detail::counters[TAG_COUNT];
+
+const Counters& memoryStats::counters(Tag tag) {
+    return detail::counters[static_cast<int>(tag)];
+}
+
+void memoryStats::beginFrame() {
+    for (int i = 0; i < TAG_COUNT; i++) {
+        uint64_t frame = detail::counters[i].frameAllocations.exchange(0, std::memory_order_relaxed);
+        maxFrame[i] = std::max(maxFrame[i], frame);
+    }
+}
+
+uint64_t memoryStats::maxFrameAllocations(Tag tag) {
+    return maxFrame[static_cast<int>(tag)];
+}
+
+const char* memoryStats::tagName(Tag tag) {
+    switch (tag) {
+    case Tag::BOARD: return "board";
+    case Tag::IMAGES: return "images";
+    case Tag::DEVICE_BITMAPS: return "device bitmaps";
+    default: return "?";
+    }
+}
+
+std::string memoryStats::formatReport() {
+    std::string report = "memory [KiB]        current      peak  allocations  max/frame\n";
+
+    char line[128];
+    for (int i = 0; i < TAG_COUNT; i++) {
+        const Counters& c = detail::counters[i];
+        std::snprintf(line, sizeof(line), "%-16s %10.1f %9.1f %12llu %10llu\n",
+            tagName(static_cast<Tag>(i)),
+            c.currentBytes.load(std::memory_order_relaxed) / 1024.0, c.peakBytes.load(std::memory_order_relaxed) / 1024.0,
+            static_cast<unsigned long long>(c.allocations.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(maxFrame[i]));
+        report += line;
+    }
+    return report;
+}
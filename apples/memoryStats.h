@@ -0,0 +1,80 @@
+// Memory use by subsystem: current and peak bytes, allocation counts in total and per frame.
+// Containers are tagged with Allocator, memory owned by something else (e.g. device bitmaps,
+// estimated from their pixel size) is reported with allocated()/freed(). Counting is a few relaxed
+// atomic adds per allocation, so it's always on. Doesn't depend on any platform headers, so the
+// board and image code keep building anywhere.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace memoryStats {
+    enum class Tag {
+        BOARD,          // apple grids
+        IMAGES,         // decoded images, mip levels and resampled copies
+        DEVICE_BITMAPS, // render target bitmaps, 4 bytes per pixel
+        COUNT
+    };
+
+    struct Counters {
+        std::atomic<int64_t> currentBytes = 0;
+        std::atomic<int64_t> peakBytes = 0;
+        std::atomic<uint64_t> allocations = 0;
+        std::atomic<uint64_t> frameAllocations = 0; // since beginFrame()
+    };
+
+    namespace detail {
+        extern Counters counters[static_cast<int>(Tag::COUNT)];
+    }
+
+    inline void allocated(Tag tag, size_t bytes) {
+        Counters& c = detail::counters[static_cast<int>(tag)];
+        int64_t current = c.currentBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+        int64_t peak = c.peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !c.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        c.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void freed(Tag tag, size_t bytes) {
+        detail::counters[static_cast<int>(tag)].currentBytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    // std::allocator that counts what it allocates under tag
+    template<typename T, Tag tag>
+    struct Allocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind { using other = Allocator<U, tag>; };
+
+        Allocator() = default;
+        template<typename U>
+        Allocator(const Allocator<U, tag>&) {}
+
+        T* allocate(size_t n) {
+            allocated(tag, n * sizeof(T));
+            return std::allocator<T>().allocate(n);
+        }
+        void deallocate(T* p, size_t n) {
+            freed(tag, n * sizeof(T));
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        bool operator==(const Allocator<U, tag>&) const { return true; }
+    };
+
+    const Counters& counters(Tag tag);
+
+    // Frame thread, at the start of each frame. Per frame counts start over, the most any frame
+    // allocated is kept.
+    void beginFrame();
+    uint64_t maxFrameAllocations(Tag tag);
+
+    const char* tagName(Tag tag);
+    // Human readable table of all tags
+    std::string formatReport();
+} // namespace memoryStats
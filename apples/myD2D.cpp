@@ -38,7 +38,8 @@ void MyD2DObjectCollection::init(HWND hwnd, rtd rtdv) {
 
 			hCheck(d2d_factory->CreateHwndRenderTarget(
 				D2D1::RenderTargetProperties(),
-				D2D1::HwndRenderTargetProperties(hwnd, D2D1::SizeU(size_x, size_y)),
+				// contents are kept between frames, so only changed regions have to be redrawn
+				D2D1::HwndRenderTargetProperties(hwnd, D2D1::SizeU(size_x, size_y), D2D1_PRESENT_OPTIONS_RETAIN_CONTENTS),
 				&d2d_render_target));
 		}
 	}
@@ -0,0 +1,58 @@
+// Windows types the game logic is written with. On Windows they come from the Windows headers;
+// elsewhere the few the logic uses are defined here, so the game state, game logic and input
+// handling build on Linux for tests, benchmarks and tools, without any of the window or drawing code.
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <d2d1.h>
+#else
+#include <cstdint>
+
+typedef int INT;
+typedef unsigned int UINT;
+typedef int BOOL;
+typedef float FLOAT;
+typedef unsigned char BYTE;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef int32_t INT32;
+typedef int64_t INT64;
+
+#define FALSE 0
+#define TRUE 1
+
+// virtual key codes of the keys the game reacts to, letters are their upper case characters
+#define VK_LBUTTON 0x01
+#define VK_RBUTTON 0x02
+#define VK_ESCAPE 0x1B
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+#define VK_F3 0x72
+#define VK_F4 0x73
+
+#define WHEEL_DELTA 120
+
+// the Windows headers have these as macros
+template<typename T>
+constexpr T min(T a, T b) { return b < a ? b : a; }
+template<typename T>
+constexpr T max(T a, T b) { return a < b ? b : a; }
+
+struct D2D1_RECT_F {
+    FLOAT left;
+    FLOAT top;
+    FLOAT right;
+    FLOAT bottom;
+};
+
+namespace D2D1 {
+    constexpr D2D1_RECT_F RectF(FLOAT left = 0.0f, FLOAT top = 0.0f, FLOAT right = 0.0f, FLOAT bottom = 0.0f) {
+        return { left, top, right, bottom };
+    }
+} // namespace D2D1
+#endif
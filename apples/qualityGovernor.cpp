@@ -0,0 +1,62 @@
+#include "qualityGovernor.h"
+
+#include <algorithm>
+#include <bit>
+
+using qualityGovernor::Governor;
+using qualityGovernor::Settings;
+
+namespace {
+    const uint32_t UNLIMITED = UINT32_MAX;
+
+    const Settings LEVELS[qualityGovernor::LEVEL_COUNT] = {
+        // smooth images, falling apples, gradient, outline, text antialiasing
+        { true,  UNLIMITED, true,  1.0f, true },
+        { false, UNLIMITED, true,  1.0f, true },
+        { false, 200,       true,  1.0f, true },
+        { false, 200,       false, 1.0f, true },
+        { false, 200,       false, 0.5f, true },
+        { false, 50,        false, 0.5f, false },
+    };
+
+    const uint32_t DOWN_WINDOW_MASK = (1u << Governor::DOWN_WINDOW) - 1;
+} // namespace
+
+Settings qualityGovernor::settingsFor(int level) {
+    return LEVELS[std::clamp(level, 0, LEVEL_COUNT - 1)];
+}
+
+void Governor::change(int level) {
+    m_steppedUp = level < m_level;
+    m_level = level;
+    m_missed = 0;
+    m_framesSinceChange = 0;
+    m_headroomFrames = 0;
+}
+
+bool Governor::frame(double frameTimeMs) {
+    if (frameTimeMs > IGNORED_FRAME_MS) { return false; }
+
+    m_framesSinceChange++;
+    m_missed = (m_missed << 1) | (frameTimeMs > m_budgetMs * OVER_BUDGET ? 1 : 0);
+    m_headroomFrames = frameTimeMs < m_budgetMs * HEADROOM ? m_headroomFrames + 1 : 0;
+    if (m_framesSinceChange % CALM_FRAMES == 0 && m_upFrames > UP_FRAMES) {
+        m_upFrames = std::max(m_upFrames / 2, static_cast<int>(UP_FRAMES));
+    }
+
+    // the new level gets a full window before it's judged
+    if (m_framesSinceChange >= DOWN_WINDOW && std::popcount(m_missed & DOWN_WINDOW_MASK) >= DOWN_MISSED &&
+        m_level < LEVEL_COUNT - 1) {
+        if (m_steppedUp && m_framesSinceChange < OSCILLATION_FRAMES) {
+            m_upFrames = std::min(m_upFrames * 2, static_cast<int>(MAX_UP_FRAMES));
+        }
+        change(m_level + 1);
+        return true;
+    }
+
+    if (m_headroomFrames >= m_upFrames && m_level > 0) {
+        change(m_level - 1);
+        return true;
+    }
+    return false;
+}
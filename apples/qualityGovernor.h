@@ -0,0 +1,67 @@
+// Render quality governor: watches frame times against the frame budget and gives up render quality
+// one step at a time while frames keep missing it, taking it back once there's been headroom for a
+// while. Stepping up takes much longer than stepping down, and longer still after a step up had to
+// be taken back, so the level settles instead of flipping between two, until the level has held for
+// a while. Frame times are passed in
+// explicitly, so the policy can be driven by synthetic traces. Doesn't depend on any platform headers.
+#pragma once
+
+#include <cstdint>
+
+namespace qualityGovernor {
+    // What drawLogic draws at a level
+    struct Settings {
+        bool smoothImages;         // linear interpolation of images, otherwise nearest neighbor
+        uint32_t maxFallingApples; // per board, the rest aren't drawn while falling
+        bool appleGradient;        // gradient apple bodies, otherwise flat
+        float outlineScale;        // of the apple outline width
+        bool textAntialiasing;
+    };
+
+    // 0 is full quality, each level down gives up one more thing, least missed first
+    const int LEVEL_COUNT = 6;
+    Settings settingsFor(int level);
+
+    class Governor {
+    public:
+        // frames slower than budget * OVER_BUDGET count as missed
+        static constexpr double OVER_BUDGET = 1.2;
+        // of the last DOWN_WINDOW frames, this many missing the budget steps down
+        static constexpr int DOWN_WINDOW = 30;
+        static constexpr int DOWN_MISSED = 10;
+        // this many frames in a row under budget * HEADROOM step up
+        static constexpr double HEADROOM = 0.7;
+        static constexpr int UP_FRAMES = 240;
+        // a step down this soon after stepping up doubles the frames the next step up needs
+        static constexpr int OSCILLATION_FRAMES = 600;
+        static constexpr int MAX_UP_FRAMES = 16 * UP_FRAMES;
+        // every this many frames without a change halve it again, back down to UP_FRAMES
+        static constexpr int CALM_FRAMES = 2 * MAX_UP_FRAMES;
+        // stalls (window moves, breakpoints, the machine sleeping) aren't the renderer's fault
+        static constexpr double IGNORED_FRAME_MS = 250.0;
+
+    private:
+        double m_budgetMs;
+        int m_level = 0;
+        uint32_t m_missed = 0;       // one bit per frame since the last change, newest lowest
+        int m_framesSinceChange = 0;
+        int m_headroomFrames = 0;    // in a row
+        int m_upFrames = UP_FRAMES;
+        bool m_steppedUp = false;    // last change was a step up
+
+        void change(int level);
+
+    public:
+        explicit Governor(double budgetMs) : m_budgetMs(budgetMs) {}
+
+        // Once per frame with the time since the previous frame. Returns true when the level changed.
+        bool frame(double frameTimeMs);
+
+        void setBudget(double budgetMs) { m_budgetMs = budgetMs; }
+        double budgetMs() const { return m_budgetMs; }
+        int level() const { return m_level; }
+        // frames in a row with headroom the next step up needs
+        int upFrames() const { return m_upFrames; }
+        Settings settings() const { return settingsFor(m_level); }
+    };
+} // namespace qualityGovernor
@@ -0,0 +1,90 @@
+#include "renderStats.h"
+
+#include <algorithm>
+#include <array>
+
+using renderStats::Counters;
+using renderStats::FrameStats;
+using renderStats::Section;
+
+namespace {
+    FrameStats collecting;
+    FrameStats finished;
+
+    std::array<double, renderStats::HISTORY_SIZE> frameTimes;
+    int frameTimesCount = 0;
+    int frameTimesNext = 0;
+} // namespace
+
+Counters* renderStats::detail::current = &collecting.sections[0];
+
+Counters& Counters::operator+=(const Counters& other) {
+    drawCalls += other.drawCalls;
+    transformChanges += other.transformChanges;
+    brushColorChanges += other.brushColorChanges;
+    textDraws += other.textDraws;
+    return *this;
+}
+
+Counters FrameStats::total() const {
+    Counters result;
+    for (const Counters& counters : sections) {
+        result += counters;
+    }
+    return result;
+}
+
+void renderStats::beginFrame() {
+    collecting = FrameStats();
+    setSection(Section::MENU);
+}
+
+void renderStats::endFrame(double frameTimeMs) {
+    collecting.frameTimeMs = frameTimeMs;
+    finished = collecting;
+
+    frameTimes[frameTimesNext] = frameTimeMs;
+    frameTimesNext = (frameTimesNext + 1) % HISTORY_SIZE;
+    frameTimesCount = std::min(frameTimesCount + 1, HISTORY_SIZE);
+}
+
+void renderStats::setSection(Section section) {
+    detail::current = &collecting.sections[static_cast<int>(section)];
+}
+
+const FrameStats& renderStats::lastFrame() {
+    return finished;
+}
+
+double renderStats::averageFps() {
+    if (frameTimesCount == 0) { return 0.0; }
+
+    double sum = 0.0;
+    for (int i = 0; i < frameTimesCount; i++) {
+        sum += frameTimes[i];
+    }
+    return sum > 0.0 ? 1000.0 * frameTimesCount / sum : 0.0;
+}
+
+double renderStats::frameTimePercentileMs(double percentile) {
+    if (frameTimesCount == 0) { return 0.0; }
+
+    std::array<double, HISTORY_SIZE> sorted;
+    std::copy(frameTimes.begin(), frameTimes.begin() + frameTimesCount, sorted.begin());
+
+    int index = static_cast<int>(percentile / 100.0 * (frameTimesCount - 1) + 0.5);
+    index = std::clamp(index, 0, frameTimesCount - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + frameTimesCount);
+    return sorted[index];
+}
+
+const char* renderStats::sectionName(Section section) {
+    switch (section) {
+    case Section::MENU: return "menu";
+    case Section::PLAY_FIELD: return "play field";
+    case Section::APPLES: return "apples";
+    case Section::TEXT: return "text";
+    case Section::OVERLAYS: return "overlays";
+    default: return "?";
+    }
+}
@@ -0,0 +1,59 @@
+// Per-frame rendering counters (draw calls, transform and brush changes, text draws)
+// split by drawLogic section, plus frame time history for FPS and percentiles.
+// Doesn't depend on any platform headers, so it can be built and tested on any OS.
+#pragma once
+
+#include <cstdint>
+
+namespace renderStats {
+    enum class Section {
+        MENU,       // menu backgrounds, border, buttons
+        PLAY_FIELD, // score panel, timer, play area
+        APPLES,
+        TEXT,       // standalone texts (titles, help, settings values)
+        OVERLAYS,   // drag rectangle, game over, stats overlay, layer composition
+        COUNT
+    };
+
+    struct Counters {
+        uint32_t drawCalls = 0;
+        uint32_t transformChanges = 0;
+        uint32_t brushColorChanges = 0;
+        uint32_t textDraws = 0;
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    struct FrameStats {
+        Counters sections[static_cast<int>(Section::COUNT)];
+        double frameTimeMs = 0.0; // time since the previous frame
+
+        Counters total() const;
+        const Counters& section(Section s) const { return sections[static_cast<int>(s)]; }
+    };
+
+    // Called around each frame, frameTimeMs being time since the previous frame started
+    void beginFrame();
+    void endFrame(double frameTimeMs);
+
+    // Counters below are attributed to this section until changed
+    void setSection(Section section);
+
+    namespace detail {
+        extern Counters* current;
+    }
+    inline void countDrawCall() { detail::current->drawCalls++; }
+    inline void countTransform() { detail::current->transformChanges++; }
+    inline void countBrushColor() { detail::current->brushColorChanges++; }
+    inline void countText() { detail::current->textDraws++; detail::current->drawCalls++; }
+
+    // Stats of the last finished frame
+    const FrameStats& lastFrame();
+
+    // Computed over the last HISTORY_SIZE frames
+    const int HISTORY_SIZE = 256;
+    double averageFps();
+    double frameTimePercentileMs(double percentile);
+
+    const char* sectionName(Section section);
+} // namespace renderStats
@@ -0,0 +1,68 @@
+// Counter-based random number streams. Every number is a pure function of (key, index), so
+// streams can be split into independent child streams (per board, per apple, per thread)
+// and results don't depend on the order or the thread things are generated in.
+// Doesn't depend on any platform headers, so it can be built and tested on any OS.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rng {
+    // SplitMix64 finalizer, a bijective 64 bit mix
+    constexpr uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // index-th number of the stream identified by key
+    constexpr uint64_t at(uint64_t key, uint64_t index) {
+        return mix(key + (index + 1) * 0x9E3779B97F4A7C15ull);
+    }
+
+    // uniform float in [0, 1) from the top 24 bits
+    constexpr float toUnitFloat(uint64_t bits) {
+        return static_cast<float>(bits >> 40) * (1.0f / 16777216.0f);
+    }
+
+    class Stream {
+    private:
+        uint64_t m_key;
+        uint64_t m_counter = 0;
+
+    public:
+        constexpr explicit Stream(uint64_t seed = 0) : m_key(mix(seed)) {}
+
+        // Independent stream derived from this stream's key and id, not affected by how many
+        // numbers were drawn from this stream
+        constexpr Stream split(uint64_t id) const {
+            return Stream(m_key ^ mix(id + 0x632BE59BD9B4E019ull));
+        }
+
+        constexpr uint64_t next() { return at(m_key, m_counter++); }
+
+        // uniform in [minValue, maxValue]
+        constexpr int32_t nextInt(int32_t minValue, int32_t maxValue) {
+            uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(maxValue) - minValue + 1);
+            return minValue + static_cast<int32_t>(((next() >> 32) * range) >> 32);
+        }
+
+        // uniform in [minValue, maxValue)
+        constexpr float nextFloat(float minValue = 0.0f, float maxValue = 1.0f) {
+            return toUnitFloat(next()) * (maxValue - minValue) + minValue;
+        }
+
+        // Same numbers as count calls to nextFloat, but without a dependency between iterations,
+        // so the loop can be vectorized
+        void fillFloats(float* out, size_t count, float minValue = 0.0f, float maxValue = 1.0f) {
+            float scale = maxValue - minValue;
+            for (size_t i = 0; i < count; i++) {
+                out[i] = toUnitFloat(at(m_key, m_counter + i)) * scale + minValue;
+            }
+            m_counter += count;
+        }
+    };
+} // namespace rng
@@ -0,0 +1,117 @@
+// Rule variants: target sum, apple value range, allowed selection shape and scoring.
+// Each variant is a type, so generators and move validators are templates instantiated per variant
+// and the classic rules compile to the same checks as when they were hard-coded.
+// No Windows types here either, move validation builds with any standard compiler.
+#pragma once
+
+#include <algorithm>
+
+namespace rules {
+    enum class SelectionShape {
+        RECTANGLE, // any apples inside the dragged rectangle
+        LINE,      // only apples in a single row or column
+    };
+
+    enum class Scoring {
+        PER_APPLE, // each popped apple is a point
+        PER_MOVE,  // each successful move is a point
+    };
+
+    template<int TARGET, int MIN, int MAX, SelectionShape SHAPE, Scoring SCORING>
+    struct Rules {
+        static constexpr int TARGET_SUM = TARGET;
+        static constexpr int MIN_VALUE = MIN;
+        static constexpr int MAX_VALUE = MAX;
+        static constexpr SelectionShape SELECTION_SHAPE = SHAPE;
+        static constexpr Scoring SCORING_TYPE = SCORING;
+
+        static_assert(MIN_VALUE >= 1 && MIN_VALUE <= MAX_VALUE, "invalid apple value range");
+        static_assert(MAX_VALUE <= 99, "apple values are drawn and stored as at most 2 digits");
+        static_assert(TARGET_SUM > MIN_VALUE, "target sum has to need more than one apple");
+    };
+
+    using Classic = Rules<10, 1, 9, SelectionShape::RECTANGLE, Scoring::PER_APPLE>;
+    using Fifteen = Rules<15, 1, 9, SelectionShape::RECTANGLE, Scoring::PER_APPLE>;
+    using Twenty = Rules<20, 1, 12, SelectionShape::RECTANGLE, Scoring::PER_APPLE>;
+    using Lines = Rules<10, 1, 9, SelectionShape::LINE, Scoring::PER_MOVE>;
+
+    // runtime selection of one of the variants above
+    enum class Variant {
+        CLASSIC,
+        FIFTEEN,
+        TWENTY,
+        LINES,
+        COUNT
+    };
+
+    inline const wchar_t* variantName(Variant variant) {
+        switch (variant) {
+        case Variant::FIFTEEN: return L"Sum 15";
+        case Variant::TWENTY: return L"Sum 20, 1-12";
+        case Variant::LINES: return L"Lines only";
+        default: return L"Classic";
+        }
+    }
+
+    inline Variant nextVariant(Variant variant) {
+        return static_cast<Variant>((static_cast<int>(variant) + 1) % static_cast<int>(Variant::COUNT));
+    }
+
+    // Calls f with a default constructed rules type of the variant, so the variant is
+    // resolved once per call and everything inside f is specialized on it
+    template<typename F>
+    decltype(auto) visit(Variant variant, F&& f) {
+        switch (variant) {
+        case Variant::FIFTEEN: return f(Fifteen{});
+        case Variant::TWENTY: return f(Twenty{});
+        case Variant::LINES: return f(Lines{});
+        default: return f(Classic{});
+        }
+    }
+
+    // Accumulates apples of a selection and validates it as a move
+    template<typename R>
+    class Selection {
+    private:
+        int m_sum = 0;
+        int m_count = 0;
+        // only tracked when the shape needs it
+        int m_minX = 0, m_minY = 0, m_maxX = 0, m_maxY = 0;
+
+    public:
+        void add(int value, int x, int y) {
+            if constexpr (R::SELECTION_SHAPE == SelectionShape::LINE) {
+                if (m_count == 0) {
+                    m_minX = m_maxX = x;
+                    m_minY = m_maxY = y;
+                } else {
+                    m_minX = std::min<int>(m_minX, x);
+                    m_maxX = std::max<int>(m_maxX, x);
+                    m_minY = std::min<int>(m_minY, y);
+                    m_maxY = std::max<int>(m_maxY, y);
+                }
+            }
+            m_sum += value;
+            m_count++;
+        }
+
+        int sum() const { return m_sum; }
+        int count() const { return m_count; }
+
+        bool valid() const {
+            if constexpr (R::SELECTION_SHAPE == SelectionShape::LINE) {
+                if (m_minX != m_maxX && m_minY != m_maxY) { return false; }
+            }
+            return m_sum == R::TARGET_SUM;
+        }
+
+        // points for popping this selection
+        int score() const {
+            if constexpr (R::SCORING_TYPE == Scoring::PER_MOVE) {
+                return 1;
+            } else {
+                return m_count;
+            }
+        }
+    };
+} // namespace rules
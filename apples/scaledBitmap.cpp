@@ -0,0 +1,104 @@
+#include "scaledBitmap.h"
+
+#include "helper.h"
+
+using help::hCheck;
+using imageScale::Image;
+
+namespace {
+    ID2D1Bitmap* createBitmap(ID2D1RenderTarget* target, const Image& image) {
+        ID2D1Bitmap* bitmap = nullptr;
+        hCheck(target->CreateBitmap(
+            D2D1::SizeU(image.width, image.height),
+            image.pixels.data(), image.width * 4,
+            D2D1::BitmapProperties(D2D1::PixelFormat(
+                DXGI_FORMAT_B8G8R8A8_UNORM,
+                D2D1_ALPHA_MODE_PREMULTIPLIED)),
+            &bitmap));
+        memoryStats::allocated(memoryStats::Tag::DEVICE_BITMAPS, static_cast<size_t>(image.width) * image.height * 4);
+        return bitmap;
+    }
+
+    void releaseBitmap(ID2D1Bitmap*& bitmap) {
+        if (bitmap != nullptr) {
+            D2D1_SIZE_U size = bitmap->GetPixelSize();
+            memoryStats::freed(memoryStats::Tag::DEVICE_BITMAPS, static_cast<size_t>(size.width) * size.height * 4);
+        }
+        help::SafeRelease(bitmap);
+    }
+
+    template<typename T>
+    bool isReady(const std::future<T>& job) {
+        return job.valid() && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+} // namespace
+
+ScaledBitmap::~ScaledBitmap() {
+    releaseDeviceBitmaps();
+}
+
+void ScaledBitmap::setSource(Image source) {
+    // the jobs read the source and mip levels
+    if (m_mipsJob.valid()) { m_mipsJob.wait(); }
+    if (m_scaleJob.valid()) { m_scaleJob.wait(); }
+    m_mipsJob = {};
+    m_scaleJob = {};
+    releaseDeviceBitmaps();
+
+    m_source = std::move(source);
+    m_mips.clear();
+    m_mipsJob = std::async(std::launch::async, [this]() {
+        return imageScale::buildMips(m_source);
+    });
+}
+
+void ScaledBitmap::releaseDeviceBitmaps() {
+    releaseBitmap(m_sourceBitmap);
+    releaseBitmap(m_scaledBitmap);
+}
+
+ID2D1Bitmap* ScaledBitmap::get(ID2D1RenderTarget* target, UINT32 widthPx, UINT32 heightPx) {
+    m_wantedWidth = widthPx;
+    m_wantedHeight = heightPx;
+    update(target);
+
+    bool scaled = widthPx < m_source.width || heightPx < m_source.height;
+    if (scaled && m_scaledBitmap != nullptr) {
+        return m_scaledBitmap;
+    }
+
+    if (m_sourceBitmap == nullptr) {
+        m_sourceBitmap = createBitmap(target, m_source);
+    }
+    return m_sourceBitmap;
+}
+
+bool ScaledBitmap::update(ID2D1RenderTarget* target) {
+    if (isReady(m_mipsJob)) {
+        m_mips = m_mipsJob.get();
+    }
+
+    bool changed = false;
+    if (isReady(m_scaleJob)) {
+        // even if the size is already outdated it's closer than the previous one
+        Image image = m_scaleJob.get();
+        releaseBitmap(m_scaledBitmap);
+        m_scaledBitmap = createBitmap(target, image);
+        m_revision++;
+        changed = true;
+    }
+
+    // one size at a time, after a resize the next update starts the new size
+    bool scaled = m_wantedWidth < m_source.width || m_wantedHeight < m_source.height;
+    if (scaled && m_wantedWidth > 0 && m_wantedHeight > 0 && !m_mipsJob.valid() && !m_scaleJob.valid()) {
+        D2D1_SIZE_U size = m_scaledBitmap ? m_scaledBitmap->GetPixelSize() : D2D1::SizeU(0, 0);
+        if (size.width != m_wantedWidth || size.height != m_wantedHeight) {
+            UINT32 width = m_wantedWidth;
+            UINT32 height = m_wantedHeight;
+            m_scaleJob = std::async(std::launch::async, [this, width, height]() {
+                return imageScale::scaleTo(m_source, m_mips, width, height);
+            });
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,54 @@
+// Image drawn smaller than its source size. Downscaling the full size source with linear
+// interpolation on every draw aliases and costs the same every frame, so the image is kept with
+// pre-filtered mip levels and a copy resampled to the exact size it's drawn at. Both are made on
+// background threads, until the exact size is ready the previous one (or the source) is used.
+#pragma once
+
+#include <Windows.h>
+#include <d2d1.h>
+#include <chrono>
+#include <future>
+#include <vector>
+#include "imageScale.h"
+
+class ScaledBitmap {
+private:
+    imageScale::Image m_source;
+    std::vector<imageScale::Image> m_mips;
+
+    ID2D1Bitmap* m_sourceBitmap = nullptr;
+    ID2D1Bitmap* m_scaledBitmap = nullptr;
+
+    // size the bitmap was last asked for, only that size is made
+    UINT32 m_wantedWidth = 0;
+    UINT32 m_wantedHeight = 0;
+    UINT32 m_revision = 0;
+
+    // declared last, so running jobs are waited for before what they read is destroyed
+    std::future<std::vector<imageScale::Image>> m_mipsJob;
+    std::future<imageScale::Image> m_scaleJob;
+
+public:
+    ScaledBitmap() = default;
+    ~ScaledBitmap();
+
+    ScaledBitmap(const ScaledBitmap&) = delete;
+    ScaledBitmap& operator=(const ScaledBitmap&) = delete;
+
+    // Takes the decoded source pixels and starts building the mip levels
+    void setSource(imageScale::Image source);
+
+    // Device bitmaps are created lazily for the render target the bitmap is used with
+    void releaseDeviceBitmaps();
+
+    // Bitmap to draw into a widthPx x heightPx area. Only smaller sizes are scaled, for bigger ones
+    // the source is returned for the render target to scale up. Never waits for the background work.
+    ID2D1Bitmap* get(ID2D1RenderTarget* target, UINT32 widthPx, UINT32 heightPx);
+
+    // Installs finished background work. Returns true when that changed what get() returns,
+    // anything cached with the previous bitmap has to be redrawn.
+    bool update(ID2D1RenderTarget* target);
+
+    // changes every time update() installs a new bitmap
+    UINT32 revision() const { return m_revision; }
+};
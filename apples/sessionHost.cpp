@@ -0,0 +1,107 @@
+#include "sessionHost.h"
+
+#include <algorithm>
+#include <execution>
+#include "gameLogic.h"
+
+using sessionHost::Host;
+using sessionHost::Input;
+
+void Host::Session::tick(timeBase::Ns timeNs) {
+    {
+        std::lock_guard lock(inboxMutex);
+        if (applied == applying.size()) {
+            applying.clear();
+            applied = 0;
+            std::swap(applying, inbox);
+        }
+    }
+
+    // up to the first key change, pollAllKeys wouldn't see a press released in the same tick and
+    // a release has to happen where the mouse was then
+    while (applied < applying.size()) {
+        const Input& input = applying[applied++];
+        switch (input.type) {
+        case Input::Type::MOUSE_MOVE:
+            controller->setMousePos(input.x, input.y);
+            break;
+        case Input::Type::KEY_DOWN:
+        case Input::Type::KEY_UP:
+            controller->setKeyDown(input.key, input.type == Input::Type::KEY_DOWN);
+            break;
+        case Input::Type::WHEEL:
+            controller->addWheelDelta(input.x);
+            break;
+        case Input::Type::WINDOW_SIZE:
+            controller->setWindowSize(input.x, input.y);
+            break;
+        }
+        if (input.type == Input::Type::KEY_DOWN || input.type == Input::Type::KEY_UP) { break; }
+    }
+
+    controller->pollAllKeys(false);
+    ended = gameLogic::processFrame(*controller, state, timeNs);
+}
+
+Host::Host(UINT64 seed) : m_seeds(seed) {}
+
+Host::~Host() {
+    for (const std::unique_ptr<Session>& session : m_sessions) {
+        if (session->open) { gameLogic::stop(session->state); }
+    }
+}
+
+sessionHost::SessionId Host::open(timeBase::Ns timeNs) {
+    SessionId id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = static_cast<SessionId>(m_sessions.size());
+        m_sessions.push_back(std::make_unique<Session>());
+    }
+
+    Session& session = *m_sessions[id];
+    gameLogic::init(timeNs, session.state, nullptr, false);
+    session.state.sessionRng = m_seeds.split(m_opened++);
+    session.state.nextSeed = session.state.sessionRng.next();
+    session.controller.emplace();
+    session.controller->setWindowSize(1920, 1080);
+    session.open = true;
+    session.ended = false;
+    {
+        std::lock_guard lock(session.inboxMutex);
+        session.inbox.clear();
+        session.applying.clear();
+        session.applied = 0;
+    }
+    m_tickedStale = true;
+    return id;
+}
+
+void Host::close(SessionId id) {
+    Session& session = *m_sessions[id];
+    gameLogic::stop(session.state);
+    session.open = false;
+    m_free.push_back(id);
+    m_tickedStale = true;
+}
+
+void Host::submit(SessionId id, const Input* inputs, size_t count) {
+    Session& session = *m_sessions[id];
+    std::lock_guard lock(session.inboxMutex);
+    session.inbox.insert(session.inbox.end(), inputs, inputs + count);
+}
+
+void Host::tick(timeBase::Ns timeNs) {
+    if (m_tickedStale) {
+        m_ticked.clear();
+        for (const std::unique_ptr<Session>& session : m_sessions) {
+            if (session->open) { m_ticked.push_back(session.get()); }
+        }
+        m_tickedStale = false;
+    }
+    std::for_each(std::execution::par, m_ticked.begin(), m_ticked.end(), [timeNs](Session* session) {
+        if (!session->ended) { session->tick(timeNs); }
+    });
+}
@@ -0,0 +1,81 @@
+// Many independent games in one process, for a server running the games of its clients. Each
+// session has its own GameState (with its board seed stream and timer) and Controller. Input
+// arrives in batches from any thread and is applied at the start of the session's next tick. A
+// tick advances every session, spread over the cores by the parallel algorithms' work stealing
+// scheduler (TBB under libstdc++). Closed sessions are kept and reused by the next open, with the
+// board memory they grew. Doesn't depend on any platform headers.
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "controller.h"
+#include "gameState.h"
+#include "rng.h"
+#include "timeBase.h"
+
+namespace sessionHost {
+    struct Input {
+        enum class Type : UINT8 {
+            MOUSE_MOVE,  // to x, y in window pixels
+            KEY_DOWN,    // key
+            KEY_UP,      // key
+            WHEEL,       // by x, in WHEEL_DELTA units
+            WINDOW_SIZE, // x by y pixels
+        };
+        Type type;
+        UINT8 key;
+        INT x;
+        INT y;
+    };
+
+    using SessionId = UINT32;
+
+    class Host {
+    private:
+        struct Session {
+            std::optional<Controller> controller; // new for every open
+            gamestate::GameState state;
+            bool open = false;
+            bool ended = false; // the game quit (escape in the title menu), it's no longer ticked
+
+            std::mutex inboxMutex;
+            std::vector<Input> inbox;
+            std::vector<Input> applying; // swapped with inbox by the tick, so neither reallocates
+            size_t applied = 0;          // inputs of applying already applied
+
+            void tick(timeBase::Ns timeNs);
+        };
+
+        rng::Stream m_seeds;
+        UINT64 m_opened = 0;
+        std::vector<std::unique_ptr<Session>> m_sessions; // by id
+        std::vector<SessionId> m_free;
+        std::vector<Session*> m_ticked; // open sessions, rebuilt after an open or close
+        bool m_tickedStale = false;
+
+    public:
+        // Boards of the sessions are drawn from streams split off seed, one per open
+        explicit Host(UINT64 seed);
+        ~Host();
+
+        Host(const Host&) = delete;
+        Host& operator=(const Host&) = delete;
+
+        // A new game in its title menu, in a 1920x1080 window until told otherwise
+        SessionId open(timeBase::Ns timeNs);
+        void close(SessionId id);
+
+        // Any thread. Inputs are applied in order, each tick up to and including the next key press
+        // or release, so a click sent in one batch takes two ticks like it does in a window.
+        void submit(SessionId id, const Input* inputs, size_t count);
+
+        // Frame of every open session at timeNs. Not concurrently with open, close or state.
+        void tick(timeBase::Ns timeNs);
+
+        const gamestate::GameState& state(SessionId id) const { return m_sessions[id]->state; }
+        bool ended(SessionId id) const { return m_sessions[id]->ended; }
+        size_t sessionCount() const { return m_sessions.size() - m_free.size(); }
+    };
+} // namespace sessionHost
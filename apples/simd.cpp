@@ -0,0 +1,230 @@
+#include "simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET(isa) // MSVC takes intrinsics of any instruction set without flags
+#else
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+using simd::Bounds;
+using simd::Level;
+using simd::PointLayout;
+
+namespace {
+    Level detectLevel() {
+#if SIMD_X86 && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        if (!(info[3] & (1 << 26))) { return Level::SCALAR; }
+        // AVX needs the OS to save ymm registers (and zmm ones for AVX-512)
+        bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+        if (!osAvx || maxLeaf < 7) { return Level::SSE2; }
+        unsigned long long xcr0 = _xgetbv(0);
+        if ((xcr0 & 0x6) != 0x6) { return Level::SSE2; }
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6) { return Level::AVX512; }
+        return (info[1] & (1 << 5)) ? Level::AVX2 : Level::SSE2;
+#elif SIMD_X86
+        // checks OS support as well
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) { return Level::AVX512; }
+        if (__builtin_cpu_supports("avx2")) { return Level::AVX2; }
+        if (__builtin_cpu_supports("sse2")) { return Level::SSE2; }
+        return Level::SCALAR;
+#else
+        return Level::SCALAR;
+#endif
+    }
+
+    Level currentLevel = simd::supportedLevel();
+
+    int32_t load32(const std::byte* p) {
+        int32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // all variants finish the records that don't fill a whole vector with this
+    void selectScalar(const std::byte* records, size_t begin, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected) {
+        for (size_t i = begin; i < count; i++) {
+            const std::byte* record = records + i * layout.stride;
+            if ((load32(record + layout.skipOffset) & 0xff) != 0) { continue; }
+
+            float x = static_cast<float>(load32(record + layout.xOffset)) * layout.unit;
+            float y = static_cast<float>(load32(record + layout.yOffset)) * layout.unit;
+            if (x + bounds.margin >= bounds.left && x - bounds.margin <= bounds.right &&
+                y + bounds.margin >= bounds.top && y - bounds.margin <= bounds.bottom) {
+                selected[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+    }
+
+#if SIMD_X86
+    // lambdas don't take the target of the function they are in, so lane loads are functions of their own
+
+    // no gather before AVX2, lanes are loaded one by one
+    SIMD_TARGET("sse2")
+    __m128i lanes4(const std::byte* p, size_t stride) {
+        return _mm_setr_epi32(load32(p), load32(p + stride), load32(p + 2 * stride), load32(p + 3 * stride));
+    }
+
+    SIMD_TARGET("sse2")
+    size_t selectSse2(const std::byte* records, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected) {
+        const __m128 unit = _mm_set1_ps(layout.unit);
+        const __m128 margin = _mm_set1_ps(bounds.margin);
+        const __m128 left = _mm_set1_ps(bounds.left);
+        const __m128 top = _mm_set1_ps(bounds.top);
+        const __m128 right = _mm_set1_ps(bounds.right);
+        const __m128 bottom = _mm_set1_ps(bounds.bottom);
+        const __m128i byteMask = _mm_set1_epi32(0xff);
+        const size_t stride = layout.stride;
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const std::byte* p = records + i * stride;
+            __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(lanes4(p + layout.xOffset, stride)), unit);
+            __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(lanes4(p + layout.yOffset, stride)), unit);
+            __m128i skip = _mm_and_si128(lanes4(p + layout.skipOffset, stride), byteMask);
+
+            __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(x, margin), left), _mm_cmple_ps(_mm_sub_ps(x, margin), right)),
+                _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(y, margin), top), _mm_cmple_ps(_mm_sub_ps(y, margin), bottom)));
+            inside = _mm_and_ps(inside, _mm_castsi128_ps(_mm_cmpeq_epi32(skip, _mm_setzero_si128())));
+            selected[i / 64] |= static_cast<uint64_t>(_mm_movemask_ps(inside)) << (i % 64);
+        }
+        return i;
+    }
+
+    SIMD_TARGET("avx2")
+    __m256i lanes8(const std::byte* p, __m256i index) {
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(p), index, 1);
+    }
+
+    SIMD_TARGET("avx2")
+    size_t selectAvx2(const std::byte* records, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected) {
+        const __m256 unit = _mm256_set1_ps(layout.unit);
+        const __m256 margin = _mm256_set1_ps(bounds.margin);
+        const __m256 left = _mm256_set1_ps(bounds.left);
+        const __m256 top = _mm256_set1_ps(bounds.top);
+        const __m256 right = _mm256_set1_ps(bounds.right);
+        const __m256 bottom = _mm256_set1_ps(bounds.bottom);
+        const __m256i byteMask = _mm256_set1_epi32(0xff);
+        const __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32(static_cast<int>(layout.stride)));
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const std::byte* p = records + i * layout.stride;
+            __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(lanes8(p + layout.xOffset, index)), unit);
+            __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(lanes8(p + layout.yOffset, index)), unit);
+            __m256i skip = _mm256_and_si256(lanes8(p + layout.skipOffset, index), byteMask);
+
+            __m256 inside = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(x, margin), left, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_sub_ps(x, margin), right, _CMP_LE_OQ)),
+                _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(y, margin), top, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_sub_ps(y, margin), bottom, _CMP_LE_OQ)));
+            inside = _mm256_and_ps(inside, _mm256_castsi256_ps(_mm256_cmpeq_epi32(skip, _mm256_setzero_si256())));
+            selected[i / 64] |= static_cast<uint64_t>(_mm256_movemask_ps(inside)) << (i % 64);
+        }
+        return i;
+    }
+
+    // Masked gather and conversion with all lanes set: GCC implements the plain ones on an undefined
+    // register and warns it may be used uninitialized
+    SIMD_TARGET("avx512f")
+    __m512i lanes16(const std::byte* p, __m512i index) {
+        return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, p, 1);
+    }
+
+    SIMD_TARGET("avx512f")
+    __m512 floats16(const std::byte* p, __m512i index) {
+        return _mm512_maskz_cvtepi32_ps(0xFFFF, lanes16(p, index));
+    }
+
+    SIMD_TARGET("avx512f")
+    size_t selectAvx512(const std::byte* records, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected) {
+        const __m512 unit = _mm512_set1_ps(layout.unit);
+        const __m512 margin = _mm512_set1_ps(bounds.margin);
+        const __m512 left = _mm512_set1_ps(bounds.left);
+        const __m512 top = _mm512_set1_ps(bounds.top);
+        const __m512 right = _mm512_set1_ps(bounds.right);
+        const __m512 bottom = _mm512_set1_ps(bounds.bottom);
+        const __m512i byteMask = _mm512_set1_epi32(0xff);
+        const __m512i index = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm512_set1_epi32(static_cast<int>(layout.stride)));
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const std::byte* p = records + i * layout.stride;
+            __m512 x = _mm512_mul_ps(floats16(p + layout.xOffset, index), unit);
+            __m512 y = _mm512_mul_ps(floats16(p + layout.yOffset, index), unit);
+
+            __mmask16 inside =
+                _mm512_cmp_ps_mask(_mm512_add_ps(x, margin), left, _CMP_GE_OQ) &
+                _mm512_cmp_ps_mask(_mm512_sub_ps(x, margin), right, _CMP_LE_OQ) &
+                _mm512_cmp_ps_mask(_mm512_add_ps(y, margin), top, _CMP_GE_OQ) &
+                _mm512_cmp_ps_mask(_mm512_sub_ps(y, margin), bottom, _CMP_LE_OQ);
+            inside &= _mm512_testn_epi32_mask(lanes16(p + layout.skipOffset, index), byteMask);
+            selected[i / 64] |= static_cast<uint64_t>(inside) << (i % 64);
+        }
+        return i;
+    }
+#endif
+} // namespace
+
+Level simd::supportedLevel() {
+    static const Level supported = detectLevel();
+    return supported;
+}
+
+Level simd::level() {
+    return currentLevel;
+}
+
+void simd::setLevel(Level level) {
+    currentLevel = std::min(level, supportedLevel());
+}
+
+const char* simd::levelName(Level level) {
+    switch (level) {
+    case Level::SCALAR: return "scalar";
+    case Level::SSE2: return "SSE2";
+    case Level::AVX2: return "AVX2";
+    case Level::AVX512: return "AVX-512";
+    default: return "?";
+    }
+}
+
+void simd::selectInBounds(const void* records, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected) {
+    const std::byte* bytes = static_cast<const std::byte*>(records);
+    std::fill(selected, selected + (count + 63) / 64, uint64_t(0));
+
+    size_t done = 0;
+    switch (currentLevel) {
+#if SIMD_X86
+    case Level::AVX512:
+        done = selectAvx512(bytes, count, layout, bounds, selected);
+        break;
+    case Level::AVX2:
+        done = selectAvx2(bytes, count, layout, bounds, selected);
+        break;
+    case Level::SSE2:
+        done = selectSse2(bytes, count, layout, bounds, selected);
+        break;
+#endif
+    default:
+        break;
+    }
+    selectScalar(bytes, done, count, layout, bounds, selected);
+}
@@ -0,0 +1,47 @@
+// Vectorized kernels for scans over board cells, with SSE2, AVX2 and AVX-512 variants picked at
+// startup by what the CPU supports, so one binary runs as fast as it can on old and new machines.
+// Every variant gives the same results as the scalar one (the same float operations in the same
+// order, lane by lane). Doesn't depend on any platform headers, records are described by their
+// layout instead, so the kernels can be built, compared and benchmarked anywhere.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace simd {
+    enum class Level {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512, // F
+        COUNT
+    };
+
+    // best the CPU and OS support, detected once
+    Level supportedLevel();
+    // level the kernels run at, supportedLevel() unless lowered
+    Level level();
+    // Lowers (or restores) the level for comparing results and benchmarking, capped at supportedLevel()
+    void setLevel(Level level);
+    const char* levelName(Level level);
+
+    // Records with int32 fixed point x and y positions, x * unit being the position
+    struct PointLayout {
+        size_t stride;
+        size_t xOffset;
+        size_t yOffset;
+        size_t skipOffset; // byte that excludes the record when not zero, 4 bytes from it must lie in the record
+        float unit;
+    };
+
+    // Inclusive, with margin added around each point
+    struct Bounds {
+        float left, top, right, bottom;
+        float margin;
+    };
+
+    // Sets bit i % 64 of selected[i / 64] for each of count records that isn't skipped and has
+    // x * unit + margin >= left && x * unit - margin <= right (y likewise), clears the rest.
+    // selected has to have room for (count + 63) / 64 words.
+    void selectInBounds(const void* records, size_t count, const PointLayout& layout, const Bounds& bounds, uint64_t* selected);
+} // namespace simd
@@ -0,0 +1,54 @@
+#include "slowFrames.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using slowFrames::Frame;
+
+namespace {
+    // min-heap on logicUs, the fastest kept frame is the one replaced
+    Frame kept[slowFrames::KEPT_FRAMES];
+    int keptCount = 0;
+
+    bool slower(const Frame& a, const Frame& b) {
+        return a.logicUs > b.logicUs;
+    }
+} // namespace
+
+void slowFrames::record(const Frame& frame) {
+    if (keptCount < KEPT_FRAMES) {
+        kept[keptCount++] = frame;
+        std::push_heap(kept, kept + keptCount, slower);
+        return;
+    }
+    if (frame.logicUs <= kept[0].logicUs) { return; }
+
+    std::pop_heap(kept, kept + keptCount, slower);
+    kept[keptCount - 1] = frame;
+    std::push_heap(kept, kept + keptCount, slower);
+}
+
+std::vector<Frame> slowFrames::worst() {
+    std::vector<Frame> frames(kept, kept + keptCount);
+    std::sort(frames.begin(), frames.end(), slower);
+    return frames;
+}
+
+void slowFrames::reset() {
+    keptCount = 0;
+}
+
+std::string slowFrames::formatReport() {
+    std::string report = "slowest logic frames [ms]  at [s]  mode players   apples   seed             rev  drag falling  mouse\n";
+
+    char line[192];
+    for (const Frame& f : worst()) {
+        std::snprintf(line, sizeof(line), "%26.2f %7.1f %5u %7u %8u   %016llx %5u %4u %7u  %.0f,%.0f%s\n",
+            f.logicUs / 1000.0, f.timeUs / 1e6, f.mode, f.playerCount, f.appleCount,
+            static_cast<unsigned long long>(f.boardSeed), f.boardRevision,
+            f.inDrag ? f.draggedApples : 0, f.fallingApples,
+            f.mouseX, f.mouseY, f.mouseDown ? " down" : "");
+        report += line;
+    }
+    return report;
+}
@@ -0,0 +1,38 @@
+// Worst game logic frames of a session: the frame loop times every processFrame and passes what the
+// frame started from (mode, board, drag, falling apples) and its mouse input. The slowest few are
+// kept with that context, so outliers from input nobody thought to try show up in real play with
+// the board seed and input that caused them. Doesn't depend on any platform headers.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace slowFrames {
+    struct Frame {
+        uint64_t logicUs;       // processFrame time
+        uint64_t timeUs;        // when the frame started, since the session started
+        uint64_t boardSeed;     // of the first player, 0 outside of a game
+        uint32_t boardRevision;
+        uint32_t appleCount;    // board size
+        uint32_t draggedApples;
+        uint32_t fallingApples;
+        float mouseX;           // logical
+        float mouseY;
+        uint8_t mode;           // GameState::Mode
+        uint8_t playerCount;
+        bool mouseDown;
+        bool inDrag;
+    };
+
+    const int KEPT_FRAMES = 16;
+
+    // Frame thread only. Allocation free; a frame faster than all kept ones costs one comparison.
+    void record(const Frame& frame);
+    // kept frames, slowest first
+    std::vector<Frame> worst();
+    void reset();
+
+    // Human readable table of the kept frames
+    std::string formatReport();
+} // namespace slowFrames
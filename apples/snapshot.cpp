@@ -0,0 +1,530 @@
+#include "snapshot.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include "gameLogic.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using gamestate::Apple;
+using gamestate::CellXY;
+using gamestate::GameState;
+
+namespace {
+    // Layout (little endian, all records 4 byte aligned):
+    //   Header | StateRecord | AppleRecord[appleCountX * appleCountY] (row major) | CellXY[fallingCount]
+    // Board records are present only while a board exists (mode PLAYING).
+    const UINT32 MAGIC = 0x534C5041; // "APLS"
+    const UINT32 VERSION = 5;
+
+    struct Header {
+        UINT32 magic;
+        UINT32 version;
+        UINT64 size;     // whole snapshot including the header
+        UINT64 checksum; // FNV-1a of everything after the header
+    };
+
+    struct StateRecord {
+        INT32 mode;
+        INT32 appleCountX;
+        INT32 appleCountY;
+        INT32 playTime;
+        INT32 hugeBoard;
+        INT32 highScore;
+        FLOAT appleSize;
+
+        INT32 hasBoard;
+        INT32 timesOver;
+        INT32 score;
+        UINT64 elapsedNs; // game time passed, the start time is rebased on restore
+        UINT32 boardRevision;
+        INT32 fallingCount;
+        FLOAT appleMinX;
+        FLOAT appleMinY;
+        FLOAT viewZoom;
+        FLOAT viewCenterX;
+        FLOAT viewCenterY;
+        INT32 ruleVariant;
+        UINT64 boardSeed;
+    };
+
+    struct AppleRecord {
+        UINT8 value;
+        UINT8 popped;
+        UINT16 reserved;
+        INT32 fixedX; // Apple's fixed point physics state
+        INT32 fixedY;
+        INT32 fixedAngle;
+        INT32 velX;
+        INT32 velY;
+        INT32 accY;
+        INT32 velAngular;
+    };
+
+    static_assert(sizeof(Header) == 24);
+    static_assert(sizeof(StateRecord) == 88);
+    static_assert(sizeof(AppleRecord) == 32);
+    static_assert(sizeof(CellXY) == 8);
+
+    UINT64 fnv1a(const BYTE* data, size_t size) {
+        UINT64 hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool hasBoard(const GameState& gameState) {
+        // versus boards are not saved, such a session is restored to the main menu
+        return gameState.mode == GameState::Mode::PLAYING && gameState.playerCount == 1 &&
+            !gameState.players[0].apples.empty();
+    }
+} // namespace
+
+size_t snapshot::serializedSize(const GameState& gameState) {
+    size_t size = sizeof(Header) + sizeof(StateRecord);
+    if (hasBoard(gameState)) {
+        size += sizeof(AppleRecord) * gameState.players[0].apples.sizeX() * gameState.players[0].apples.sizeY();
+        size += sizeof(CellXY) * gameState.players[0].fallingApples.size();
+    }
+    return size;
+}
+
+size_t snapshot::serialize(const GameState& gameState, timeBase::Ns timeNs, BYTE* out) {
+    const GameState::SingletonPlay& play = gameState.players[0];
+    bool board = hasBoard(gameState);
+    size_t size = serializedSize(gameState);
+
+    Header header = {
+        .magic = MAGIC,
+        .version = VERSION,
+        .size = size,
+        .checksum = 0,
+    };
+    std::memcpy(out, &header, sizeof(header));
+
+    StateRecord state = {
+        .mode = static_cast<INT32>(board || gameState.mode != GameState::Mode::PLAYING ?
+            gameState.mode : GameState::Mode::MAIN_MENU),
+        .appleCountX = gameState.appleCountX,
+        .appleCountY = gameState.appleCountY,
+        .playTime = gameState.playTime,
+        .hugeBoard = gameState.hugeBoard,
+        .highScore = gameState.highScore,
+        .appleSize = gameState.appleSize,
+        .ruleVariant = static_cast<INT32>(gameState.ruleVariant),
+    };
+    if (board) {
+        state.hasBoard = 1;
+        state.timesOver = play.timesOver;
+        state.score = play.score;
+        state.elapsedNs = timeNs > play.startTimeNs ? timeNs - play.startTimeNs : 0;
+        state.boardRevision = play.boardRevision;
+        state.fallingCount = static_cast<INT32>(play.fallingApples.size());
+        state.appleMinX = play.appleMinX;
+        state.appleMinY = play.appleMinY;
+        state.viewZoom = play.viewZoom;
+        state.viewCenterX = play.viewCenterX;
+        state.viewCenterY = play.viewCenterY;
+        state.boardSeed = play.boardSeed;
+    }
+    BYTE* p = out + sizeof(Header);
+    std::memcpy(p, &state, sizeof(state));
+    p += sizeof(state);
+
+    if (board) {
+        INT sizeX = play.apples.sizeX();
+        BYTE* apples = p;
+        play.apples.forEach([apples, sizeX](const Apple& apple, INT x, INT y) {
+            AppleRecord record = {
+                .value = static_cast<UINT8>(apple.value),
+                .popped = apple.popped,
+                .reserved = 0,
+                .fixedX = apple.fixedX,
+                .fixedY = apple.fixedY,
+                .fixedAngle = apple.fixedAngle,
+                .velX = apple.velX,
+                .velY = apple.velY,
+                .accY = apple.accY,
+                .velAngular = apple.velAngular,
+            };
+            std::memcpy(apples + sizeof(AppleRecord) * (static_cast<size_t>(y) * sizeX + x), &record, sizeof(record));
+        });
+        p += sizeof(AppleRecord) * play.apples.sizeX() * play.apples.sizeY();
+
+        if (!play.fallingApples.empty()) {
+            std::memcpy(p, play.fallingApples.data(), sizeof(CellXY) * play.fallingApples.size());
+            p += sizeof(CellXY) * play.fallingApples.size();
+        }
+    }
+    return static_cast<size_t>(p - out);
+}
+
+void snapshot::seal(BYTE* data, size_t size) {
+    if (size < sizeof(Header)) { return; }
+    UINT64 checksum = fnv1a(data + sizeof(Header), size - sizeof(Header));
+    std::memcpy(data + offsetof(Header, checksum), &checksum, sizeof(checksum));
+}
+
+bool snapshot::deserialize(const BYTE* data, size_t size, GameState& gameState, timeBase::Ns timeNs) {
+    if (size < sizeof(Header) + sizeof(StateRecord)) { return false; }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION || header.size != size) { return false; }
+    if (header.checksum != fnv1a(data + sizeof(Header), size - sizeof(Header))) { return false; }
+
+    StateRecord state;
+    std::memcpy(&state, data + sizeof(Header), sizeof(state));
+    if (state.mode < 0 || state.mode > static_cast<INT32>(GameState::Mode::PLAYING)) { return false; }
+    if (state.ruleVariant < 0 || state.ruleVariant >= static_cast<INT32>(rules::Variant::COUNT)) { return false; }
+
+    INT maxX = state.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_X;
+    INT maxY = state.hugeBoard ? gamestate::HUGE_MAX_APPLES : gamestate::MAX_APPLES_Y;
+    if (state.appleCountX < gamestate::MIN_APPLES || state.appleCountX > maxX ||
+        state.appleCountY < gamestate::MIN_APPLES || state.appleCountY > maxY) {
+        return false;
+    }
+
+    if (state.playTime < gamestate::MIN_PLAY_TIME_SECONDS || state.playTime > gamestate::MAX_PLAY_TIME_SECONDS) { return false; }
+
+    bool board = state.hasBoard != 0;
+    if (board != (state.mode == static_cast<INT32>(GameState::Mode::PLAYING))) { return false; }
+
+    // the board's layout and view, comparisons written so NaN fails them
+    if (board) {
+        const D2D1_RECT_F& area = gamestate::APPLES_PLAY_AREA;
+        FLOAT maxAppleSize = (area.bottom - area.top) / gamestate::MIN_APPLES;
+        FLOAT maxZoom = max(1.0f, gamestate::MAX_VIEW_APPLE_SIZE / state.appleSize);
+        bool inside = state.appleSize > 0.0f && state.appleSize <= maxAppleSize &&
+            state.appleMinX >= area.left - maxAppleSize && state.appleMinX <= area.right &&
+            state.appleMinY >= area.top - maxAppleSize && state.appleMinY <= area.bottom &&
+            state.viewZoom > 0.0f && state.viewZoom <= maxZoom &&
+            state.viewCenterX >= area.left && state.viewCenterX <= area.right &&
+            state.viewCenterY >= area.top && state.viewCenterY <= area.bottom;
+        if (!inside) { return false; }
+    }
+
+    size_t appleCount = static_cast<size_t>(state.appleCountX) * state.appleCountY;
+    size_t expected = sizeof(Header) + sizeof(StateRecord);
+    if (board) {
+        if (state.fallingCount < 0 || static_cast<size_t>(state.fallingCount) > appleCount) { return false; }
+        expected += sizeof(AppleRecord) * appleCount + sizeof(CellXY) * state.fallingCount;
+    }
+    if (size != expected) { return false; }
+
+    const BYTE* apples = data + sizeof(Header) + sizeof(StateRecord);
+    const BYTE* falling = apples + sizeof(AppleRecord) * appleCount;
+    for (INT32 i = 0; board && i < state.fallingCount; i++) {
+        CellXY cell;
+        std::memcpy(&cell, falling + sizeof(CellXY) * i, sizeof(cell));
+        if (cell.x < 0 || cell.x >= state.appleCountX || cell.y < 0 || cell.y >= state.appleCountY) { return false; }
+    }
+
+    // valid, only now start modifying the state
+    gameState.mode = static_cast<GameState::Mode>(state.mode);
+    gameState.appleCountX = state.appleCountX;
+    gameState.appleCountY = state.appleCountY;
+    gameState.playTime = state.playTime;
+    gameState.hugeBoard = state.hugeBoard != 0;
+    gameState.ruleVariant = static_cast<rules::Variant>(state.ruleVariant);
+    gameState.highScore = state.highScore;
+
+    gameState.playerCount = 1;
+    GameState::SingletonPlay& play = gameState.players[0];
+    play.area = gamestate::APPLES_PLAY_AREA;
+    play.apples.clear();
+    play.fallingApples.clear();
+    play.poppedApples.clear();
+    play.draggedApples.clear();
+    play.inDrag = false;
+    play.inPan = false;
+    // without a board the apple size is a leftover of some earlier game, if any
+    if (!board) { return true; }
+
+    gameState.appleSize = state.appleSize;
+
+    play.timesOver = state.timesOver;
+    play.score = state.score;
+    play.startTimeNs = timeNs > state.elapsedNs ? timeNs - state.elapsedNs : 0;
+    play.boardRevision = state.boardRevision + 1; // anything cached for the old revision is stale
+    play.appleMinX = state.appleMinX;
+    play.appleMinY = state.appleMinY;
+    play.viewZoom = state.viewZoom;
+    play.viewCenterX = state.viewCenterX;
+    play.viewCenterY = state.viewCenterY;
+    play.boardSeed = state.boardSeed;
+
+    play.apples.generateParallel(state.appleCountX, state.appleCountY, [apples, &state](INT x, INT y) {
+        AppleRecord record;
+        std::memcpy(&record, apples + sizeof(AppleRecord) * (static_cast<size_t>(y) * state.appleCountX + x), sizeof(record));
+
+        Apple apple(record.value, 0.0f, 0.0f, rng::Stream());
+        apple.popped = record.popped != 0;
+        apple.fixedX = record.fixedX;
+        apple.fixedY = record.fixedY;
+        apple.fixedAngle = record.fixedAngle;
+        apple.velX = record.velX;
+        apple.velY = record.velY;
+        apple.accY = record.accY;
+        apple.velAngular = record.velAngular;
+        return apple;
+    });
+
+    play.fallingApples.resize(state.fallingCount);
+    if (state.fallingCount > 0) {
+        std::memcpy(play.fallingApples.data(), falling, sizeof(CellXY) * state.fallingCount);
+    }
+    // the order they popped in isn't saved, that of the board will do
+    play.apples.forEach([&play](const Apple& apple, INT x, INT y) {
+        if (apple.popped) { play.poppedApples.push_back({ x, y }); }
+    });
+    return true;
+}
+
+bool snapshot::loadFile(const std::filesystem::path& path, GameState& gameState, timeBase::Ns timeNs) {
+    bool restored = false;
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            const BYTE* view = static_cast<const BYTE*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (view != nullptr) {
+                restored = deserialize(view, static_cast<size_t>(fileSize.QuadPart), gameState, timeNs);
+                UnmapViewOfFile(view);
+            }
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            restored = deserialize(static_cast<const BYTE*>(view), static_cast<size_t>(st.st_size), gameState, timeNs);
+            munmap(view, static_cast<size_t>(st.st_size));
+        }
+    }
+    ::close(fd);
+#endif
+    return restored;
+}
+
+bool snapshot::writeFile(const std::filesystem::path& path, const BYTE* data, size_t size) {
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+#ifdef _WIN32
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    bool written = true;
+    while (written && size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD done = 0;
+        written = WriteFile(file, data, chunk, &done, nullptr) && done == chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    written = written && FlushFileBuffers(file);
+    CloseHandle(file);
+
+    // replacing only after the data is on disk, a power loss leaves either the old or the new snapshot
+    return written && MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { return false; }
+
+    bool written = true;
+    while (written && size > 0) {
+        ssize_t done = ::write(fd, data, size);
+        written = done > 0;
+        if (written) {
+            data += done;
+            size -= static_cast<size_t>(done);
+        }
+    }
+    written = written && fsync(fd) == 0;
+    ::close(fd);
+
+    // rename replaces atomically, a power loss leaves either the old or the new snapshot
+    return written && std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+
+snapshot::Checkpointer::Checkpointer(const std::filesystem::path& path)
+    : m_path(path), m_worker(&Checkpointer::workerLoop, this) {
+}
+
+snapshot::Checkpointer::~Checkpointer() {
+    // let the pending checkpoint finish, so the file on disk is the latest one
+    waitWritten();
+    m_state = STOPPING;
+    m_state.notify_all();
+    m_worker.join();
+}
+
+void snapshot::Checkpointer::workerLoop() {
+    for (;;) {
+        m_state.wait(IDLE);
+        int state = m_state.load();
+        if (state == STOPPING) { return; }
+        if (state != PENDING) { continue; }
+
+        write();
+
+        m_state = IDLE;
+        m_state.notify_all();
+    }
+}
+
+void snapshot::Checkpointer::capture(const GameState& gameState, timeBase::Ns timeNs) {
+    const GameState::SingletonPlay& play = gameState.players[0];
+    Capture& capture = m_capture;
+    capture.mode = gameState.mode;
+    capture.appleCountX = gameState.appleCountX;
+    capture.appleCountY = gameState.appleCountY;
+    capture.playTime = gameState.playTime;
+    capture.hugeBoard = gameState.hugeBoard;
+    capture.ruleVariant = gameState.ruleVariant;
+    capture.highScore = gameState.highScore;
+    capture.appleSize = gameState.appleSize;
+    capture.playerCount = gameState.playerCount;
+    capture.timeNs = timeNs;
+    capture.changed.clear();
+    capture.falling.clear();
+
+    capture.hasBoard = hasBoard(gameState);
+    if (!capture.hasBoard) {
+        m_board.reset();
+        return;
+    }
+    capture.timesOver = play.timesOver;
+    capture.score = play.score;
+    capture.startTimeNs = play.startTimeNs;
+    capture.boardSeed = play.boardSeed;
+    capture.boardRevision = play.boardRevision;
+    capture.appleMinX = play.appleMinX;
+    capture.appleMinY = play.appleMinY;
+    capture.viewZoom = play.viewZoom;
+    capture.viewCenterX = play.viewCenterX;
+    capture.viewCenterY = play.viewCenterY;
+
+    // a new game, even on the same board (e.g. the daily one), starts from the generated board
+    capture.newBoard = !m_board || m_board->boardSeed != play.boardSeed || m_board->startTimeNs != play.startTimeNs ||
+        m_board->width != play.apples.sizeX() || m_board->height != play.apples.sizeY();
+    if (capture.newBoard) {
+        m_board = CapturedBoard{
+            .boardSeed = play.boardSeed,
+            .startTimeNs = play.startTimeNs,
+            .width = play.apples.sizeX(),
+            .height = play.apples.sizeY(),
+            .poppedCount = 0,
+        };
+        m_lastFalling.clear();
+    }
+
+    // Only popped apples change. Those popped before the last checkpoint that were still falling
+    // then have moved since, apples popped since are either falling or have fallen already.
+    for (gamestate::CellXY cell : m_lastFalling) {
+        capture.changed.emplace_back(cell, play.apples.at(cell));
+    }
+    for (size_t i = m_board->poppedCount; i < play.poppedApples.size(); i++) {
+        capture.changed.emplace_back(play.poppedApples[i], play.apples.at(play.poppedApples[i]));
+    }
+    m_board->poppedCount = play.poppedApples.size();
+    for (gamestate::CellXY cell : play.fallingApples) {
+        capture.changed.emplace_back(cell, play.apples.at(cell));
+        capture.falling.push_back(cell);
+    }
+    m_lastFalling.assign(play.fallingApples.begin(), play.fallingApples.end());
+}
+
+void snapshot::Checkpointer::write() {
+    const Capture& capture = m_capture;
+    GameState& copy = m_copy;
+    GameState::SingletonPlay& play = copy.players[0];
+    copy.mode = capture.mode;
+    copy.appleCountX = capture.appleCountX;
+    copy.appleCountY = capture.appleCountY;
+    copy.playTime = capture.playTime;
+    copy.hugeBoard = capture.hugeBoard;
+    copy.ruleVariant = capture.ruleVariant;
+    copy.highScore = capture.highScore;
+    copy.appleSize = capture.appleSize;
+    copy.playerCount = capture.playerCount;
+
+    if (capture.hasBoard) {
+        // apples that never popped are as generated, library boards included
+        if (capture.newBoard) {
+            gameLogic::generateBoard(copy, play, capture.boardSeed, nullptr);
+        }
+        for (const auto& [cell, apple] : capture.changed) {
+            play.apples.at(cell) = apple;
+        }
+        play.fallingApples.assign(capture.falling.begin(), capture.falling.end());
+        play.timesOver = capture.timesOver;
+        play.score = capture.score;
+        play.startTimeNs = capture.startTimeNs;
+        play.boardRevision = capture.boardRevision;
+        play.appleMinX = capture.appleMinX;
+        play.appleMinY = capture.appleMinY;
+        play.viewZoom = capture.viewZoom;
+        play.viewCenterX = capture.viewCenterX;
+        play.viewCenterY = capture.viewCenterY;
+    } else {
+        play.apples.clear();
+        play.fallingApples.clear();
+    }
+
+    size_t size = serializedSize(copy);
+    if (m_buffer.size() < size) {
+        m_buffer.resize(size);
+    }
+    size = serialize(copy, capture.timeNs, m_buffer.data());
+    seal(m_buffer.data(), size);
+    writeFile(m_path, m_buffer.data(), size);
+}
+
+bool snapshot::Checkpointer::tryCheckpoint(const GameState& gameState, timeBase::Ns timeNs) {
+    // the capture belongs to the worker until it's IDLE again
+    if (m_state.load() != IDLE) { return false; }
+
+    capture(gameState, timeNs);
+
+    m_state = PENDING;
+    m_state.notify_all();
+    return true;
+}
+
+void snapshot::Checkpointer::waitWritten() {
+    while (m_state.load() == PENDING) {
+        m_state.wait(PENDING);
+    }
+}
+
+void snapshot::Checkpointer::checkpointNow(const GameState& gameState, timeBase::Ns timeNs) {
+    waitWritten();
+
+    capture(gameState, timeNs);
+    write();
+}
@@ -0,0 +1,107 @@
+// Compact versioned binary snapshots of GameState (settings, menu and an in-progress board
+// including the timer and falling apples), used to resume the game after a restart or power loss
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "gameState.h"
+#include "platform.h"
+
+namespace snapshot {
+    // Number of bytes serialize() writes for the given state
+    size_t serializedSize(const gamestate::GameState& gameState);
+
+    // Writes the snapshot into out (at least serializedSize() bytes) without allocating.
+    // Checksum is left empty, seal() fills it in, so it can be done off the frame thread.
+    size_t serialize(const gamestate::GameState& gameState, timeBase::Ns timeNs, BYTE* out);
+    void seal(BYTE* data, size_t size);
+
+    // Restores state from a sealed snapshot, timer is resumed relative to timeNs. Returns false and
+    // leaves gameState untouched if the data is not a valid snapshot, or one with settings or a view
+    // the game can't be in (no play time, no apple size, a view off the board).
+    bool deserialize(const BYTE* data, size_t size, gamestate::GameState& gameState, timeBase::Ns timeNs);
+
+    // Memory maps the file and restores state from it
+    bool loadFile(const std::filesystem::path& path, gamestate::GameState& gameState, timeBase::Ns timeNs);
+    // Writes a sealed snapshot to a temporary file and replaces path with it, so there is always
+    // a complete snapshot on disk
+    bool writeFile(const std::filesystem::path& path, const BYTE* data, size_t size);
+
+    // Periodic checkpoints. The frame thread only hands over what changed since the last checkpoint
+    // (the game's settings and timer, apples popped since and the falling ones), the background
+    // thread keeps a copy of the board up to date with it, generating a new board from its seed,
+    // and serializes, checksums and writes the snapshot. A checkpoint costs the frame thread the
+    // same on a huge board as on a small one.
+    class Checkpointer {
+    private:
+        enum State { IDLE, PENDING, STOPPING };
+
+        // what the frame thread hands over
+        struct Capture {
+            gamestate::GameState::Mode mode;
+            INT appleCountX;
+            INT appleCountY;
+            INT playTime;
+            bool hugeBoard;
+            rules::Variant ruleVariant;
+            INT highScore;
+            FLOAT appleSize;
+            INT playerCount;
+            timeBase::Ns timeNs;
+
+            bool hasBoard;
+            bool newBoard; // generated again from boardSeed, before the changes apply
+            BOOL timesOver;
+            INT score;
+            timeBase::Ns startTimeNs;
+            UINT64 boardSeed;
+            UINT32 boardRevision;
+            FLOAT appleMinX;
+            FLOAT appleMinY;
+            FLOAT viewZoom;
+            FLOAT viewCenterX;
+            FLOAT viewCenterY;
+            std::vector<std::pair<gamestate::CellXY, gamestate::Apple>> changed;
+            std::vector<gamestate::CellXY> falling;
+        };
+
+        // board the worker's copy is of, frame thread only
+        struct CapturedBoard {
+            UINT64 boardSeed;
+            timeBase::Ns startTimeNs;
+            INT width;
+            INT height;
+            size_t poppedCount; // of poppedApples
+        };
+
+        std::filesystem::path m_path;
+        Capture m_capture;
+        std::optional<CapturedBoard> m_board;
+        std::vector<gamestate::CellXY> m_lastFalling; // falling at the last checkpoint
+        gamestate::GameState m_copy; // worker only, the game as of the last checkpoint
+        std::vector<BYTE> m_buffer;
+        std::atomic<int> m_state = IDLE;
+        std::thread m_worker;
+
+        void capture(const gamestate::GameState& gameState, timeBase::Ns timeNs);
+        // applies the capture to the copy and writes the snapshot
+        void write();
+        void workerLoop();
+
+    public:
+        Checkpointer(const std::filesystem::path& path);
+        ~Checkpointer();
+
+        // Never blocks. Returns false and skips the checkpoint if the previous one is still being written.
+        // Allocates only when more apples changed than at any checkpoint before.
+        bool tryCheckpoint(const gamestate::GameState& gameState, timeBase::Ns timeNs);
+        // Waits until the pending checkpoint, if any, is on disk
+        void waitWritten();
+        // Waits for the pending checkpoint and writes this one synchronously, e.g. on exit
+        void checkpointNow(const gamestate::GameState& gameState, timeBase::Ns timeNs);
+    };
+} // namespace snapshot
@@ -0,0 +1,126 @@
+#include "spectator.h"
+
+using gamestate::GameState;
+
+spectator::Broadcaster::Broadcaster(const std::wstring& pipeName) : m_pipeName(pipeName) {
+    // outbound only, a viewer has nothing to say
+    m_pipe = CreateNamedPipeW(m_pipeName.c_str(), PIPE_ACCESS_OUTBOUND,
+        PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 64 * 1024, 0, 0, nullptr);
+    if (m_pipe == INVALID_HANDLE_VALUE) { return; } // e.g. another instance broadcasts already
+
+    m_worker = std::thread(&Broadcaster::workerLoop, this);
+}
+
+spectator::Broadcaster::~Broadcaster() {
+    if (m_worker.joinable()) {
+        m_state = STOPPING;
+        m_state.notify_all();
+        if (m_connected) {
+            // a write to a viewer that doesn't read would never return
+            CancelSynchronousIo(m_worker.native_handle());
+        } else {
+            // the worker waits for a viewer, be one
+            HANDLE client = CreateFileW(m_pipeName.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            if (client != INVALID_HANDLE_VALUE) { CloseHandle(client); }
+        }
+        m_worker.join();
+    }
+    if (m_pipe != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_pipe);
+    }
+}
+
+void spectator::Broadcaster::workerLoop() {
+    for (;;) {
+        bool connected = ConnectNamedPipe(m_pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if (m_state.load() == STOPPING || !connected) { return; }
+        m_newViewer = true;
+        m_connected = true;
+
+        for (;;) {
+            m_state.wait(IDLE);
+            int state = m_state.load();
+            if (state == STOPPING) { return; }
+            if (state != PENDING) { continue; }
+
+            DWORD done = 0;
+            bool written = WriteFile(m_pipe, m_writing.data(), static_cast<DWORD>(m_writing.size()), &done, nullptr) &&
+                done == m_writing.size();
+            m_writing.clear();
+            m_state = IDLE;
+            m_state.notify_all();
+            if (!written) { break; }
+        }
+
+        // the viewer is gone, wait for the next one
+        m_connected = false;
+        DisconnectNamedPipe(m_pipe);
+    }
+}
+
+void spectator::Broadcaster::frame(const GameState& gameState) {
+    if (!m_connected) { return; }
+
+    if (m_newViewer.exchange(false)) {
+        m_pending.clear();
+        m_encoder.requestKeyframe();
+    }
+    m_encoder.encode(gameState, m_pending);
+
+    if (m_pending.size() > MAX_PENDING_BYTES) {
+        m_pending.clear();
+        m_encoder.requestKeyframe();
+        return;
+    }
+    if (m_state.load() != IDLE) { return; }
+
+    // m_writing was emptied by the worker, so swapping keeps both buffers allocated
+    m_writing.swap(m_pending);
+    m_state = PENDING;
+    m_state.notify_all();
+}
+
+spectator::Viewer::Viewer(const std::wstring& pipeName) : m_pipeName(pipeName) {}
+
+spectator::Viewer::~Viewer() {
+    disconnect();
+}
+
+void spectator::Viewer::disconnect() {
+    if (m_pipe != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_pipe);
+        m_pipe = INVALID_HANDLE_VALUE;
+    }
+    m_received.clear();
+    m_decoder.reset();
+}
+
+bool spectator::Viewer::update(GameState& gameState, timeBase::Ns timeNs) {
+    if (m_pipe == INVALID_HANDLE_VALUE) {
+        if (m_lastAttemptNs != 0 && timeNs - m_lastAttemptNs < RECONNECT_PERIOD_NS) { return false; }
+        m_lastAttemptNs = timeNs;
+        m_pipe = CreateFileW(m_pipeName.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (m_pipe == INVALID_HANDLE_VALUE) { return false; }
+    }
+
+    // only what's already there is read, so ReadFile doesn't block
+    DWORD available = 0;
+    if (!PeekNamedPipe(m_pipe, nullptr, 0, nullptr, &available, nullptr)) {
+        disconnect();
+        return false;
+    }
+    if (available > 0) {
+        size_t previousSize = m_received.size();
+        m_received.resize(previousSize + available);
+        DWORD done = 0;
+        if (!ReadFile(m_pipe, m_received.data() + previousSize, available, &done, nullptr)) {
+            disconnect();
+            return false;
+        }
+        m_received.resize(previousSize + done);
+    }
+
+    size_t used = m_decoder.apply(m_received.data(), m_received.size(), gameState);
+    m_received.erase(m_received.begin(), m_received.begin() + used);
+    return m_decoder.synced();
+}
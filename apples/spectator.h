@@ -0,0 +1,71 @@
+// Spectator feed: every frame is encoded (see spectatorCodec.h) and sent to a local viewer over a
+// named pipe.
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gameState.h"
+#include "spectatorCodec.h"
+
+namespace spectator {
+    const wchar_t DEFAULT_PIPE_NAME[] = L"\\\\.\\pipe\\apples-spectator";
+
+    // Game side: serves the feed to one viewer at a time. Encoding happens on the frame thread only
+    // while a viewer is connected, writing to the pipe on a background thread.
+    class Broadcaster {
+    private:
+        enum State { IDLE, PENDING, STOPPING };
+        // a viewer this far behind gets a keyframe instead of the frames it missed
+        static const size_t MAX_PENDING_BYTES = 1 << 20;
+
+        std::wstring m_pipeName;
+        HANDLE m_pipe = INVALID_HANDLE_VALUE;
+        Encoder m_encoder;
+        std::vector<BYTE> m_pending; // not handed to the worker yet
+        std::vector<BYTE> m_writing; // belongs to the worker while PENDING
+        std::atomic<int> m_state = IDLE;
+        std::atomic<bool> m_connected = false;
+        std::atomic<bool> m_newViewer = false;
+        std::thread m_worker;
+
+        void workerLoop();
+
+    public:
+        Broadcaster(const std::wstring& pipeName);
+        ~Broadcaster();
+
+        Broadcaster(const Broadcaster&) = delete;
+        Broadcaster& operator=(const Broadcaster&) = delete;
+
+        // Never blocks, call once per frame after the game logic
+        void frame(const gamestate::GameState& gameState);
+    };
+
+    // Viewer side: connects to a broadcaster's pipe, retrying while there is none
+    class Viewer {
+    private:
+        static const timeBase::Ns RECONNECT_PERIOD_NS = 500 * timeBase::NS_PER_MS;
+
+        std::wstring m_pipeName;
+        HANDLE m_pipe = INVALID_HANDLE_VALUE;
+        timeBase::Ns m_lastAttemptNs = 0;
+        Decoder m_decoder;
+        std::vector<BYTE> m_received; // starts at a message boundary
+
+        void disconnect();
+
+    public:
+        Viewer(const std::wstring& pipeName);
+        ~Viewer();
+
+        Viewer(const Viewer&) = delete;
+        Viewer& operator=(const Viewer&) = delete;
+
+        // Applies everything received so far without blocking. Returns false while gameState
+        // doesn't show the game yet (not connected or waiting for a keyframe).
+        bool update(gamestate::GameState& gameState, timeBase::Ns timeNs);
+    };
+} // namespace spectator
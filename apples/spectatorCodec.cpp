@@ -0,0 +1,641 @@
+#include "spectatorCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include "gameLogic.h"
+
+using gamestate::Apple;
+using gamestate::CellXY;
+using gamestate::GameState;
+using SingletonPlay = gamestate::GameState::SingletonPlay;
+
+namespace {
+    // Payloads start with the message type. Integers are LEB128 varints (signed ones zigzag
+    // encoded), floats their raw little endian bits, so they are reproduced exactly.
+    const BYTE KEYFRAME = 1;
+    const BYTE DELTA = 2;
+
+    // what a delta frame contains
+    const BYTE FRAME_MOUSE = 1 << 0;
+    const BYTE FRAME_PLAYERS = 1 << 1;
+
+    // what changed for a player
+    const BYTE PLAYER_SCORE = 1 << 0;
+    const BYTE PLAYER_TIMES_OVER = 1 << 1;
+    const BYTE PLAYER_DRAG = 1 << 2;
+    const BYTE PLAYER_VIEW = 1 << 3;
+    const BYTE PLAYER_DRAGGED = 1 << 4;
+    const BYTE PLAYER_POPS = 1 << 5;
+
+    // a length beyond this can only be a broken stream
+    const UINT64 MAX_MESSAGE_SIZE = 64ull << 20;
+
+    void putByte(std::vector<BYTE>& out, BYTE value) {
+        out.push_back(value);
+    }
+
+    void putVarint(std::vector<BYTE>& out, UINT64 value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<BYTE>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<BYTE>(value));
+    }
+
+    void putSigned(std::vector<BYTE>& out, INT64 value) {
+        putVarint(out, (static_cast<UINT64>(value) << 1) ^ static_cast<UINT64>(value >> 63));
+    }
+
+    void putFloat(std::vector<BYTE>& out, FLOAT value) {
+        UINT32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (INT i = 0; i < 4; i++) {
+            out.push_back(static_cast<BYTE>(bits >> (8 * i)));
+        }
+    }
+
+    void putCells(std::vector<BYTE>& out, const std::vector<CellXY>& cells, INT sizeX) {
+        putVarint(out, cells.size());
+        for (CellXY cell : cells) {
+            putVarint(out, static_cast<UINT64>(cell.y) * sizeX + cell.x);
+        }
+    }
+
+    // Bounds checked reading, anything past the end reads as 0 and clears ok
+    struct Reader {
+        const BYTE* p;
+        const BYTE* end;
+        bool ok = true;
+
+        BYTE byte() {
+            if (p == end) {
+                ok = false;
+                return 0;
+            }
+            return *p++;
+        }
+
+        UINT64 varint() {
+            UINT64 value = 0;
+            for (INT shift = 0; shift < 64; shift += 7) {
+                BYTE b = byte();
+                value |= static_cast<UINT64>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) { return value; }
+            }
+            ok = false;
+            return 0;
+        }
+
+        INT64 signedVarint() {
+            UINT64 value = varint();
+            return static_cast<INT64>(value >> 1) ^ -static_cast<INT64>(value & 1);
+        }
+
+        FLOAT real() {
+            UINT32 bits = 0;
+            for (INT i = 0; i < 4; i++) {
+                bits |= static_cast<UINT32>(byte()) << (8 * i);
+            }
+            FLOAT value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // cell index of a board, fails if it's not on the board
+        CellXY cell(INT sizeX, INT sizeY) {
+            UINT64 index = varint();
+            if (sizeX <= 0 || index >= static_cast<UINT64>(sizeX) * sizeY) {
+                ok = false;
+                return { 0, 0 };
+            }
+            return { static_cast<INT>(index % sizeX), static_cast<INT>(index / sizeX) };
+        }
+
+        // element count that can't be more than max
+        UINT64 count(UINT64 max) {
+            UINT64 value = varint();
+            if (value > max) {
+                ok = false;
+                return 0;
+            }
+            return value;
+        }
+    };
+
+    bool hasBoards(const GameState& gameState) {
+        return gameState.mode == GameState::Mode::PLAYING && !gameState.players[0].apples.empty();
+    }
+
+    void setDragged(SingletonPlay& play, Reader& reader) {
+        for (CellXY cell : play.draggedApples) {
+            play.apples.at(cell).inDrag = false;
+        }
+        play.draggedApples.clear();
+
+        INT sizeX = play.apples.sizeX();
+        INT sizeY = play.apples.sizeY();
+        UINT64 count = reader.count(static_cast<UINT64>(sizeX) * sizeY);
+        for (UINT64 i = 0; i < count && reader.ok; i++) {
+            CellXY cell = reader.cell(sizeX, sizeY);
+            if (!reader.ok) { break; }
+            play.apples.at(cell).inDrag = true;
+            play.draggedApples.push_back(cell);
+        }
+    }
+} // namespace
+
+spectator::Encoder::Settings spectator::Encoder::Settings::of(const GameState& gameState) {
+    return {
+        .mode = gameState.mode,
+        .appleCountX = gameState.appleCountX,
+        .appleCountY = gameState.appleCountY,
+        .playTime = gameState.playTime,
+        .hugeBoard = gameState.hugeBoard,
+        .ruleVariant = gameState.ruleVariant,
+        .boardChoice = gameState.boardChoice,
+        .playerCount = gameState.playerCount,
+        .highScore = gameState.highScore,
+        .appleSize = gameState.appleSize,
+    };
+}
+
+bool spectator::Encoder::needsKeyframe(const GameState& gameState) const {
+    if (m_keyframeRequested || m_framesSinceKeyframe >= KEYFRAME_INTERVAL) { return true; }
+    if (!(Settings::of(gameState) == m_settings)) { return true; }
+
+    bool boards = hasBoards(gameState);
+    if (m_players.size() != (boards ? static_cast<size_t>(gameState.playerCount) : 0)) { return true; }
+    for (size_t i = 0; i < m_players.size(); i++) {
+        const SingletonPlay& play = gameState.players[i];
+        const PlayerMirror& mirror = m_players[i];
+        // a new board, or a change deltas don't describe (more than one pop per frame)
+        if (play.boardSeed != mirror.boardSeed || play.startTimeNs != mirror.startTimeNs ||
+            play.boardRevision - mirror.boardRevision > 1 ||
+            mirror.popped.size() != static_cast<size_t>(play.apples.sizeX()) * play.apples.sizeY()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void spectator::Encoder::encodeKeyframe(const GameState& gameState) {
+    m_settings = Settings::of(gameState);
+    m_currentTimeNs = gameState.currentTimeNs;
+    m_mouseX = gameState.logicalMouseX;
+    m_mouseY = gameState.logicalMouseY;
+    m_framesSinceKeyframe = 0;
+    m_keyframeRequested = false;
+
+    putByte(m_payload, KEYFRAME);
+    putVarint(m_payload, gameState.currentTimeNs);
+    putByte(m_payload, static_cast<BYTE>(gameState.mode));
+    putVarint(m_payload, gameState.appleCountX);
+    putVarint(m_payload, gameState.appleCountY);
+    putVarint(m_payload, gameState.playTime);
+    putByte(m_payload, gameState.hugeBoard);
+    putByte(m_payload, static_cast<BYTE>(gameState.ruleVariant));
+    putByte(m_payload, static_cast<BYTE>(gameState.boardChoice));
+    putByte(m_payload, static_cast<BYTE>(gameState.playerCount));
+    putSigned(m_payload, gameState.highScore);
+    putFloat(m_payload, gameState.appleSize);
+    putFloat(m_payload, gameState.logicalMouseX);
+    putFloat(m_payload, gameState.logicalMouseY);
+
+    bool boards = hasBoards(gameState);
+    putByte(m_payload, boards);
+    m_players.resize(boards ? gameState.playerCount : 0);
+    for (size_t i = 0; i < m_players.size(); i++) {
+        const SingletonPlay& play = gameState.players[i];
+        PlayerMirror& mirror = m_players[i];
+        INT sizeX = play.apples.sizeX();
+        INT sizeY = play.apples.sizeY();
+
+        mirror.boardSeed = play.boardSeed;
+        mirror.startTimeNs = play.startTimeNs;
+        mirror.boardRevision = play.boardRevision;
+        mirror.score = play.score;
+        mirror.timesOver = play.timesOver;
+        mirror.inDrag = play.inDrag;
+        mirror.dragStartX = play.dragStartX;
+        mirror.dragStartY = play.dragStartY;
+        mirror.viewZoom = play.viewZoom;
+        mirror.viewCenterX = play.viewCenterX;
+        mirror.viewCenterY = play.viewCenterY;
+        mirror.draggedApples = play.draggedApples;
+
+        putVarint(m_payload, play.boardSeed);
+        putVarint(m_payload, play.startTimeNs);
+        putVarint(m_payload, play.boardRevision);
+        putSigned(m_payload, play.score);
+        putByte(m_payload, play.timesOver != FALSE);
+        putFloat(m_payload, play.area.left);
+        putFloat(m_payload, play.area.top);
+        putFloat(m_payload, play.area.right);
+        putFloat(m_payload, play.area.bottom);
+        putFloat(m_payload, play.appleMinX);
+        putFloat(m_payload, play.appleMinY);
+        putFloat(m_payload, play.viewZoom);
+        putFloat(m_payload, play.viewCenterX);
+        putFloat(m_payload, play.viewCenterY);
+        putByte(m_payload, play.inDrag);
+        putFloat(m_payload, play.dragStartX);
+        putFloat(m_payload, play.dragStartY);
+
+        // popped apples as run lengths, alternating between unpopped and popped runs
+        mirror.popped.resize(static_cast<size_t>(sizeX) * sizeY);
+        UINT64 runCount = 1;
+        for (INT y = 0; y < sizeY; y++) {
+            for (INT x = 0; x < sizeX; x++) {
+                size_t index = static_cast<size_t>(y) * sizeX + x;
+                mirror.popped[index] = play.apples.at(x, y).popped;
+                if (mirror.popped[index] != (index > 0 ? mirror.popped[index - 1] : false)) { runCount++; }
+            }
+        }
+        putVarint(m_payload, runCount);
+        UINT64 runLength = 0;
+        for (size_t index = 0; index < mirror.popped.size(); index++) {
+            if (mirror.popped[index] != (index > 0 ? mirror.popped[index - 1] : false)) {
+                putVarint(m_payload, runLength);
+                runLength = 0;
+            }
+            runLength++;
+        }
+        putVarint(m_payload, runLength);
+
+        // the rest of their physics comes from the seed
+        putVarint(m_payload, play.fallingApples.size());
+        for (CellXY cell : play.fallingApples) {
+            const Apple& apple = play.apples.at(cell);
+            putVarint(m_payload, static_cast<UINT64>(cell.y) * sizeX + cell.x);
+            putSigned(m_payload, apple.fixedX);
+            putSigned(m_payload, apple.fixedY);
+            putSigned(m_payload, apple.fixedAngle);
+            putSigned(m_payload, apple.velY);
+        }
+
+        putCells(m_payload, play.draggedApples, sizeX);
+    }
+}
+
+void spectator::Encoder::encodeDelta(const GameState& gameState) {
+    m_framesSinceKeyframe++;
+
+    putByte(m_payload, DELTA);
+    putVarint(m_payload, gameState.currentTimeNs - m_currentTimeNs);
+    m_currentTimeNs = gameState.currentTimeNs;
+
+    size_t flagsAt = m_payload.size();
+    BYTE flags = 0;
+    putByte(m_payload, 0);
+
+    if (gameState.logicalMouseX != m_mouseX || gameState.logicalMouseY != m_mouseY) {
+        flags |= FRAME_MOUSE;
+        m_mouseX = gameState.logicalMouseX;
+        m_mouseY = gameState.logicalMouseY;
+        putFloat(m_payload, m_mouseX);
+        putFloat(m_payload, m_mouseY);
+    }
+
+    size_t countAt = m_payload.size();
+    BYTE changedPlayers = 0;
+    putByte(m_payload, 0);
+    for (size_t i = 0; i < m_players.size(); i++) {
+        const SingletonPlay& play = gameState.players[i];
+        PlayerMirror& mirror = m_players[i];
+        INT sizeX = play.apples.sizeX();
+
+        // new pops are the falling apples the viewer doesn't know are popped, they were
+        // appended in the order they popped
+        m_pops.clear();
+        for (CellXY cell : play.fallingApples) {
+            size_t index = static_cast<size_t>(cell.y) * sizeX + cell.x;
+            if (!mirror.popped[index]) {
+                mirror.popped[index] = true;
+                m_pops.push_back(cell);
+            }
+        }
+
+        BYTE playerFlags = 0;
+        if (play.score != mirror.score) { playerFlags |= PLAYER_SCORE; }
+        if ((play.timesOver != FALSE) != mirror.timesOver) { playerFlags |= PLAYER_TIMES_OVER; }
+        if (play.inDrag != mirror.inDrag ||
+            (play.inDrag && (play.dragStartX != mirror.dragStartX || play.dragStartY != mirror.dragStartY))) {
+            playerFlags |= PLAYER_DRAG;
+        }
+        if (play.viewZoom != mirror.viewZoom || play.viewCenterX != mirror.viewCenterX ||
+            play.viewCenterY != mirror.viewCenterY) {
+            playerFlags |= PLAYER_VIEW;
+        }
+        if (!std::equal(play.draggedApples.begin(), play.draggedApples.end(),
+            mirror.draggedApples.begin(), mirror.draggedApples.end(),
+            [](CellXY a, CellXY b) { return a.x == b.x && a.y == b.y; })) {
+            playerFlags |= PLAYER_DRAGGED;
+        }
+        if (!m_pops.empty()) { playerFlags |= PLAYER_POPS; }
+        if (playerFlags == 0) { continue; }
+
+        changedPlayers++;
+        putByte(m_payload, static_cast<BYTE>(i));
+        putByte(m_payload, playerFlags);
+        if (playerFlags & PLAYER_SCORE) {
+            mirror.score = play.score;
+            putSigned(m_payload, play.score);
+        }
+        if (playerFlags & PLAYER_TIMES_OVER) {
+            mirror.timesOver = play.timesOver != FALSE;
+            putByte(m_payload, mirror.timesOver);
+        }
+        if (playerFlags & PLAYER_DRAG) {
+            mirror.inDrag = play.inDrag;
+            putByte(m_payload, play.inDrag);
+            if (play.inDrag) {
+                mirror.dragStartX = play.dragStartX;
+                mirror.dragStartY = play.dragStartY;
+                putFloat(m_payload, play.dragStartX);
+                putFloat(m_payload, play.dragStartY);
+            }
+        }
+        if (playerFlags & PLAYER_VIEW) {
+            mirror.viewZoom = play.viewZoom;
+            mirror.viewCenterX = play.viewCenterX;
+            mirror.viewCenterY = play.viewCenterY;
+            putFloat(m_payload, play.viewZoom);
+            putFloat(m_payload, play.viewCenterX);
+            putFloat(m_payload, play.viewCenterY);
+        }
+        if (playerFlags & PLAYER_DRAGGED) {
+            mirror.draggedApples.assign(play.draggedApples.begin(), play.draggedApples.end());
+            putCells(m_payload, play.draggedApples, sizeX);
+        }
+        if (playerFlags & PLAYER_POPS) {
+            mirror.boardRevision++;
+            putCells(m_payload, m_pops, sizeX);
+        }
+    }
+
+    if (changedPlayers > 0) {
+        flags |= FRAME_PLAYERS;
+        m_payload[countAt] = changedPlayers;
+    } else {
+        m_payload.pop_back();
+    }
+    m_payload[flagsAt] = flags;
+}
+
+void spectator::Encoder::encode(const GameState& gameState, std::vector<BYTE>& out) {
+    m_payload.clear();
+    if (needsKeyframe(gameState)) {
+        encodeKeyframe(gameState);
+    } else {
+        encodeDelta(gameState);
+    }
+    putVarint(out, m_payload.size());
+    out.insert(out.end(), m_payload.begin(), m_payload.end());
+}
+
+bool spectator::Decoder::applyKeyframe(const BYTE* data, size_t size, GameState& gameState) {
+    Reader reader = { data, data + size };
+
+    timeBase::Ns currentTimeNs = reader.varint();
+    BYTE mode = reader.byte();
+    INT appleCountX = static_cast<INT>(reader.count(gamestate::HUGE_MAX_APPLES));
+    INT appleCountY = static_cast<INT>(reader.count(gamestate::HUGE_MAX_APPLES));
+    INT playTime = static_cast<INT>(reader.count(INT32_MAX));
+    bool hugeBoard = reader.byte() != 0;
+    BYTE ruleVariant = reader.byte();
+    BYTE boardChoice = reader.byte();
+    BYTE playerCount = reader.byte();
+    INT highScore = static_cast<INT>(reader.signedVarint());
+    FLOAT appleSize = reader.real();
+    FLOAT mouseX = reader.real();
+    FLOAT mouseY = reader.real();
+    bool boards = reader.byte() != 0;
+    if (!reader.ok || mode > static_cast<BYTE>(GameState::Mode::PLAYING) ||
+        ruleVariant >= static_cast<BYTE>(rules::Variant::COUNT) ||
+        boardChoice >= static_cast<BYTE>(GameState::BoardChoice::COUNT) ||
+        playerCount < 1 || playerCount > gamestate::MAX_PLAYERS ||
+        (boards && (appleCountX < gamestate::MIN_APPLES || appleCountY < gamestate::MIN_APPLES))) {
+        return false;
+    }
+
+    // boards are kept if they would be generated the same, only their state is replaced
+    bool sameSettings = gameState.appleCountX == appleCountX && gameState.appleCountY == appleCountY &&
+        gameState.ruleVariant == static_cast<rules::Variant>(ruleVariant) && gameState.appleSize == appleSize;
+
+    gameState.previousTimeNs = currentTimeNs;
+    gameState.currentTimeNs = currentTimeNs;
+    gameState.mode = static_cast<GameState::Mode>(mode);
+    gameState.appleCountX = appleCountX;
+    gameState.appleCountY = appleCountY;
+    gameState.playTime = playTime;
+    gameState.hugeBoard = hugeBoard;
+    gameState.ruleVariant = static_cast<rules::Variant>(ruleVariant);
+    gameState.boardChoice = static_cast<GameState::BoardChoice>(boardChoice);
+    gameState.playerCount = playerCount;
+    gameState.highScore = highScore;
+    gameState.appleSize = appleSize;
+    gameState.logicalMouseX = mouseX;
+    gameState.logicalMouseY = mouseY;
+
+    size_t appleCount = static_cast<size_t>(appleCountX) * appleCountY;
+    std::vector<bool> popped;
+    for (INT i = 0; i < gamestate::MAX_PLAYERS; i++) {
+        SingletonPlay& play = gameState.players[i];
+        play.inPan = false;
+        if (!boards || i >= playerCount) {
+            play.apples.clear();
+            play.fallingApples.clear();
+            play.poppedApples.clear();
+            play.draggedApples.clear();
+            play.inDrag = false;
+            continue;
+        }
+
+        UINT64 boardSeed = reader.varint();
+        play.startTimeNs = reader.varint();
+        play.boardRevision = static_cast<UINT32>(reader.varint());
+        play.score = static_cast<INT>(reader.signedVarint());
+        play.timesOver = reader.byte() != 0;
+        play.area.left = reader.real();
+        play.area.top = reader.real();
+        play.area.right = reader.real();
+        play.area.bottom = reader.real();
+        FLOAT appleMinX = reader.real();
+        FLOAT appleMinY = reader.real();
+        play.viewZoom = reader.real();
+        play.viewCenterX = reader.real();
+        play.viewCenterY = reader.real();
+        play.inDrag = reader.byte() != 0;
+        play.dragStartX = reader.real();
+        play.dragStartY = reader.real();
+
+        popped.assign(appleCount, false);
+        UINT64 runCount = reader.count(appleCount + 1);
+        size_t cell = 0;
+        for (UINT64 run = 0; run < runCount && reader.ok; run++) {
+            UINT64 length = reader.count(appleCount - cell);
+            if (run % 2 == 1) {
+                std::fill(popped.begin() + cell, popped.begin() + cell + length, true);
+            }
+            cell += length;
+        }
+        if (!reader.ok || cell != appleCount) { return false; }
+
+        // after a broken message the boards may be anything, they are only kept while in sync
+        bool regenerate = !m_synced || !sameSettings || play.apples.sizeX() != appleCountX || play.apples.sizeY() != appleCountY ||
+            play.boardSeed != boardSeed || play.appleMinX != appleMinX || play.appleMinY != appleMinY;
+        // popped apples have moved, they can't be unpopped without generating the board again
+        for (size_t index = 0; index < appleCount && !regenerate; index++) {
+            regenerate = play.apples.at(static_cast<INT>(index % appleCountX), static_cast<INT>(index / appleCountX)).popped &&
+                !popped[index];
+        }
+        play.fallingApples.clear();
+        play.draggedApples.clear();
+        if (regenerate) {
+            play.appleMinX = appleMinX;
+            play.appleMinY = appleMinY;
+            gameLogic::generateBoard(gameState, play, boardSeed, nullptr);
+        }
+        // the order they popped in isn't sent, that of the board will do
+        play.poppedApples.clear();
+        for (INT y = 0; y < appleCountY; y++) {
+            for (INT x = 0; x < appleCountX; x++) {
+                Apple& apple = play.apples.at(x, y);
+                apple.popped = popped[static_cast<size_t>(y) * appleCountX + x];
+                apple.inDrag = false;
+                if (apple.popped) { play.poppedApples.push_back({ x, y }); }
+            }
+        }
+
+        UINT64 fallingCount = reader.count(appleCount);
+        for (UINT64 f = 0; f < fallingCount && reader.ok; f++) {
+            CellXY cell = reader.cell(appleCountX, appleCountY);
+            INT32 fixedX = static_cast<INT32>(reader.signedVarint());
+            INT32 fixedY = static_cast<INT32>(reader.signedVarint());
+            INT32 fixedAngle = static_cast<INT32>(reader.signedVarint());
+            INT32 velY = static_cast<INT32>(reader.signedVarint());
+            // only popped apples fall, settled ones have to stay where the seed put them
+            if (!reader.ok || !popped[static_cast<size_t>(cell.y) * appleCountX + cell.x]) {
+                reader.ok = false;
+                break;
+            }
+            Apple& apple = play.apples.at(cell);
+            apple.fixedX = fixedX;
+            apple.fixedY = fixedY;
+            apple.fixedAngle = fixedAngle;
+            apple.velY = velY;
+            play.fallingApples.push_back(cell);
+        }
+
+        setDragged(play, reader);
+        if (!reader.ok) { return false; }
+    }
+    m_synced = true;
+    return true;
+}
+
+bool spectator::Decoder::applyDelta(const BYTE* data, size_t size, GameState& gameState) {
+    Reader reader = { data, data + size };
+
+    timeBase::Ns deltaTimeNs = reader.varint();
+    BYTE flags = reader.byte();
+    if (!reader.ok) { return false; }
+
+    gameState.previousTimeNs = gameState.currentTimeNs;
+    gameState.currentTimeNs += deltaTimeNs;
+
+    // the same steps as the game's frame, so the falling apples end up in the same places
+    bool boards = hasBoards(gameState);
+    for (INT i = 0; boards && i < gameState.playerCount; i++) {
+        SingletonPlay& play = gameState.players[i];
+        INT64 step = gamestate::fallStep(deltaTimeNs);
+        std::erase_if(play.fallingApples, [&](CellXY cell) {
+            Apple& apple = play.apples.at(cell);
+            apple.animate(step);
+            return apple.fallen();
+        });
+    }
+
+    if (flags & FRAME_MOUSE) {
+        gameState.logicalMouseX = reader.real();
+        gameState.logicalMouseY = reader.real();
+    }
+
+    BYTE changedPlayers = (flags & FRAME_PLAYERS) ? reader.byte() : 0;
+    for (BYTE changed = 0; changed < changedPlayers && reader.ok; changed++) {
+        BYTE player = reader.byte();
+        BYTE playerFlags = reader.byte();
+        if (!boards || player >= gameState.playerCount) { return false; }
+        SingletonPlay& play = gameState.players[player];
+
+        if (playerFlags & PLAYER_SCORE) {
+            play.score = static_cast<INT>(reader.signedVarint());
+        }
+        if (playerFlags & PLAYER_TIMES_OVER) {
+            play.timesOver = reader.byte() != 0;
+        }
+        if (playerFlags & PLAYER_DRAG) {
+            play.inDrag = reader.byte() != 0;
+            if (play.inDrag) {
+                play.dragStartX = reader.real();
+                play.dragStartY = reader.real();
+            }
+        }
+        if (playerFlags & PLAYER_VIEW) {
+            play.viewZoom = reader.real();
+            play.viewCenterX = reader.real();
+            play.viewCenterY = reader.real();
+        }
+        if (playerFlags & PLAYER_DRAGGED) {
+            setDragged(play, reader);
+        }
+        if (playerFlags & PLAYER_POPS) {
+            INT sizeX = play.apples.sizeX();
+            INT sizeY = play.apples.sizeY();
+            UINT64 count = reader.count(static_cast<UINT64>(sizeX) * sizeY);
+            for (UINT64 i = 0; i < count && reader.ok; i++) {
+                CellXY cell = reader.cell(sizeX, sizeY);
+                Apple& apple = play.apples.at(cell);
+                if (!reader.ok || apple.popped) {
+                    reader.ok = false;
+                    break;
+                }
+                apple.pop();
+                apple.inDrag = false;
+                play.fallingApples.push_back(cell);
+                play.poppedApples.push_back(cell);
+            }
+            play.boardRevision++;
+        }
+    }
+    return reader.ok;
+}
+
+size_t spectator::Decoder::apply(const BYTE* data, size_t size, GameState& gameState) {
+    size_t used = 0;
+    while (used < size) {
+        Reader reader = { data + used, data + size };
+        UINT64 length = reader.varint();
+        if (!reader.ok) { break; } // the length itself is incomplete
+        if (length > MAX_MESSAGE_SIZE) {
+            // nothing after this can be trusted to start at a message
+            m_synced = false;
+            return size;
+        }
+
+        size_t header = static_cast<size_t>(reader.p - (data + used));
+        if (length > size - used - header) { break; }
+
+        const BYTE* payload = reader.p;
+        bool ok = false;
+        if (length > 0 && payload[0] == KEYFRAME) {
+            ok = applyKeyframe(payload + 1, static_cast<size_t>(length) - 1, gameState);
+        } else if (length > 0 && payload[0] == DELTA) {
+            ok = !m_synced || applyDelta(payload + 1, static_cast<size_t>(length) - 1, gameState);
+        }
+        if (!ok) { m_synced = false; }
+
+        used += header + static_cast<size_t>(length);
+    }
+    return used;
+}
@@ -0,0 +1,95 @@
+// Spectator feed encoding: after every frame the state drawLogic draws from is encoded as a delta
+// against the previous frame. Boards are sent as their seed and falling apples are simulated by the
+// decoder with the same frame times, so after a keyframe (a viewer connecting, settings changing, a
+// new board or every KEYFRAME_INTERVAL frames) an idle frame is 7 bytes and one with a moving mouse
+// 15. The decoder reconstructs the state bit exactly. Doesn't depend on any platform headers, the
+// transport is in spectator.h.
+#pragma once
+
+#include <vector>
+#include "gameState.h"
+#include "platform.h"
+
+namespace spectator {
+    const UINT32 KEYFRAME_INTERVAL = 600;
+
+    // Frame thread side. Every message is a varint length followed by the payload.
+    class Encoder {
+    private:
+        // what the viewer has, as of the last encoded frame
+        struct PlayerMirror {
+            UINT64 boardSeed;
+            timeBase::Ns startTimeNs;
+            UINT32 boardRevision;
+            INT score;
+            bool timesOver;
+            bool inDrag;
+            FLOAT dragStartX;
+            FLOAT dragStartY;
+            FLOAT viewZoom;
+            FLOAT viewCenterX;
+            FLOAT viewCenterY;
+            std::vector<bool> popped; // row major
+            std::vector<gamestate::CellXY> draggedApples;
+        };
+
+        // a change in any of these is sent as a keyframe
+        struct Settings {
+            gamestate::GameState::Mode mode;
+            INT appleCountX;
+            INT appleCountY;
+            INT playTime;
+            bool hugeBoard;
+            rules::Variant ruleVariant;
+            gamestate::GameState::BoardChoice boardChoice;
+            INT playerCount;
+            INT highScore;
+            FLOAT appleSize;
+
+            static Settings of(const gamestate::GameState& gameState);
+            bool operator==(const Settings&) const = default;
+        };
+
+        Settings m_settings = {};
+        std::vector<PlayerMirror> m_players; // empty without boards
+        timeBase::Ns m_currentTimeNs = 0;
+        FLOAT m_mouseX = 0.0f;
+        FLOAT m_mouseY = 0.0f;
+        UINT32 m_framesSinceKeyframe = 0;
+        bool m_keyframeRequested = true;
+
+        std::vector<BYTE> m_payload;
+        std::vector<gamestate::CellXY> m_pops; // of the player being encoded
+
+        bool needsKeyframe(const gamestate::GameState& gameState) const;
+        void encodeKeyframe(const gamestate::GameState& gameState);
+        void encodeDelta(const gamestate::GameState& gameState);
+
+    public:
+        // the next frame is encoded in full, e.g. for a new viewer or after dropped data
+        void requestKeyframe() { m_keyframeRequested = true; }
+
+        // Appends the message for gameState's current frame to out. Allocates only while the
+        // buffers grow (bigger boards, longer drags).
+        void encode(const gamestate::GameState& gameState, std::vector<BYTE>& out);
+    };
+
+    // Viewer side, applies messages to a GameState in the order they were encoded
+    class Decoder {
+    private:
+        bool m_synced = false;
+
+        bool applyKeyframe(const BYTE* data, size_t size, gamestate::GameState& gameState);
+        bool applyDelta(const BYTE* data, size_t size, gamestate::GameState& gameState);
+
+    public:
+        // Applies all complete messages at the start of data and returns how many bytes they took,
+        // the rest has to be passed again with more data. Deltas are skipped until a keyframe, and
+        // after a message that doesn't parse.
+        size_t apply(const BYTE* data, size_t size, gamestate::GameState& gameState);
+
+        // gameState shows the encoded state
+        bool synced() const { return m_synced; }
+        void reset() { m_synced = false; }
+    };
+} // namespace spectator
@@ -0,0 +1,211 @@
+#include "telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using telemetry::Event;
+using telemetry::EventType;
+
+namespace {
+    // Layout (little endian): FileHeader | Event[] in the order they were recorded
+    const uint32_t MAGIC = 0x4C545041; // "APTL"
+    const uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t eventSize;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 16);
+
+    const uint64_t RING_CAPACITY = 4096; // power of two, minutes of play at a normal rate
+    const auto FLUSH_PERIOD = std::chrono::milliseconds(100);
+
+    // Producer and consumer positions only grow, the slot is the position modulo the capacity.
+    // Each side caches the other's position, so the cache line it's on is only touched when needed.
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> tail = 0; // next slot the producer writes
+        uint64_t cachedHead = 0;
+        alignas(64) std::atomic<uint64_t> head = 0; // next slot the consumer reads
+        alignas(64) Event events[RING_CAPACITY];
+    };
+
+    std::unique_ptr<Ring> ring;
+    std::ofstream file;
+    std::thread writer;
+    std::atomic<bool> stopping = false;
+    uint64_t dropped = 0;
+
+    // consumer side, writes everything that's in the ring
+    void drain() {
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head == tail) { return; }
+
+        while (head != tail) {
+            uint64_t slot = head & (RING_CAPACITY - 1);
+            uint64_t count = tail - head;
+            if (count > RING_CAPACITY - slot) { count = RING_CAPACITY - slot; } // up to the end of the array
+            file.write(reinterpret_cast<const char*>(&ring->events[slot]), count * sizeof(Event));
+            head += count;
+        }
+        ring->head.store(head, std::memory_order_release);
+        file.flush();
+    }
+
+    void writerLoop() {
+        while (!stopping.load()) {
+            drain();
+            std::this_thread::sleep_for(FLUSH_PERIOD);
+        }
+        drain();
+    }
+} // namespace
+
+bool telemetry::start(const std::filesystem::path& directory) {
+    stop();
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    file.open(directory / ("session-" + std::to_string(nowMs) + ".bin"), std::ios::binary | std::ios::trunc);
+    if (!file) { return false; }
+
+    FileHeader header = { MAGIC, VERSION, sizeof(Event), 0 };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    ring = std::make_unique<Ring>();
+    dropped = 0;
+    stopping = false;
+    writer = std::thread(writerLoop);
+    return true;
+}
+
+void telemetry::stop() {
+    if (!ring) { return; }
+
+    stopping = true;
+    writer.join();
+    file.close();
+    ring.reset();
+}
+
+void telemetry::record(const Event& event) {
+    if (!ring) { return; }
+
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->cachedHead >= RING_CAPACITY) {
+        ring->cachedHead = ring->head.load(std::memory_order_acquire);
+        if (tail - ring->cachedHead >= RING_CAPACITY) {
+            dropped++;
+            return;
+        }
+    }
+    ring->events[tail & (RING_CAPACITY - 1)] = event;
+    ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+uint64_t telemetry::droppedEvents() {
+    return dropped;
+}
+
+bool telemetry::readFile(const std::filesystem::path& path, std::vector<Event>& events) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { return false; }
+
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != MAGIC || header.version != VERSION || header.eventSize != sizeof(Event)) {
+        return false;
+    }
+
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error) { return false; }
+
+    size_t count = static_cast<size_t>((size - sizeof(FileHeader)) / sizeof(Event));
+    size_t first = events.size();
+    events.resize(first + count);
+    in.read(reinterpret_cast<char*>(events.data() + first), count * sizeof(Event));
+    // the file may have grown or shrunk since its size was read
+    events.resize(first + static_cast<size_t>(in.gcount()) / sizeof(Event));
+    return true;
+}
+
+telemetry::Stats& telemetry::Stats::operator+=(const Stats& other) {
+    games += other.games;
+    finishedGames += other.finishedGames;
+    playerResults += other.playerResults;
+    scoreSum += other.scoreSum;
+    drags += other.drags;
+    failedDrags += other.failedDrags;
+    thinkTimeUs += other.thinkTimeUs;
+    thinkCount += other.thinkCount;
+    return *this;
+}
+
+uint64_t telemetry::settingsKey(const Event& gameStart) {
+    return (static_cast<uint64_t>(gameStart.width) << 48) | (static_cast<uint64_t>(gameStart.height) << 32) |
+        (static_cast<uint64_t>(static_cast<uint32_t>(gameStart.value) & 0xFFFF) << 16) | gameStart.count;
+}
+
+void telemetry::accumulate(const std::vector<Event>& session, std::map<uint64_t, Stats>& stats) {
+    const int PLAYERS = 256;
+
+    // Per player time the board was ready for the next move, 0 while no game is running.
+    // Leaving to a menu needs no handling, the next game starts with GAME_START again.
+    uint64_t readyUs[PLAYERS] = {};
+    Stats* current = nullptr;
+    bool finished = false; // every board of a versus game times out in the same frame
+
+    for (const Event& event : session) {
+        switch (event.type) {
+        case EventType::GAME_START:
+            current = &stats[settingsKey(event)];
+            current->games++;
+            finished = false;
+            std::fill(std::begin(readyUs), std::end(readyUs), event.timeUs);
+            break;
+
+        case EventType::DRAG_START:
+            if (current && readyUs[event.player] != 0 && event.timeUs >= readyUs[event.player]) {
+                current->thinkTimeUs += event.timeUs - readyUs[event.player];
+                current->thinkCount++;
+            }
+            break;
+
+        case EventType::DRAG_END:
+        case EventType::POP:
+            if (!current) { break; }
+            current->drags++;
+            if (event.type == EventType::DRAG_END) {
+                current->failedDrags++;
+            }
+            readyUs[event.player] = event.timeUs;
+            break;
+
+        case EventType::TIME_OVER:
+            if (!current) { break; }
+            if (!finished) {
+                current->finishedGames++;
+                finished = true;
+            }
+            current->playerResults++;
+            current->scoreSum += event.value > 0 ? static_cast<uint64_t>(event.value) : 0;
+            readyUs[event.player] = 0;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
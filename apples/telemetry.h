@@ -0,0 +1,77 @@
+// Gameplay telemetry: events are put into a lock-free single producer ring buffer by the frame
+// thread and written to a per-session binary log by a background thread. Sessions can be read back
+// and aggregated into per-settings stats (think time, failed drags, ...) used to tune difficulty.
+// All times are passed in explicitly (in microseconds). Doesn't depend on any platform headers,
+// so logs can be written and aggregated on any OS.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace telemetry {
+    enum class EventType : uint8_t {
+        GAME_START,  // width, height: board size, count: rule variant, value: play time
+        DRAG_START,
+        DRAG_END,    // drag that didn't pop, width, height: selection in apples, count: apples, value: sum
+        POP,         // same as DRAG_END for a drag that popped
+        RESET,       // value: score when the game was reset
+        TIME_OVER,   // value: final score
+        MODE_CHANGE, // count: new GameState::Mode
+        COUNT
+    };
+
+    // one record of the log
+    struct Event {
+        uint64_t timeUs;
+        EventType type;
+        uint8_t player;
+        uint16_t width;
+        uint16_t height;
+        uint16_t count;
+        int32_t value;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Event) == 24);
+
+    // Starts a new session log in directory, named after the current wall clock time.
+    // Without a session, record() does nothing.
+    bool start(const std::filesystem::path& directory);
+    // Writes out everything recorded and closes the log
+    void stop();
+
+    // Frame thread only. Never blocks or allocates, drops the event if the ring is full.
+    void record(const Event& event);
+    // events dropped because the writer fell behind
+    uint64_t droppedEvents();
+
+    // Events of a session log, a partly written last event is ignored
+    bool readFile(const std::filesystem::path& path, std::vector<Event>& events);
+
+    // Per-settings stats of any number of sessions
+    struct Stats {
+        uint64_t games = 0;
+        uint64_t finishedGames = 0; // a versus game counts once, however many boards it had
+        uint64_t playerResults = 0; // final scores, one per player of every finished game
+        uint64_t scoreSum = 0;      // of the final scores
+        uint64_t drags = 0;
+        uint64_t failedDrags = 0;
+        uint64_t thinkTimeUs = 0; // from game start or the previous drag end to a drag start
+        uint64_t thinkCount = 0;
+
+        double failedDragRate() const { return drags ? static_cast<double>(failedDrags) / drags : 0.0; }
+        double meanThinkTimeUs() const { return thinkCount ? static_cast<double>(thinkTimeUs) / thinkCount : 0.0; }
+        double meanScore() const { return playerResults ? static_cast<double>(scoreSum) / playerResults : 0.0; }
+
+        Stats& operator+=(const Stats& other);
+    };
+
+    // Packed board size, play time and rule variant of a GAME_START event
+    uint64_t settingsKey(const Event& gameStart);
+
+    // Adds the games of one session to stats. Maps of sessions aggregated on different threads
+    // can be merged with Stats::operator+=.
+    void accumulate(const std::vector<Event>& session, std::map<uint64_t, Stats>& stats);
+} // namespace telemetry
@@ -0,0 +1,39 @@
+#include "timeBase.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+    timeBase::MonotonicSource monotonic;
+    std::atomic<timeBase::Source*> source = &monotonic;
+} // namespace
+
+timeBase::Ns timeBase::MonotonicSource::now() {
+#ifdef _WIN32
+    // fixed at boot, so it's read once
+    static const uint64_t frequency = []() {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        return static_cast<uint64_t>(freq.QuadPart);
+    }();
+
+    LARGE_INTEGER time;
+    QueryPerformanceCounter(&time);
+    return ticksToNs(static_cast<uint64_t>(time.QuadPart), frequency);
+#else
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<Ns>(time.tv_sec) * NS_PER_SECOND + static_cast<Ns>(time.tv_nsec);
+#endif
+}
+
+void timeBase::setSource(Source* newSource) {
+    source = newSource ? newSource : &monotonic;
+}
+
+timeBase::Ns timeBase::now() {
+    return source.load()->now();
+}
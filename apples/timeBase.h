@@ -0,0 +1,57 @@
+// Monotonic nanosecond time for the game loop. Frame times, timers and animation steps all use it,
+// so apples move by the exact frame time at any refresh rate instead of whole milliseconds.
+// Where the time comes from is swappable: the OS monotonic clock normally, a virtual clock that
+// only moves when told to for tests and replays. Plain C++ apart from the OS clock.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace timeBase {
+    // nanoseconds since an arbitrary start, 64 bits last for centuries
+    using Ns = uint64_t;
+
+    constexpr Ns NS_PER_US = 1'000;
+    constexpr Ns NS_PER_MS = 1'000'000;
+    constexpr Ns NS_PER_SECOND = 1'000'000'000;
+
+    // for durations of one frame up to minutes, where float precision is plenty
+    constexpr float toSeconds(Ns duration) {
+        return static_cast<float>(duration) / static_cast<float>(NS_PER_SECOND);
+    }
+
+    // Counter ticks to nanoseconds without multiplying the whole count (which overflows after
+    // weeks at 10 MHz), exact for frequencies up to 18 GHz
+    constexpr Ns ticksToNs(uint64_t ticks, uint64_t frequency) {
+        return ticks / frequency * NS_PER_SECOND + ticks % frequency * NS_PER_SECOND / frequency;
+    }
+
+    class Source {
+    public:
+        virtual ~Source() = default;
+        virtual Ns now() = 0;
+    };
+
+    // QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere
+    class MonotonicSource : public Source {
+    public:
+        Ns now() override;
+    };
+
+    class VirtualSource : public Source {
+    private:
+        std::atomic<Ns> m_now;
+
+    public:
+        explicit VirtualSource(Ns start = 0) : m_now(start) {}
+
+        Ns now() override { return m_now.load(); }
+        void advance(Ns duration) { m_now += duration; }
+    };
+
+    // Replaces the clock now() reads, for all threads. The source has to stay alive while it's in
+    // use, nullptr goes back to the monotonic clock.
+    void setSource(Source* source);
+
+    Ns now();
+} // namespace timeBase
@@ -0,0 +1,38 @@
+// Apple detail tiers: what choosing them and counting the apples of the view costs per frame. The
+// draw calls they save need Direct2D to time, they're counted by appleDetail::DRAW_CALLS instead and
+// appleDetailTest checks which tier each of these cases gets.
+#include <string>
+#include "appleDetail.h"
+#include "bench.h"
+#include "headless.h"
+
+namespace {
+    struct Case {
+        const char* name;
+        INT applesX, applesY;
+        bool hugeBoard;
+        INT windowWidth, windowHeight;
+    };
+
+    // full detail, simple in half HD, flat in a quarter, and a huge board zoomed out
+    const Case CASES[] = {
+        { "32x20_1920x1080", gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y, false, 1920, 1080 },
+        { "32x20_960x540", gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y, false, 960, 540 },
+        { "32x20_480x270", gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y, false, 480, 270 },
+        { "huge_250x250_960x540", 250, 250, true, 960, 540 },
+    };
+} // namespace
+
+BENCH_SUITE(appleDetail) {
+    for (const Case& c : CASES) {
+        headless::Game game;
+        game.start({ .appleCountX = c.applesX, .appleCountY = c.applesY, .hugeBoard = c.hugeBoard });
+        game.controller.setWindowSize(c.windowWidth, c.windowHeight);
+        game.frame();
+        const gamestate::GameState::SingletonPlay& play = game.state.players[0];
+
+        context.measure(std::string("apple_detail/board_cost_") + c.name, [&]() {
+            bench::keep(appleDetail::boardCost(game.state, play).drawCalls);
+        });
+    }
+}
@@ -0,0 +1,147 @@
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace {
+    std::vector<std::pair<const char*, bench::Suite>>& suites() {
+        static std::vector<std::pair<const char*, bench::Suite>> registered;
+        return registered;
+    }
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: apples_bench [--filter TEXT] [--quick] [--json FILE] [--baseline FILE] [--threshold RATIO]\n"
+            "  --filter     only benchmarks whose name contains TEXT\n"
+            "  --quick      one short pass, to check everything runs\n"
+            "  --json       writes the results to FILE\n"
+            "  --baseline   compares against the results in FILE (written with --json)\n"
+            "  --threshold  fails if a benchmark is slower than the baseline by more than RATIO (default 0.25)\n");
+    }
+
+    std::string escaped(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') { out += '\\'; }
+            out += c;
+        }
+        return out;
+    }
+
+    bool writeJson(const char* path, const std::vector<bench::Result>& results) {
+        std::ofstream out(path);
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const bench::Result& result = results[i];
+            char nsPerOp[32];
+            std::snprintf(nsPerOp, sizeof(nsPerOp), "%.3f", result.nsPerOp);
+            out << "    { \"name\": \"" << escaped(result.name) << "\", \"ns_per_op\": " << nsPerOp
+                << ", \"iterations\": " << result.iterations << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    // Reads the name and ns_per_op of every benchmark of a file written by writeJson, the format
+    // is ours so there is no need for a full JSON parser
+    bool readBaseline(const char* path, std::map<std::string, double>& baseline) {
+        std::ifstream in(path);
+        if (!in) { return false; }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+
+        const std::string NAME = "\"name\": \"";
+        const std::string NS_PER_OP = "\"ns_per_op\": ";
+        for (size_t at = text.find(NAME); at != std::string::npos; at = text.find(NAME, at)) {
+            at += NAME.size();
+            std::string name;
+            for (; at < text.size() && text[at] != '"'; at++) {
+                if (text[at] == '\\') { at++; }
+                name += text[at];
+            }
+            size_t value = text.find(NS_PER_OP, at);
+            if (value == std::string::npos) { return false; }
+            baseline[name] = std::strtod(text.c_str() + value + NS_PER_OP.size(), nullptr);
+        }
+        return true;
+    }
+} // namespace
+
+bench::Registration::Registration(const char* name, Suite suite) {
+    suites().emplace_back(name, suite);
+}
+
+void bench::Context::report(const std::string& name, double nsPerOp, uint64_t iterations) {
+    if (!selected(name)) { return; }
+    m_results.push_back({ name, nsPerOp, iterations });
+    std::printf("%-48s %14.1f ns/op %12llu iterations\n", name.c_str(), nsPerOp,
+        static_cast<unsigned long long>(iterations));
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    bool quick = false;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 0.25;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselinePath && !readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "can't read the baseline %s\n", baselinePath);
+        return 2;
+    }
+
+    bench::Context context(filter, quick);
+    for (auto& [name, suite] : suites()) {
+        suite(context);
+    }
+
+    if (jsonPath && !writeJson(jsonPath, context.results())) {
+        std::fprintf(stderr, "can't write %s\n", jsonPath);
+        return 2;
+    }
+
+    if (!baselinePath) { return 0; }
+    int slower = 0;
+    std::printf("\ncompared to %s (threshold %+.0f%%):\n", baselinePath, threshold * 100.0);
+    for (const bench::Result& result : context.results()) {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end() || found->second <= 0.0) {
+            std::printf("%-48s %14s\n", result.name.c_str(), "new");
+            continue;
+        }
+        double change = result.nsPerOp / found->second - 1.0;
+        bool regressed = change > threshold;
+        slower += regressed;
+        std::printf("%-48s %+13.1f%%%s\n", result.name.c_str(), change * 100.0, regressed ? "  SLOWER" : "");
+    }
+    if (slower > 0) {
+        std::printf("%d benchmark(s) slower than the baseline allows\n", slower);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Micro benchmarks of the game's hot paths. Every source file registers its suites with
+// BENCH_SUITE, a suite measures any number of named operations. Results are printed, written as
+// JSON with --json and compared against a baseline file with --baseline, so a slowdown beyond
+// --threshold fails the run (see main in bench.cpp for the options).
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+    struct Result {
+        std::string name;
+        double nsPerOp;
+        uint64_t iterations; // of the best repetition
+    };
+
+    class Context {
+    private:
+        std::string m_filter;
+        bool m_quick;
+        std::vector<Result> m_results;
+
+        bool selected(const std::string& name) const {
+            return m_filter.empty() || name.find(m_filter) != std::string::npos;
+        }
+
+    public:
+        Context(std::string filter, bool quick) : m_filter(std::move(filter)), m_quick(quick) {}
+
+        // one quick pass to check everything runs, numbers aren't worth comparing
+        bool quick() const { return m_quick; }
+        const std::vector<Result>& results() const { return m_results; }
+
+        // For operations measure() can't time, e.g. when only part of every call counts
+        void report(const std::string& name, double nsPerOp, uint64_t iterations);
+
+        // Times op(), the fastest of a few repetitions each long enough for the clock to be
+        // precise. Setup done in op between timed parts has to be cheap or rare.
+        template<typename F>
+        void measure(const std::string& name, F op) {
+            if (!selected(name)) { return; }
+            using Clock = std::chrono::steady_clock;
+            const auto batchTime = m_quick ? std::chrono::microseconds(200) : std::chrono::milliseconds(20);
+            const int repetitions = m_quick ? 1 : 7;
+
+            op(); // warm up caches and lazily set up state
+            uint64_t batch = 1;
+            for (;;) {
+                auto start = Clock::now();
+                for (uint64_t i = 0; i < batch; i++) { op(); }
+                if (Clock::now() - start >= batchTime || batch >= (1ull << 30)) { break; }
+                batch *= 2;
+            }
+
+            double best = 0.0;
+            for (int repetition = 0; repetition < repetitions; repetition++) {
+                auto start = Clock::now();
+                for (uint64_t i = 0; i < batch; i++) { op(); }
+                double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / batch;
+                if (repetition == 0 || ns < best) { best = ns; }
+            }
+            report(name, best, batch);
+        }
+    };
+
+    // keeps the compiler from optimizing away a result nobody reads
+    template<typename T>
+    inline void keep(const T& value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    using Suite = void(*)(Context&);
+
+    struct Registration {
+        Registration(const char* name, Suite suite);
+    };
+} // namespace bench
+
+#define BENCH_SUITE(name) \
+    static void bench_##name(bench::Context& context); \
+    static bench::Registration benchRegistration_##name(#name, bench_##name); \
+    static void bench_##name(bench::Context& context)
@@ -0,0 +1,203 @@
+// Per-frame and per-game hot paths of the game logic, over board sizes from the smallest to the
+// biggest regular one
+#include <string>
+#include <tuple>
+#include <vector>
+#include "bench.h"
+#include "dragScan.h"
+#include "headless.h"
+
+namespace {
+    struct Size {
+        INT x, y;
+    };
+    const Size SIZES[] = { { 4, 4 }, { 8, 6 }, { gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y }, { 24, 15 },
+        { gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y } };
+
+    std::string sized(const char* name, Size size) {
+        return std::string(name) + "/" + std::to_string(size.x) + "x" + std::to_string(size.y);
+    }
+
+    gamestate::GameState settings(Size size) {
+        gamestate::GameState gameState;
+        gameState.appleCountX = size.x;
+        gameState.appleCountY = size.y;
+        gameState.ruleVariant = rules::Variant::CLASSIC;
+        return gameState;
+    }
+
+    // The drag test alone on a board size compiled for, its fixed size path against the runtime size
+    // one, which is what the size takes without the fixed one. Random drags of up to half the board.
+    template<typename Extents>
+    void measureDragScanPaths(bench::Context& context, Extents) {
+        const Size size = { Extents::SIZE_X, Extents::SIZE_Y };
+        headless::Game game;
+        game.start({ .appleCountX = size.x, .appleCountY = size.y, .playTime = 900 });
+        gamestate::GameState::SingletonPlay& play = game.state.players[0];
+        const FLOAT appleSize = game.state.appleSize;
+
+        struct Drag {
+            INT minX, minY, maxX, maxY;
+            simd::Bounds bounds;
+        };
+        rng::Stream random(50);
+        std::vector<Drag> drags(1024);
+        for (Drag& drag : drags) {
+            const FLOAT left = play.appleMinX + random.nextFloat(0.0f, static_cast<FLOAT>(size.x)) * appleSize;
+            const FLOAT top = play.appleMinY + random.nextFloat(0.0f, static_cast<FLOAT>(size.y)) * appleSize;
+            const D2D1_RECT_F rect = D2D1::RectF(left, top, left + random.nextFloat(0.0f, size.x * 0.5f) * appleSize,
+                top + random.nextFloat(0.0f, size.y * 0.5f) * appleSize);
+            game.state.cellsOver(play, rect, drag.minX, drag.minY, drag.maxX, drag.maxY);
+            drag.bounds = { .left = rect.left, .top = rect.top, .right = rect.right, .bottom = rect.bottom, .margin = 0.05f * appleSize };
+        }
+
+        auto measurePath = [&](const char* name, auto path) {
+            size_t next = 0;
+            context.measure(sized(name, size), [&]() {
+                const Drag& drag = drags[next++ % drags.size()];
+                INT selected = 0;
+                dragScan::selectInBounds<decltype(path)>(play.apples, drag.minX, drag.minY, drag.maxX, drag.maxY, drag.bounds,
+                    [&selected](gamestate::Apple&, INT, INT) { selected++; });
+                bench::keep(selected);
+            });
+        };
+        measurePath("drag_scan_fixed", Extents());
+        measurePath("drag_scan_runtime", dragScan::RuntimeExtents());
+    }
+} // namespace
+
+// new board of a game, values drawn and fixed up to a clearable sum
+BENCH_SUITE(generateBoard) {
+    for (Size size : SIZES) {
+        gamestate::GameState gameState = settings(size);
+        gamestate::GameState::SingletonPlay play{};
+        UINT64 seed = 0;
+        context.measure(sized("generate_board", size), [&]() {
+            gameLogic::generateBoard(gameState, play, seed++, nullptr);
+            bench::keep(play.apples.at(0, 0).value);
+        });
+    }
+}
+
+// one frame of falling for a board where every apple is falling
+BENCH_SUITE(animate) {
+    for (Size size : SIZES) {
+        gamestate::GameState gameState = settings(size);
+        gamestate::GameState::SingletonPlay play{};
+        gameLogic::generateBoard(gameState, play, 1, nullptr);
+        play.apples.forEach([](gamestate::Apple& apple, INT, INT) { apple.pop(); });
+        const gamestate::AppleGrid popped = play.apples;
+        const INT64 step = gamestate::fallStep(headless::FRAME_NS);
+
+        context.measure(sized("animate", size), [&]() {
+            // apples are out of sight after some seconds, then they fall again from the top
+            if (play.apples.at(0, 0).fallen()) { play.apples = popped; }
+            play.apples.forEach([step](gamestate::Apple& apple, INT, INT) { apple.animate(step); });
+        });
+    }
+}
+
+// a frame while dragging, the selection is scanned again every frame the mouse moves
+BENCH_SUITE(dragScan) {
+    for (Size size : SIZES) {
+        headless::Game game;
+        game.start({ .appleCountX = size.x, .appleCountY = size.y, .playTime = 900 });
+        const FLOAT inset = game.state.appleSize * 0.45f;
+        game.moveTo(game.cellX(0) - inset, game.cellY(0) - inset);
+        game.press();
+        game.frame();
+
+        // the whole board and half of it in turns, never let go so nothing pops
+        const FLOAT fullX = game.cellX(size.x - 1) + inset, fullY = game.cellY(size.y - 1) + inset;
+        const FLOAT halfX = game.cellX(size.x / 2) + inset, halfY = game.cellY(size.y / 2) + inset;
+        bool full = false;
+        context.measure(sized("drag_scan", size), [&]() {
+            full = !full;
+            game.moveTo(full ? fullX : halfX, full ? fullY : halfY);
+            game.frame(1000); // the game never runs out of time
+            bench::keep(game.state.players[0].draggedApples.size());
+        });
+    }
+}
+
+// the drag test's two paths on every board size compiled for
+BENCH_SUITE(dragScanPaths) {
+    std::apply([&context](auto... extents) { (measureDragScanPaths(context, extents), ...); }, dragScan::FixedSizes());
+}
+
+// The game steps falling apples one by one through their cells. Batching them for SIMD needs the
+// state in arrays of its own: here they're gathered from the grid into arrays, stepped there in
+// loops the compiler vectorizes (from SSE4.1 on, which has 32x32 bit products to 64 bits) and
+// written back, against the game's way. Gathering and scattering costs more than the batched step
+// saves. Keeping the physics outside the grid for good would save at most the difference to the
+// step alone, and would change the board layout, snapshots and spectator streams for the ~100 ns a
+// frame takes with the handful of apples a game has falling.
+BENCH_SUITE(fallingBatch) {
+    struct Board {
+        const char* name;
+        Size size;
+        INT falling;
+    };
+    const Board BOARDS[] = { { "move", { gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y }, 16 },
+        { "full", { gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y }, gamestate::MAX_APPLES_X * gamestate::MAX_APPLES_Y },
+        { "huge", { 250, 250 }, 250 * 250 } };
+    for (const Board& board : BOARDS) {
+        gamestate::GameState gameState = settings(board.size);
+        gamestate::GameState::SingletonPlay play{};
+        gameLogic::generateBoard(gameState, play, 1, nullptr);
+        // spread over the board like the pops of a game
+        std::vector<gamestate::CellXY> cells;
+        const INT cellCount = board.size.x * board.size.y;
+        for (INT i = 0; i < board.falling; i++) {
+            const INT cell = static_cast<INT>(static_cast<INT64>(i) * cellCount / board.falling);
+            cells.push_back({ cell % board.size.x, cell / board.size.x });
+            play.apples.at(cells.back()).pop();
+        }
+        const gamestate::AppleGrid popped = play.apples;
+        const INT64 step = gamestate::fallStep(headless::FRAME_NS);
+        const std::string suffix = std::string(board.name) + "_" + std::to_string(board.falling);
+
+        context.measure("falling/cell_list_" + suffix, [&]() {
+            if (play.apples.at(cells[0]).fallen()) { play.apples = popped; }
+            for (gamestate::CellXY cell : cells) { play.apples.at(cell).animate(step); }
+        });
+
+        const size_t count = cells.size();
+        std::vector<INT32> x(count), y(count), angle(count), velX(count), velY(count), accY(count), velAngular(count);
+        auto stepped = [step](INT32 perSecond) {
+            return static_cast<INT32>((perSecond * step) >> gamestate::STEP_FRACTION_BITS);
+        };
+        auto gather = [&]() {
+            for (size_t i = 0; i < count; i++) {
+                const gamestate::Apple& apple = play.apples.at(cells[i]);
+                x[i] = apple.fixedX, y[i] = apple.fixedY, angle[i] = apple.fixedAngle;
+                velX[i] = apple.velX, velY[i] = apple.velY, accY[i] = apple.accY, velAngular[i] = apple.velAngular;
+            }
+        };
+        auto stepAll = [&]() {
+            // a loop per field, each over two arrays, so the compiler sees they don't overlap
+            for (size_t i = 0; i < count; i++) { x[i] += stepped(velX[i]); }
+            for (size_t i = 0; i < count; i++) { y[i] += stepped(velY[i]); }
+            for (size_t i = 0; i < count; i++) { velY[i] += stepped(accY[i]); }
+            for (size_t i = 0; i < count; i++) { angle[i] += stepped(velAngular[i]); }
+        };
+        play.apples = popped;
+        gather();
+        // what batching could save at best, the state already in arrays and never written back
+        context.measure("falling/batched_step_only_" + suffix, [&]() {
+            if (y[0] > gamestate::toFixed(30000.0)) { gather(); }
+            stepAll();
+            bench::keep(y[0]);
+        });
+
+        context.measure("falling/batched_" + suffix, [&]() {
+            if (play.apples.at(cells[0]).fallen()) { play.apples = popped; }
+            gather();
+            stepAll();
+            for (size_t i = 0; i < count; i++) {
+                gamestate::Apple& apple = play.apples.at(cells[i]);
+                apple.fixedX = x[i], apple.fixedY = y[i], apple.fixedAngle = angle[i], apple.velY = velY[i];
+            }
+        });
+    }
+}
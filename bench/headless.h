@@ -0,0 +1,141 @@
+// Plays the game without a window for benchmarks and tests: input goes through the controller's
+// setters in a 1920x1080 window (so window and logical coordinates are the same) and frames run
+// at a time that only moves when told to.
+#pragma once
+
+#include <functional>
+#include "controller.h"
+#include "gameLogic.h"
+#include "gameState.h"
+
+namespace headless {
+    const timeBase::Ns FRAME_NS = 16'666'667;
+
+    struct Settings {
+        INT appleCountX = gamestate::DEFAULT_APPLES_X;
+        INT appleCountY = gamestate::DEFAULT_APPLES_Y;
+        INT playerCount = 1;
+        rules::Variant ruleVariant = rules::Variant::CLASSIC;
+        INT playTime = gamestate::DEFAULT_PLAY_TIME_SECONDS;
+        bool hugeBoard = false;
+        gamestate::GameState::BoardChoice boardChoice = gamestate::GameState::BoardChoice::RANDOM;
+    };
+
+    class Game {
+    public:
+        Controller controller;
+        gamestate::GameState state;
+        timeBase::Ns timeNs;
+        std::function<void()> afterFrame; // e.g. to look at every frame of a drag
+        // Installed with timeBase::setSource and not ahead of timeNs, it's moved to timeNs every frame,
+        // so readers of timeBase::now() (input capture times, latency) see the game's time, not wall time
+        timeBase::VirtualSource* clock = nullptr;
+
+        // the same start time plays the same boards
+        explicit Game(timeBase::Ns startNs = timeBase::NS_PER_SECOND, highScores::Store* scores = nullptr) : timeNs(startNs) {
+            controller.setWindowSize(1920, 1080);
+            gameLogic::init(timeNs, state, scores, false);
+        }
+        ~Game() { gameLogic::stop(state); }
+
+        Game(const Game&) = delete;
+        Game& operator=(const Game&) = delete;
+
+        bool frame(timeBase::Ns deltaNs = FRAME_NS) {
+            timeNs += deltaNs;
+            if (clock) { clock->advance(timeNs - clock->now()); }
+            controller.pollAllKeys(false);
+            bool result = gameLogic::processFrame(controller, state, timeNs);
+            if (afterFrame) { afterFrame(); }
+            return result;
+        }
+
+        void moveTo(FLOAT x, FLOAT y) { controller.setMousePos(static_cast<INT>(x), static_cast<INT>(y)); }
+        void press(UINT8 key = VK_LBUTTON) { controller.setKeyDown(key, true); }
+        void release(UINT8 key = VK_LBUTTON) { controller.setKeyDown(key, false); }
+
+        // a frame with the key down and one with it up again
+        void tap(UINT8 key) {
+            press(key);
+            frame();
+            release(key);
+            frame();
+        }
+        void click(FLOAT x, FLOAT y) {
+            moveTo(x, y);
+            tap(VK_LBUTTON);
+        }
+        void click(const gamestate::Button& button) {
+            click((button.left + button.right) / 2.0f, (button.top + button.bottom) / 2.0f);
+        }
+
+        // From any menu into a game with these settings
+        void start(const Settings& settings) {
+            state.mode = gamestate::GameState::Mode::MAIN_MENU;
+            state.appleCountX = settings.appleCountX;
+            state.appleCountY = settings.appleCountY;
+            state.playerCount = settings.playerCount;
+            state.ruleVariant = settings.ruleVariant;
+            state.playTime = settings.playTime;
+            state.hugeBoard = settings.hugeBoard;
+            state.boardChoice = settings.boardChoice;
+            click(gamestate::buttonMainMenuStart);
+        }
+
+        // logical position of the middle of a cell of a player's board
+        FLOAT cellX(INT x, INT player = 0) const {
+            const gamestate::GameState::SingletonPlay& play = state.players[player];
+            return play.toLogicalX(play.appleMinX + state.appleSize * (x + 0.5f));
+        }
+        FLOAT cellY(INT y, INT player = 0) const {
+            const gamestate::GameState::SingletonPlay& play = state.players[player];
+            return play.toLogicalY(play.appleMinY + state.appleSize * (y + 0.5f));
+        }
+
+        // drags over the cells [x0, x1] x [y0, y1] from corner to corner and lets go
+        void drag(INT x0, INT y0, INT x1, INT y1, INT player = 0) {
+            const FLOAT inset = state.appleSize * state.players[player].viewZoom * 0.45f;
+            moveTo(cellX(x0, player) - inset, cellY(y0, player) - inset);
+            press();
+            frame();
+            moveTo(cellX(x1, player) + inset, cellY(y1, player) + inset);
+            frame();
+            release();
+            frame();
+        }
+
+        // The first rectangle of at most maxSide x maxSide cells that is a valid move, smallest first,
+        // as its corner cells x0, y0, x1, y1. False if there is none.
+        bool findMove(INT (&found)[4], INT player = 0, INT maxSide = 4) const {
+            const gamestate::AppleGrid& apples = state.players[player].apples;
+            return rules::visit(state.ruleVariant, [&](auto variant) {
+                for (INT side = 1; side <= maxSide * maxSide; side++) {
+                    INT w = (side - 1) % maxSide + 1, h = (side - 1) / maxSide + 1;
+                    for (INT y0 = 0; y0 + h <= apples.sizeY(); y0++) {
+                        for (INT x0 = 0; x0 + w <= apples.sizeX(); x0++) {
+                            rules::Selection<decltype(variant)> selection;
+                            for (INT y = y0; y < y0 + h; y++) {
+                                for (INT x = x0; x < x0 + w; x++) {
+                                    if (!apples.at(x, y).popped) { selection.add(apples.at(x, y).value, x, y); }
+                                }
+                            }
+                            if (selection.count() > 0 && selection.valid()) {
+                                found[0] = x0, found[1] = y0, found[2] = x0 + w - 1, found[3] = y0 + h - 1;
+                                return true;
+                            }
+                        }
+                    }
+                }
+                return false;
+            });
+        }
+
+        // Drags over the move findMove finds. False if there is none.
+        bool popAny(INT player = 0, INT maxSide = 4) {
+            INT found[4];
+            if (!findMove(found, player, maxSide)) { return false; }
+            drag(found[0], found[1], found[2], found[3], player);
+            return true;
+        }
+    };
+} // namespace headless
@@ -0,0 +1,28 @@
+// Opening a high score file the size of a tournament's: 4M records, each one a new best of its
+// settings, indexed on load. Over 1k board settings the index stays small, over 100k it's bigger
+// than the cache.
+#include <filesystem>
+#include <string>
+#include "bench.h"
+#include "highScores.h"
+
+BENCH_SUITE(highScores) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "apples-high-scores-bench.scores";
+    const INT RECORDS = context.quick() ? 100000 : 4000000;
+    for (INT keys : { 1000, 100000 }) {
+        std::filesystem::remove(path);
+        {
+            highScores::Store store(path);
+            for (INT i = 0; i < RECORDS; i++) {
+                INT key = i % keys;
+                store.submit({ 4 + key % 500, 4 + key / 500, 120, rules::Variant::CLASSIC }, 1 + i / keys);
+            }
+        }
+
+        context.measure("high_scores/load_" + std::to_string(RECORDS / 1000) + "k_records_" + std::to_string(keys / 1000) + "k_settings", [&]() {
+            highScores::Store store(path);
+            bench::keep(store.best({ 4, 4, 120, rules::Variant::CLASSIC }));
+        });
+    }
+    std::filesystem::remove(path);
+}
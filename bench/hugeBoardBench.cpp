@@ -0,0 +1,46 @@
+// Huge boards at the zoom they start at: the view shows about as many apples at any board size, so
+// with culling the cost of a frame has to stay flat as the board grows
+#include <string>
+#include "bench.h"
+#include "headless.h"
+
+namespace {
+    const INT HUGE_SIZES[] = { 64, 250, 1000 };
+
+    std::string sized(const char* name, INT size) {
+        return std::string(name) + "/" + std::to_string(size) + "x" + std::to_string(size);
+    }
+} // namespace
+
+BENCH_SUITE(hugeBoard) {
+    for (INT size : HUGE_SIZES) {
+        if (context.quick() && size > 250) { continue; }
+        headless::Game game;
+        game.start({ .appleCountX = size, .appleCountY = size, .playTime = 900, .hugeBoard = true });
+        const gamestate::GameState::SingletonPlay& play = game.state.players[0];
+
+        // apples of the view, as drawing visits them
+        context.measure(sized("huge_cull", size), [&]() {
+            INT minX, minY, maxX, maxY, visible = 0;
+            game.state.cellsOver(play, play.visibleBoardArea(), minX, minY, maxX, maxY);
+            play.apples.forEachInChunksOver(minX, minY, maxX, maxY, [&](const gamestate::Apple& apple, INT, INT) {
+                visible += !apple.popped;
+            });
+            bench::keep(visible);
+        });
+
+        // a frame dragging over all of the view and half of it in turns
+        game.moveTo(play.area.left + 2.0f, play.area.top + 2.0f);
+        game.press();
+        game.frame();
+        bool full = false;
+        context.measure(sized("huge_drag_scan", size), [&]() {
+            full = !full;
+            game.moveTo(full ? play.area.right - 2.0f : (play.area.left + play.area.right) / 2.0f,
+                full ? play.area.bottom - 2.0f : (play.area.top + play.area.bottom) / 2.0f);
+            game.frame(1000);
+            bench::keep(play.draggedApples.size());
+        });
+        game.release();
+    }
+}
@@ -0,0 +1,42 @@
+// Downscaling of the menu images: the SSE2 kernels against the scalar reference and the whole
+// scaleTo, mip level selection included, at window sizes the background is drawn at
+#include <random>
+#include <string>
+#include "bench.h"
+#include "imageScale.h"
+
+namespace {
+    using imageScale::Image;
+
+    // bigTree.png, the main menu background
+    const uint32_t SOURCE_WIDTH = 867;
+    const uint32_t SOURCE_HEIGHT = 579;
+
+    Image noise(uint32_t width, uint32_t height) {
+        std::mt19937 random(1);
+        Image image(width, height);
+        for (uint32_t& pixel : image.pixels) { pixel = random() | 0xFF000000u; }
+        return image;
+    }
+} // namespace
+
+BENCH_SUITE(imageScale) {
+    const Image source = noise(SOURCE_WIDTH, SOURCE_HEIGHT);
+
+    context.measure("image_scale/halve_867x579", [&]() { bench::keep(imageScale::halve(source).pixels[0]); });
+    context.measure("image_scale/halve_867x579_scalar", [&]() { bench::keep(imageScale::halveScalar(source).pixels[0]); });
+    context.measure("image_scale/resize_600x400", [&]() { bench::keep(imageScale::resize(source, 600, 400).pixels[0]); });
+    context.measure("image_scale/resize_600x400_scalar", [&]() {
+        bench::keep(imageScale::resizeScalar(source, 600, 400).pixels[0]);
+    });
+    context.measure("image_scale/build_mips_867x579", [&]() { bench::keep(imageScale::buildMips(source).size()); });
+
+    // drawn at a quarter, a half and most of its size
+    const std::vector<Image> mips = imageScale::buildMips(source);
+    for (uint32_t width : { 217u, 433u, 700u }) {
+        uint32_t height = width * SOURCE_HEIGHT / SOURCE_WIDTH;
+        context.measure("image_scale/scale_to_" + std::to_string(width) + "x" + std::to_string(height), [&]() {
+            bench::keep(imageScale::scaleTo(source, mips, width, height).pixels[0]);
+        });
+    }
+}
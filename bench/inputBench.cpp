@@ -0,0 +1,137 @@
+// Random numbers, menu hit testing and key polling, each done every frame or per apple
+#include <random>
+#include <vector>
+#include "bench.h"
+#include "controller.h"
+#include "gameState.h"
+#include "rng.h"
+
+namespace {
+    // what a board is drawn into, so both generators below do the same work apart from drawing
+    struct DrawnApple {
+        int value;
+        float velX, velY, accY, velAngular;
+    };
+
+    // as the game drew boards before the counter based streams, a distribution per float
+    std::mt19937_64 mt;
+    float randomFloat(float minValue, float maxValue) {
+        const int v = 0x8'0000;
+        std::uniform_int_distribution unidist(0, v);
+        return static_cast<float>(unidist(mt)) / static_cast<float>(v) * (maxValue - minValue) + minValue;
+    }
+
+    void drawBoardMt(std::vector<DrawnApple>& apples, int sizeX, int sizeY) {
+        std::uniform_int_distribution appleDistr(1, 9);
+        int valueSum = 0;
+        for (DrawnApple& apple : apples) {
+            apple.value = appleDistr(mt);
+            valueSum += apple.value;
+            apple.velX = randomFloat(-247.1f, 247.1f);
+            apple.velY = randomFloat(-643.1f, -656.9f);
+            apple.accY = randomFloat(1261.2f, 1395.3f);
+            apple.velAngular = randomFloat(-82.8f, 82.8f);
+        }
+        while (valueSum % 10 != 0) {
+            int x = std::uniform_int_distribution(0, sizeX - 1)(mt);
+            int y = std::uniform_int_distribution(0, sizeY - 1)(mt);
+            if (apples[y * sizeX + x].value != 1) {
+                apples[y * sizeX + x].value--;
+                valueSum--;
+            }
+        }
+    }
+
+    void drawBoardStreams(std::vector<DrawnApple>& apples, int sizeX, int sizeY, uint64_t seed) {
+        rng::Stream boardRng(seed);
+        rng::Stream appleRngs = boardRng.split(0);
+        int valueSum = 0;
+        for (size_t i = 0; i < apples.size(); i++) {
+            rng::Stream appleRng = appleRngs.split(i);
+            DrawnApple& apple = apples[i];
+            apple.value = appleRng.nextInt(1, 9);
+            valueSum += apple.value;
+            apple.velX = appleRng.nextFloat(-247.1f, 247.1f);
+            apple.velY = appleRng.nextFloat(-656.9f, -643.1f);
+            apple.accY = appleRng.nextFloat(1261.2f, 1395.3f);
+            apple.velAngular = appleRng.nextFloat(-82.8f, 82.8f);
+        }
+        rng::Stream fixUpRng = boardRng.split(1);
+        while (valueSum % 10 != 0) {
+            int x = fixUpRng.nextInt(0, sizeX - 1);
+            int y = fixUpRng.nextInt(0, sizeY - 1);
+            if (apples[y * sizeX + x].value != 1) {
+                apples[y * sizeX + x].value--;
+                valueSum--;
+            }
+        }
+    }
+} // namespace
+
+BENCH_SUITE(rng) {
+    const size_t COUNT = 1024;
+    std::vector<float> floats(COUNT);
+    rng::Stream stream(1);
+
+    context.measure("rng/next_float_x1024", [&]() {
+        for (size_t i = 0; i < COUNT; i++) { floats[i] = stream.nextFloat(-1.0f, 1.0f); }
+        bench::keep(floats[COUNT - 1]);
+    });
+    context.measure("rng/fill_floats_x1024", [&]() {
+        stream.fillFloats(floats.data(), COUNT, -1.0f, 1.0f);
+        bench::keep(floats[COUNT - 1]);
+    });
+    context.measure("rng/next_int_x1024", [&]() {
+        int32_t sum = 0;
+        for (size_t i = 0; i < COUNT; i++) { sum += stream.nextInt(1, 9); }
+        bench::keep(sum);
+    });
+
+    // the draws of a 32x20 board, the game's generate_board adds placing the apples in chunks
+    std::vector<DrawnApple> apples(32 * 20);
+    context.measure("rng/draw_board_32x20_mt19937", [&]() {
+        drawBoardMt(apples, 32, 20);
+        bench::keep(apples[0].value);
+    });
+    uint64_t seed = 0;
+    context.measure("rng/draw_board_32x20_streams", [&]() {
+        drawBoardStreams(apples, 32, 20, seed++);
+        bench::keep(apples[0].value);
+    });
+}
+
+// every button of every menu against a mouse moving over the window
+BENCH_SUITE(buttons) {
+    std::vector<const gamestate::Button*> buttons = { &gamestate::buttonMainMenuStart, &gamestate::buttonMainMenuHelp,
+        &gamestate::buttonHelpMenuBack, &gamestate::buttonPlayingMenu, &gamestate::buttonPlayingReset,
+        &gamestate::buttonMainMenuReset };
+    for (const gamestate::Button& button : gamestate::mainMenuSettingsButtons) {
+        buttons.push_back(&button);
+    }
+
+    INT position = 0;
+    context.measure("buttons/hover_over_all", [&]() {
+        position = (position + 97) % (1920 * 1080);
+        FLOAT mouseX = static_cast<FLOAT>(position % 1920);
+        FLOAT mouseY = static_cast<FLOAT>(position / 1920);
+        INT hovered = 0;
+        for (const gamestate::Button* button : buttons) {
+            hovered += button->hoverOver(mouseX, mouseY);
+        }
+        bench::keep(hovered);
+    });
+}
+
+// key states of all 256 keys, as every frame polls them
+BENCH_SUITE(controller) {
+    Controller controller;
+    controller.setWindowSize(1920, 1080);
+    bool down = false;
+    context.measure("controller/poll_all_keys", [&]() {
+        down = !down;
+        controller.setKeyDown(VK_LBUTTON, down);
+        controller.setKeyDown('R', !down);
+        controller.pollAllKeys(false);
+        bench::keep(controller.keyJustDown(VK_LBUTTON));
+    });
+}
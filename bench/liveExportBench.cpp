@@ -0,0 +1,48 @@
+// Publishing the live state into a block like the shared memory section: a frame of a game in play
+// with a drag going on, which only writes the header, and a new 1000x1000 board written in full.
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "headless.h"
+#include "liveExport.h"
+
+namespace {
+    struct Block {
+        std::vector<uint64_t> words = std::vector<uint64_t>((liveState::blockSize() + 7) / 8, 0);
+    };
+} // namespace
+
+BENCH_SUITE(liveExport) {
+    for (INT players : { 1, 8 }) {
+        Block block;
+        liveExport::Publisher publisher(block.words.data(), 1);
+        headless::Game game;
+        game.start({ .playerCount = players });
+        // a drag going on, the board published in full on the first frame
+        game.moveTo(game.cellX(2), game.cellY(2));
+        game.press();
+        game.frame();
+        game.moveTo(game.cellX(5), game.cellY(4));
+        game.frame();
+        publisher.frame(game.state);
+        context.measure("live/frame_" + std::to_string(players) + "_players", [&]() {
+            publisher.frame(game.state);
+            bench::keep(block.words[0]);
+        });
+        game.release();
+    }
+
+    // two games taking turns, every frame has the other board to write
+    Block block;
+    liveExport::Publisher publisher(block.words.data(), 1);
+    headless::Game first, second(timeBase::NS_PER_SECOND * 2);
+    const headless::Settings huge = { .appleCountX = gamestate::HUGE_MAX_APPLES, .appleCountY = gamestate::HUGE_MAX_APPLES, .hugeBoard = true };
+    first.start(huge);
+    second.start(huge);
+    bool turn = false;
+    context.measure("live/new_board_" + std::to_string(gamestate::HUGE_MAX_APPLES), [&]() {
+        turn = !turn;
+        publisher.frame(turn ? first.state : second.state);
+        bench::keep(block.words[0]);
+    });
+}
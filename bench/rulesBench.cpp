@@ -0,0 +1,77 @@
+// Move validation of the classic rules specialized from the variant, resolved at runtime per move,
+// and written out by hand as the game had it before there were variants. The first has to cost
+// the same as the last.
+#include <vector>
+#include "bench.h"
+#include "rng.h"
+#include "rules.h"
+
+namespace {
+    struct Move {
+        int first; // in values
+        int count;
+    };
+
+    const int MOVES = 4096;
+
+    struct Moves {
+        std::vector<int> values;
+        std::vector<Move> moves;
+
+        Moves() {
+            rng::Stream random(31);
+            for (int i = 0; i < MOVES; i++) {
+                Move move = { static_cast<int>(values.size()), random.nextInt(1, 8) };
+                for (int a = 0; a < move.count; a++) { values.push_back(random.nextInt(1, 9)); }
+                moves.push_back(move);
+            }
+        }
+    };
+
+    template<typename R>
+    int scoreOf(const Moves& moves, const Move& move) {
+        rules::Selection<R> selection;
+        for (int a = 0; a < move.count; a++) { selection.add(moves.values[move.first + a], a, 0); }
+        return selection.valid() ? selection.score() : 0;
+    }
+} // namespace
+
+BENCH_SUITE(rules) {
+    const Moves moves;
+
+    context.measure("rules/hard_coded_x4096", [&]() {
+        int score = 0;
+        for (const Move& move : moves.moves) {
+            int dragSum = 0, dragCount = 0;
+            for (int a = 0; a < move.count; a++) {
+                dragSum += moves.values[move.first + a];
+                dragCount++;
+            }
+            if (dragSum == 10) { score += dragCount; }
+        }
+        bench::keep(score);
+    });
+
+    context.measure("rules/classic_x4096", [&]() {
+        int score = 0;
+        for (const Move& move : moves.moves) { score += scoreOf<rules::Classic>(moves, move); }
+        bench::keep(score);
+    });
+
+    // the game resolves the variant once per frame, this is the worst case of once per move
+    volatile rules::Variant chosen = rules::Variant::CLASSIC;
+    context.measure("rules/visit_per_move_x4096", [&]() {
+        rules::Variant variant = chosen; // not known at compile time
+        int score = 0;
+        for (const Move& move : moves.moves) {
+            score += rules::visit(variant, [&](auto rules) { return scoreOf<decltype(rules)>(moves, move); });
+        }
+        bench::keep(score);
+    });
+
+    context.measure("rules/lines_x4096", [&]() {
+        int score = 0;
+        for (const Move& move : moves.moves) { score += scoreOf<rules::Lines>(moves, move); }
+        bench::keep(score);
+    });
+}
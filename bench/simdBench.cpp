@@ -0,0 +1,54 @@
+// Bounds selection over apple records at every level the CPU supports, for a chunk as the drag test
+// scans it and for a long run of records; levels the CPU doesn't have aren't measured.
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "gameState.h"
+#include "rng.h"
+#include "simd.h"
+
+namespace {
+    const simd::PointLayout APPLE_POINTS = {
+        .stride = sizeof(gamestate::Apple),
+        .xOffset = offsetof(gamestate::Apple, fixedX),
+        .yOffset = offsetof(gamestate::Apple, fixedY),
+        .skipOffset = offsetof(gamestate::Apple, popped),
+        .unit = gamestate::FALL_UNIT,
+    };
+
+    const char* const LEVEL_KEYS[] = { "scalar", "sse2", "avx2", "avx512" };
+    static_assert(std::size(LEVEL_KEYS) == static_cast<size_t>(simd::Level::COUNT));
+
+    // a board's worth of apples 50 apart, a few popped
+    std::vector<gamestate::Apple> board(size_t count) {
+        rng::Stream random(48);
+        std::vector<gamestate::Apple> apples;
+        for (size_t i = 0; i < count; i++) {
+            apples.emplace_back(random.nextInt(1, 9), static_cast<FLOAT>(i % 16 * 50), static_cast<FLOAT>(i / 16 * 50), random.split(i));
+            if (random.nextInt(0, 9) == 0) { apples.back().pop(); }
+        }
+        return apples;
+    }
+} // namespace
+
+BENCH_SUITE(simdSelect) {
+    const simd::Level supported = simd::supportedLevel();
+    const size_t CHUNK = gamestate::AppleGrid::CHUNK_SIZE * gamestate::AppleGrid::CHUNK_SIZE;
+    for (size_t count : { CHUNK, size_t(65536) }) {
+        const std::vector<gamestate::Apple> apples = board(count);
+        std::vector<uint64_t> selected((count + 63) / 64);
+        // a drag over half the columns of a quarter of the rows
+        const simd::Bounds bounds = { .left = 100.0f, .top = 0.0f, .right = 500.0f, .bottom = count * 50.0f / 64.0f, .margin = 20.0f };
+        for (int level = 0; level <= static_cast<int>(supported); level++) {
+            const std::string name = std::string("simd/select_") + LEVEL_KEYS[level] + "_" + std::to_string(count);
+            simd::setLevel(static_cast<simd::Level>(level));
+            context.measure(name, [&]() {
+                simd::selectInBounds(apples.data(), count, APPLE_POINTS, bounds, selected.data());
+                bench::keep(selected[0]);
+            });
+        }
+    }
+    simd::setLevel(supported);
+}
@@ -0,0 +1,41 @@
+// What a checkpoint costs the frame thread, against serializing the whole game as the frame thread
+// used to. The first stays flat as the board grows.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "headless.h"
+#include "snapshot.h"
+
+BENCH_SUITE(snapshot) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "apples-bench.snapshot";
+    for (INT size : { 17, 250, 1000 }) {
+        if (context.quick() && size > 250) { continue; }
+        const std::string board = std::to_string(size) + "x" + std::to_string(size);
+        headless::Game game;
+        game.start({ .appleCountX = size, .appleCountY = size, .playTime = 900, .hugeBoard = size > gamestate::MAX_APPLES_X });
+
+        std::vector<BYTE> buffer(snapshot::serializedSize(game.state));
+        context.measure("snapshot/serialize/" + board, [&]() {
+            bench::keep(snapshot::serialize(game.state, game.timeNs, buffer.data()));
+        });
+
+        // each checkpoint is written before the next one is timed
+        snapshot::Checkpointer checkpointer(path);
+        const int checkpoints = context.quick() ? 2 : size >= 1000 ? 8 : 32;
+        double best = 0.0;
+        for (int i = 0; i < checkpoints; i++) {
+            checkpointer.waitWritten();
+            game.frame();
+            auto start = std::chrono::steady_clock::now();
+            checkpointer.tryCheckpoint(game.state, game.timeNs);
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            best = i == 0 ? ns : std::min(best, ns);
+        }
+        checkpointer.waitWritten();
+        context.report("snapshot/checkpoint_frame_thread/" + board, best, checkpoints);
+    }
+    std::filesystem::remove(path);
+}
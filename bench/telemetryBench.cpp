@@ -0,0 +1,39 @@
+// What recording an event costs the frame thread, with a session open and its writer thread
+// running: into a ring with room, and into a full one that drops it. Both have to stay well under
+// 50 ns, a frame records a handful of events at most.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include "bench.h"
+#include "telemetry.h"
+
+BENCH_SUITE(telemetry) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "apples-telemetry-bench";
+    const uint64_t BATCH = 1024; // a quarter of the ring
+    const int SESSIONS = context.quick() ? 1 : 8;
+    std::filesystem::remove_all(directory);
+
+    uint64_t timeUs = 0;
+    auto recordBatch = [&timeUs, BATCH]() {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < BATCH; i++) {
+            telemetry::record({ .timeUs = timeUs++, .type = telemetry::EventType::POP, .width = 2, .height = 1, .count = 2, .value = 10 });
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BATCH;
+    };
+
+    // a new session per batch, the writer only empties the ring every 100 ms
+    double bestRoom = 0.0, bestFull = 0.0;
+    for (int session = 0; session < SESSIONS; session++) {
+        if (!telemetry::start(directory)) { return; }
+        double room = recordBatch();
+        while (telemetry::droppedEvents() == 0) { telemetry::record({ .timeUs = timeUs++, .type = telemetry::EventType::DRAG_START }); }
+        double full = recordBatch();
+        telemetry::stop();
+        bestRoom = session == 0 ? room : std::min(bestRoom, room);
+        bestFull = session == 0 ? full : std::min(bestFull, full);
+    }
+    context.report("telemetry/record", bestRoom, BATCH);
+    context.report("telemetry/record_ring_full", bestFull, BATCH);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,33 @@
+// A frame of a versus game of 1 to 8 players, every board busy with falling apples and a drag.
+// Boards are simulated in parallel, so on enough cores the frame grows less than the player count.
+#include <string>
+#include "bench.h"
+#include "headless.h"
+
+BENCH_SUITE(versus) {
+    for (INT players = 1; players <= gamestate::MAX_PLAYERS; players++) {
+        headless::Game game;
+        game.start({ .playerCount = players, .playTime = 900 });
+        for (INT i = 0; i < players; i++) {
+            gamestate::GameState::SingletonPlay& play = game.state.players[i];
+            play.apples.forEach([&](gamestate::Apple& apple, INT x, INT y) {
+                apple.pop();
+                play.fallingApples.push_back({ x, y });
+            });
+        }
+
+        // dragging over the first board, the frames are short so apples don't fall out of sight
+        const gamestate::GameState::SingletonPlay& first = game.state.players[0];
+        game.moveTo(first.area.left + 2.0f, first.area.top + 2.0f);
+        game.press();
+        game.frame(1000);
+        bool far = false;
+        context.measure("versus_frame/" + std::to_string(players) + "_boards", [&]() {
+            far = !far;
+            game.moveTo(far ? first.area.right - 2.0f : first.area.left + 40.0f, far ? first.area.bottom - 2.0f : first.area.top + 40.0f);
+            game.frame(1000);
+            bench::keep(first.fallingApples.size());
+        });
+        game.release();
+    }
+}
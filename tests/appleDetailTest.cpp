@@ -0,0 +1,114 @@
+// Apple detail tiers: the thresholds, falling apples never drawn with more detail than settled ones,
+// and the tiers real boards get at different board and window sizes and zooms.
+#include "appleDetail.h"
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    using appleDetail::Detail;
+
+    void checkThresholds() {
+        CHECK(appleDetail::select(400.0f, false) == Detail::FULL);
+        CHECK(appleDetail::select(appleDetail::SIMPLE_APPLE_PIXELS, false) == Detail::FULL);
+        CHECK(appleDetail::select(39.9f, false) == Detail::SIMPLE);
+        CHECK(appleDetail::select(appleDetail::FLAT_APPLE_PIXELS, false) == Detail::SIMPLE);
+        CHECK(appleDetail::select(17.9f, false) == Detail::FLAT);
+        CHECK(appleDetail::select(0.0f, false) == Detail::FLAT);
+
+        // falling ones as if half the size
+        CHECK(appleDetail::select(80.0f, true) == Detail::FULL);
+        CHECK(appleDetail::select(79.9f, true) == Detail::SIMPLE);
+        CHECK(appleDetail::select(36.0f, true) == Detail::SIMPLE);
+        CHECK(appleDetail::select(35.9f, true) == Detail::FLAT);
+
+        // smaller never gets more detail, falling never more than settled
+        int wrong = 0;
+        Detail previous = Detail::FULL;
+        for (FLOAT pixels = 300.0f; pixels >= 0.0f; pixels -= 0.25f) {
+            Detail settled = appleDetail::select(pixels, false);
+            wrong += settled < previous;
+            wrong += appleDetail::select(pixels, true) < settled;
+            previous = settled;
+        }
+        CHECK_EQ(wrong, 0);
+
+        // the cheaper tier is cheaper
+        CHECK(appleDetail::DRAW_CALLS[0] > appleDetail::DRAW_CALLS[1]);
+        CHECK(appleDetail::DRAW_CALLS[1] > appleDetail::DRAW_CALLS[2]);
+    }
+
+    Detail settledDetail(const headless::Game& game) {
+        return appleDetail::select(appleDetail::applePixels(game.state, game.state.players[0]), false);
+    }
+
+    void resize(headless::Game& game, INT width, INT height) {
+        game.controller.setWindowSize(width, height);
+        game.frame();
+    }
+
+    void checkBoards() {
+        // the default board is full detail down to half of full HD
+        headless::Game game;
+        game.start({});
+        CHECK(settledDetail(game) == Detail::FULL);
+        resize(game, 960, 540);
+        CHECK(settledDetail(game) == Detail::FULL);
+        resize(game, 480, 270);
+        CHECK(settledDetail(game) == Detail::SIMPLE);
+
+        // the biggest regular board is simpler in small windows
+        headless::Game big;
+        big.start({ .appleCountX = gamestate::MAX_APPLES_X, .appleCountY = gamestate::MAX_APPLES_Y });
+        CHECK(settledDetail(big) == Detail::FULL);
+        appleDetail::Cost full = appleDetail::boardCost(big.state, big.state.players[0]);
+        CHECK_EQ(full.apples[0], gamestate::MAX_APPLES_X * gamestate::MAX_APPLES_Y);
+        CHECK_EQ(full.drawCalls, full.apples[0] * appleDetail::DRAW_CALLS[0]);
+        resize(big, 960, 540);
+        CHECK(settledDetail(big) == Detail::SIMPLE);
+        resize(big, 480, 270);
+        CHECK(settledDetail(big) == Detail::FLAT);
+        appleDetail::Cost flat = appleDetail::boardCost(big.state, big.state.players[0]);
+        CHECK_EQ(flat.apples[2], gamestate::MAX_APPLES_X * gamestate::MAX_APPLES_Y);
+        CHECK_EQ(flat.drawCalls * appleDetail::DRAW_CALLS[0], full.drawCalls * appleDetail::DRAW_CALLS[2]);
+
+        // falling apples are counted with their own tier while they're in sight
+        resize(big, 1920, 1080);
+        CHECK(big.popAny());
+        appleDetail::Cost popped = appleDetail::boardCost(big.state, big.state.players[0]);
+        const INT falling = static_cast<INT>(big.state.players[0].fallingApples.size());
+        CHECK(falling > 0);
+        CHECK_EQ(popped.apples[0] + popped.apples[1] + popped.apples[2], gamestate::MAX_APPLES_X * gamestate::MAX_APPLES_Y);
+        CHECK_EQ(popped.apples[static_cast<size_t>(appleDetail::select(appleDetail::applePixels(big.state, big.state.players[0]), true))] >= falling, true);
+        for (int frame = 0; frame < 600; frame++) { big.frame(); }
+        appleDetail::Cost fallen = appleDetail::boardCost(big.state, big.state.players[0]);
+        CHECK_EQ(fallen.apples[0] + fallen.apples[1] + fallen.apples[2], gamestate::MAX_APPLES_X * gamestate::MAX_APPLES_Y - falling);
+
+        // a huge board zoomed out is simple in full HD and flat in a smaller window, and full detail zoomed
+        // in, with fewer apples in the view
+        headless::Game huge;
+        huge.start({ .appleCountX = 400, .appleCountY = 400, .hugeBoard = true });
+        const gamestate::GameState::SingletonPlay& play = huge.state.players[0];
+        CHECK(settledDetail(huge) == Detail::SIMPLE);
+        resize(huge, 960, 540);
+        CHECK(settledDetail(huge) == Detail::FLAT);
+        appleDetail::Cost zoomedOut = appleDetail::boardCost(huge.state, play);
+        CHECK(zoomedOut.apples[2] > 0);
+        CHECK_EQ(zoomedOut.apples[0] + zoomedOut.apples[1], 0);
+        resize(huge, 1920, 1080);
+        huge.moveTo((play.area.left + play.area.right) / 2.0f, (play.area.top + play.area.bottom) / 2.0f);
+        for (int step = 0; step < 20 && settledDetail(huge) != Detail::FULL; step++) {
+            huge.controller.addWheelDelta(WHEEL_DELTA);
+            huge.frame();
+        }
+        CHECK(settledDetail(huge) == Detail::FULL);
+        appleDetail::Cost zoomedIn = appleDetail::boardCost(huge.state, play);
+        CHECK(zoomedIn.apples[0] > 0);
+        CHECK(zoomedIn.apples[0] < zoomedOut.apples[2]);
+    }
+} // namespace
+
+int main() {
+    checkThresholds();
+    checkBoards();
+    return check::result();
+}
@@ -0,0 +1,154 @@
+// Board library: every board of a built library is the board its seed generates, solved and sorted
+// into the difficulty it's listed under, and the same arguments build the same file. The daily
+// board is the same with or without a library.
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "boardLibrary.h"
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    const std::filesystem::path DIRECTORY = std::filesystem::temp_directory_path() / "apples-board-library-test";
+    const std::filesystem::path PATH = DIRECTORY / "assets" / "boards.lib";
+    const int CANDIDATES = 40;
+
+    std::vector<char> readFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void checkBoards(const boards::Library& library, const boards::BuildSpec& spec) {
+        size_t total = 0;
+        for (int d = 0; d < static_cast<int>(boards::Difficulty::COUNT); d++) {
+            const boards::Difficulty difficulty = static_cast<boards::Difficulty>(d);
+            size_t count = library.boardCount(spec.sizeX, spec.sizeY, spec.variant, difficulty);
+            total += count;
+            int wrong = 0;
+            for (size_t choice = 0; choice < count; choice++) {
+                boards::BoardInfo board;
+                CHECK(library.pick(spec.sizeX, spec.sizeY, spec.variant, difficulty, choice, board));
+                std::vector<uint8_t> values(static_cast<size_t>(spec.sizeX) * spec.sizeY);
+                rules::visit(spec.variant, [&](auto variant) {
+                    using R = decltype(variant);
+                    boards::generateValues<R>(spec.sizeX, spec.sizeY, board.seed, values.data());
+                    boards::SolverResult solved = boards::solveGreedy<R>(spec.sizeX, spec.sizeY, values.data());
+                    wrong += solved.score != board.solverScore ||
+                        boards::classify(solved.clearedApples, spec.sizeX * spec.sizeY) != difficulty;
+                });
+                wrong += !std::equal(values.begin(), values.end(), board.values);
+            }
+            CHECK_EQ(wrong, 0);
+
+            // choices beyond the group wrap around
+            boards::BoardInfo first, wrapped;
+            if (count > 0) {
+                CHECK(library.pick(spec.sizeX, spec.sizeY, spec.variant, difficulty, 0, first));
+                CHECK(library.pick(spec.sizeX, spec.sizeY, spec.variant, difficulty, count, wrapped));
+                CHECK_EQ(first.seed, wrapped.seed);
+            }
+        }
+        CHECK_EQ(total, static_cast<size_t>(spec.candidates));
+    }
+
+    void checkBuild() {
+        const std::vector<boards::BuildSpec> specs = {
+            { .sizeX = 8, .sizeY = 6, .variant = rules::Variant::CLASSIC, .candidates = CANDIDATES },
+            { .sizeX = 8, .sizeY = 6, .variant = rules::Variant::LINES, .candidates = CANDIDATES },
+            { .sizeX = gamestate::DEFAULT_APPLES_X, .sizeY = gamestate::DEFAULT_APPLES_Y, .variant = rules::Variant::CLASSIC,
+                .candidates = CANDIDATES },
+        };
+        CHECK(boards::build(PATH, specs, 3));
+        std::vector<char> built = readFile(PATH);
+        CHECK(boards::build(PATH, specs, 3));
+        CHECK(readFile(PATH) == built);
+
+        boards::Library library;
+        CHECK(library.open(PATH));
+        for (const boards::BuildSpec& spec : specs) { checkBoards(library, spec); }
+        CHECK_EQ(library.boardCount(9, 6, rules::Variant::CLASSIC, boards::Difficulty::NORMAL), 0u);
+        boards::BoardInfo board;
+        CHECK(!library.pick(8, 6, rules::Variant::TWENTY, boards::Difficulty::EASY, 0, board));
+
+        // not a library
+        std::ofstream(DIRECTORY / "other.lib") << "no boards in here";
+        boards::Library other;
+        CHECK(!other.open(DIRECTORY / "other.lib"));
+        CHECK(!other.open(DIRECTORY / "missing.lib"));
+
+        // a board count and a values offset big enough to overflow the size checks
+        auto damaged = [&](size_t offset, uint64_t value) {
+            std::vector<char> bytes = built;
+            std::memcpy(bytes.data() + offset, &value, sizeof(value));
+            std::ofstream(DIRECTORY / "damaged.lib", std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            return DIRECTORY / "damaged.lib";
+        };
+        boards::Library hugeCount;
+        CHECK(!hugeCount.open(damaged(16, 0x2000000000000024ull)));
+        uint32_t groupCount;
+        std::memcpy(&groupCount, built.data() + 8, sizeof(groupCount));
+        boards::Library hugeOffset;
+        CHECK(hugeOffset.open(damaged(24 + groupCount * 24 + 8, ~0ull - 7)));
+        size_t picked = 0;
+        for (const boards::BuildSpec& spec : specs) {
+            for (int d = 0; d < static_cast<int>(boards::Difficulty::COUNT); d++) {
+                const boards::Difficulty difficulty = static_cast<boards::Difficulty>(d);
+                for (size_t choice = 0; choice < hugeOffset.boardCount(spec.sizeX, spec.sizeY, spec.variant, difficulty); choice++) {
+                    picked += hugeOffset.pick(spec.sizeX, spec.sizeY, spec.variant, difficulty, choice, board);
+                }
+            }
+        }
+        CHECK_EQ(picked, specs.size() * CANDIDATES - 1);
+    }
+
+    UINT64 startedSeed(gamestate::GameState::BoardChoice choice) {
+        headless::Game game;
+        game.start({ .boardChoice = choice });
+        CHECK(game.state.mode == gamestate::GameState::Mode::PLAYING);
+        return game.state.players[0].boardSeed;
+    }
+
+    // the library of checkBuild has boards of the default settings
+    void checkDaily() {
+        auto today = std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+        const UINT64 daily = boards::dailySeed(today.time_since_epoch().count());
+        CHECK_EQ(startedSeed(gamestate::GameState::BoardChoice::DAILY), daily);
+
+        // the game loads the library from where it runs
+        const std::filesystem::path was = std::filesystem::current_path();
+        std::filesystem::current_path(DIRECTORY);
+        gameLogic::setup();
+        CHECK_EQ(startedSeed(gamestate::GameState::BoardChoice::DAILY), daily);
+
+        boards::Library library;
+        CHECK(library.open(PATH));
+        boards::BoardInfo easy;
+        CHECK(library.pick(gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y, rules::Variant::CLASSIC,
+            boards::Difficulty::EASY, 0, easy));
+        const UINT64 easySeed = startedSeed(gamestate::GameState::BoardChoice::EASY);
+        bool fromLibrary = false;
+        size_t count = library.boardCount(gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y, rules::Variant::CLASSIC,
+            boards::Difficulty::EASY);
+        for (size_t choice = 0; choice < count; choice++) {
+            library.pick(gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y, rules::Variant::CLASSIC,
+                boards::Difficulty::EASY, choice, easy);
+            fromLibrary = fromLibrary || easy.seed == easySeed;
+        }
+        CHECK(fromLibrary);
+
+        gameLogic::free();
+        std::filesystem::current_path(was);
+    }
+} // namespace
+
+int main() {
+    std::filesystem::remove_all(DIRECTORY);
+    std::filesystem::create_directories(PATH.parent_path());
+    checkBuild();
+    checkDaily();
+    std::filesystem::remove_all(DIRECTORY);
+    return check::result();
+}
@@ -0,0 +1,157 @@
+// ChunkedGrid against a flat row major grid: cell access, iteration and the chunk ranges culling
+// relies on, and the culled range of a huge board's view against testing every apple
+#include <set>
+#include <utility>
+#include <vector>
+#include "board.h"
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    using Grid = gamestate::ChunkedGrid<int>;
+    const int CHUNK = Grid::CHUNK_SIZE;
+
+    int cellValue(int x, int y) { return y * 10007 + x; }
+
+    void checkAccessAndIteration(int sizeX, int sizeY) {
+        std::vector<int> flat(static_cast<size_t>(sizeX) * sizeY);
+        for (int y = 0; y < sizeY; y++) {
+            for (int x = 0; x < sizeX; x++) { flat[y * sizeX + x] = cellValue(x, y); }
+        }
+
+        Grid grid, parallel;
+        grid.generate(sizeX, sizeY, cellValue);
+        parallel.generateParallel(sizeX, sizeY, cellValue);
+        CHECK_EQ(grid.sizeX(), sizeX);
+        CHECK_EQ(grid.sizeY(), sizeY);
+
+        int wrong = 0;
+        for (int y = 0; y < sizeY; y++) {
+            for (int x = 0; x < sizeX; x++) {
+                wrong += grid.at(x, y) != flat[y * sizeX + x];
+                wrong += parallel.at(gamestate::CellXY{ x, y }) != flat[y * sizeX + x];
+            }
+        }
+        CHECK_EQ(wrong, 0);
+
+        // every cell once, with its own coordinates
+        std::vector<int> visits(flat.size());
+        grid.forEach([&](int& cell, int x, int y) {
+            wrong += cell != flat[y * sizeX + x];
+            visits[y * sizeX + x]++;
+        });
+        CHECK_EQ(wrong, 0);
+        CHECK(std::all_of(visits.begin(), visits.end(), [](int count) { return count == 1; }));
+
+        // chunks tile the grid row major
+        int chunksX = (sizeX + CHUNK - 1) / CHUNK;
+        int chunksY = (sizeY + CHUNK - 1) / CHUNK;
+        for (int i = 0; i < chunksX * chunksY; i++) {
+            const Grid::Chunk& chunk = grid.chunk(i);
+            CHECK_EQ(chunk.originX, i % chunksX * CHUNK);
+            CHECK_EQ(chunk.originY, i / chunksX * CHUNK);
+            CHECK_EQ(chunk.cells.size(), static_cast<size_t>(chunk.sizeX * chunk.sizeY));
+        }
+    }
+
+    // The range's cells are visited once each, anything else visited is in a chunk the range touches
+    void checkRange(const Grid& grid, int minX, int minY, int maxX, int maxY) {
+        std::set<std::pair<int, int>> visited;
+        int duplicates = 0, outside = 0, wrong = 0;
+        grid.forEachInChunksOver(minX, minY, maxX, maxY, [&](const int& cell, int x, int y) {
+            duplicates += !visited.insert({ x, y }).second;
+            outside += x / CHUNK < minX / CHUNK || x / CHUNK > maxX / CHUNK || y / CHUNK < minY / CHUNK || y / CHUNK > maxY / CHUNK;
+            wrong += cell != cellValue(x, y);
+        });
+        CHECK_EQ(duplicates, 0);
+        CHECK_EQ(outside, 0);
+        CHECK_EQ(wrong, 0);
+
+        int missing = 0;
+        for (int y = std::max(minY, 0); y <= std::min(maxY, grid.sizeY() - 1); y++) {
+            for (int x = std::max(minX, 0); x <= std::min(maxX, grid.sizeX() - 1); x++) {
+                missing += !visited.count({ x, y });
+            }
+        }
+        CHECK_EQ(missing, 0);
+
+        // whole chunks see the same cells
+        size_t chunkCells = 0;
+        grid.forEachChunkOver(minX, minY, maxX, maxY, [&](const Grid::Chunk& chunk) { chunkCells += chunk.cells.size(); });
+        CHECK_EQ(chunkCells, visited.size());
+    }
+
+    void checkRanges() {
+        Grid grid;
+        grid.generate(100, 37, cellValue);
+        rng::Stream random(26);
+        for (int i = 0; i < 500; i++) {
+            // partly or wholly off the grid too
+            int minX = random.nextInt(-20, 110), maxX = minX + random.nextInt(-2, 60);
+            int minY = random.nextInt(-20, 45), maxY = minY + random.nextInt(-2, 30);
+            checkRange(grid, minX, minY, maxX, maxY);
+        }
+        checkRange(grid, 0, 0, 99, 36);
+        checkRange(grid, 15, 15, 16, 16); // corner of four chunks
+    }
+
+    // what the view of a huge board draws: apples of the culled range whose square touches the view
+    std::set<std::pair<int, int>> drawn(const gamestate::GameState& gameState, const gamestate::GameState::SingletonPlay& play, bool culled) {
+        D2D1_RECT_F view = play.visibleBoardArea();
+        FLOAT half = gameState.appleSize / 2.0f;
+        std::set<std::pair<int, int>> apples;
+        auto test = [&](const gamestate::Apple& apple, INT x, INT y) {
+            if (apple.posX() + half >= view.left && apple.posX() - half <= view.right &&
+                apple.posY() + half >= view.top && apple.posY() - half <= view.bottom) {
+                apples.insert({ x, y });
+            }
+        };
+        if (culled) {
+            INT minX, minY, maxX, maxY;
+            gameState.cellsOver(play, view, minX, minY, maxX, maxY);
+            play.apples.forEachInChunksOver(minX, minY, maxX, maxY, test);
+        } else {
+            for (INT y = 0; y < play.apples.sizeY(); y++) {
+                for (INT x = 0; x < play.apples.sizeX(); x++) { test(play.apples.at(x, y), x, y); }
+            }
+        }
+        return apples;
+    }
+
+    void checkCulling() {
+        headless::Game game;
+        game.start({ .appleCountX = 300, .appleCountY = 170, .hugeBoard = true });
+        const gamestate::GameState::SingletonPlay& play = game.state.players[0];
+        CHECK(play.zoomedIn());
+        const FLOAT startX = play.viewCenterX, startY = play.viewCenterY;
+
+        // zoomed in and out around the middle, then panned around with the arrows
+        game.moveTo(1100.0f, 500.0f);
+        for (INT step = 0; step < 24; step++) {
+            if (step < 4) {
+                game.controller.addWheelDelta(WHEEL_DELTA);
+            } else if (step < 8) {
+                game.controller.addWheelDelta(-WHEEL_DELTA);
+            }
+            UINT8 arrow = step < 14 ? VK_RIGHT : step < 19 ? VK_DOWN : step < 21 ? VK_LEFT : VK_UP;
+            game.press(arrow);
+            game.frame(timeBase::NS_PER_SECOND / 4);
+            game.release(arrow);
+
+            std::set<std::pair<int, int>> culled = drawn(game.state, play, true);
+            CHECK(!culled.empty());
+            CHECK(culled.size() < static_cast<size_t>(play.apples.sizeX()) * play.apples.sizeY() / 8);
+            CHECK(culled == drawn(game.state, play, false));
+        }
+        CHECK(play.viewCenterX != startX && play.viewCenterY != startY);
+    }
+} // namespace
+
+int main() {
+    for (auto [x, y] : { std::pair{ 1, 1 }, { 15, 17 }, { 16, 16 }, { 17, 33 }, { 100, 37 }, { 64, 64 } }) {
+        checkAccessAndIteration(x, y);
+    }
+    checkRanges();
+    checkCulling();
+    return check::result();
+}
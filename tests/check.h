@@ -0,0 +1,40 @@
+// Checks for the tests. Every test is an executable of its own, a failed check is printed with
+// where it failed and the test goes on, main returns check::result() so ctest sees the failures.
+#pragma once
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace check {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& what) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what.c_str());
+        failures()++;
+    }
+
+    template<typename A, typename B>
+    void equal(const A& a, const B& b, const char* file, int line, const char* aText, const char* bText) {
+        if (a == b) { return; }
+        std::ostringstream what;
+        what << aText << " == " << bText << " (" << a << " vs " << b << ")";
+        fail(file, line, what.str());
+    }
+
+    inline int result() {
+        if (failures() == 0) {
+            std::printf("all checks passed\n");
+            return 0;
+        }
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+} // namespace check
+
+#define CHECK(condition) \
+    do { if (!(condition)) { check::fail(__FILE__, __LINE__, #condition); } } while (false)
+#define CHECK_EQ(a, b) check::equal((a), (b), __FILE__, __LINE__, #a, #b)
@@ -0,0 +1,175 @@
+// DirtyRegionTracker: which items make what dirty, and that merging, banding and clipping never
+// leave a changed part of the screen out while keeping within maxRects
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "check.h"
+#include "dirtyRegions.h"
+#include "rng.h"
+
+namespace {
+    using Rect = DirtyRegionTracker::Rect;
+    const Rect SCREEN = { 0.0f, 0.0f, 1920.0f, 1080.0f };
+    const size_t MAX_RECTS = 8;
+
+    bool contains(const Rect& outer, const Rect& inner) {
+        return outer.left <= inner.left && outer.top <= inner.top && outer.right >= inner.right && outer.bottom >= inner.bottom;
+    }
+
+    Rect clipped(const Rect& rect) {
+        return { std::max(rect.left, SCREEN.left), std::max(rect.top, SCREEN.top),
+            std::min(rect.right, SCREEN.right), std::min(rect.bottom, SCREEN.bottom) };
+    }
+
+    // every changed rect is wholly inside one of the dirty ones, which stay on screen and few
+    void checkCovered(const std::vector<Rect>& dirty, const std::vector<Rect>& changed) {
+        CHECK(dirty.size() <= MAX_RECTS);
+        for (const Rect& rect : dirty) {
+            CHECK(contains(SCREEN, rect));
+            CHECK(rect.area() > 0.0f);
+        }
+        int uncovered = 0;
+        for (const Rect& rect : changed) {
+            Rect visible = clipped(rect);
+            if (visible.area() <= 0.0f) { continue; }
+            uncovered += std::none_of(dirty.begin(), dirty.end(), [&](const Rect& d) { return contains(d, visible); });
+        }
+        CHECK_EQ(uncovered, 0);
+    }
+
+    void checkItemChanges() {
+        DirtyRegionTracker tracker(SCREEN, MAX_RECTS);
+        const Rect button = { 720.0f, 560.0f, 1200.0f, 700.0f };
+        const Rect timer = { 100.0f, 100.0f, 300.0f, 160.0f };
+
+        // nothing drawn yet, the first frame is all dirty
+        tracker.addItem(1, button, 0);
+        tracker.addItem(2, timer, 0);
+        const std::vector<Rect>* dirty = &tracker.finishFrame();
+        CHECK(tracker.fullRedraw());
+        CHECK_EQ(dirty->size(), 1u);
+        CHECK(contains((*dirty)[0], SCREEN));
+
+        // the same items, nothing to do
+        tracker.addItem(2, timer, 0);
+        tracker.addItem(1, button, 0);
+        dirty = &tracker.finishFrame();
+        CHECK(!tracker.fullRedraw());
+        CHECK(dirty->empty());
+        CHECK_EQ(tracker.dirtyArea(), 0.0f);
+
+        // hover changes the button's look only, the timer ticks: two separate rects
+        tracker.addItem(1, button, 1);
+        tracker.addItem(2, timer, 1);
+        dirty = &tracker.finishFrame();
+        CHECK_EQ(dirty->size(), 2u);
+        checkCovered(*dirty, { button, timer });
+        CHECK_EQ(tracker.dirtyArea(), button.area() + timer.area());
+        // a usual frame redraws little of the screen
+        CHECK(tracker.dirtyArea() < 0.05f * SCREEN.area());
+
+        // moved, old and new place
+        const Rect moved = { 130.0f, 110.0f, 330.0f, 170.0f };
+        tracker.addItem(1, button, 1);
+        tracker.addItem(2, moved, 1);
+        dirty = &tracker.finishFrame();
+        checkCovered(*dirty, { timer, moved });
+        CHECK(tracker.dirtyArea() < timer.united(moved).area() + 1.0f);
+
+        // removed and added
+        const Rect apple = { 1500.0f, 900.0f, 1560.0f, 960.0f };
+        tracker.addItem(1, button, 1);
+        tracker.addItem(3, apple, 0);
+        dirty = &tracker.finishFrame();
+        checkCovered(*dirty, { moved, apple });
+        for (const Rect& rect : *dirty) { CHECK(!rect.intersects(button)); }
+
+        // invalidated by hand, partly off screen
+        const Rect offScreen = { -50.0f, 1000.0f, 40.0f, 1200.0f };
+        tracker.addItem(1, button, 1);
+        tracker.addItem(3, apple, 0);
+        tracker.invalidate(offScreen);
+        dirty = &tracker.finishFrame();
+        CHECK_EQ(dirty->size(), 1u);
+        checkCovered(*dirty, { offScreen });
+        CHECK_EQ(tracker.dirtyArea(), clipped(offScreen).area());
+
+        tracker.addItem(1, button, 1);
+        tracker.addItem(3, apple, 0);
+        tracker.invalidateAll();
+        tracker.finishFrame();
+        CHECK(tracker.fullRedraw());
+        CHECK_EQ(tracker.dirtyArea(), SCREEN.area());
+    }
+
+    // Random frames of items that move, change, appear and disappear against the list of rects
+    // that changed, through the pairwise merging and, with many rects, the banding
+    void checkRandomFrames() {
+        DirtyRegionTracker tracker(SCREEN, MAX_RECTS);
+        rng::Stream random(27);
+        struct Item {
+            Rect bounds;
+            uint64_t state;
+            bool shown;
+        };
+        std::vector<Item> items(300);
+        for (Item& item : items) {
+            float x = random.nextFloat(-100.0f, 1950.0f), y = random.nextFloat(-100.0f, 1100.0f);
+            item = { { x, y, x + random.nextFloat(5.0f, 120.0f), y + random.nextFloat(5.0f, 120.0f) }, 0, random.nextInt(0, 1) == 1 };
+        }
+        for (size_t i = 0; i < items.size(); i++) {
+            if (items[i].shown) { tracker.addItem(i, items[i].bounds, items[i].state); }
+        }
+        tracker.finishFrame();
+
+        for (int frame = 0; frame < 400; frame++) {
+            // from a couple of changes to most items changing
+            int changes = frame % 4 == 0 ? random.nextInt(50, 300) : random.nextInt(0, 6);
+            const std::vector<Item> before = items;
+            for (int c = 0; c < changes; c++) {
+                Item& item = items[random.nextInt(0, static_cast<int32_t>(items.size()) - 1)];
+                switch (random.nextInt(0, 2)) {
+                case 0: {
+                    float dx = random.nextFloat(-40.0f, 40.0f), dy = random.nextFloat(-40.0f, 40.0f);
+                    item.bounds = { item.bounds.left + dx, item.bounds.top + dy, item.bounds.right + dx, item.bounds.bottom + dy };
+                    break;
+                }
+                case 1:
+                    item.state++;
+                    break;
+                default:
+                    item.shown = !item.shown;
+                    break;
+                }
+            }
+            // what was on screen and what is now, for every item that looks different
+            std::vector<Rect> changed;
+            for (size_t i = 0; i < items.size(); i++) {
+                const Item& was = before[i];
+                const Item& is = items[i];
+                if (was.shown == is.shown && (!is.shown || (was.state == is.state &&
+                    std::memcmp(&was.bounds, &is.bounds, sizeof(Rect)) == 0))) {
+                    continue;
+                }
+                if (was.shown) { changed.push_back(was.bounds); }
+                if (is.shown) { changed.push_back(is.bounds); }
+            }
+            for (size_t i = 0; i < items.size(); i++) {
+                if (items[i].shown) { tracker.addItem(i, items[i].bounds, items[i].state); }
+            }
+
+            const std::vector<Rect>& dirty = tracker.finishFrame();
+            checkCovered(dirty, changed);
+            if (changed.empty()) { CHECK(dirty.empty()); }
+            float area = 0.0f;
+            for (const Rect& rect : dirty) { area += rect.area(); }
+            CHECK_EQ(tracker.dirtyArea(), area);
+        }
+    }
+} // namespace
+
+int main() {
+    checkItemChanges();
+    checkRandomFrames();
+    return check::result();
+}
@@ -0,0 +1,114 @@
+// Drag scan: on every board size compiled for, the fixed size path selects exactly the apples the
+// runtime size path selects, in the same order, and the apples a plain scan of the board finds, over
+// random drags reaching past the board's edges with popped apples falling through the board.
+#include <algorithm>
+#include <cstdio>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "check.h"
+#include "dragScan.h"
+#include "headless.h"
+
+namespace {
+    using gamestate::Apple;
+
+    struct Hit {
+        const Apple* apple;
+        INT x, y;
+
+        bool operator==(const Hit&) const = default;
+        bool operator<(const Hit& other) const { return y != other.y ? y < other.y : x < other.x; }
+    };
+
+    template<typename Extents>
+    std::vector<Hit> select(gamestate::AppleGrid& apples, INT minX, INT minY, INT maxX, INT maxY, const simd::Bounds& bounds) {
+        std::vector<Hit> hits;
+        dragScan::selectInBounds<Extents>(apples, minX, minY, maxX, maxY, bounds,
+            [&hits](Apple& apple, INT x, INT y) { hits.push_back({ &apple, x, y }); });
+        return hits;
+    }
+
+    // every cell of the board, row by row
+    std::vector<Hit> reference(const gamestate::AppleGrid& apples, const simd::Bounds& bounds) {
+        std::vector<Hit> hits;
+        for (INT y = 0; y < apples.sizeY(); y++) {
+            for (INT x = 0; x < apples.sizeX(); x++) {
+                const Apple& apple = apples.at(x, y);
+                if (!apple.popped && apple.posX() + bounds.margin >= bounds.left && apple.posX() - bounds.margin <= bounds.right &&
+                    apple.posY() + bounds.margin >= bounds.top && apple.posY() - bounds.margin <= bounds.bottom) {
+                    hits.push_back({ &apple, x, y });
+                }
+            }
+        }
+        return hits;
+    }
+
+    template<typename Extents>
+    void checkSize(Extents) {
+        headless::Game game;
+        game.start({ .appleCountX = Extents::SIZE_X, .appleCountY = Extents::SIZE_Y });
+        gamestate::GameState::SingletonPlay& play = game.state.players[0];
+        const FLOAT appleSize = game.state.appleSize;
+
+        bool fixed = false;
+        dragScan::visitExtents(play.apples, [&fixed](auto extents) { fixed = std::is_same_v<decltype(extents), Extents>; });
+        CHECK(fixed);
+
+        // a fifth of the apples popped and somewhere on their way down
+        rng::Stream random(50);
+        play.apples.forEach([&](Apple& apple, INT, INT) {
+            if (random.nextInt(0, 4) == 0) {
+                apple.pop();
+                apple.fixedY += random.nextInt(0, 1 << 24);
+            }
+        });
+
+        int cases = 0, differing = 0, wrong = 0;
+        size_t selected = 0;
+        for (int round = 0; round < 5000; round++) {
+            // corners up to a few cells off the board, margins up to nearly half an apple
+            const FLOAT left = play.appleMinX + random.nextFloat(-3.0f, Extents::SIZE_X + 3.0f) * appleSize;
+            const FLOAT top = play.appleMinY + random.nextFloat(-3.0f, Extents::SIZE_Y + 3.0f) * appleSize;
+            const D2D1_RECT_F rect = D2D1::RectF(left, top, left + random.nextFloat(0.0f, Extents::SIZE_X * 0.5f) * appleSize,
+                top + random.nextFloat(0.0f, Extents::SIZE_Y * 0.5f) * appleSize);
+            const simd::Bounds bounds = {
+                .left = rect.left, .top = rect.top, .right = rect.right, .bottom = rect.bottom,
+                .margin = round % 2 == 0 ? 0.05f * appleSize : random.nextFloat(0.0f, 0.45f * appleSize),
+            };
+            INT minX, minY, maxX, maxY;
+            game.state.cellsOver(play, rect, minX, minY, maxX, maxY);
+
+            std::vector<Hit> fixedHits = select<Extents>(play.apples, minX, minY, maxX, maxY, bounds);
+            const std::vector<Hit> runtimeHits = select<dragScan::RuntimeExtents>(play.apples, minX, minY, maxX, maxY, bounds);
+            differing += fixedHits != runtimeHits;
+            std::sort(fixedHits.begin(), fixedHits.end());
+            wrong += fixedHits != reference(play.apples, bounds);
+            selected += runtimeHits.size();
+            cases++;
+        }
+        std::printf("%dx%d: %d of %d drags differ from the runtime size path, %d from the reference, %zu apples selected\n",
+            Extents::SIZE_X, Extents::SIZE_Y, differing, cases, wrong, selected);
+        CHECK_EQ(differing, 0);
+        CHECK_EQ(wrong, 0);
+        CHECK(selected > 0);
+    }
+
+    void checkOtherSizes() {
+        // sizes not compiled for take the runtime path
+        for (INT size : { 4, gamestate::DEFAULT_APPLES_X + 1, gamestate::HUGE_MAX_APPLES }) {
+            headless::Game game;
+            game.start({ .appleCountX = size, .appleCountY = gamestate::DEFAULT_APPLES_Y, .hugeBoard = size > gamestate::MAX_APPLES_X });
+            bool runtime = false;
+            dragScan::visitExtents(game.state.players[0].apples,
+                [&runtime](auto extents) { runtime = std::is_same_v<decltype(extents), dragScan::RuntimeExtents>; });
+            CHECK(runtime);
+        }
+    }
+} // namespace
+
+int main() {
+    std::apply([](auto... extents) { (checkSize(extents), ...); }, dragScan::FixedSizes());
+    checkOtherSizes();
+    return check::result();
+}
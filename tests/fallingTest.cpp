@@ -0,0 +1,124 @@
+// Falling physics are integer only: time steps and single apple steps round the same way everywhere,
+// a whole board falls along a pinned trajectory, and games played with the same input and frame times
+// fall bit for bit the same, whichever thread each board is stepped on.
+#include <cstdint>
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    using gamestate::Apple;
+
+    void checkSteps() {
+        CHECK_EQ(gamestate::fallStep(0), 0);
+        CHECK_EQ(gamestate::fallStep(headless::FRAME_NS), 17476); // 1/60 s in 1/2^20 s, rounded down
+        CHECK_EQ(gamestate::fallStep(timeBase::NS_PER_SECOND), 1 << gamestate::STEP_FRACTION_BITS);
+        // a stall is cut to one second
+        CHECK_EQ(gamestate::fallStep(5 * timeBase::NS_PER_SECOND), 1 << gamestate::STEP_FRACTION_BITS);
+
+        // products round towards minus infinity, for negative velocities too
+        Apple apple(1, 10.0f, 20.0f, rng::Stream(1));
+        apple.pop();
+        apple.velX = -1;
+        apple.velY = 3;
+        apple.accY = 0;
+        apple.velAngular = -(1 << gamestate::STEP_FRACTION_BITS);
+        const INT32 x = apple.fixedX, y = apple.fixedY, angle = apple.fixedAngle;
+        apple.animate(1);
+        CHECK_EQ(apple.fixedX, x - 1);
+        CHECK_EQ(apple.fixedY, y);
+        CHECK_EQ(apple.fixedAngle, angle - 1);
+
+        // apples that aren't popped or already fell stay where they are
+        Apple settled(1, 10.0f, 20.0f, rng::Stream(1));
+        settled.animate(gamestate::fallStep(headless::FRAME_NS));
+        CHECK_EQ(settled.fixedY, gamestate::toFixed(20.0));
+    }
+
+    // a step by hand, the way the physics are meant to be: position moves by the old velocity
+    void checkSingleApple() {
+        Apple apple(7, 123.4f, 567.8f, rng::Stream(99));
+        apple.pop();
+        INT64 x = apple.fixedX, y = apple.fixedY, angle = apple.fixedAngle, velY = apple.velY;
+        const INT64 step = gamestate::fallStep(headless::FRAME_NS);
+        int wrong = 0;
+        for (int frame = 0; frame < 120; frame++) {
+            x += (apple.velX * step) >> gamestate::STEP_FRACTION_BITS;
+            y += (velY * step) >> gamestate::STEP_FRACTION_BITS;
+            velY += (apple.accY * step) >> gamestate::STEP_FRACTION_BITS;
+            angle += (apple.velAngular * step) >> gamestate::STEP_FRACTION_BITS;
+            apple.animate(step);
+            wrong += apple.fixedX != x || apple.fixedY != y || apple.velY != velY || apple.fixedAngle != angle;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    // FNV-1a over the physics state of every apple
+    uint64_t fallHash(const gamestate::AppleGrid& apples) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto add = [&hash](INT32 value) {
+            hash = (hash ^ static_cast<uint32_t>(value)) * 0x100000001b3ull;
+        };
+        apples.forEach([&](const Apple& apple, INT, INT) {
+            add(apple.fixedX);
+            add(apple.fixedY);
+            add(apple.fixedAngle);
+            add(apple.velX);
+            add(apple.velY);
+            add(apple.accY);
+            add(apple.velAngular);
+        });
+        return hash;
+    }
+
+    // The value every compiler, CPU and build type has to end up with. If it changes, replays and
+    // spectators of earlier builds don't match any more.
+    void checkPinnedTrajectory() {
+        gamestate::GameState gameState;
+        gameState.appleCountX = gamestate::MAX_APPLES_X;
+        gameState.appleCountY = gamestate::MAX_APPLES_Y;
+        gameState.ruleVariant = rules::Variant::CLASSIC;
+        gamestate::GameState::SingletonPlay play{};
+        gameLogic::generateBoard(gameState, play, 12345, nullptr);
+        play.apples.forEach([](Apple& apple, INT, INT) { apple.pop(); });
+
+        const uint64_t start = fallHash(play.apples);
+        CHECK_EQ(start, 0xcda0ab385ba081daull);
+        // uneven frames and a stall, still short of falling out of sight
+        const timeBase::Ns frames[] = { headless::FRAME_NS, headless::FRAME_NS / 2, 3 * headless::FRAME_NS };
+        for (int frame = 0; frame < 90; frame++) {
+            const INT64 step = gamestate::fallStep(frame == 45 ? 2 * timeBase::NS_PER_SECOND : frames[frame % 3]);
+            play.apples.forEach([step](Apple& apple, INT, INT) { apple.animate(step); });
+        }
+        CHECK_EQ(fallHash(play.apples), 0x72ebad8f6a2acc08ull);
+        int fallen = 0;
+        play.apples.forEach([&fallen](const Apple& apple, INT, INT) { fallen += apple.fallen(); });
+        CHECK_EQ(fallen, 0);
+    }
+
+    // four boards stepped in parallel, twice with the same input and frame times
+    void playVersus(headless::Game& game) {
+        game.start({ .playerCount = 4 });
+        for (int round = 0; round < 6; round++) {
+            for (INT player = 0; player < 4; player++) { game.popAny(player); }
+            for (int frame = 0; frame < 7; frame++) { game.frame(); }
+        }
+    }
+
+    void checkGames() {
+        headless::Game first, second;
+        playVersus(first);
+        playVersus(second);
+        for (INT player = 0; player < 4; player++) {
+            CHECK(!first.state.players[player].fallingApples.empty());
+            CHECK_EQ(fallHash(first.state.players[player].apples), fallHash(second.state.players[player].apples));
+        }
+    }
+} // namespace
+
+int main() {
+    checkSteps();
+    checkSingleApple();
+    checkPinnedTrajectory();
+    checkGames();
+    return check::result();
+}
@@ -0,0 +1,208 @@
+// High score file: scores survive reopening, a torn tail after a valid header is cut off and
+// written over, a file that isn't ours (another program's, another version) is kept under
+// another name instead of being overwritten, and one that can't be mapped is left alone.
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "check.h"
+#include "highScores.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const std::filesystem::path PATH = std::filesystem::temp_directory_path() / "apples-high-scores-test.scores";
+    const std::filesystem::path ASIDE = std::filesystem::path(PATH) += ".bad";
+    const std::filesystem::path ASIDE_1 = std::filesystem::path(PATH) += ".1.bad";
+
+    const highScores::Key KEY = { 17, 10, 120, rules::Variant::CLASSIC };
+    const highScores::Key OTHER_KEY = { 8, 6, 60, rules::Variant::TWENTY };
+    const size_t HEADER_SIZE = 16;
+    const size_t RECORD_SIZE = 16;
+
+    std::vector<BYTE> readFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<BYTE>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::vector<BYTE>& data) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    void removeAll() {
+        for (const std::filesystem::path& path : { PATH, ASIDE, ASIDE_1 }) {
+            std::filesystem::remove(path);
+        }
+    }
+
+    void checkReopen() {
+        removeAll();
+        {
+            highScores::Store store(PATH);
+            CHECK_EQ(store.best(KEY), 0);
+            CHECK(store.submit(KEY, 30));
+            CHECK(store.submit(KEY, 50));
+            CHECK(store.submit(OTHER_KEY, 7));
+        }
+        CHECK_EQ(std::filesystem::file_size(PATH), HEADER_SIZE + 3 * RECORD_SIZE);
+
+        highScores::Store store(PATH);
+        CHECK_EQ(store.best(KEY), 50);
+        CHECK_EQ(store.top(KEY)->count, 2);
+        CHECK_EQ(store.top(KEY)->scores[1], 30);
+        CHECK_EQ(store.best(OTHER_KEY), 7);
+        CHECK(!std::filesystem::exists(ASIDE));
+    }
+
+    // a crash while appending leaves part of a record
+    void checkTornTail() {
+        removeAll();
+        {
+            highScores::Store store(PATH);
+            for (INT score = 1; score <= 4; score++) { CHECK(store.submit(KEY, score)); }
+        }
+        std::vector<BYTE> data = readFile(PATH);
+        data.insert(data.end(), { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 });
+        writeFile(PATH, data);
+
+        {
+            highScores::Store store(PATH);
+            CHECK_EQ(store.top(KEY)->count, 4);
+            CHECK_EQ(std::filesystem::file_size(PATH), HEADER_SIZE + 4 * RECORD_SIZE);
+            CHECK(store.submit(KEY, 9));
+        }
+        highScores::Store store(PATH);
+        CHECK_EQ(store.best(KEY), 9);
+        CHECK_EQ(store.top(KEY)->count, 5);
+        CHECK(!std::filesystem::exists(ASIDE));
+
+        // a damaged record drops it and the ones after it
+        data = readFile(PATH);
+        data[HEADER_SIZE + 2 * RECORD_SIZE + 9] ^= 0x40;
+        writeFile(PATH, data);
+        highScores::Store damaged(PATH);
+        CHECK_EQ(damaged.top(KEY)->count, 2);
+        CHECK_EQ(std::filesystem::file_size(PATH), HEADER_SIZE + 2 * RECORD_SIZE);
+    }
+
+    // only the start of the header made it to disk
+    void checkTornHeader() {
+        removeAll();
+        { highScores::Store store(PATH); }
+        std::vector<BYTE> data = readFile(PATH);
+        CHECK_EQ(data.size(), HEADER_SIZE);
+        data.resize(6);
+        writeFile(PATH, data);
+
+        {
+            highScores::Store store(PATH);
+            CHECK(store.submit(KEY, 12));
+        }
+        CHECK(!std::filesystem::exists(ASIDE));
+        highScores::Store store(PATH);
+        CHECK_EQ(store.best(KEY), 12);
+    }
+
+    // not ours: kept as it was under another name, a new file is started
+    void checkForeign(const std::vector<BYTE>& foreign) {
+        removeAll();
+        writeFile(PATH, foreign);
+        {
+            highScores::Store store(PATH);
+            CHECK(store.top(KEY) == nullptr);
+            CHECK(store.submit(KEY, 21));
+        }
+        CHECK(readFile(ASIDE) == foreign);
+        CHECK_EQ(std::filesystem::file_size(PATH), HEADER_SIZE + RECORD_SIZE);
+
+        // an earlier one that was set aside isn't overwritten
+        std::vector<BYTE> second = foreign;
+        second.push_back(0xFF);
+        writeFile(PATH, second);
+        { highScores::Store store(PATH); }
+        CHECK(readFile(ASIDE) == foreign);
+        CHECK(readFile(ASIDE_1) == second);
+    }
+
+    void checkNotOurs() {
+        const char text[] = "not a high score file, just some text that happens to be here";
+        checkForeign(std::vector<BYTE>(text, text + sizeof(text) - 1));
+        checkForeign({ 'x', 'y' }); // shorter than a header
+
+        // ours, but of a newer version the game doesn't know
+        removeAll();
+        {
+            highScores::Store store(PATH);
+            CHECK(store.submit(KEY, 40));
+        }
+        std::vector<BYTE> newer = readFile(PATH);
+        newer[4] = 2;
+        checkForeign(newer);
+    }
+
+#ifdef __linux__
+    // bytes of address space the process has mapped
+    size_t mappedBytes() {
+        std::ifstream statm("/proc/self/statm");
+        size_t pages = 0;
+        statm >> pages;
+        return pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    // A big file and too little address space left to map it: the file is kept as it is, with all
+    // its scores, and the run goes on without saving
+    void checkUnmappable() {
+        removeAll();
+        {
+            highScores::Store store(PATH);
+            CHECK(store.submit(KEY, 50));
+        }
+        // the record over and over, 64 MB of a tournament's scores
+        std::vector<BYTE> data = readFile(PATH);
+        const std::vector<BYTE> record(data.end() - RECORD_SIZE, data.end());
+        const size_t RECORDS = 4 << 20;
+        data.reserve(HEADER_SIZE + RECORDS * RECORD_SIZE);
+        while (data.size() < HEADER_SIZE + RECORDS * RECORD_SIZE) { data.insert(data.end(), record.begin(), record.end()); }
+        writeFile(PATH, data);
+        const size_t size = data.size();
+        data = {};
+
+        // room for the store's worker thread, not for the file
+        rlimit original;
+        getrlimit(RLIMIT_AS, &original);
+        rlimit limited = original;
+        limited.rlim_cur = mappedBytes() + size / 2;
+        CHECK_EQ(setrlimit(RLIMIT_AS, &limited), 0);
+        {
+            highScores::Store store(PATH);
+            CHECK(store.top(KEY) == nullptr);
+            CHECK(store.submit(KEY, 70));
+            CHECK_EQ(store.best(KEY), 70);
+        }
+        setrlimit(RLIMIT_AS, &original);
+
+        CHECK(!std::filesystem::exists(ASIDE));
+        CHECK_EQ(std::filesystem::file_size(PATH), size);
+        highScores::Store store(PATH);
+        CHECK_EQ(store.best(KEY), 50);
+        CHECK_EQ(store.top(KEY)->count, highScores::TOP_COUNT);
+    }
+#endif
+} // namespace
+
+int main() {
+    checkReopen();
+    checkTornTail();
+    checkTornHeader();
+    checkNotOurs();
+#ifdef __linux__
+    checkUnmappable();
+#endif
+    removeAll();
+    return check::result();
+}
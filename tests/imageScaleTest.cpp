@@ -0,0 +1,119 @@
+// Image scaling: scaleTo resamples from the smallest mip level that is still at least as big as the
+// wanted size, and the SSE2 kernels give exactly what the scalar ones give.
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "check.h"
+#include "imageScale.h"
+
+namespace {
+    using imageScale::Image;
+
+    Image filled(uint32_t width, uint32_t height, uint32_t color) {
+        Image image(width, height);
+        for (uint32_t& pixel : image.pixels) { pixel = color; }
+        return image;
+    }
+
+    // opaque and different for every level, resampling a single color image keeps it exactly
+    uint32_t levelColor(size_t level) {
+        return 0xFF000000u | static_cast<uint32_t>(level * 23 + 5) << 16 | static_cast<uint32_t>(200 - level * 11);
+    }
+
+    // level 0 is the source, then the mips; each one a single color so the result tells where it's from
+    std::vector<Image> levels(uint32_t width, uint32_t height) {
+        std::vector<Image> result = { filled(width, height, levelColor(0)) };
+        for (const Image& mip : imageScale::buildMips(result[0])) {
+            result.push_back(filled(mip.width, mip.height, levelColor(result.size())));
+        }
+        return result;
+    }
+
+    // smallest of all levels that covers the size, by area and not by the order they're in
+    size_t expectedLevel(const std::vector<Image>& all, uint32_t width, uint32_t height) {
+        size_t best = 0;
+        for (size_t i = 0; i < all.size(); i++) {
+            bool covers = all[i].width >= width && all[i].height >= height;
+            if (covers && uint64_t(all[i].width) * all[i].height < uint64_t(all[best].width) * all[best].height) { best = i; }
+        }
+        return best;
+    }
+
+    // level the scaled image was resampled from, or -1 if it's not a single level's color
+    int selectedLevel(const Image& scaled, size_t levelCount) {
+        for (size_t level = 0; level < levelCount; level++) {
+            bool all = !scaled.pixels.empty();
+            for (uint32_t pixel : scaled.pixels) { all = all && pixel == levelColor(level); }
+            if (all) { return static_cast<int>(level); }
+        }
+        return -1;
+    }
+
+    int scaledLevel(const std::vector<Image>& all, uint32_t width, uint32_t height) {
+        const std::vector<Image> mips(all.begin() + 1, all.end());
+        Image scaled = imageScale::scaleTo(all[0], mips, width, height);
+        CHECK_EQ(scaled.width, width);
+        CHECK_EQ(scaled.height, height);
+        return selectedLevel(scaled, all.size());
+    }
+
+    void checkMipSelection() {
+        // the main menu background
+        const std::vector<Image> tree = levels(867, 579);
+        CHECK_EQ(tree.size(), 10u); // and 433x289 down to 1x1
+        CHECK_EQ(tree[1].width, 433u);
+        CHECK_EQ(tree[1].height, 289u);
+
+        CHECK_EQ(scaledLevel(tree, 867, 579), 0);
+        CHECK_EQ(scaledLevel(tree, 600, 400), 0);
+        CHECK_EQ(scaledLevel(tree, 434, 289), 0);
+        CHECK_EQ(scaledLevel(tree, 433, 289), 1);
+        CHECK_EQ(scaledLevel(tree, 433, 290), 0);
+        CHECK_EQ(scaledLevel(tree, 300, 200), 1);
+        CHECK_EQ(scaledLevel(tree, 216, 144), 2);
+        CHECK_EQ(scaledLevel(tree, 217, 100), 1);
+        CHECK_EQ(scaledLevel(tree, 13, 1), 6); // 13x9, the width decides
+        CHECK_EQ(scaledLevel(tree, 1, 1), 9);
+
+        // every size of some differently shaped images, odd sizes round their mips down
+        for (auto [w, h] : { std::pair<uint32_t, uint32_t>{ 867, 579 }, { 256, 256 }, { 301, 77 }, { 5, 640 } }) {
+            const std::vector<Image> all = levels(w, h);
+            int wrong = 0;
+            for (uint32_t height = 1; height <= h; height += h / 37 + 1) {
+                for (uint32_t width = 1; width <= w; width += w / 41 + 1) {
+                    wrong += scaledLevel(all, width, height) != static_cast<int>(expectedLevel(all, width, height));
+                }
+            }
+            CHECK_EQ(wrong, 0);
+        }
+    }
+
+    Image noise(uint32_t width, uint32_t height, std::mt19937& random) {
+        // premultiplied: no channel above alpha
+        Image image(width, height);
+        for (uint32_t& pixel : image.pixels) {
+            uint32_t alpha = random() & 0xFF;
+            pixel = alpha << 24;
+            for (int i = 0; i < 3; i++) { pixel |= (random() % (alpha + 1)) << (8 * i); }
+        }
+        return image;
+    }
+
+    void checkKernels() {
+        std::mt19937 random(7);
+        for (auto [w, h] : { std::pair<uint32_t, uint32_t>{ 1, 1 }, { 2, 1 }, { 3, 7 }, { 17, 9 }, { 64, 64 }, { 867, 579 } }) {
+            Image source = noise(w, h, random);
+            CHECK(imageScale::halve(source).pixels == imageScale::halveScalar(source).pixels);
+            for (auto [dw, dh] : { std::pair<uint32_t, uint32_t>{ 1, 1 }, { w / 2 + 1, h / 2 + 1 }, { w * 3 / 4 + 1, h }, { w, h } }) {
+                CHECK(imageScale::resize(source, dw, dh).pixels == imageScale::resizeScalar(source, dw, dh).pixels);
+            }
+        }
+    }
+} // namespace
+
+int main() {
+    checkMipSelection();
+    checkKernels();
+    return check::result();
+}
@@ -0,0 +1,215 @@
+// Input latency from synthetic event streams: histogram buckets and percentiles against hand worked
+// values, and presses and releases with known capture times going through the controller, the game
+// logic and latency::framePresented on a virtual clock, with actions waiting over several frames
+// for the present that shows them.
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+#include "helper.h"
+#include "latency.h"
+#include "rng.h"
+
+namespace {
+    using latency::Action;
+    using latency::Histogram;
+
+    void checkBuckets() {
+        // exact below 8, then 4 buckets per power of two
+        for (uint64_t us = 0; us < 8; us++) {
+            CHECK_EQ(Histogram::bucketOf(us), static_cast<int>(us));
+            CHECK_EQ(Histogram::bucketUpperBoundUs(static_cast<int>(us)), us);
+        }
+        CHECK_EQ(Histogram::bucketOf(8), 8);
+        CHECK_EQ(Histogram::bucketOf(9), 8);
+        CHECK_EQ(Histogram::bucketOf(10), 9);
+        CHECK_EQ(Histogram::bucketUpperBoundUs(8), 9u);
+        CHECK_EQ(Histogram::bucketOf(1000), 35);
+        CHECK_EQ(Histogram::bucketUpperBoundUs(35), 1023u);
+        CHECK_EQ(Histogram::bucketOf(1024), 36);
+        // hours and more go into the last bucket
+        CHECK_EQ(Histogram::bucketOf(UINT64_MAX), Histogram::BUCKETS - 1);
+
+        // every duration lies in its bucket, above the bound of the one before
+        int wrong = 0;
+        for (uint64_t us = 1; us < (uint64_t(1) << 30); us += us / 7 + 1) {
+            int bucket = Histogram::bucketOf(us);
+            wrong += Histogram::bucketUpperBoundUs(bucket) < us || Histogram::bucketUpperBoundUs(bucket - 1) >= us;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    void checkPercentiles() {
+        Histogram histogram;
+        CHECK_EQ(histogram.percentileUs(50.0), 0u);
+        for (uint64_t us = 1; us <= 100; us++) { histogram.add(us); }
+        CHECK_EQ(histogram.count(), 100u);
+        CHECK_EQ(histogram.meanUs(), 50.5);
+        CHECK_EQ(histogram.maxUs(), 100u);
+        // the upper bound of the bucket holding the value of that rank, never above the maximum
+        CHECK_EQ(histogram.percentileUs(0.0), 1u);
+        CHECK_EQ(histogram.percentileUs(50.0), 55u);  // 50 is in [48, 55]
+        CHECK_EQ(histogram.percentileUs(90.0), 95u);  // 90 is in [80, 95]
+        CHECK_EQ(histogram.percentileUs(99.0), 100u); // 99 is in [96, 111]
+        histogram.clear();
+        CHECK_EQ(histogram.count(), 0u);
+
+        // random frame times: at or above the exact percentile, by at most a bucket (a quarter)
+        rng::Stream random(29);
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 10000; i++) {
+            values.push_back(static_cast<uint64_t>(random.nextInt(100, 100000)));
+            histogram.add(values.back());
+        }
+        std::sort(values.begin(), values.end());
+        int wrong = 0;
+        for (double percentile : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9 }) {
+            uint64_t exact = values[static_cast<size_t>(percentile / 100.0 * (values.size() - 1))];
+            uint64_t reported = histogram.percentileUs(percentile);
+            wrong += reported < exact || reported > exact + exact / 4;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    // A game instrumented like the one a window shows, on a clock that only moves when told to, so
+    // every capture, state and present time is known
+    class Pipeline {
+    private:
+        timeBase::VirtualSource m_clock;
+        UINT64 m_baseUs = 0;
+
+    public:
+        headless::Game game;
+
+        Pipeline() : m_clock(timeBase::NS_PER_SECOND), game(timeBase::NS_PER_SECOND) {
+            timeBase::setSource(&m_clock);
+            game.state.instrumented = true;
+            game.start({ .playTime = 900 });
+            // the clock catches up with the game's frames, times below count from there
+            m_clock.advance(game.timeNs - m_clock.now());
+            m_baseUs = help::myTimer64us();
+            latency::reset();
+        }
+        ~Pipeline() { timeBase::setSource(nullptr); }
+
+        // the clock moved on to us after the base
+        void at(UINT64 us) { m_clock.advance((m_baseUs + us) * timeBase::NS_PER_US - m_clock.now()); }
+        void press(UINT64 us) {
+            at(us);
+            game.press();
+        }
+        void release(UINT64 us) {
+            at(us);
+            game.release();
+        }
+        // a frame processed at us, the game's time moving along with the clock
+        void frame(UINT64 us) {
+            at(us);
+            game.frame(m_clock.now() - game.timeNs);
+        }
+        void present(UINT64 us) {
+            at(us);
+            latency::framePresented(help::myTimer64us());
+        }
+    };
+
+    void checkPipeline() {
+        Pipeline pipeline;
+        headless::Game& game = pipeline.game;
+        INT move[4];
+        CHECK(game.findMove(move));
+        const FLOAT inset = game.state.appleSize * game.state.players[0].viewZoom * 0.45f;
+        const UINT32 revision = game.state.players[0].boardRevision;
+
+        // pressed 2 ms into a frame, acted on at its end, shown two frames later
+        game.moveTo(game.cellX(move[0]) - inset, game.cellY(move[1]) - inset);
+        pipeline.press(2000);
+        pipeline.frame(16000);
+        game.moveTo(game.cellX(move[2]) + inset, game.cellY(move[3]) + inset);
+        pipeline.frame(32000);
+        pipeline.present(40000);
+        CHECK_EQ(latency::captureToState(Action::DRAG_START).count(), 1u);
+        CHECK_EQ(latency::captureToState(Action::DRAG_START).maxUs(), 14000u);
+        CHECK_EQ(latency::captureToPresent(Action::DRAG_START).count(), 1u);
+        CHECK_EQ(latency::captureToPresent(Action::DRAG_START).maxUs(), 38000u);
+
+        // the release pops, and the present after it counts the pop only
+        pipeline.release(41000);
+        pipeline.frame(48000);
+        CHECK_EQ(game.state.players[0].boardRevision, revision + 1);
+        pipeline.frame(64000);
+        pipeline.present(70000);
+        CHECK_EQ(latency::captureToState(Action::POP).count(), 1u);
+        CHECK_EQ(latency::captureToState(Action::POP).maxUs(), 7000u);
+        CHECK_EQ(latency::captureToPresent(Action::POP).count(), 1u);
+        CHECK_EQ(latency::captureToPresent(Action::POP).maxUs(), 29000u);
+        CHECK_EQ(latency::captureToPresent(Action::DRAG_START).count(), 1u);
+
+        // a drag over a single apple pops nothing; its start and end wait over three frames for the
+        // same present
+        INT x = 0, y = 0;
+        while (game.state.players[0].apples.at(x, y).popped) { x++; }
+        game.moveTo(game.cellX(x), game.cellY(y));
+        pipeline.press(80000);
+        pipeline.frame(80500);
+        pipeline.release(81000);
+        pipeline.frame(96000);
+        pipeline.frame(112000);
+        pipeline.present(120000);
+        const Histogram& startState = latency::captureToState(Action::DRAG_START);
+        const Histogram& startPresent = latency::captureToPresent(Action::DRAG_START);
+        CHECK_EQ(startState.count(), 2u);
+        CHECK_EQ(startState.meanUs(), (14000.0 + 500.0) / 2);
+        CHECK_EQ(startPresent.count(), 2u);
+        CHECK_EQ(startPresent.meanUs(), (38000.0 + 40000.0) / 2);
+        CHECK_EQ(latency::captureToState(Action::DRAG_END).count(), 1u);
+        CHECK_EQ(latency::captureToState(Action::DRAG_END).maxUs(), 15000u);
+        CHECK_EQ(latency::captureToPresent(Action::DRAG_END).maxUs(), 39000u);
+        CHECK_EQ(game.state.players[0].boardRevision, revision + 1);
+
+        // a present with nothing acted on since the last one adds nothing
+        pipeline.frame(128000);
+        pipeline.present(130000);
+        CHECK_EQ(startPresent.count(), 2u);
+        CHECK_EQ(latency::captureToPresent(Action::DRAG_END).count(), 1u);
+
+        // neither does a press and release both between two polls, the game never sees it
+        pipeline.press(131000);
+        pipeline.release(132000);
+        pipeline.frame(144000);
+        pipeline.present(150000);
+        CHECK_EQ(startState.count(), 2u);
+        CHECK_EQ(latency::captureToState(Action::DRAG_END).count(), 1u);
+
+        // a row per action and direction under the heading
+        const std::string report = latency::formatReport();
+        CHECK_EQ(std::count(report.begin(), report.end(), '\n'), 1 + 2 * static_cast<int>(Action::COUNT));
+        CHECK(report.find("pop        ->present") != std::string::npos);
+
+        latency::reset();
+        CHECK_EQ(startState.count(), 0u);
+        CHECK_EQ(latency::captureToPresent(Action::POP).count(), 0u);
+    }
+
+    void checkUninstrumented() {
+        // games that aren't shown in a window (tests, servers) don't report
+        headless::Game game;
+        game.start({});
+        latency::reset();
+        INT move[4];
+        CHECK(game.findMove(move));
+        game.drag(move[0], move[1], move[2], move[3]);
+        latency::framePresented(help::myTimer64us());
+        CHECK_EQ(latency::captureToState(Action::DRAG_START).count(), 0u);
+        CHECK_EQ(latency::captureToPresent(Action::POP).count(), 0u);
+    }
+} // namespace
+
+int main() {
+    checkBuckets();
+    checkPercentiles();
+    checkPipeline();
+    checkUninstrumented();
+    return check::result();
+}
@@ -0,0 +1,233 @@
+// Live state block: one writer at a time claims a block and a second one is turned away, a block left
+// over mid-write by a crashed game is taken over, readers racing a writer never see a torn frame, and
+// what the publisher writes for a game in play matches its boards.
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+#include "liveExport.h"
+#include "liveState.h"
+
+namespace {
+    // zeroed like a new section, aligned for the header
+    struct Block {
+        std::vector<uint64_t> words = std::vector<uint64_t>((liveState::blockSize() + 7) / 8, 0);
+
+        void* data() { return words.data(); }
+        liveState::Header& header() { return *reinterpret_cast<liveState::Header*>(words.data()); }
+    };
+
+    bool alive(uint32_t) { return true; }
+    bool gone(uint32_t) { return false; }
+
+    void checkClaim() {
+        Block block;
+        CHECK(liveState::claim(block.data(), 7, alive));
+        CHECK_EQ(block.header().writer.load(), 7u);
+        // a second game while the first one runs, and after it crashed
+        CHECK(!liveState::claim(block.data(), 8, alive));
+        CHECK_EQ(block.header().writer.load(), 7u);
+        CHECK(liveState::claim(block.data(), 8, gone));
+        CHECK_EQ(block.header().writer.load(), 8u);
+
+        // a writer lets go of its own claim only
+        {
+            liveState::Writer writer(block.data(), 8);
+        }
+        CHECK_EQ(block.header().writer.load(), 0u);
+        {
+            liveState::Writer writer(block.data(), 9);
+            block.header().writer.store(10);
+        }
+        CHECK_EQ(block.header().writer.load(), 10u);
+
+        // publishers on the same block: the second doesn't publish until the first is gone
+        Block shared;
+        std::optional<liveExport::Publisher> first(std::in_place, shared.data(), 1);
+        liveExport::Publisher second(shared.data(), 2);
+        CHECK(first->publishing());
+        CHECK(!second.publishing());
+        first.reset();
+        liveExport::Publisher third(shared.data(), 3);
+        CHECK(third.publishing());
+    }
+
+    void checkLeftOver() {
+        // a game that crashed in the middle of frame 41
+        Block block;
+        block.header().sequence.store(41);
+        block.header().writer.store(5);
+        CHECK(liveState::claim(block.data(), 6, gone));
+        liveState::Writer writer(block.data(), 6);
+        const uint32_t sequence = block.header().sequence.load();
+        CHECK_EQ(sequence % 2, 0u);
+        CHECK(sequence > 41);
+        CHECK_EQ(block.header().magic, liveState::MAGIC);
+        CHECK(liveState::read(block.data(), [](const liveState::Header&, const uint8_t*) {}));
+    }
+
+    const int32_t STRESS_WIDTH = 64;
+    const int32_t STRESS_HEIGHT = 64;
+
+    // Everything in a frame follows from its number, so a frame read partly before and partly after a
+    // write doesn't add up
+    void writeFrame(liveState::Writer& writer, uint32_t frame) {
+        liveState::Header& header = writer.header();
+        writer.begin();
+        header.width = STRESS_WIDTH;
+        header.height = STRESS_HEIGHT;
+        header.playerCount = 1;
+        liveState::Player& player = header.players[0];
+        player.score = static_cast<int32_t>(frame);
+        player.boardRevision = frame;
+        player.dragLeft = static_cast<float>(frame % 1000);
+        player.dragBottom = static_cast<float>(frame % 1000) + 1.0f;
+        uint8_t* values = writer.values(0);
+        for (int32_t i = 0; i < STRESS_WIDTH * STRESS_HEIGHT; i++) { values[i] = static_cast<uint8_t>(frame + i); }
+        player.remainingMs = -static_cast<int32_t>(frame);
+        writer.end();
+    }
+
+    struct ReaderResult {
+        int reads = 0;
+        int retried = 0; // reads that gave up while the writer kept writing
+        int torn = 0;
+        int backwards = 0;
+    };
+
+    void readFrames(const void* block, const std::atomic<bool>& done, ReaderResult& result) {
+        uint64_t lastFrame = 0;
+        uint32_t attempts = 0;
+        std::vector<uint8_t> values(STRESS_WIDTH * STRESS_HEIGHT);
+        while (!done.load(std::memory_order_relaxed)) {
+            uint64_t frame = 0;
+            int32_t score = 0, remainingMs = 0;
+            uint32_t revision = 0;
+            float dragLeft = 0.0f, dragBottom = 0.0f;
+            bool ok = liveState::read(block, [&](const liveState::Header& header, const uint8_t* bytes) {
+                frame = header.frame;
+                score = header.players[0].score;
+                revision = header.players[0].boardRevision;
+                dragLeft = header.players[0].dragLeft;
+                dragBottom = header.players[0].dragBottom;
+                // now and then preempted halfway through, so the writer gets in on a single core too
+                if (++attempts % 4 == 0) { std::this_thread::yield(); }
+                std::memcpy(values.data(), bytes + header.players[0].valuesOffset, values.size());
+                remainingMs = header.players[0].remainingMs;
+            });
+            // lets the writer on, on a single core too
+            std::this_thread::yield();
+            if (!ok) {
+                result.retried++;
+                continue;
+            }
+            result.reads++;
+            // frame n is the one ending the frame counter on n + 1
+            const uint32_t written = static_cast<uint32_t>(score);
+            bool consistent = (frame == written + 1 && revision == written && remainingMs == -score &&
+                dragLeft == static_cast<float>(written % 1000) && dragBottom == dragLeft + 1.0f);
+            for (int32_t i = 0; i < STRESS_WIDTH * STRESS_HEIGHT && consistent; i++) {
+                consistent = values[i] == static_cast<uint8_t>(written + i);
+            }
+            result.torn += !consistent;
+            result.backwards += frame < lastFrame;
+            lastFrame = frame;
+        }
+    }
+
+    void checkStress() {
+        Block block;
+        CHECK(liveState::claim(block.data(), 1, alive));
+        liveState::Writer writer(block.data(), 1);
+        // readers start on a complete frame
+        writeFrame(writer, 0);
+
+        const int READERS = 3;
+        std::atomic<bool> done = false;
+        std::vector<ReaderResult> results(READERS);
+        std::vector<std::thread> readers;
+        for (int i = 0; i < READERS; i++) {
+            readers.emplace_back(readFrames, block.data(), std::cref(done), std::ref(results[i]));
+        }
+        const uint32_t FRAMES = 200000;
+        // runs of frames with readers let in between, on a single core they'd otherwise mostly find
+        // the writer preempted in the middle of a frame
+        for (uint32_t frame = 1; frame <= FRAMES; frame++) {
+            writeFrame(writer, frame);
+            if (frame % 16 == 0) { std::this_thread::yield(); }
+        }
+        done = true;
+        for (std::thread& reader : readers) { reader.join(); }
+
+        ReaderResult total;
+        for (const ReaderResult& result : results) {
+            total.reads += result.reads;
+            total.retried += result.retried;
+            total.torn += result.torn;
+            total.backwards += result.backwards;
+        }
+        std::printf("%u frames written, %d read by %d readers (%d gave up for now), %d torn, %d going back\n", FRAMES, total.reads,
+            READERS, total.retried, total.torn, total.backwards);
+        CHECK(total.reads > 0);
+        CHECK_EQ(total.torn, 0);
+        CHECK_EQ(total.backwards, 0);
+        CHECK_EQ(block.header().frame, uint64_t(FRAMES) + 1);
+    }
+
+    // cells of a player's board as published, values and popped bits, read consistently
+    void checkBoard(const void* block, const headless::Game& game, INT player) {
+        const gamestate::AppleGrid& apples = game.state.players[player].apples;
+        int wrong = 0;
+        CHECK(liveState::read(block, [&](const liveState::Header& header, const uint8_t* bytes) {
+            wrong = 0;
+            const uint8_t* values = bytes + header.players[player].valuesOffset;
+            const uint8_t* popped = bytes + header.players[player].poppedOffset;
+            apples.forEach([&](const gamestate::Apple& apple, INT x, INT y) {
+                size_t index = static_cast<size_t>(y) * header.width + x;
+                wrong += values[index] != apple.value;
+                wrong += ((popped[index / 8] >> (index % 8)) & 1) != (apple.popped ? 1 : 0);
+            });
+        }));
+        CHECK_EQ(wrong, 0);
+    }
+
+    void checkPublisher() {
+        Block block;
+        liveExport::Publisher publisher(block.data(), 1);
+        headless::Game game;
+        game.afterFrame = [&]() { publisher.frame(game.state); };
+        game.start({ .playerCount = 2 });
+        CHECK(game.popAny(0));
+        CHECK(game.popAny(1));
+        CHECK(game.popAny(0));
+
+        const liveState::Header& header = block.header();
+        CHECK_EQ(header.mode, 3);
+        CHECK_EQ(header.playerCount, 2);
+        CHECK_EQ(header.width, game.state.appleCountX);
+        CHECK_EQ(header.height, game.state.appleCountY);
+        for (INT player = 0; player < 2; player++) {
+            CHECK_EQ(header.players[player].score, game.state.players[player].score);
+            CHECK_EQ(header.players[player].boardRevision, game.state.players[player].boardRevision);
+            checkBoard(block.data(), game, player);
+        }
+        CHECK(header.players[0].score > 0);
+
+        // a new board is written in full
+        game.tap('R');
+        CHECK(game.popAny(0));
+        checkBoard(block.data(), game, 0);
+    }
+} // namespace
+
+int main() {
+    checkClaim();
+    checkLeftOver();
+    checkStress();
+    checkPublisher();
+    return check::result();
+}
@@ -0,0 +1,171 @@
+// Memory accounting: the tagged allocator counts exactly the bytes its containers hold, current bytes
+// go back down when they're freed while the peak stays at the most ever held, boards and images are
+// counted under their own tags, concurrent counting loses nothing and the most allocating frame is kept.
+#include <algorithm>
+#include <list>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "gameState.h"
+#include "imageScale.h"
+#include "memoryStats.h"
+
+namespace {
+    using memoryStats::Tag;
+
+    // counters of a tag relative to when it was taken, so what other checks left behind doesn't matter
+    struct Delta {
+        Tag tag;
+        int64_t currentBytes;
+        int64_t peakBytes;
+        uint64_t allocations;
+
+        explicit Delta(Tag tag) : tag(tag) {
+            const memoryStats::Counters& c = memoryStats::counters(tag);
+            currentBytes = c.currentBytes.load();
+            peakBytes = c.peakBytes.load();
+            allocations = c.allocations.load();
+        }
+        int64_t bytes() const { return memoryStats::counters(tag).currentBytes.load() - currentBytes; }
+        uint64_t count() const { return memoryStats::counters(tag).allocations.load() - allocations; }
+
+        // most held since, over what was held then, and what that should be if held bytes were the most
+        int64_t peakHeld() const { return memoryStats::counters(tag).peakBytes.load() - currentBytes; }
+        int64_t peakIf(int64_t held) const { return std::max(peakBytes - currentBytes, held); }
+    };
+
+    void checkAllocator() {
+        using Vector = std::vector<uint64_t, memoryStats::Allocator<uint64_t, Tag::IMAGES>>;
+        const Delta start(Tag::IMAGES);
+        int64_t grown = 0;
+        {
+            Vector a;
+            a.reserve(100);
+            CHECK_EQ(start.bytes(), 800);
+            CHECK_EQ(start.count(), 1u);
+            Vector b(50);
+            CHECK_EQ(start.bytes(), 1200);
+            CHECK_EQ(start.peakHeld(), start.peakIf(1200));
+
+            // growing holds old and new memory at once, then frees the old
+            a.resize(100);
+            a.push_back(1);
+            grown = static_cast<int64_t>(a.capacity() * sizeof(uint64_t));
+            CHECK_EQ(start.bytes(), grown + 400);
+            CHECK_EQ(start.peakHeld(), start.peakIf(800 + grown + 400));
+            CHECK_EQ(start.count(), 3u);
+        }
+        CHECK_EQ(start.bytes(), 0);
+        CHECK_EQ(start.peakHeld(), start.peakIf(800 + grown + 400));
+
+        // rebound to the node type of a list, every node counted under the same tag
+        const Delta list(Tag::IMAGES);
+        {
+            std::list<uint64_t, memoryStats::Allocator<uint64_t, Tag::IMAGES>> nodes;
+            for (int i = 0; i < 10; i++) { nodes.push_back(i); }
+            CHECK_EQ(list.count(), 10u);
+            CHECK(list.bytes() >= static_cast<int64_t>(10 * sizeof(uint64_t)));
+        }
+        CHECK_EQ(list.bytes(), 0);
+    }
+
+    void checkReported() {
+        const Delta base(Tag::DEVICE_BITMAPS);
+        memoryStats::allocated(Tag::DEVICE_BITMAPS, 1000);
+        memoryStats::allocated(Tag::DEVICE_BITMAPS, 500);
+        memoryStats::freed(Tag::DEVICE_BITMAPS, 1000);
+        memoryStats::allocated(Tag::DEVICE_BITMAPS, 200);
+        CHECK_EQ(base.bytes(), 700);
+        CHECK_EQ(base.peakHeld(), base.peakIf(1500));
+        CHECK_EQ(base.count(), 3u);
+        memoryStats::freed(Tag::DEVICE_BITMAPS, 700);
+        CHECK_EQ(base.bytes(), 0);
+        CHECK_EQ(base.peakHeld(), base.peakIf(1500));
+
+        // the other tags don't see any of it
+        const Delta board(Tag::BOARD);
+        memoryStats::allocated(Tag::DEVICE_BITMAPS, 64);
+        memoryStats::freed(Tag::DEVICE_BITMAPS, 64);
+        CHECK_EQ(board.bytes(), 0);
+        CHECK_EQ(board.count(), 0u);
+    }
+
+    void checkBoardsAndImages() {
+        // a grid holds its chunk list and the cells of every chunk
+        const Delta board(Tag::BOARD);
+        {
+            gamestate::AppleGrid grid;
+            grid.generate(40, 20, [](int x, int y) { return gamestate::Apple(1, x, y, rng::Stream()); });
+            const int chunks = 3 * 2;
+            const int64_t bytes = chunks * sizeof(gamestate::AppleGrid::Chunk) + 40 * 20 * sizeof(gamestate::Apple);
+            CHECK_EQ(board.bytes(), bytes);
+            CHECK_EQ(board.count(), static_cast<uint64_t>(1 + chunks));
+
+            // the same size again keeps the chunk list and replaces the cells
+            grid.generate(40, 20, [](int x, int y) { return gamestate::Apple(1, x, y, rng::Stream()); });
+            CHECK_EQ(board.bytes(), bytes);
+            CHECK_EQ(board.count(), static_cast<uint64_t>(1 + 2 * chunks));
+        }
+        CHECK_EQ(board.bytes(), 0);
+
+        // an image holds 4 bytes a pixel, a halved copy a quarter of that
+        const Delta images(Tag::IMAGES);
+        {
+            imageScale::Image image(256, 128);
+            CHECK_EQ(images.bytes(), 256 * 128 * 4);
+            imageScale::Image half = imageScale::halve(image);
+            CHECK_EQ(images.bytes(), 256 * 128 * 4 + 128 * 64 * 4);
+        }
+        CHECK_EQ(images.bytes(), 0);
+    }
+
+    void checkConcurrent() {
+        const Delta start(Tag::BOARD);
+        const int THREADS = 8, ROUNDS = 20000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([] {
+                for (int i = 0; i < ROUNDS; i++) {
+                    memoryStats::allocated(Tag::BOARD, 16);
+                    memoryStats::freed(Tag::BOARD, 16);
+                }
+                // each thread keeps one block at the end, never more than one at a time
+                memoryStats::allocated(Tag::BOARD, 16);
+            });
+        }
+        for (std::thread& thread : threads) { thread.join(); }
+        CHECK_EQ(start.count(), static_cast<uint64_t>(THREADS * (ROUNDS + 1)));
+        CHECK_EQ(start.bytes(), THREADS * 16);
+        CHECK_EQ(start.peakHeld(), start.peakIf(THREADS * 16));
+        memoryStats::freed(Tag::BOARD, THREADS * 16);
+    }
+
+    void checkFrames() {
+        memoryStats::beginFrame();
+        for (int i = 0; i < 5; i++) { memoryStats::allocated(Tag::DEVICE_BITMAPS, 0); }
+        memoryStats::beginFrame();
+        CHECK_EQ(memoryStats::counters(Tag::DEVICE_BITMAPS).frameAllocations.load(), 0u);
+        memoryStats::allocated(Tag::DEVICE_BITMAPS, 0);
+        memoryStats::beginFrame();
+        // the busier earlier frame is the one kept
+        const uint64_t most = memoryStats::maxFrameAllocations(Tag::DEVICE_BITMAPS);
+        CHECK(most >= 5u);
+        for (int i = 0; i < static_cast<int>(most) + 3; i++) { memoryStats::allocated(Tag::DEVICE_BITMAPS, 0); }
+        memoryStats::beginFrame();
+        CHECK_EQ(memoryStats::maxFrameAllocations(Tag::DEVICE_BITMAPS), most + 3);
+
+        const std::string report = memoryStats::formatReport();
+        for (int i = 0; i < static_cast<int>(Tag::COUNT); i++) {
+            CHECK(report.find(memoryStats::tagName(static_cast<Tag>(i))) != std::string::npos);
+        }
+    }
+} // namespace
+
+int main() {
+    checkAllocator();
+    checkReported();
+    checkBoardsAndImages();
+    checkConcurrent();
+    checkFrames();
+    return check::result();
+}
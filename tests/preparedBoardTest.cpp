@@ -0,0 +1,108 @@
+// Boards of the next game generated in the background: Reset takes over the same board the game would
+// have generated itself, the board sequence doesn't depend on when the worker finishes, a settings
+// change isn't served an outdated board, and a Reset on the biggest huge board is a short frame.
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<INT> values(const gamestate::AppleGrid& apples) {
+        std::vector<INT> result;
+        apples.forEach([&result](const gamestate::Apple& apple, INT, INT) { result.push_back(apple.value); });
+        return result;
+    }
+
+    void waitPrepared(headless::Game& game) {
+        if (game.state.preparedBoard.valid()) { game.state.preparedBoard.wait(); }
+    }
+
+    // seeds and values of the boards after start and four resets, with the worker done before each
+    // reset or never waited for
+    std::vector<std::vector<INT>> playResets(bool wait, std::vector<UINT64>& seeds) {
+        headless::Game game;
+        game.start({ .appleCountX = 60, .appleCountY = 40, .hugeBoard = true });
+        std::vector<std::vector<INT>> boards;
+        for (int reset = 0; reset < 5; reset++) {
+            if (reset > 0) {
+                if (wait) { waitPrepared(game); }
+                game.tap('R');
+            }
+            seeds.push_back(game.state.players[0].boardSeed);
+            boards.push_back(values(game.state.players[0].apples));
+
+            // the same board as generated on the spot from its seed
+            gamestate::GameState::SingletonPlay fresh{};
+            gameLogic::generateBoard(game.state, fresh, game.state.players[0].boardSeed, nullptr);
+            CHECK(values(fresh.apples) == boards.back());
+        }
+        return boards;
+    }
+
+    void checkSequence() {
+        std::vector<UINT64> waitedSeeds, hurriedSeeds;
+        std::vector<std::vector<INT>> waited = playResets(true, waitedSeeds);
+        std::vector<std::vector<INT>> hurried = playResets(false, hurriedSeeds);
+        CHECK(waitedSeeds == hurriedSeeds);
+        CHECK(waited == hurried);
+        for (size_t i = 1; i < waitedSeeds.size(); i++) { CHECK(waitedSeeds[i] != waitedSeeds[i - 1]); }
+    }
+
+    void checkSettingsChange() {
+        headless::Game game;
+        game.state.mode = gamestate::GameState::Mode::MAIN_MENU;
+        game.frame();
+        waitPrepared(game);
+        CHECK_EQ(game.state.preparedRequest.appleCountX, gamestate::DEFAULT_APPLES_X);
+
+        // a bigger board right after the prepared one was done for the default size
+        game.start({ .appleCountX = 24, .appleCountY = 15 });
+        CHECK(game.state.mode == gamestate::GameState::Mode::PLAYING);
+        CHECK_EQ(game.state.players[0].apples.sizeX(), 24);
+        CHECK_EQ(game.state.players[0].apples.sizeY(), 15);
+
+        // and the one prepared next is for the new size
+        waitPrepared(game);
+        CHECK_EQ(game.state.preparedRequest.appleCountX, 24);
+        game.tap('R');
+        CHECK_EQ(game.state.players[0].apples.sizeX(), 24);
+    }
+
+    // the Reset frame alone, the fastest of a few
+    timeBase::Ns resetFrameNs(headless::Game& game, bool prepared) {
+        timeBase::Ns fastest = timeBase::NS_PER_SECOND * 60;
+        for (int round = 0; round < 3; round++) {
+            waitPrepared(game);
+            if (!prepared) { game.state.preparedBoard.get(); }
+            game.press('R');
+            const Clock::time_point start = Clock::now();
+            game.frame();
+            fastest = std::min<timeBase::Ns>(fastest, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            game.release('R');
+            game.frame();
+        }
+        return fastest;
+    }
+
+    void checkResetTime() {
+        headless::Game game;
+        game.start({ .appleCountX = gamestate::HUGE_MAX_APPLES, .appleCountY = gamestate::HUGE_MAX_APPLES, .hugeBoard = true });
+        const timeBase::Ns preparedNs = resetFrameNs(game, true);
+        const timeBase::Ns generatedNs = resetFrameNs(game, false);
+        std::printf("reset frame of a %dx%d board: %.2f ms prepared, %.2f ms generated in the frame\n", gamestate::HUGE_MAX_APPLES,
+            gamestate::HUGE_MAX_APPLES, preparedNs / 1e6, generatedNs / 1e6);
+        // taking the board over is a move, generating it touches every apple
+        CHECK(preparedNs * 4 < generatedNs);
+        CHECK_EQ(game.state.players[0].apples.sizeX(), gamestate::HUGE_MAX_APPLES);
+    }
+} // namespace
+
+int main() {
+    checkSequence();
+    checkSettingsChange();
+    checkResetTime();
+    return check::result();
+}
@@ -0,0 +1,169 @@
+// Quality governor driven by synthetic frame time traces: sustained overload steps down a window at a
+// time and occasional misses don't, headroom steps back up, a step up taken back soon doubles the wait
+// for the next one up to MAX_UP_FRAMES and a calm stretch halves it again, and stalls are ignored.
+#include "check.h"
+#include "qualityGovernor.h"
+
+namespace {
+    using qualityGovernor::Governor;
+
+    const double BUDGET_MS = 1000.0 / 60.0;
+    const double OVER_MS = 30.0;    // misses the budget
+    const double FAST_MS = 5.0;     // with headroom
+    const double STEADY_MS = 15.0;  // neither
+    const double STALL_MS = 1000.0; // not the renderer's fault
+
+    // Runs frames of frameMs until the level changes, at most limit of them. The frame it changed on,
+    // counted from 1, or 0 if it didn't.
+    int framesToChange(Governor& governor, double frameMs, int limit = 100000) {
+        for (int frame = 1; frame <= limit; frame++) {
+            if (governor.frame(frameMs)) { return frame; }
+        }
+        return 0;
+    }
+
+    void checkOverload() {
+        // a window to judge every level, down to the lowest, where it stays
+        Governor governor(BUDGET_MS);
+        for (int level = 1; level < qualityGovernor::LEVEL_COUNT; level++) {
+            CHECK_EQ(framesToChange(governor, OVER_MS), Governor::DOWN_WINDOW);
+            CHECK_EQ(governor.level(), level);
+        }
+        CHECK_EQ(framesToChange(governor, OVER_MS, 10000), 0);
+        CHECK_EQ(governor.level(), qualityGovernor::LEVEL_COUNT - 1);
+
+        // one miss short of DOWN_MISSED in every window holds, DOWN_MISSED steps down
+        for (int missed : { Governor::DOWN_MISSED - 1, Governor::DOWN_MISSED }) {
+            Governor spiky(BUDGET_MS);
+            int changed = 0;
+            for (int frame = 0; frame < 100 * Governor::DOWN_WINDOW && !changed; frame++) {
+                changed = spiky.frame(frame % Governor::DOWN_WINDOW < missed ? OVER_MS : STEADY_MS);
+            }
+            CHECK_EQ(changed != 0, missed == Governor::DOWN_MISSED);
+        }
+
+        // a frame just over budget * OVER_BUDGET misses, one at it doesn't; a level that had its window
+        // already steps down on DOWN_MISSED misses in a row
+        Governor edge(BUDGET_MS);
+        CHECK_EQ(framesToChange(edge, BUDGET_MS * Governor::OVER_BUDGET, 1000), 0);
+        CHECK_EQ(framesToChange(edge, BUDGET_MS * Governor::OVER_BUDGET + 0.01, 1000), Governor::DOWN_MISSED);
+    }
+
+    void checkRecovery() {
+        Governor governor(BUDGET_MS);
+        while (governor.level() < qualityGovernor::LEVEL_COUNT - 1) { governor.frame(OVER_MS); }
+
+        // frames without headroom don't step up however many there are
+        CHECK_EQ(framesToChange(governor, STEADY_MS, 5000), 0);
+
+        // a step up per UP_FRAMES fast frames, back to full quality
+        for (int level = qualityGovernor::LEVEL_COUNT - 2; level >= 0; level--) {
+            CHECK_EQ(framesToChange(governor, FAST_MS), Governor::UP_FRAMES);
+            CHECK_EQ(governor.level(), level);
+        }
+        CHECK_EQ(framesToChange(governor, FAST_MS, 5000), 0);
+        CHECK(governor.settings().smoothImages);
+
+        // one slow frame starts the run over
+        Governor interrupted(BUDGET_MS);
+        while (interrupted.level() < 1) { interrupted.frame(OVER_MS); }
+        for (int frame = 0; frame < Governor::UP_FRAMES - 1; frame++) { interrupted.frame(FAST_MS); }
+        interrupted.frame(STEADY_MS);
+        CHECK_EQ(framesToChange(interrupted, FAST_MS), Governor::UP_FRAMES);
+    }
+
+    // steps down, then up after upFrames() fast frames, and takes that back right away
+    void oscillate(Governor& governor) {
+        while (governor.level() < 1) { governor.frame(OVER_MS); }
+        const int upFrames = governor.upFrames();
+        CHECK_EQ(framesToChange(governor, FAST_MS), upFrames);
+        CHECK_EQ(framesToChange(governor, OVER_MS), Governor::DOWN_WINDOW);
+    }
+
+    void checkOscillation() {
+        Governor governor(BUDGET_MS);
+        CHECK_EQ(governor.upFrames(), Governor::UP_FRAMES);
+        int expected = Governor::UP_FRAMES;
+        for (int round = 0; round < 8; round++) {
+            oscillate(governor);
+            expected = expected * 2 > Governor::MAX_UP_FRAMES ? Governor::MAX_UP_FRAMES : expected * 2;
+            CHECK_EQ(governor.upFrames(), expected);
+        }
+        CHECK_EQ(governor.upFrames(), Governor::MAX_UP_FRAMES);
+
+        // a step down long after the step up isn't an oscillation
+        Governor settled(BUDGET_MS);
+        while (settled.level() < 1) { settled.frame(OVER_MS); }
+        framesToChange(settled, FAST_MS);
+        for (int frame = 0; frame < Governor::OSCILLATION_FRAMES; frame++) { settled.frame(STEADY_MS); }
+        CHECK_EQ(framesToChange(settled, OVER_MS), Governor::DOWN_MISSED);
+        CHECK_EQ(settled.upFrames(), Governor::UP_FRAMES);
+
+        // every CALM_FRAMES at the same level halve it, back down to where it started and no further
+        for (int halving = 0; halving < 4; halving++) {
+            const int before = governor.upFrames();
+            CHECK_EQ(framesToChange(governor, STEADY_MS, Governor::CALM_FRAMES), 0);
+            CHECK_EQ(governor.upFrames(), before / 2);
+        }
+        CHECK_EQ(framesToChange(governor, STEADY_MS, 2 * Governor::CALM_FRAMES), 0);
+        CHECK_EQ(governor.upFrames(), Governor::UP_FRAMES);
+    }
+
+    void checkStalls() {
+        // stalls alone change nothing, not even at full load
+        Governor governor(BUDGET_MS);
+        CHECK_EQ(framesToChange(governor, STALL_MS, 1000), 0);
+        CHECK_EQ(framesToChange(governor, Governor::IGNORED_FRAME_MS + 1.0, 1000), 0);
+        CHECK_EQ(governor.level(), 0);
+
+        // nor do they count as frames: a window of misses with stalls in between steps down on its last miss
+        int missed = 0, frames = 0;
+        while (missed < Governor::DOWN_WINDOW) {
+            frames++;
+            if (frames % 3 == 0) {
+                CHECK(!governor.frame(STALL_MS));
+            } else {
+                missed++;
+                if (governor.frame(OVER_MS)) { break; }
+            }
+        }
+        CHECK_EQ(missed, Governor::DOWN_WINDOW);
+        CHECK_EQ(governor.level(), 1);
+
+        // and don't break a run of headroom
+        for (int frame = 0; frame < Governor::UP_FRAMES - 1; frame++) { governor.frame(FAST_MS); }
+        CHECK(!governor.frame(STALL_MS));
+        CHECK(governor.frame(FAST_MS));
+        CHECK_EQ(governor.level(), 0);
+
+        // a frame of exactly IGNORED_FRAME_MS is a slow frame like any other
+        CHECK_EQ(framesToChange(governor, Governor::IGNORED_FRAME_MS), Governor::DOWN_WINDOW);
+    }
+
+    void checkLevels() {
+        // each level gives up something more and takes nothing back
+        int wrong = 0;
+        for (int level = 1; level < qualityGovernor::LEVEL_COUNT; level++) {
+            qualityGovernor::Settings better = qualityGovernor::settingsFor(level - 1);
+            qualityGovernor::Settings worse = qualityGovernor::settingsFor(level);
+            wrong += worse.smoothImages > better.smoothImages || worse.maxFallingApples > better.maxFallingApples ||
+                worse.appleGradient > better.appleGradient || worse.outlineScale > better.outlineScale ||
+                worse.textAntialiasing > better.textAntialiasing;
+            wrong += worse.smoothImages == better.smoothImages && worse.maxFallingApples == better.maxFallingApples &&
+                worse.appleGradient == better.appleGradient && worse.outlineScale == better.outlineScale &&
+                worse.textAntialiasing == better.textAntialiasing;
+        }
+        CHECK_EQ(wrong, 0);
+        CHECK(qualityGovernor::settingsFor(-1).smoothImages);
+        CHECK(!qualityGovernor::settingsFor(qualityGovernor::LEVEL_COUNT).textAntialiasing);
+    }
+} // namespace
+
+int main() {
+    checkOverload();
+    checkRecovery();
+    checkOscillation();
+    checkStalls();
+    checkLevels();
+    return check::result();
+}
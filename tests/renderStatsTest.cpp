@@ -0,0 +1,123 @@
+// Render stats fed known counts and frame times: counters land in the section set when they're
+// counted, lastFrame is the last finished frame, and FPS and percentiles cover the last HISTORY_SIZE
+// frames, older ones dropping out as the window wraps around.
+#include <cmath>
+#include "check.h"
+#include "renderStats.h"
+
+namespace {
+    using renderStats::Section;
+
+    bool near(double a, double b) { return std::fabs(a - b) < 1e-9 * std::fabs(b) + 1e-12; }
+
+    // a frame of known counts, the apples drawn applePasses times
+    void drawFrame(int applePasses, double frameTimeMs) {
+        renderStats::beginFrame();
+        // MENU until a section is set
+        renderStats::countDrawCall();
+        renderStats::setSection(Section::PLAY_FIELD);
+        renderStats::countTransform();
+        renderStats::countDrawCall();
+        renderStats::countDrawCall();
+        renderStats::setSection(Section::APPLES);
+        for (int pass = 0; pass < applePasses; pass++) {
+            for (int apple = 0; apple < 170; apple++) {
+                renderStats::countTransform();
+                renderStats::countDrawCall();
+            }
+            renderStats::countBrushColor();
+        }
+        renderStats::setSection(Section::TEXT);
+        renderStats::countText();
+        renderStats::countText();
+        renderStats::setSection(Section::OVERLAYS);
+        renderStats::countBrushColor();
+        renderStats::countDrawCall();
+        renderStats::endFrame(frameTimeMs);
+    }
+
+    void checkEmpty() {
+        CHECK_EQ(renderStats::averageFps(), 0.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 0.0);
+        CHECK_EQ(renderStats::lastFrame().total().drawCalls, 0u);
+    }
+
+    void checkSections() {
+        drawFrame(1, 16.0);
+        const renderStats::FrameStats& frame = renderStats::lastFrame();
+        CHECK_EQ(frame.section(Section::MENU).drawCalls, 1u);
+        CHECK_EQ(frame.section(Section::PLAY_FIELD).drawCalls, 2u);
+        CHECK_EQ(frame.section(Section::PLAY_FIELD).transformChanges, 1u);
+        CHECK_EQ(frame.section(Section::APPLES).drawCalls, 170u);
+        CHECK_EQ(frame.section(Section::APPLES).transformChanges, 170u);
+        CHECK_EQ(frame.section(Section::APPLES).brushColorChanges, 1u);
+        // a text is a draw call too
+        CHECK_EQ(frame.section(Section::TEXT).textDraws, 2u);
+        CHECK_EQ(frame.section(Section::TEXT).drawCalls, 2u);
+        CHECK_EQ(frame.section(Section::OVERLAYS).brushColorChanges, 1u);
+        CHECK_EQ(frame.total().drawCalls, 1u + 2u + 170u + 2u + 1u);
+        CHECK_EQ(frame.total().transformChanges, 171u);
+        CHECK_EQ(frame.total().brushColorChanges, 2u);
+        CHECK_EQ(frame.total().textDraws, 2u);
+        CHECK_EQ(frame.frameTimeMs, 16.0);
+
+        // the apples drawn twice show as twice the apple draw calls, the other sections unchanged
+        drawFrame(2, 16.0);
+        CHECK_EQ(frame.section(Section::APPLES).drawCalls, 340u);
+        CHECK_EQ(frame.section(Section::PLAY_FIELD).drawCalls, 2u);
+        CHECK_EQ(frame.total().drawCalls, 1u + 2u + 340u + 2u + 1u);
+
+        // a frame being drawn doesn't show until it's finished
+        renderStats::beginFrame();
+        renderStats::setSection(Section::APPLES);
+        renderStats::countDrawCall();
+        CHECK_EQ(renderStats::lastFrame().section(Section::APPLES).drawCalls, 340u);
+        renderStats::endFrame(16.0);
+        CHECK_EQ(renderStats::lastFrame().section(Section::APPLES).drawCalls, 1u);
+        CHECK_EQ(renderStats::lastFrame().section(Section::MENU).drawCalls, 0u);
+    }
+
+    void checkWindow() {
+        // after the 3 frames of checkSections, 1 to HISTORY_SIZE ms fill the window exactly
+        const int N = renderStats::HISTORY_SIZE;
+        for (int i = 1; i <= N; i++) { renderStats::endFrame(i); }
+        const double sum = N * (N + 1) / 2.0;
+        CHECK(near(renderStats::averageFps(), 1000.0 * N / sum));
+        // the value at rank round(p / 100 * (N - 1))
+        CHECK_EQ(renderStats::frameTimePercentileMs(0.0), 1.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(50.0), 129.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 253.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(100.0), static_cast<double>(N));
+
+        // half a window of stalls pushes out the fastest half
+        for (int i = 0; i < N / 2; i++) { renderStats::endFrame(1000.0); }
+        const double upperHalf = sum - (N / 2) * (N / 2 + 1) / 2.0;
+        CHECK(near(renderStats::averageFps(), 1000.0 * N / (upperHalf + 1000.0 * N / 2)));
+        CHECK_EQ(renderStats::frameTimePercentileMs(0.0), N / 2 + 1.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(49.0), N - 2.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(50.0), 1000.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 1000.0);
+
+        // and a full window of steady frames leaves nothing of them
+        for (int i = 0; i < N; i++) { renderStats::endFrame(5.0); }
+        CHECK(near(renderStats::averageFps(), 200.0));
+        CHECK_EQ(renderStats::frameTimePercentileMs(0.0), 5.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 5.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(100.0), 5.0);
+
+        // one slow frame in a full window is the maximum but not the 99th percentile
+        renderStats::endFrame(40.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(100.0), 40.0);
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 5.0);
+        // four of them are
+        for (int i = 0; i < 3; i++) { renderStats::endFrame(40.0); }
+        CHECK_EQ(renderStats::frameTimePercentileMs(99.0), 40.0);
+    }
+} // namespace
+
+int main() {
+    checkEmpty();
+    checkSections();
+    checkWindow();
+    return check::result();
+}
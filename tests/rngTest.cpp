@@ -0,0 +1,122 @@
+// Random streams are reproducible: fixed values for fixed seeds on every compiler and platform,
+// splits independent of what was drawn, batches equal to single draws, and boards the same
+// however many threads generate them. Saved games, daily boards and spectators rely on all of it.
+#include <cstdint>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+#include "rng.h"
+
+namespace {
+    void checkKnownValues() {
+        // SplitMix64's reference output for seed 0
+        rng::Stream zero(0);
+        CHECK_EQ(zero.next(), 0xe220a8397b1dcdafull);
+        CHECK_EQ(zero.next(), 0x6e789e6aa1b965f4ull);
+        CHECK_EQ(zero.next(), 0x06c45d188009454full);
+
+        rng::Stream seeded(42);
+        rng::Stream split = seeded.split(7);
+        CHECK_EQ(seeded.next(), 0x989b3f130a063869ull);
+        CHECK_EQ(seeded.next(), 0x290db4bf2570ded7ull);
+        CHECK_EQ(split.next(), 0x4d0498159e682c82ull);
+        CHECK_EQ(split.next(), 0x7507b605e2d02494ull);
+
+        // usable at compile time too
+        static_assert(rng::at(0, 0) == 0xe220a8397b1dcdafull);
+    }
+
+    void checkSplitsAndBatches() {
+        rng::Stream stream(32);
+        rng::Stream before = stream.split(5);
+        for (int i = 0; i < 100; i++) { stream.next(); }
+        rng::Stream after = stream.split(5);
+        CHECK_EQ(before.next(), after.next());
+        CHECK(stream.split(5).next() != stream.split(6).next());
+
+        rng::Stream single(99), batched(99);
+        std::vector<float> floats(1000);
+        batched.fillFloats(floats.data(), floats.size(), -3.0f, 5.0f);
+        int different = 0;
+        for (float value : floats) { different += value != single.nextFloat(-3.0f, 5.0f); }
+        CHECK_EQ(different, 0);
+        // and both go on from the same place
+        CHECK_EQ(single.next(), batched.next());
+    }
+
+    void checkRanges() {
+        rng::Stream stream(7);
+        std::vector<int> seen(9);
+        int outside = 0;
+        for (int i = 0; i < 10000; i++) {
+            int32_t value = stream.nextInt(1, 9);
+            if (value < 1 || value > 9) {
+                outside++;
+                continue;
+            }
+            seen[value - 1]++;
+            float f = stream.nextFloat(2.0f, 3.0f);
+            outside += f < 2.0f || f >= 3.0f;
+        }
+        CHECK_EQ(outside, 0);
+        // every value turns up about as often
+        for (int count : seen) { CHECK(count > 1000 && count < 1230); }
+        CHECK_EQ(stream.nextInt(INT32_MIN, INT32_MIN), INT32_MIN);
+    }
+
+    uint64_t boardHash(const gamestate::AppleGrid& apples) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        apples.forEach([&](const gamestate::Apple& apple, INT, INT) {
+            const int32_t fields[] = { apple.value, apple.fixedX, apple.fixedY, apple.velX, apple.velY, apple.accY, apple.velAngular };
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(fields);
+            for (size_t i = 0; i < sizeof(fields); i++) { hash = (hash ^ bytes[i]) * 0x100000001b3ull; }
+        });
+        return hash;
+    }
+
+    void checkBoards() {
+        gamestate::GameState gameState;
+        gameState.appleCountX = gamestate::DEFAULT_APPLES_X;
+        gameState.appleCountY = gamestate::DEFAULT_APPLES_Y;
+        gameState.ruleVariant = rules::Variant::CLASSIC;
+        gamestate::GameState::SingletonPlay play;
+        gameLogic::generateBoard(gameState, play, 1, nullptr);
+        // values and falling physics of the default board of seed 1, as they have always been
+        CHECK_EQ(boardHash(play.apples), 0xd5a6923ad53a1ce4ull);
+
+        // big enough to be generated on several threads, against one apple at a time
+        gameState.appleCountX = 200;
+        gameState.appleCountY = 90;
+        gameLogic::generateBoard(gameState, play, 77, nullptr);
+        gamestate::GameState::SingletonPlay again;
+        gameLogic::generateBoard(gameState, again, 77, nullptr);
+        CHECK_EQ(boardHash(play.apples), boardHash(again.apples));
+
+        // an apple depends on the seed and its cell only, so a bigger board starts with the same
+        // physics (values differ where the fix-up changed them)
+        gamestate::GameState::SingletonPlay wider;
+        gameState.appleCountX = 201;
+        gameLogic::generateBoard(gameState, wider, 77, nullptr);
+        int different = 0;
+        for (INT x = 0; x < 200; x++) {
+            different += play.apples.at(x, 0).velX != wider.apples.at(x, 0).velX ||
+                play.apples.at(x, 0).accY != wider.apples.at(x, 0).accY;
+        }
+        CHECK_EQ(different, 0);
+
+        // and games of the same start time play the same boards
+        headless::Game first, second;
+        first.start({});
+        second.start({});
+        CHECK_EQ(first.state.players[0].boardSeed, second.state.players[0].boardSeed);
+        CHECK_EQ(boardHash(first.state.players[0].apples), boardHash(second.state.players[0].apples));
+    }
+} // namespace
+
+int main() {
+    checkKnownValues();
+    checkSplitsAndBatches();
+    checkRanges();
+    checkBoards();
+    return check::result();
+}
@@ -0,0 +1,129 @@
+// Move validators of every rule variant against a brute force check of the rules, over every
+// rectangle of random boards, and generated boards against the variant's value range and sum.
+// In a game the same moves have to pop and score.
+#include <set>
+#include <utility>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+
+namespace {
+    struct Cell {
+        int value;
+        bool popped;
+    };
+
+    // the rules as written down: a move is the unpopped apples of the dragged rectangle, they must
+    // sum to the target and, for lines, lie in one row or column
+    template<typename R>
+    void checkVariant(rng::Stream& random) {
+        const int SIZE_X = 6, SIZE_Y = 5;
+        int moves = 0;
+        for (int board = 0; board < 40; board++) {
+            std::vector<Cell> cells(SIZE_X * SIZE_Y);
+            for (Cell& cell : cells) {
+                cell = { random.nextInt(R::MIN_VALUE, R::MAX_VALUE), random.nextInt(0, 3) == 0 };
+            }
+            for (int y0 = 0; y0 < SIZE_Y; y0++) for (int y1 = y0; y1 < SIZE_Y; y1++) {
+                for (int x0 = 0; x0 < SIZE_X; x0++) for (int x1 = x0; x1 < SIZE_X; x1++) {
+                    rules::Selection<R> selection;
+                    int sum = 0, count = 0;
+                    std::set<int> rows, columns;
+                    for (int y = y0; y <= y1; y++) {
+                        for (int x = x0; x <= x1; x++) {
+                            const Cell& cell = cells[y * SIZE_X + x];
+                            if (cell.popped) { continue; }
+                            selection.add(cell.value, x, y);
+                            sum += cell.value;
+                            count++;
+                            rows.insert(y);
+                            columns.insert(x);
+                        }
+                    }
+                    bool line = rows.size() <= 1 || columns.size() <= 1;
+                    bool valid = sum == R::TARGET_SUM && (R::SELECTION_SHAPE == rules::SelectionShape::RECTANGLE || line);
+                    CHECK_EQ(selection.valid(), valid);
+                    CHECK_EQ(selection.sum(), sum);
+                    CHECK_EQ(selection.count(), count);
+                    if (valid) {
+                        CHECK_EQ(selection.score(), R::SCORING_TYPE == rules::Scoring::PER_APPLE ? count : 1);
+                        moves++;
+                    }
+                }
+            }
+        }
+        CHECK(moves > 0);
+    }
+
+    // values in range, and the sum made divisible by the target so the board can be cleared
+    template<typename R>
+    void checkGenerated(rules::Variant variant) {
+        gamestate::GameState gameState;
+        gameState.ruleVariant = variant;
+        for (auto [x, y] : { std::pair{ 4, 4 }, { 17, 10 }, { 32, 20 }, { 37, 23 } }) {
+            gameState.appleCountX = x;
+            gameState.appleCountY = y;
+            for (UINT64 seed = 1; seed <= 20; seed++) {
+                gamestate::GameState::SingletonPlay play;
+                gameLogic::generateBoard(gameState, play, seed, nullptr);
+                int sum = 0, outOfRange = 0;
+                play.apples.forEach([&](const gamestate::Apple& apple, INT, INT) {
+                    sum += apple.value;
+                    outOfRange += apple.value < R::MIN_VALUE || apple.value > R::MAX_VALUE;
+                });
+                CHECK_EQ(outOfRange, 0);
+                CHECK_EQ(sum % R::TARGET_SUM, 0);
+            }
+        }
+    }
+
+    // moves popped in a game score by the variant's rules, a block isn't a line
+    template<typename R>
+    void checkPlayed(rules::Variant variant) {
+        headless::Game game;
+        game.start({ .ruleVariant = variant });
+        const gamestate::GameState::SingletonPlay& play = game.state.players[0];
+        for (int move = 0; move < 5; move++) {
+            INT score = play.score;
+            size_t popped = play.poppedApples.size();
+            CHECK(game.popAny());
+            size_t apples = play.poppedApples.size() - popped;
+            CHECK(apples > 0);
+            CHECK_EQ(play.score - score, R::SCORING_TYPE == rules::Scoring::PER_APPLE ? static_cast<INT>(apples) : 1);
+        }
+
+        if constexpr (R::SELECTION_SHAPE == rules::SelectionShape::LINE) {
+            // a 2x2 block of unpopped apples summing to the target isn't a move
+            for (INT y = 0; y + 1 < play.apples.sizeY(); y++) {
+                for (INT x = 0; x + 1 < play.apples.sizeX(); x++) {
+                    int sum = 0, unpopped = 0;
+                    for (INT c = 0; c < 4; c++) {
+                        const gamestate::Apple& apple = play.apples.at(x + c % 2, y + c / 2);
+                        sum += apple.value;
+                        unpopped += !apple.popped;
+                    }
+                    if (unpopped == 4 && sum == R::TARGET_SUM) {
+                        INT score = play.score;
+                        game.drag(x, y, x + 1, y + 1);
+                        CHECK_EQ(play.score, score);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+} // namespace
+
+int main() {
+    rng::Stream random(31);
+    for (int v = 0; v < static_cast<int>(rules::Variant::COUNT); v++) {
+        rules::Variant variant = static_cast<rules::Variant>(v);
+        rules::visit(variant, [&](auto rules) {
+            using R = decltype(rules);
+            checkVariant<R>(random);
+            checkGenerated<R>(variant);
+            checkPlayed<R>(variant);
+        });
+    }
+    return check::result();
+}
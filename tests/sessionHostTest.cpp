@@ -0,0 +1,197 @@
+// Session host: sessions ticked together play exactly like games of their own fed the same input,
+// a click or a drag sent in one batch takes the ticks it takes in a window, sessions draw boards
+// of their own, and ended and closed sessions leave the others alone.
+#include <deque>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+#include "sessionHost.h"
+
+namespace {
+    using sessionHost::Input;
+    using Batch = std::vector<Input>;
+
+    const UINT64 SEED = 5;
+
+    void apply(Controller& controller, const Input& input) {
+        switch (input.type) {
+        case Input::Type::MOUSE_MOVE: controller.setMousePos(input.x, input.y); break;
+        case Input::Type::KEY_DOWN: controller.setKeyDown(input.key, true); break;
+        case Input::Type::KEY_UP: controller.setKeyDown(input.key, false); break;
+        case Input::Type::WHEEL: controller.addWheelDelta(input.x); break;
+        case Input::Type::WINDOW_SIZE: controller.setWindowSize(input.x, input.y); break;
+        }
+    }
+
+    Input move(FLOAT x, FLOAT y) { return { Input::Type::MOUSE_MOVE, 0, static_cast<INT>(x), static_cast<INT>(y) }; }
+    Input down(UINT8 key = VK_LBUTTON) { return { Input::Type::KEY_DOWN, key, 0, 0 }; }
+    Input up(UINT8 key = VK_LBUTTON) { return { Input::Type::KEY_UP, key, 0, 0 }; }
+
+    bool samePlay(const gamestate::GameState& a, const gamestate::GameState& b) {
+        if (a.mode != b.mode || a.playerCount != b.playerCount || a.ruleVariant != b.ruleVariant) { return false; }
+        for (INT i = 0; i < a.playerCount; i++) {
+            const gamestate::GameState::SingletonPlay& p = a.players[i];
+            const gamestate::GameState::SingletonPlay& q = b.players[i];
+            if (p.boardSeed != q.boardSeed || p.score != q.score || p.timesOver != q.timesOver ||
+                p.fallingApples.size() != q.fallingApples.size() || p.poppedApples.size() != q.poppedApples.size()) {
+                return false;
+            }
+            for (size_t k = 0; k < p.poppedApples.size(); k++) {
+                if (p.poppedApples[k].x != q.poppedApples[k].x || p.poppedApples[k].y != q.poppedApples[k].y) { return false; }
+            }
+        }
+        return true;
+    }
+
+    // Plays a session through the menus into a game and pops whatever it finds, one batch per tick.
+    // The same batches go to a game of its own, which also decides what to do next.
+    struct Player {
+        headless::Game reference;
+        sessionHost::SessionId id;
+        INT variantPresses;
+        std::deque<Batch> planned;
+
+        Player(sessionHost::Host& host, timeBase::Ns startNs, UINT64 opened, INT variantPresses) :
+            reference(startNs), id(host.open(startNs)), variantPresses(variantPresses) {
+            reference.state.sessionRng = rng::Stream(SEED).split(opened);
+            reference.state.nextSeed = reference.state.sessionRng.next();
+        }
+
+        void plan() {
+            const gamestate::GameState& state = reference.state;
+            const gamestate::Button& start = gamestate::buttonMainMenuStart;
+            INT found[4];
+            if (state.mode == gamestate::GameState::Mode::TITLE_MENU) {
+                planned.push_back({ move(100, 100), down() });
+                planned.push_back({ up() });
+            } else if (state.mode == gamestate::GameState::Mode::MAIN_MENU && variantPresses > 0) {
+                variantPresses--;
+                planned.push_back({ down('V') });
+                planned.push_back({ up('V') });
+            } else if (state.mode == gamestate::GameState::Mode::MAIN_MENU) {
+                planned.push_back({ move((start.left + start.right) / 2, (start.top + start.bottom) / 2), down() });
+                planned.push_back({ up() });
+            } else if (reference.findMove(found, 0, 3)) {
+                const FLOAT inset = state.appleSize * 0.45f;
+                planned.push_back({ move(reference.cellX(found[0]) - inset, reference.cellY(found[1]) - inset), down() });
+                planned.push_back({ move(reference.cellX(found[2]) + inset, reference.cellY(found[3]) + inset) });
+                planned.push_back({ up() });
+            } else {
+                planned.push_back({ down('R') });
+                planned.push_back({ up('R') });
+            }
+        }
+
+        // the next batch, applied to the reference game and sent to the host
+        void step(sessionHost::Host& host) {
+            if (planned.empty()) { plan(); }
+            const Batch batch = planned.front();
+            planned.pop_front();
+            for (const Input& input : batch) { apply(reference.controller, input); }
+            reference.frame();
+            host.submit(id, batch.data(), batch.size());
+        }
+    };
+
+    void checkAgainstOwnGames() {
+        const timeBase::Ns startNs = timeBase::NS_PER_SECOND;
+        sessionHost::Host host(SEED);
+        std::vector<std::unique_ptr<Player>> players;
+        const INT SESSIONS = 24;
+        for (INT i = 0; i < SESSIONS; i++) { players.push_back(std::make_unique<Player>(host, startNs, i, i % 4)); }
+        CHECK_EQ(host.sessionCount(), static_cast<size_t>(SESSIONS));
+
+        timeBase::Ns timeNs = startNs;
+        int differing = 0;
+        for (int tick = 0; tick < 600; tick++) {
+            for (const std::unique_ptr<Player>& player : players) { player->step(host); }
+            timeNs += headless::FRAME_NS;
+            host.tick(timeNs);
+            for (const std::unique_ptr<Player>& player : players) {
+                differing += !samePlay(host.state(player->id), player->reference.state);
+            }
+        }
+        CHECK_EQ(differing, 0);
+
+        // every session played, on boards of its own
+        int playing = 0, popped = 0;
+        for (INT i = 0; i < SESSIONS; i++) {
+            const gamestate::GameState& state = host.state(players[i]->id);
+            playing += state.mode == gamestate::GameState::Mode::PLAYING;
+            popped += !state.players[0].poppedApples.empty();
+            for (INT j = 0; j < i; j++) {
+                CHECK(state.players[0].boardSeed != host.state(players[j]->id).players[0].boardSeed);
+            }
+        }
+        CHECK_EQ(playing, SESSIONS);
+        CHECK_EQ(popped, SESSIONS);
+    }
+
+    void checkBatches() {
+        timeBase::Ns timeNs = timeBase::NS_PER_SECOND;
+        sessionHost::Host host(SEED);
+        sessionHost::SessionId id = host.open(timeNs);
+        auto tick = [&](int count) {
+            for (int i = 0; i < count; i++) { host.tick(timeNs += headless::FRAME_NS); }
+        };
+
+        // two clicks in one batch, through the title and main menu into a game
+        const gamestate::Button& start = gamestate::buttonMainMenuStart;
+        const Batch clicks = { move(10, 10), down(), up(), move((start.left + start.right) / 2, (start.top + start.bottom) / 2),
+            down(), up() };
+        host.submit(id, clicks.data(), clicks.size());
+        tick(1);
+        CHECK(host.state(id).mode == gamestate::GameState::Mode::MAIN_MENU);
+        tick(3);
+        CHECK(host.state(id).mode == gamestate::GameState::Mode::PLAYING);
+
+        // a whole drag over a valid move, and the session next to it isn't touched
+        sessionHost::SessionId other = host.open(timeNs);
+        headless::Game finder;
+        finder.state.players[0].apples = host.state(id).players[0].apples;
+        finder.state.ruleVariant = host.state(id).ruleVariant;
+        INT found[4];
+        CHECK(finder.findMove(found));
+        const gamestate::GameState::SingletonPlay& play = host.state(id).players[0];
+        const FLOAT inset = host.state(id).appleSize * 0.45f;
+        auto x = [&](INT cell) { return play.toLogicalX(play.appleMinX + host.state(id).appleSize * (cell + 0.5f)); };
+        auto y = [&](INT cell) { return play.toLogicalY(play.appleMinY + host.state(id).appleSize * (cell + 0.5f)); };
+        const Batch drag = { move(x(found[0]) - inset, y(found[1]) - inset), down(), move(x(found[2]) + inset, y(found[3]) + inset), up() };
+        host.submit(id, drag.data(), drag.size());
+        tick(2);
+        CHECK(!host.state(id).players[0].poppedApples.empty());
+        CHECK(host.state(other).mode == gamestate::GameState::Mode::TITLE_MENU);
+
+        // escape in the title menu ends a session, it isn't ticked any more
+        const Batch escape = { down(VK_ESCAPE), up(VK_ESCAPE) };
+        host.submit(other, escape.data(), escape.size());
+        tick(2);
+        CHECK(host.ended(other));
+        const timeBase::Ns endedAt = host.state(other).currentTimeNs;
+        tick(1);
+        CHECK_EQ(host.state(other).currentTimeNs, endedAt);
+        CHECK(!host.ended(id));
+
+        // a closed session's slot is reused, in the title menu with nothing held and boards of its own
+        const UINT64 closedSeed = host.state(id).players[0].boardSeed;
+        host.submit(id, clicks.data(), 2);
+        host.close(id);
+        CHECK_EQ(host.sessionCount(), 1u);
+        sessionHost::SessionId reopened = host.open(timeNs);
+        CHECK_EQ(reopened, id);
+        CHECK_EQ(host.sessionCount(), 2u);
+        CHECK(host.state(reopened).mode == gamestate::GameState::Mode::TITLE_MENU);
+        tick(2);
+        CHECK(host.state(reopened).mode == gamestate::GameState::Mode::TITLE_MENU);
+        host.submit(reopened, clicks.data(), clicks.size());
+        tick(4);
+        CHECK(host.state(reopened).mode == gamestate::GameState::Mode::PLAYING);
+        CHECK(host.state(reopened).players[0].boardSeed != closedSeed);
+    }
+} // namespace
+
+int main() {
+    checkAgainstOwnGames();
+    checkBatches();
+    return check::result();
+}
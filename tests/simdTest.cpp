@@ -0,0 +1,115 @@
+// Vectorized bounds selection: every level the CPU supports selects exactly what the scalar kernel
+// and a plain reference select, over random chunks of apples and rectangles, with lengths that leave
+// tails of every size, points on the edges, popped apples and positions at the ends of the range.
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "check.h"
+#include "gameState.h"
+#include "rng.h"
+#include "simd.h"
+
+namespace {
+    using gamestate::Apple;
+
+    const simd::PointLayout APPLE_POINTS = {
+        .stride = sizeof(Apple),
+        .xOffset = offsetof(Apple, fixedX),
+        .yOffset = offsetof(Apple, fixedY),
+        .skipOffset = offsetof(Apple, popped),
+        .unit = gamestate::FALL_UNIT,
+    };
+
+    // the contract of selectInBounds, written out plainly
+    std::vector<uint64_t> reference(const std::vector<Apple>& apples, const simd::Bounds& bounds) {
+        std::vector<uint64_t> selected((apples.size() + 63) / 64, 0);
+        for (size_t i = 0; i < apples.size(); i++) {
+            const Apple& apple = apples[i];
+            const float x = static_cast<float>(apple.fixedX) * gamestate::FALL_UNIT;
+            const float y = static_cast<float>(apple.fixedY) * gamestate::FALL_UNIT;
+            if (!apple.popped && x + bounds.margin >= bounds.left && x - bounds.margin <= bounds.right &&
+                y + bounds.margin >= bounds.top && y - bounds.margin <= bounds.bottom) {
+                selected[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+        return selected;
+    }
+
+    std::vector<uint64_t> select(const std::vector<Apple>& apples, const simd::Bounds& bounds) {
+        // garbage past the last word would show if the kernels didn't clear it
+        std::vector<uint64_t> selected((apples.size() + 63) / 64, ~uint64_t(0));
+        simd::selectInBounds(apples.data(), apples.size(), APPLE_POINTS, bounds, selected.data());
+        return selected;
+    }
+
+    // apples on a grid of cells like a board's, some popped and some far off or at the ends of the range
+    std::vector<Apple> randomApples(rng::Stream& random, size_t count) {
+        std::vector<Apple> apples;
+        for (size_t i = 0; i < count; i++) {
+            Apple apple(random.nextInt(1, 9), static_cast<FLOAT>(random.nextInt(0, 40) * 50), static_cast<FLOAT>(random.nextInt(0, 30) * 50),
+                random.split(i));
+            if (random.nextInt(0, 4) == 0) { apple.pop(); }
+            if (random.nextInt(0, 9) == 0) {
+                apple.fixedX += random.nextInt(-(1 << 20), 1 << 20);
+                apple.fixedY += random.nextInt(-(1 << 20), 1 << 20);
+            }
+            if (random.nextInt(0, 49) == 0) { apple.fixedX = random.nextInt(0, 1) ? INT32_MAX : INT32_MIN; }
+            apples.push_back(apple);
+        }
+        return apples;
+    }
+
+    // on the cell grid so some apples lie exactly on the edges
+    simd::Bounds randomBounds(rng::Stream& random) {
+        const FLOAT left = static_cast<FLOAT>(random.nextInt(-2, 40) * 50), top = static_cast<FLOAT>(random.nextInt(-2, 30) * 50);
+        return {
+            .left = left,
+            .top = top,
+            .right = left + static_cast<FLOAT>(random.nextInt(0, 20) * 50),
+            .bottom = top + static_cast<FLOAT>(random.nextInt(0, 15) * 50),
+            .margin = random.nextInt(0, 2) == 0 ? 0.0f : random.nextFloat(0.0f, 60.0f),
+        };
+    }
+
+    void checkLevels() {
+        const simd::Level supported = simd::supportedLevel();
+        rng::Stream random(48);
+        int cases = 0, differing[static_cast<int>(simd::Level::COUNT)] = {};
+        for (int round = 0; round < 400; round++) {
+            // a chunk's worth and lengths around every vector width
+            const size_t count = round % 4 == 0 ? gamestate::AppleGrid::CHUNK_SIZE * gamestate::AppleGrid::CHUNK_SIZE
+                                                : static_cast<size_t>(random.nextInt(0, 200));
+            const std::vector<Apple> apples = randomApples(random, count);
+            for (int r = 0; r < 8; r++) {
+                const simd::Bounds bounds = randomBounds(random);
+                const std::vector<uint64_t> expected = reference(apples, bounds);
+                for (int level = 0; level <= static_cast<int>(supported); level++) {
+                    simd::setLevel(static_cast<simd::Level>(level));
+                    differing[level] += select(apples, bounds) != expected;
+                }
+                cases++;
+            }
+        }
+        simd::setLevel(supported);
+        for (int level = 0; level <= static_cast<int>(supported); level++) {
+            std::printf("%s: %d of %d cases differ\n", simd::levelName(static_cast<simd::Level>(level)), differing[level], cases);
+            CHECK_EQ(differing[level], 0);
+        }
+    }
+
+    void checkLevelControl() {
+        const simd::Level supported = simd::supportedLevel();
+        CHECK(simd::level() == supported);
+        simd::setLevel(simd::Level::SCALAR);
+        CHECK(simd::level() == simd::Level::SCALAR);
+        // never above what the CPU has
+        simd::setLevel(simd::Level::AVX512);
+        CHECK(simd::level() == supported);
+    }
+} // namespace
+
+int main() {
+    checkLevelControl();
+    checkLevels();
+    return check::result();
+}
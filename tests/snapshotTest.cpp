@@ -0,0 +1,181 @@
+// Snapshots: the checkpointer's copy of the game, kept up to date with what changed, has to write
+// exactly what serializing the game itself writes; restored games play on the same; snapshots
+// with settings or a view the game can't be in are refused without touching the game.
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "check.h"
+#include "headless.h"
+#include "snapshot.h"
+
+namespace {
+    const std::filesystem::path PATH = std::filesystem::temp_directory_path() / "apples-snapshot-test.snapshot";
+
+    std::vector<BYTE> sealed(const gamestate::GameState& gameState, timeBase::Ns timeNs) {
+        std::vector<BYTE> data(snapshot::serializedSize(gameState));
+        data.resize(snapshot::serialize(gameState, timeNs, data.data()));
+        snapshot::seal(data.data(), data.size());
+        return data;
+    }
+
+    std::vector<BYTE> readFile() {
+        std::ifstream in(PATH, std::ios::binary);
+        return std::vector<BYTE>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // the checkpoint on disk is the game as it is
+    void checkWritten(snapshot::Checkpointer& checkpointer, const headless::Game& game) {
+        checkpointer.checkpointNow(game.state, game.timeNs);
+        CHECK(readFile() == sealed(game.state, game.timeNs));
+    }
+
+    void checkCheckpoints() {
+        headless::Game game;
+        snapshot::Checkpointer checkpointer(PATH);
+        checkWritten(checkpointer, game); // title menu
+
+        game.start({});
+        checkWritten(checkpointer, game);
+        for (int round = 0; round < 12; round++) {
+            for (int pop = 0; pop < 2; pop++) { CHECK(game.popAny()); }
+            // apples are still falling at some checkpoints and have fallen since at others
+            for (int frame = 0; frame < (round % 3 == 0 ? 600 : 20); frame++) { game.frame(); }
+            if (round % 2 == 0) {
+                CHECK(checkpointer.tryCheckpoint(game.state, game.timeNs));
+                checkpointer.waitWritten();
+                CHECK(readFile() == sealed(game.state, game.timeNs));
+            } else {
+                checkWritten(checkpointer, game);
+            }
+            if (round == 5) {
+                game.tap('R'); // a new board of the same size
+                checkWritten(checkpointer, game);
+            }
+        }
+
+        // no board in the menu and in versus mode, then a different board again
+        game.tap(VK_ESCAPE);
+        checkWritten(checkpointer, game);
+        game.start({ .playerCount = 2 });
+        game.popAny();
+        checkWritten(checkpointer, game);
+        game.tap(VK_ESCAPE);
+        game.start({ .appleCountX = 9, .appleCountY = 7, .ruleVariant = rules::Variant::TWENTY });
+        CHECK(game.popAny());
+        checkWritten(checkpointer, game);
+    }
+
+    // restored the game plays on the same, and checkpoints of it start from the restored board
+    void checkRestore() {
+        headless::Game game;
+        game.start({ .appleCountX = 20, .appleCountY = 12 });
+        for (int pop = 0; pop < 6; pop++) { CHECK(game.popAny()); }
+        for (int frame = 0; frame < 30; frame++) { game.frame(); }
+        {
+            snapshot::Checkpointer checkpointer(PATH);
+            checkpointer.checkpointNow(game.state, game.timeNs);
+        }
+
+        headless::Game restored(game.timeNs + 5 * timeBase::NS_PER_SECOND);
+        CHECK(snapshot::loadFile(PATH, restored.state, restored.timeNs));
+        CHECK(restored.state.mode == gamestate::GameState::Mode::PLAYING);
+        const gamestate::GameState::SingletonPlay& was = game.state.players[0];
+        const gamestate::GameState::SingletonPlay& is = restored.state.players[0];
+        CHECK_EQ(is.score, was.score);
+        CHECK_EQ(is.boardSeed, was.boardSeed);
+        CHECK_EQ(is.poppedApples.size(), was.poppedApples.size());
+        CHECK_EQ(is.fallingApples.size(), was.fallingApples.size());
+        CHECK_EQ(restored.timeNs - is.startTimeNs, game.timeNs - was.startTimeNs);
+        int different = 0;
+        was.apples.forEach([&](const gamestate::Apple& apple, INT x, INT y) {
+            different += std::memcmp(&apple, &is.apples.at(x, y), sizeof(apple)) != 0;
+        });
+        CHECK_EQ(different, 0);
+
+        // both go on the same
+        for (int pop = 0; pop < 3; pop++) {
+            CHECK(game.popAny());
+            CHECK(restored.popAny());
+        }
+        CHECK_EQ(restored.state.players[0].score, game.state.players[0].score);
+
+        snapshot::Checkpointer checkpointer(PATH);
+        checkWritten(checkpointer, restored);
+        for (int frame = 0; frame < 10; frame++) { restored.frame(); }
+        checkWritten(checkpointer, restored);
+    }
+
+    // StateRecord of version 5, from the start of the snapshot
+    const size_t PLAY_TIME = 24 + 12;
+    const size_t APPLE_SIZE = 24 + 24;
+    const size_t APPLE_MIN_X = 24 + 56;
+    const size_t VIEW_ZOOM = 24 + 64;
+    const size_t VIEW_CENTER_X = 24 + 68;
+    const size_t VIEW_CENTER_Y = 24 + 72;
+
+    template<typename T>
+    bool accepted(std::vector<BYTE> data, size_t offset, T value) {
+        std::memcpy(data.data() + offset, &value, sizeof(value));
+        snapshot::seal(data.data(), data.size());
+
+        headless::Game target;
+        target.state.appleSize = 123.0f;
+        bool restored = snapshot::deserialize(data.data(), data.size(), target.state, target.timeNs);
+        // refused ones leave the game as it was
+        if (!restored) {
+            CHECK(target.state.mode == gamestate::GameState::Mode::TITLE_MENU);
+            CHECK_EQ(target.state.appleSize, 123.0f);
+            CHECK(target.state.players[0].apples.empty());
+        }
+        return restored;
+    }
+
+    void checkValidation() {
+        headless::Game game;
+        game.start({ .appleCountX = 100, .appleCountY = 100, .hugeBoard = true });
+        CHECK(game.state.players[0].zoomedIn());
+        const std::vector<BYTE> data = sealed(game.state, game.timeNs);
+        const float NaN = std::numeric_limits<float>::quiet_NaN();
+        const float INF = std::numeric_limits<float>::infinity();
+
+        CHECK(accepted(data, PLAY_TIME, game.state.playTime));
+        CHECK(!accepted(data, PLAY_TIME, 0));
+        CHECK(!accepted(data, PLAY_TIME, -5));
+        CHECK(!accepted(data, PLAY_TIME, gamestate::MAX_PLAY_TIME_SECONDS + 5));
+        for (float bad : { 0.0f, -1.0f, NaN, INF, 1e9f }) {
+            CHECK(!accepted(data, APPLE_SIZE, bad));
+            CHECK(!accepted(data, VIEW_ZOOM, bad));
+            CHECK(!accepted(data, APPLE_MIN_X, bad == 0.0f ? -1e6f : bad));
+            CHECK(!accepted(data, VIEW_CENTER_X, bad == 0.0f ? -1e6f : bad));
+            CHECK(!accepted(data, VIEW_CENTER_Y, bad == 0.0f ? -1e6f : bad));
+        }
+        CHECK(!accepted(data, VIEW_CENTER_X, gamestate::APPLES_PLAY_AREA.right + 1.0f));
+
+        // torn or damaged
+        headless::Game target;
+        CHECK(!snapshot::deserialize(data.data(), data.size() - 1, target.state, target.timeNs));
+        std::vector<BYTE> damaged = data;
+        damaged[data.size() / 2] ^= 1;
+        CHECK(!snapshot::deserialize(damaged.data(), damaged.size(), target.state, target.timeNs));
+        CHECK(target.state.mode == gamestate::GameState::Mode::TITLE_MENU);
+
+        // and the menu, where the apple size is whatever an earlier game left
+        headless::Game menu;
+        menu.state.mode = gamestate::GameState::Mode::MAIN_MENU;
+        menu.state.appleSize = NaN;
+        std::vector<BYTE> menuData = sealed(menu.state, menu.timeNs);
+        CHECK(accepted(menuData, APPLE_SIZE, NaN));
+    }
+} // namespace
+
+int main() {
+    checkCheckpoints();
+    checkRestore();
+    checkValidation();
+    std::filesystem::remove(PATH);
+    return check::result();
+}
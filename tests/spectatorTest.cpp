@@ -0,0 +1,360 @@
+// Spectator feed: a decoder fed the encoder's messages shows exactly what the game shows, every
+// frame, through menus, settings changes, versus, zoomed huge boards and library boards; a viewer
+// joining mid-game catches up at the next keyframe; torn messages wait for the rest and broken ones
+// unsync the decoder until the next keyframe instead of corrupting it.
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+#include "boardLibrary.h"
+#include "check.h"
+#include "headless.h"
+#include "spectatorCodec.h"
+
+namespace {
+    using gamestate::GameState;
+    using SingletonPlay = gamestate::GameState::SingletonPlay;
+
+    bool sameCells(const std::vector<gamestate::CellXY>& a, const std::vector<gamestate::CellXY>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [](gamestate::CellXY p, gamestate::CellXY q) { return p.x == q.x && p.y == q.y; });
+    }
+
+    // everything drawLogic draws from; popped apples that have fallen aren't drawn, so where they are isn't sent
+    bool sameView(const GameState& shown, const GameState& game) {
+        bool same = shown.mode == game.mode && shown.currentTimeNs == game.currentTimeNs &&
+            shown.appleCountX == game.appleCountX && shown.appleCountY == game.appleCountY &&
+            shown.playTime == game.playTime && shown.hugeBoard == game.hugeBoard &&
+            shown.ruleVariant == game.ruleVariant && shown.boardChoice == game.boardChoice &&
+            shown.playerCount == game.playerCount && shown.highScore == game.highScore &&
+            shown.logicalMouseX == game.logicalMouseX && shown.logicalMouseY == game.logicalMouseY;
+        if (!same || game.mode != GameState::Mode::PLAYING) { return same; }
+
+        same = shown.appleSize == game.appleSize;
+        for (INT i = 0; same && i < game.playerCount; i++) {
+            const SingletonPlay& a = shown.players[i];
+            const SingletonPlay& b = game.players[i];
+            same = a.score == b.score && (a.timesOver != FALSE) == (b.timesOver != FALSE) && a.boardSeed == b.boardSeed &&
+                a.startTimeNs == b.startTimeNs && a.inDrag == b.inDrag && a.viewZoom == b.viewZoom &&
+                a.viewCenterX == b.viewCenterX && a.viewCenterY == b.viewCenterY && a.appleMinX == b.appleMinX &&
+                a.appleMinY == b.appleMinY && a.area.left == b.area.left && a.area.bottom == b.area.bottom &&
+                (!b.inDrag || (a.dragStartX == b.dragStartX && a.dragStartY == b.dragStartY)) &&
+                a.apples.sizeX() == b.apples.sizeX() && a.apples.sizeY() == b.apples.sizeY() &&
+                sameCells(a.fallingApples, b.fallingApples) && sameCells(a.draggedApples, b.draggedApples) &&
+                a.poppedApples.size() == b.poppedApples.size();
+            if (!same) { break; }
+
+            std::vector<bool> falling(static_cast<size_t>(b.apples.sizeX()) * b.apples.sizeY());
+            for (gamestate::CellXY cell : b.fallingApples) { falling[static_cast<size_t>(cell.y) * b.apples.sizeX() + cell.x] = true; }
+            b.apples.forEach([&](const gamestate::Apple& apple, INT x, INT y) {
+                const gamestate::Apple& other = a.apples.at(x, y);
+                same = same && other.value == apple.value && other.popped == apple.popped && other.inDrag == apple.inDrag;
+                if (!apple.popped || falling[static_cast<size_t>(y) * b.apples.sizeX() + x]) {
+                    same = same && other.fixedX == apple.fixedX && other.fixedY == apple.fixedY &&
+                        other.fixedAngle == apple.fixedAngle && other.velY == apple.velY;
+                }
+            });
+        }
+        return same;
+    }
+
+    // A game with a viewer following it; the viewer's own encoder starts with a keyframe, like
+    // the broadcaster's does for every viewer that connects
+    struct Feed {
+        headless::Game& game;
+        spectator::Encoder encoder;
+        spectator::Decoder decoder;
+        headless::Game viewer;
+        std::vector<BYTE> stream;
+        int mismatches = 0;
+        int frames = 0;
+
+        explicit Feed(headless::Game& game) : game(game) {}
+
+        // encodes the frame the game is at and shows it
+        void sync() {
+            size_t from = stream.size();
+            encoder.encode(game.state, stream);
+            CHECK_EQ(decoder.apply(stream.data() + from, stream.size() - from, viewer.state), stream.size() - from);
+            frames++;
+            mismatches += !decoder.synced() || !sameView(viewer.state, game.state);
+        }
+    };
+
+    // a game whose every frame is encoded for any number of feeds
+    struct Session {
+        headless::Game game;
+        std::vector<Feed*> feeds;
+
+        Session() {
+            game.afterFrame = [this]() {
+                for (Feed* feed : feeds) { feed->sync(); }
+            };
+        }
+
+        void frames(int count) {
+            for (int i = 0; i < count; i++) { game.frame(); }
+        }
+    };
+
+    void checkGame() {
+        Session session;
+        Feed feed(session.game);
+        session.feeds = { &feed };
+        feed.sync(); // title menu
+
+        session.game.start({});
+        for (int round = 0; round < 8; round++) {
+            CHECK(session.game.popAny());
+            session.frames(round % 2 ? 40 : 3);
+        }
+
+        // a drag in progress, then let go without popping
+        session.game.moveTo(session.game.cellX(0), session.game.cellY(0));
+        session.game.press();
+        session.frames(2);
+        session.game.moveTo(session.game.cellX(3), session.game.cellY(2));
+        session.frames(3);
+        session.game.release();
+        session.frames(2);
+
+        session.game.tap('R'); // a new board of the same settings
+        CHECK(session.game.popAny());
+        session.frames(10);
+
+        // settings changes between games
+        session.game.tap(VK_ESCAPE);
+        session.game.start({ .appleCountX = 9, .appleCountY = 7, .ruleVariant = rules::Variant::TWENTY });
+        for (int round = 0; round < 3; round++) { session.game.popAny(); }
+        session.frames(20);
+        session.game.tap(VK_ESCAPE);
+        session.game.start({ .playerCount = 3, .ruleVariant = rules::Variant::LINES });
+        for (INT player = 0; player < 3; player++) { session.game.popAny(player); }
+        session.frames(30);
+
+        // zooming and panning on a huge board change the view only
+        session.game.tap(VK_ESCAPE);
+        session.game.start({ .appleCountX = 120, .appleCountY = 80, .hugeBoard = true });
+        for (UINT8 key : { VK_RIGHT, VK_DOWN, VK_RIGHT }) { session.game.tap(key); }
+        session.game.controller.addWheelDelta(-WHEEL_DELTA);
+        session.frames(5);
+        CHECK(session.game.popAny());
+        session.frames(10);
+
+        // the time running out, and the periodic keyframe on the way
+        session.game.tap(VK_ESCAPE);
+        session.game.start({ .playTime = gamestate::MIN_PLAY_TIME_SECONDS });
+        session.frames(static_cast<int>(gamestate::MIN_PLAY_TIME_SECONDS * 60 + 30));
+        CHECK(session.game.state.players[0].timesOver);
+        session.frames(spectator::KEYFRAME_INTERVAL);
+
+        CHECK(feed.frames > 1000);
+        CHECK_EQ(feed.mismatches, 0);
+    }
+
+    // a second viewer in the middle of a game
+    void checkJoin() {
+        Session session;
+        Feed first(session.game);
+        session.feeds = { &first };
+        session.game.start({ .appleCountX = 20, .appleCountY = 12 });
+        for (int pop = 0; pop < 5; pop++) { session.game.popAny(); }
+        session.frames(15); // some still falling
+
+        Feed late(session.game);
+        session.feeds.push_back(&late);
+        late.sync();
+        CHECK(late.decoder.synced());
+        for (int pop = 0; pop < 5; pop++) { session.game.popAny(); }
+        session.frames(100);
+        CHECK_EQ(first.mismatches, 0);
+        CHECK_EQ(late.mismatches, 0);
+
+        // picking up the first viewer's stream in the middle waits for its next keyframe
+        headless::Game joined;
+        spectator::Decoder decoder;
+        size_t deltas = first.stream.size();
+        for (UINT32 frame = 0; frame < spectator::KEYFRAME_INTERVAL + 1; frame++) {
+            session.frames(1);
+            size_t used = decoder.apply(first.stream.data() + deltas, first.stream.size() - deltas, joined.state);
+            CHECK_EQ(used, first.stream.size() - deltas);
+            deltas += used;
+            if (decoder.synced()) {
+                CHECK(sameView(joined.state, session.game.state));
+                break;
+            }
+        }
+        CHECK(decoder.synced());
+    }
+
+    // boards picked from the library are sent as their seed like any other
+    void checkLibraryBoards() {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "apples-spectator-test";
+        std::filesystem::create_directories(directory / "assets");
+        CHECK(boards::build(directory / "assets" / "boards.lib", { { .sizeX = gamestate::DEFAULT_APPLES_X,
+            .sizeY = gamestate::DEFAULT_APPLES_Y, .variant = rules::Variant::CLASSIC, .candidates = 30 } }, 5));
+        const std::filesystem::path was = std::filesystem::current_path();
+        std::filesystem::current_path(directory);
+        gameLogic::setup();
+
+        for (auto choice : { GameState::BoardChoice::EASY, GameState::BoardChoice::HARD }) {
+            Session session;
+            Feed feed(session.game);
+            session.feeds = { &feed };
+            session.game.start({ .boardChoice = choice });
+            for (int pop = 0; pop < 4; pop++) { session.game.popAny(); }
+            session.frames(30);
+            CHECK_EQ(feed.mismatches, 0);
+        }
+
+        gameLogic::free();
+        std::filesystem::current_path(was);
+        std::filesystem::remove_all(directory);
+    }
+
+    // the messages of a short game, and the state they end in
+    struct Recording {
+        std::vector<BYTE> stream;
+        std::vector<size_t> ends; // of every message
+    };
+
+    Recording record(headless::Game& game) {
+        Recording recording;
+        spectator::Encoder encoder;
+        game.afterFrame = [&]() {
+            encoder.encode(game.state, recording.stream);
+            recording.ends.push_back(recording.stream.size());
+        };
+        game.start({ .appleCountX = 10, .appleCountY = 8 });
+        for (int pop = 0; pop < 4; pop++) {
+            game.popAny();
+            for (int i = 0; i < 5; i++) { game.frame(); }
+        }
+        game.afterFrame = nullptr;
+        return recording;
+    }
+
+    void checkTorn() {
+        headless::Game game;
+        const Recording recording = record(game);
+
+        // a byte at a time, every message is applied once it's all there
+        headless::Game viewer;
+        spectator::Decoder decoder;
+        std::vector<BYTE> received;
+        for (BYTE b : recording.stream) {
+            received.push_back(b);
+            size_t used = decoder.apply(received.data(), received.size(), viewer.state);
+            received.erase(received.begin(), received.begin() + used);
+        }
+        CHECK(received.empty());
+        CHECK(decoder.synced());
+        CHECK(sameView(viewer.state, game.state));
+
+        // a message cut off takes nothing and leaves the state alone
+        headless::Game cut;
+        spectator::Decoder cutDecoder;
+        const size_t keyframeEnd = recording.ends[0];
+        CHECK_EQ(cutDecoder.apply(recording.stream.data(), keyframeEnd - 1, cut.state), 0u);
+        CHECK(!cutDecoder.synced());
+        CHECK(cut.state.mode == GameState::Mode::TITLE_MENU);
+    }
+
+    // Offset of a settings field of the keyframe message at the start of a stream: after the
+    // length, the type and the time come the mode, three varints and the byte fields
+    const size_t MODE = 0;
+    const size_t RULE_VARIANT = 2;
+    const size_t BOARD_CHOICE = 3;
+    const size_t PLAYER_COUNT = 4;
+
+    size_t keyframeField(const std::vector<BYTE>& stream, size_t field) {
+        size_t at = 0;
+        auto skipVarint = [&]() {
+            while (stream[at] & 0x80) { at++; }
+            at++;
+        };
+        skipVarint(); // length
+        at++;         // type
+        skipVarint(); // time
+        if (field == MODE) { return at; }
+        at++;
+        for (int i = 0; i < 3; i++) { skipVarint(); } // board size and play time
+        return at + field - 1; // hugeBoard, then the rule variant, board choice and player count
+    }
+
+    void checkCorrupted() {
+        headless::Game game;
+        const Recording recording = record(game);
+        const size_t keyframeEnd = recording.ends[0];
+
+        auto decodeAll = [&](const std::vector<BYTE>& stream, headless::Game& viewer, spectator::Decoder& decoder) {
+            return decoder.apply(stream.data(), stream.size(), viewer.state);
+        };
+
+        // an unknown message type
+        {
+            std::vector<BYTE> stream = recording.stream;
+            stream[keyframeEnd + 1] = 0x7F;
+            headless::Game viewer;
+            spectator::Decoder decoder;
+            CHECK_EQ(decodeAll(std::vector<BYTE>(stream.begin(), stream.begin() + recording.ends[1]), viewer, decoder),
+                recording.ends[1]);
+            CHECK(!decoder.synced());
+        }
+
+        // a length no message can have: nothing after it is trusted
+        {
+            std::vector<BYTE> stream(recording.stream.begin(), recording.stream.begin() + keyframeEnd);
+            for (BYTE b : { 0xFF, 0xFF, 0xFF, 0xFF, 0x7F }) { stream.push_back(b); }
+            stream.insert(stream.end(), recording.stream.begin() + keyframeEnd, recording.stream.end());
+            headless::Game viewer;
+            spectator::Decoder decoder;
+            CHECK_EQ(decodeAll(stream, viewer, decoder), stream.size());
+            CHECK(!decoder.synced());
+        }
+
+        // keyframes with settings the game can't have
+        for (auto [field, value] : { std::pair<size_t, BYTE>{ MODE, 0x33 }, { RULE_VARIANT, 9 }, { BOARD_CHOICE, 40 },
+                 { PLAYER_COUNT, 0 }, { PLAYER_COUNT, 99 } }) {
+            std::vector<BYTE> stream(recording.stream.begin(), recording.stream.begin() + keyframeEnd);
+            stream[keyframeField(stream, field)] = value;
+            headless::Game viewer;
+            spectator::Decoder decoder;
+            CHECK_EQ(decodeAll(stream, viewer, decoder), stream.size());
+            CHECK(!decoder.synced());
+            CHECK(viewer.state.mode == GameState::Mode::TITLE_MENU);
+        }
+
+        // Random damage anywhere: the decoder never reads outside the messages, and whatever it made
+        // of them, a keyframe afterwards shows the game again
+        std::mt19937 random(11);
+        int recovered = 0;
+        for (int attempt = 0; attempt < 300; attempt++) {
+            std::vector<BYTE> stream = recording.stream;
+            for (int flips = 1 + attempt % 4; flips > 0; flips--) {
+                stream[random() % stream.size()] ^= static_cast<BYTE>(1 << (random() % 8));
+            }
+            headless::Game viewer;
+            spectator::Decoder decoder;
+            decodeAll(stream, viewer, decoder);
+
+            decoder.reset();
+            spectator::Encoder encoder;
+            std::vector<BYTE> keyframe;
+            encoder.encode(game.state, keyframe);
+            size_t used = decoder.apply(keyframe.data(), keyframe.size(), viewer.state);
+            recovered += used == keyframe.size() && decoder.synced() && sameView(viewer.state, game.state);
+        }
+        CHECK_EQ(recovered, 300);
+    }
+} // namespace
+
+int main() {
+    checkGame();
+    checkJoin();
+    checkLibraryBoards();
+    checkTorn();
+    checkCorrupted();
+    return check::result();
+}
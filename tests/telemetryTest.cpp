@@ -0,0 +1,125 @@
+// Telemetry: recorded events come back from the session log as they were, and aggregating counts
+// every game once however many players it had.
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+#include "check.h"
+#include "telemetry.h"
+
+namespace {
+    using telemetry::Event;
+    using telemetry::EventType;
+
+    const std::filesystem::path DIRECTORY = std::filesystem::temp_directory_path() / "apples-telemetry-test";
+
+    Event gameStart(uint64_t timeUs, int32_t playTime) {
+        return { .timeUs = timeUs, .type = EventType::GAME_START, .width = 17, .height = 10, .count = 0, .value = playTime };
+    }
+    Event event(uint64_t timeUs, EventType type, uint8_t player = 0, int32_t value = 0) {
+        return { .timeUs = timeUs, .type = type, .player = player, .value = value };
+    }
+
+    void checkLog() {
+        std::filesystem::remove_all(DIRECTORY);
+        CHECK(telemetry::start(DIRECTORY));
+        std::vector<Event> recorded;
+        // fewer than the ring holds, so none are dropped before the writer gets to them
+        for (uint64_t i = 0; i < 4000; i++) {
+            Event e = event(1000 + i, static_cast<EventType>(i % static_cast<uint64_t>(EventType::COUNT)),
+                static_cast<uint8_t>(i % 3), static_cast<int32_t>(i));
+            telemetry::record(e);
+            recorded.push_back(e);
+        }
+        telemetry::stop();
+        CHECK_EQ(telemetry::droppedEvents(), 0u);
+
+        std::vector<std::filesystem::path> logs;
+        for (const auto& entry : std::filesystem::directory_iterator(DIRECTORY)) { logs.push_back(entry.path()); }
+        CHECK_EQ(logs.size(), 1u);
+        if (logs.size() != 1) { return; }
+
+        std::vector<Event> read;
+        CHECK(telemetry::readFile(logs[0], read));
+        CHECK_EQ(read.size(), recorded.size());
+        bool same = read.size() == recorded.size();
+        for (size_t i = 0; same && i < read.size(); i++) {
+            same = read[i].timeUs == recorded[i].timeUs && read[i].type == recorded[i].type &&
+                read[i].player == recorded[i].player && read[i].value == recorded[i].value;
+        }
+        CHECK(same);
+
+        // a torn last event is left out
+        std::filesystem::resize_file(logs[0], std::filesystem::file_size(logs[0]) - 5);
+        read.clear();
+        CHECK(telemetry::readFile(logs[0], read));
+        CHECK_EQ(read.size(), recorded.size() - 1);
+
+        // not a log
+        std::ofstream(DIRECTORY / "other.bin") << "something else entirely";
+        CHECK(!telemetry::readFile(DIRECTORY / "other.bin", read));
+        std::filesystem::remove_all(DIRECTORY);
+    }
+
+    void checkAggregation() {
+        const std::vector<Event> session = {
+            // one player: thinks 2 s, a failed drag, thinks 1 s, a pop, time over with 30
+            gameStart(1'000'000, 60),
+            event(3'000'000, EventType::DRAG_START),
+            event(3'500'000, EventType::DRAG_END),
+            event(4'500'000, EventType::DRAG_START),
+            event(4'800'000, EventType::POP),
+            event(61'000'000, EventType::TIME_OVER, 0, 30),
+            // three players on the same settings, every board times out in the same frame
+            gameStart(70'000'000, 60),
+            event(71'000'000, EventType::DRAG_START, 1),
+            event(71'200'000, EventType::POP, 1),
+            event(130'000'000, EventType::TIME_OVER, 0, 10),
+            event(130'000'000, EventType::TIME_OVER, 1, 20),
+            event(130'000'000, EventType::TIME_OVER, 2, 60),
+            // reset before the time ran out
+            gameStart(140'000'000, 60),
+            event(141'000'000, EventType::RESET, 0, 4),
+            // another play time
+            gameStart(150'000'000, 120),
+            event(271'000'000, EventType::TIME_OVER, 0, 99),
+        };
+        std::map<uint64_t, telemetry::Stats> stats;
+        telemetry::accumulate(session, stats);
+        CHECK_EQ(stats.size(), 2u);
+
+        const telemetry::Stats& minute = stats[telemetry::settingsKey(gameStart(0, 60))];
+        CHECK_EQ(minute.games, 3u);
+        CHECK_EQ(minute.finishedGames, 2u);
+        CHECK_EQ(minute.playerResults, 4u);
+        CHECK_EQ(minute.meanScore(), 30.0); // (30 + 10 + 20 + 60) / 4
+        CHECK_EQ(minute.drags, 3u);
+        CHECK_EQ(minute.failedDrags, 1u);
+        CHECK_EQ(minute.thinkCount, 3u);
+        CHECK_EQ(minute.meanThinkTimeUs(), 4'000'000.0 / 3); // 2 s, 1 s, 1 s
+
+        const telemetry::Stats& twoMinutes = stats[telemetry::settingsKey(gameStart(0, 120))];
+        CHECK_EQ(twoMinutes.games, 1u);
+        CHECK_EQ(twoMinutes.finishedGames, 1u);
+        CHECK_EQ(twoMinutes.meanScore(), 99.0);
+
+        // the same split over sessions and merged
+        std::map<uint64_t, telemetry::Stats> first, second;
+        telemetry::accumulate(std::vector<Event>(session.begin(), session.begin() + 6), first);
+        telemetry::accumulate(std::vector<Event>(session.begin() + 6, session.end()), second);
+        for (const auto& [key, stat] : second) { first[key] += stat; }
+        for (const auto& [key, stat] : stats) {
+            CHECK_EQ(first[key].games, stat.games);
+            CHECK_EQ(first[key].finishedGames, stat.finishedGames);
+            CHECK_EQ(first[key].playerResults, stat.playerResults);
+            CHECK_EQ(first[key].scoreSum, stat.scoreSum);
+            CHECK_EQ(first[key].thinkTimeUs, stat.thinkTimeUs);
+        }
+    }
+} // namespace
+
+int main() {
+    checkLog();
+    checkAggregation();
+    return check::result();
+}
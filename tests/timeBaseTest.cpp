@@ -0,0 +1,158 @@
+// Time base: counter ticks convert exactly (against 128 bit arithmetic) at frequencies that don't
+// divide a second, up to tick counts at the end of their range, and a virtual clock installed with
+// setSource is what a headless game's controller and game logic read, frame by frame.
+#include <cstdint>
+#include "check.h"
+#include "headless.h"
+#include "helper.h"
+#include "latency.h"
+#include "rng.h"
+
+namespace {
+    using timeBase::Ns;
+
+    static_assert(timeBase::ticksToNs(10'000'000, 10'000'000) == timeBase::NS_PER_SECOND);
+    static_assert(timeBase::ticksToNs(1, 3) == 333'333'333);
+
+    // QPC rates seen in the wild (the ACPI PM timer, TSC derived ones, 10 MHz since Windows 10),
+    // a 1 Hz counter and the 18 GHz the conversion is exact up to
+    const uint64_t FREQUENCIES[] = { 1, 3, 1'000'000'000, 3'579'545, 10'000'000, 14'318'180, 24'000'000,
+        2'994'196'000, 18'000'000'000 };
+
+    // 128 bit unsigned arithmetic the slow and obvious way, MSVC has no __int128
+    struct Wide {
+        uint64_t hi = 0, lo = 0;
+
+        bool operator==(const Wide&) const = default;
+    };
+
+    Wide multiply(uint64_t a, uint64_t b) {
+        const uint64_t low = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+        const uint64_t cross1 = (a >> 32) * (b & 0xFFFFFFFF);
+        const uint64_t cross2 = (a & 0xFFFFFFFF) * (b >> 32);
+        const uint64_t middle = (low >> 32) + (cross1 & 0xFFFFFFFF) + (cross2 & 0xFFFFFFFF);
+        return { (a >> 32) * (b >> 32) + (cross1 >> 32) + (cross2 >> 32) + (middle >> 32), middle << 32 | (low & 0xFFFFFFFF) };
+    }
+
+    // bit by bit long division, divisor below 2^63
+    Wide divide(Wide n, uint64_t divisor) {
+        Wide quotient;
+        uint64_t remainder = 0;
+        for (int bit = 127; bit >= 0; bit--) {
+            remainder = remainder << 1 | ((bit >= 64 ? n.hi >> (bit - 64) : n.lo >> bit) & 1);
+            if (remainder >= divisor) {
+                remainder -= divisor;
+                (bit >= 64 ? quotient.hi : quotient.lo) |= uint64_t(1) << (bit % 64);
+            }
+        }
+        return quotient;
+    }
+
+    // ticks * 10^9 / frequency, rounded down
+    Wide exact(uint64_t ticks, uint64_t frequency) {
+        return divide(multiply(ticks, timeBase::NS_PER_SECOND), frequency);
+    }
+
+    void checkTicksToNs() {
+        int wrong = 0, cases = 0;
+        rng::Stream random(40);
+        for (uint64_t frequency : FREQUENCIES) {
+            // the most ticks whose nanoseconds still fit in 64 bits, (2^64 * frequency - 1) / 10^9, the
+            // whole range from a gigahertz up
+            const Wide lastFitting = divide({ frequency - 1, UINT64_MAX }, timeBase::NS_PER_SECOND);
+            const uint64_t last = lastFitting.hi != 0 ? UINT64_MAX : lastFitting.lo;
+            CHECK_EQ(exact(last, frequency).hi, 0u);
+            if (last < UINT64_MAX) { CHECK(exact(last + 1, frequency).hi != 0); }
+
+            auto check = [&](uint64_t ticks) {
+                wrong += !(Wide{ 0, timeBase::ticksToNs(ticks, frequency) } == exact(ticks, frequency));
+                cases++;
+            };
+            for (uint64_t ticks = 0; ticks < 1000; ticks++) { check(ticks); }
+            for (uint64_t back = 0; back < 1000; back++) { check(last - back); }
+            // around whole seconds, where the remainder wraps
+            for (uint64_t seconds : { uint64_t(1), uint64_t(86400) * 30, last / frequency - 1 }) {
+                for (uint64_t offset = 0; offset < 3; offset++) {
+                    check(seconds * frequency - 1 + offset);
+                }
+            }
+            for (int i = 0; i < 10000; i++) { check(random.next() % last); }
+        }
+        CHECK_EQ(wrong, 0);
+        CHECK(cases > 0);
+
+        // counts a 32 bit multiply would overflow on: a year at 10 MHz, the full range at 18 GHz
+        CHECK_EQ(timeBase::ticksToNs(10'000'000ull * 86400 * 365, 10'000'000), timeBase::NS_PER_SECOND * 86400 * 365);
+        CHECK_EQ(timeBase::ticksToNs(UINT64_MAX, 18'000'000'000), exact(UINT64_MAX, 18'000'000'000).lo);
+
+        // and the reference itself
+        CHECK(multiply(UINT64_MAX, UINT64_MAX) == (Wide{ UINT64_MAX - 1, 1 }));
+        CHECK(divide({ 1, 0 }, 3) == (Wide{ 0, 6148914691236517205 }));
+        CHECK(divide({ 5, 7 }, 1) == (Wide{ 5, 7 }));
+    }
+
+    void checkSource() {
+        timeBase::VirtualSource clock(5 * timeBase::NS_PER_SECOND);
+        timeBase::setSource(&clock);
+        CHECK_EQ(timeBase::now(), 5 * timeBase::NS_PER_SECOND);
+        clock.advance(1'500);
+        CHECK_EQ(timeBase::now(), 5 * timeBase::NS_PER_SECOND + 1'500);
+        CHECK_EQ(help::myTimer64us(), 5'000'001u);
+        CHECK_EQ(timeBase::now(), timeBase::now());
+
+        // back to the monotonic clock, which moves on its own
+        timeBase::setSource(nullptr);
+        Ns first = timeBase::now();
+        while (timeBase::now() == first) {}
+        CHECK(timeBase::now() > first);
+    }
+
+    void checkHeadlessGame() {
+        timeBase::VirtualSource clock(timeBase::NS_PER_SECOND);
+        timeBase::setSource(&clock);
+        headless::Game game(timeBase::NS_PER_SECOND);
+        game.clock = &clock;
+        game.state.instrumented = true;
+        game.start({ .playTime = 900 });
+        CHECK_EQ(timeBase::now(), game.timeNs);
+        latency::reset();
+
+        // a move, pressed and released between frames: captured at the frame before the one that
+        // acts on it, a frame of latency each on the game's time
+        INT move[4];
+        CHECK(game.findMove(move));
+        const UINT32 revision = game.state.players[0].boardRevision;
+        game.drag(move[0], move[1], move[2], move[3]);
+        CHECK_EQ(game.state.players[0].boardRevision, revision + 1);
+        CHECK_EQ(timeBase::now(), game.timeNs);
+        CHECK_EQ(game.controller.keyEventTimeUs(VK_LBUTTON), (game.timeNs - headless::FRAME_NS) / timeBase::NS_PER_US);
+
+        const uint64_t frameUs = game.timeNs / timeBase::NS_PER_US - (game.timeNs - headless::FRAME_NS) / timeBase::NS_PER_US;
+        const latency::Histogram& pop = latency::captureToState(latency::Action::POP);
+        CHECK_EQ(pop.count(), 1u);
+        CHECK_EQ(pop.maxUs(), frameUs);
+        CHECK_EQ(latency::captureToState(latency::Action::DRAG_START).count(), 1u);
+        CHECK(latency::captureToState(latency::Action::DRAG_START).maxUs() <= frameUs + 1);
+
+        // a present half a frame later
+        clock.advance(headless::FRAME_NS / 2);
+        latency::framePresented(help::myTimer64us());
+        CHECK_EQ(latency::captureToPresent(latency::Action::POP).maxUs(),
+            (game.timeNs + headless::FRAME_NS / 2) / timeBase::NS_PER_US - (game.timeNs - headless::FRAME_NS) / timeBase::NS_PER_US);
+
+        // a long frame takes the clock along
+        game.frame(10 * timeBase::NS_PER_SECOND);
+        CHECK_EQ(timeBase::now(), game.timeNs);
+        CHECK_EQ(help::myTimer64us(), game.timeNs / timeBase::NS_PER_US);
+
+        timeBase::setSource(nullptr);
+        latency::reset();
+    }
+} // namespace
+
+int main() {
+    checkTicksToNs();
+    checkSource();
+    checkHeadlessGame();
+    return check::result();
+}
@@ -0,0 +1,116 @@
+// Builds the board library the game loads from assets/boards.lib, see boards::build. The same
+// arguments build the same file.
+//
+//   apples_boards OUTPUT [--seed N] [--candidates N] [--size WxH]... [--variant NAME]...
+//
+// Without --size the sizes of DEFAULT_SIZES are built, without --variant every rule variant.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "boardLibrary.h"
+#include "gameState.h"
+
+namespace {
+    struct Size {
+        int x, y;
+    };
+    // the default board and sizes around it up to the biggest regular one
+    const Size DEFAULT_SIZES[] = { { 8, 6 }, { 12, 8 }, { gamestate::DEFAULT_APPLES_X, gamestate::DEFAULT_APPLES_Y },
+        { 24, 15 }, { gamestate::MAX_APPLES_X, gamestate::MAX_APPLES_Y } };
+    const int DEFAULT_CANDIDATES = 96;
+    const uint64_t DEFAULT_SEED = 1;
+
+    const char* const VARIANT_NAMES[] = { "classic", "fifteen", "twenty", "lines" };
+    static_assert(std::size(VARIANT_NAMES) == static_cast<size_t>(rules::Variant::COUNT));
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: apples_boards OUTPUT [--seed N] [--candidates N] [--size WxH]... [--variant NAME]...\n"
+            "  --seed        seed the boards are drawn from (default %llu)\n"
+            "  --candidates  boards generated per size and variant, sorted into difficulties (default %d)\n"
+            "  --size        board size, repeatable (default 8x6, 12x8, 17x10, 24x15 and 32x20)\n"
+            "  --variant     classic, fifteen, twenty or lines, repeatable (default all)\n",
+            static_cast<unsigned long long>(DEFAULT_SEED), DEFAULT_CANDIDATES);
+    }
+
+    bool parseSize(const char* text, Size& size) {
+        return std::sscanf(text, "%dx%d", &size.x, &size.y) == 2 && size.x >= gamestate::MIN_APPLES &&
+            size.y >= gamestate::MIN_APPLES && size.x <= gamestate::HUGE_MAX_APPLES && size.y <= gamestate::HUGE_MAX_APPLES;
+    }
+
+    bool parseVariant(const char* text, rules::Variant& variant) {
+        for (size_t i = 0; i < std::size(VARIANT_NAMES); i++) {
+            if (std::strcmp(text, VARIANT_NAMES[i]) == 0) {
+                variant = static_cast<rules::Variant>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* output = nullptr;
+    uint64_t seed = DEFAULT_SEED;
+    int candidates = DEFAULT_CANDIDATES;
+    std::vector<Size> sizes;
+    std::vector<rules::Variant> variants;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        Size size;
+        rules::Variant variant;
+        if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--candidates") == 0 && hasValue && std::atoi(argv[i + 1]) > 0) {
+            candidates = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue && parseSize(argv[++i], size)) {
+            sizes.push_back(size);
+        } else if (std::strcmp(argv[i], "--variant") == 0 && hasValue && parseVariant(argv[++i], variant)) {
+            variants.push_back(variant);
+        } else if (argv[i][0] != '-' && output == nullptr) {
+            output = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (output == nullptr) {
+        usage();
+        return 2;
+    }
+    if (sizes.empty()) { sizes.assign(std::begin(DEFAULT_SIZES), std::end(DEFAULT_SIZES)); }
+    if (variants.empty()) {
+        for (int v = 0; v < static_cast<int>(rules::Variant::COUNT); v++) { variants.push_back(static_cast<rules::Variant>(v)); }
+    }
+
+    std::vector<boards::BuildSpec> specs;
+    for (Size size : sizes) {
+        for (rules::Variant variant : variants) {
+            specs.push_back({ .sizeX = size.x, .sizeY = size.y, .variant = variant, .candidates = candidates });
+        }
+    }
+    if (!boards::build(output, specs, seed)) {
+        std::fprintf(stderr, "can't write %s\n", output);
+        return 1;
+    }
+
+    // read back what was written, boards per difficulty of every spec
+    boards::Library library;
+    if (!library.open(output)) {
+        std::fprintf(stderr, "%s is not a valid library\n", output);
+        return 1;
+    }
+    std::printf("%-9s %-8s %6s %6s %6s\n", "board", "rules", "easy", "normal", "hard");
+    for (const boards::BuildSpec& spec : specs) {
+        char board[16];
+        std::snprintf(board, sizeof(board), "%dx%d", spec.sizeX, spec.sizeY);
+        std::printf("%-9s %-8s", board, VARIANT_NAMES[static_cast<int>(spec.variant)]);
+        for (int d = 0; d < static_cast<int>(boards::Difficulty::COUNT); d++) {
+            std::printf(" %6zu", library.boardCount(spec.sizeX, spec.sizeY, spec.variant, static_cast<boards::Difficulty>(d)));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
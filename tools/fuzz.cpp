@@ -0,0 +1,778 @@
+// Coverage and cost guided fuzzer of the game logic and of the files and streams the game reads.
+// The logic is built a second time with a callback in every basic block (-fsanitize-coverage=
+// trace-pc), which marks the edges between blocks a run takes and counts the blocks it executes.
+// Inputs that take new edges, or make a frame (or a parse) execute more blocks or allocate more
+// than any input before, are kept and mutated further. Blocks stand in for time: an input executes
+// the same blocks on every run, where its time is noise on a loaded machine. Replays print the time.
+//
+//   apples_fuzz TARGET [--runs N] [--seed N] [--corpus DIR] [--out DIR]
+//   apples_fuzz TARGET --replay FILE...
+//
+// Inputs that took new edges are written to the corpus directory and read back from it on the next
+// start. The input with the slowest frame and the one with the most allocating frame are written
+// to the out directory as TARGET-slowest.bin and TARGET-most-allocations.bin, an input that crashes
+// as TARGET-crash.bin; --replay runs them again.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "boardLibrary.h"
+#include "headless.h"
+#include "snapshot.h"
+#include "spectatorCodec.h"
+#include "telemetry.h"
+
+namespace {
+    const size_t MAP_SIZE = 1 << 16;
+
+    // hits of each edge in the current run, saturating
+    uint8_t edgeHits[MAP_SIZE];
+    // hit count buckets of each edge seen in any run
+    uint8_t seenBuckets[MAP_SIZE];
+    // Blocks and allocations are counted by thread, a frame is charged with those of its own thread
+    // only. The next board is prepared on a thread of its own, it would land in whichever frame it
+    // overlaps otherwise.
+    thread_local uint64_t blocks = 0;
+    thread_local uint64_t heapAllocations = 0;
+    thread_local uint32_t previousBlock = 0;
+} // namespace
+
+// Called by every basic block of the instrumented logic, on any thread. Hits are updated with
+// relaxed loads and stores rather than atomic adds, a hit lost between threads doesn't matter.
+extern "C" void __sanitizer_cov_trace_pc() {
+    uintptr_t pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    uint32_t block = static_cast<uint32_t>((pc * 0x9E3779B97F4A7C15ull) >> 40);
+    std::atomic_ref<uint8_t> hits(edgeHits[(block ^ previousBlock) & (MAP_SIZE - 1)]);
+    uint8_t count = hits.load(std::memory_order_relaxed);
+    if (count != 255) { hits.store(count + 1, std::memory_order_relaxed); }
+    previousBlock = block >> 1;
+    blocks++;
+}
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Bytes = std::vector<BYTE>;
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: apples_fuzz TARGET [--runs N] [--seed N] [--corpus DIR] [--out DIR]\n"
+            "       apples_fuzz TARGET --replay FILE...\n"
+            "  TARGET     frames     game input from the menus through games\n"
+            "             snapshot   snapshots restored and played on\n"
+            "             spectator  spectator streams decoded\n"
+            "             telemetry  session logs read and aggregated\n"
+            "             library    board libraries opened and picked from\n"
+            "  --runs     mutated inputs to run (default 100000)\n"
+            "  --seed     of the mutations (default 1)\n"
+            "  --corpus   directory the inputs with new coverage are kept in\n"
+            "  --out      directory the slowest, most allocating and crashing inputs are written to (default .)\n"
+            "  --replay   runs the files and prints what they cost\n");
+    }
+
+    // Worst frame of a run. The file targets count the whole parse as one frame.
+    struct Cost {
+        uint64_t blocks = 0;
+        uint64_t allocations = 0;
+        uint64_t ns = 0;
+        uint64_t frames = 0;
+    };
+
+    template<typename F>
+    void measure(Cost& cost, F&& f) {
+        uint64_t blocksBefore = blocks, allocationsBefore = heapAllocations;
+        auto start = std::chrono::steady_clock::now();
+        f();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        cost.blocks = std::max(cost.blocks, blocks - blocksBefore);
+        cost.allocations = std::max(cost.allocations, heapAllocations - allocationsBefore);
+        cost.ns = std::max(cost.ns, ns);
+        cost.frames++;
+    }
+
+    // AFL's buckets, a loop running 9 instead of 8 times is nothing new, 16 instead of 8 is
+    uint8_t bucket(uint8_t hits) {
+        if (hits <= 3) { return hits == 3 ? 4 : hits; }
+        if (hits < 8) { return 8; }
+        if (hits < 16) { return 16; }
+        if (hits < 32) { return 32; }
+        return hits < 128 ? 64 : 128;
+    }
+
+    // true if the run took an edge, or an edge a number of times, no run before did
+    bool newCoverage() {
+        bool found = false;
+        for (size_t i = 0; i < MAP_SIZE; i++) {
+            if (edgeHits[i] == 0) { continue; }
+            uint8_t b = bucket(edgeHits[i]);
+            if ((seenBuckets[i] & b) == 0) {
+                seenBuckets[i] |= b;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    size_t edgesSeen() {
+        return static_cast<size_t>(std::count_if(std::begin(seenBuckets), std::end(seenBuckets), [](uint8_t b) { return b != 0; }));
+    }
+
+    std::filesystem::path scratchFile() {
+        return std::filesystem::temp_directory_path() / ("apples_fuzz_" + std::to_string(::getpid()) + ".bin");
+    }
+
+    bool readBytes(const std::filesystem::path& path, Bytes& bytes) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) { return false; }
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool writeBytes(const std::filesystem::path& path, const Bytes& bytes) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+
+    // Reads an input front to back, zeros after its end
+    class Reader {
+    private:
+        const Bytes& m_bytes;
+        size_t m_at = 0;
+
+    public:
+        explicit Reader(const Bytes& bytes) : m_bytes(bytes) {}
+
+        BYTE next() { return m_at < m_bytes.size() ? m_bytes[m_at++] : 0; }
+        bool done() const { return m_at >= m_bytes.size(); }
+    };
+
+    // frames target: an 8 byte header with the settings the game starts with, then operations of
+    // 4 bytes (what, a, b, c), see Op
+    namespace frames {
+        enum Op : BYTE {
+            MOVE,    // mouse to a, b
+            PRESS,   // left button down
+            RELEASE, // left button up
+            CLICK,   // at a, b
+            DRAG,    // over cells from a, b to up to 8 more in either direction, player c
+            POP,     // drag over a valid move of player c
+            KEY,     // tap one of KEYS
+            HOLD,    // an arrow key down for b frames
+            WHEEL,   // c notches at a, b
+            PAN,     // right button drag from a, b by c
+            WAIT,    // b frames of a half milliseconds
+            RESIZE,  // the window to a * 8 x b * 5
+            BUTTON,  // click one of the menu's buttons
+            STORM,   // b clicks over the board from a random stream seeded with c
+            COUNT
+        };
+
+        const size_t HEADER_SIZE = 8;
+        const size_t MAX_OPS = 256;
+        const uint64_t MAX_FRAMES = 4000;
+        const UINT8 KEYS[] = { 'R', VK_ESCAPE, 'D', 'P', 'V', 'H', VK_F3 };
+        const UINT8 ARROWS[] = { VK_LEFT, VK_RIGHT, VK_UP, VK_DOWN };
+
+        const gamestate::Button* button(BYTE choice) {
+            static const gamestate::Button* const BUTTONS[] = {
+                &gamestate::buttonMainMenuStart, &gamestate::buttonMainMenuHelp, &gamestate::buttonHelpMenuBack,
+                &gamestate::buttonPlayingMenu, &gamestate::buttonPlayingReset, &gamestate::buttonMainMenuReset,
+                &gamestate::mainMenuSettingsButtons[0], &gamestate::mainMenuSettingsButtons[1],
+                &gamestate::mainMenuSettingsButtons[2], &gamestate::mainMenuSettingsButtons[3],
+                &gamestate::mainMenuSettingsButtons[4], &gamestate::mainMenuSettingsButtons[5],
+            };
+            return BUTTONS[choice % std::size(BUTTONS)];
+        }
+
+        // A headless game whose every frame is measured, positions are logical
+        struct Session {
+            headless::Game game;
+            Cost cost;
+            INT windowWidth = 1920, windowHeight = 1080;
+
+            explicit Session(timeBase::Ns startNs) : game(startNs) {}
+
+            void frame(timeBase::Ns deltaNs = headless::FRAME_NS) {
+                measure(cost, [&]() { game.frame(deltaNs); });
+            }
+
+            void moveTo(FLOAT x, FLOAT y) {
+                const FLOAT scale = game.state.graphicalScale > 0.0f ? game.state.graphicalScale : 1.0f;
+                game.moveTo((x - gamestate::LOGICAL_WINDOW_SIZE_X / 2.0f) * scale + windowWidth / 2.0f,
+                    (y - gamestate::LOGICAL_WINDOW_SIZE_Y / 2.0f) * scale + windowHeight / 2.0f);
+            }
+
+            void click(FLOAT x, FLOAT y) {
+                moveTo(x, y);
+                game.press();
+                frame();
+                game.release();
+                frame();
+            }
+
+            bool playing() const { return game.state.mode == gamestate::GameState::Mode::PLAYING; }
+
+            void drag(INT x0, INT y0, INT x1, INT y1, INT player) {
+                const FLOAT inset = game.state.appleSize * game.state.players[player].viewZoom * 0.45f;
+                moveTo(game.cellX(x0, player) - inset, game.cellY(y0, player) - inset);
+                game.press();
+                frame();
+                moveTo(game.cellX(x1, player) + inset, game.cellY(y1, player) + inset);
+                frame();
+                game.release();
+                frame();
+            }
+        };
+
+        FLOAT logicalX(BYTE a) { return a * gamestate::LOGICAL_WINDOW_SIZE_X / 255.0f; }
+        FLOAT logicalY(BYTE b) { return b * gamestate::LOGICAL_WINDOW_SIZE_Y / 255.0f; }
+
+        Cost run(const Bytes& input) {
+            Reader in(input);
+            headless::Settings settings;
+            BYTE sizeX = in.next(), sizeY = in.next(), players = in.next(), variant = in.next(), flags = in.next();
+            uint64_t boards = in.next() | (in.next() << 8) | (in.next() << 16);
+            settings.hugeBoard = (flags & 1) != 0;
+            settings.appleCountX = gamestate::MIN_APPLES + (settings.hugeBoard ? sizeX : sizeX % (gamestate::MAX_APPLES_X - gamestate::MIN_APPLES + 1));
+            settings.appleCountY = gamestate::MIN_APPLES + (settings.hugeBoard ? sizeY : sizeY % (gamestate::MAX_APPLES_Y - gamestate::MIN_APPLES + 1));
+            settings.playerCount = 1 + players % gamestate::MAX_PLAYERS;
+            settings.ruleVariant = static_cast<rules::Variant>(variant % static_cast<BYTE>(rules::Variant::COUNT));
+            settings.boardChoice = static_cast<gamestate::GameState::BoardChoice>(
+                (flags >> 1) % static_cast<BYTE>(gamestate::GameState::BoardChoice::COUNT));
+            settings.playTime = gamestate::MIN_PLAY_TIME_SECONDS + 5 * (flags >> 4);
+
+            Session session(timeBase::NS_PER_SECOND * static_cast<timeBase::Ns>(1 + boards));
+            gamestate::GameState& state = session.game.state;
+            state.mode = gamestate::GameState::Mode::MAIN_MENU;
+            state.appleCountX = settings.appleCountX;
+            state.appleCountY = settings.appleCountY;
+            state.playerCount = settings.playerCount;
+            state.ruleVariant = settings.ruleVariant;
+            state.playTime = settings.playTime;
+            state.hugeBoard = settings.hugeBoard;
+            state.boardChoice = settings.boardChoice;
+            session.click((gamestate::buttonMainMenuStart.left + gamestate::buttonMainMenuStart.right) / 2.0f,
+                (gamestate::buttonMainMenuStart.top + gamestate::buttonMainMenuStart.bottom) / 2.0f);
+
+            for (size_t op = 0; op < MAX_OPS && !in.done() && session.cost.frames < MAX_FRAMES; op++) {
+                BYTE what = in.next(), a = in.next(), b = in.next(), c = in.next();
+                INT player = c % state.playerCount;
+                switch (static_cast<Op>(what % COUNT)) {
+                case MOVE:
+                    session.moveTo(logicalX(a), logicalY(b));
+                    session.frame();
+                    break;
+                case PRESS:
+                    session.game.press();
+                    session.frame();
+                    break;
+                case RELEASE:
+                    session.game.release();
+                    session.frame();
+                    break;
+                case CLICK:
+                    session.click(logicalX(a), logicalY(b));
+                    break;
+                case DRAG:
+                    if (session.playing()) {
+                        const gamestate::AppleGrid& apples = state.players[player].apples;
+                        INT x0 = a % apples.sizeX(), y0 = b % apples.sizeY();
+                        INT x1 = std::clamp(x0 + (c & 15) - 8, 0, apples.sizeX() - 1);
+                        INT y1 = std::clamp(y0 + ((c >> 4) & 15) - 8, 0, apples.sizeY() - 1);
+                        session.drag(x0, y0, x1, y1, player);
+                    }
+                    break;
+                case POP:
+                    if (session.playing()) {
+                        INT found[4];
+                        if (session.game.findMove(found, player)) { session.drag(found[0], found[1], found[2], found[3], player); }
+                    }
+                    break;
+                case KEY:
+                    session.game.press(KEYS[a % std::size(KEYS)]);
+                    session.frame();
+                    session.game.release(KEYS[a % std::size(KEYS)]);
+                    session.frame();
+                    break;
+                case HOLD:
+                    session.game.press(ARROWS[a % std::size(ARROWS)]);
+                    for (int i = 0; i <= b % 64; i++) { session.frame(); }
+                    session.game.release(ARROWS[a % std::size(ARROWS)]);
+                    session.frame();
+                    break;
+                case WHEEL:
+                    session.moveTo(logicalX(a), logicalY(b));
+                    session.game.controller.addWheelDelta((static_cast<INT>(c) - 128) / 32 * WHEEL_DELTA);
+                    session.frame();
+                    break;
+                case PAN:
+                    session.moveTo(logicalX(a), logicalY(b));
+                    session.game.press(VK_RBUTTON);
+                    session.frame();
+                    session.moveTo(logicalX(a) + static_cast<FLOAT>(c) * 4.0f - 512.0f, logicalY(b) - static_cast<FLOAT>(c) * 2.0f + 256.0f);
+                    session.frame();
+                    session.game.release(VK_RBUTTON);
+                    session.frame();
+                    break;
+                case WAIT:
+                    for (int i = 0; i <= b % 120; i++) { session.frame(a * 500'000); }
+                    break;
+                case RESIZE:
+                    session.windowWidth = 1 + a * 8;
+                    session.windowHeight = 1 + b * 5;
+                    session.game.controller.setWindowSize(session.windowWidth, session.windowHeight);
+                    session.frame();
+                    break;
+                case BUTTON: {
+                    const gamestate::Button* target = button(a);
+                    session.click((target->left + target->right) / 2.0f, (target->top + target->bottom) / 2.0f);
+                    break;
+                }
+                case STORM: {
+                    std::mt19937 random(c);
+                    const gamestate::GameState::SingletonPlay& play = state.players[player];
+                    for (int i = 0; i <= b % 32; i++) {
+                        session.click(std::uniform_real_distribution<FLOAT>(play.area.left, play.area.right)(random),
+                            std::uniform_real_distribution<FLOAT>(play.area.top, play.area.bottom)(random));
+                    }
+                    break;
+                }
+                case COUNT:
+                    break;
+                }
+            }
+            return session.cost;
+        }
+
+        Bytes input(std::initializer_list<BYTE> header, std::initializer_list<std::array<BYTE, 4>> ops) {
+            Bytes bytes(header);
+            for (const auto& op : ops) { bytes.insert(bytes.end(), op.begin(), op.end()); }
+            return bytes;
+        }
+
+        // a game played on, a versus game, a huge board looked around on and the menus
+        std::vector<Bytes> seeds() {
+            return {
+                input({ 13, 6, 0, 0, 0x70, 1, 0, 0 }, { { POP }, { POP }, { POP }, { WAIT, 32, 30 }, { KEY, 0 }, { POP } }),
+                input({ 28, 16, 2, 1, 0x30, 2, 0, 0 }, { { POP, 0, 0, 0 }, { POP, 0, 0, 1 }, { DRAG, 3, 2, 0x99 }, { WAIT, 40, 60 } }),
+                input({ 120, 80, 0, 3, 0x11, 3, 0, 0 }, { { WHEEL, 128, 128, 200 }, { PAN, 100, 100, 150 }, { HOLD, 1, 20 }, { POP } }),
+                input({ 0, 0, 0, 2, 0x08, 4, 0, 0 }, { { BUTTON, 3 }, { BUTTON, 6 }, { KEY, 4 }, { KEY, 5 }, { BUTTON, 0 }, { STORM, 0, 16, 7 } }),
+            };
+        }
+    } // namespace frames
+
+    // snapshot target: a snapshot, restored into a game that then plays a few frames
+    namespace snapshots {
+        Cost run(const Bytes& input) {
+            Cost cost;
+            headless::Game game;
+            bool restored = false;
+            measure(cost, [&]() { restored = snapshot::deserialize(input.data(), input.size(), game.state, game.timeNs); });
+            if (restored) {
+                for (int i = 0; i < 3; i++) { measure(cost, [&]() { game.frame(); }); }
+            }
+            return cost;
+        }
+
+        // the size in the header (after magic and version) and the checksum are made right again,
+        // so the mutations reach the parser
+        void fix(Bytes& input) {
+            const size_t SIZE_OFFSET = 8;
+            uint64_t size = input.size();
+            if (input.size() >= SIZE_OFFSET + sizeof(size)) { std::memcpy(input.data() + SIZE_OFFSET, &size, sizeof(size)); }
+            snapshot::seal(input.data(), input.size());
+        }
+
+        Bytes of(const headless::Game& game) {
+            Bytes bytes(snapshot::serializedSize(game.state));
+            snapshot::serialize(game.state, game.timeNs, bytes.data());
+            snapshot::seal(bytes.data(), bytes.size());
+            return bytes;
+        }
+
+        // menus, a game with apples falling, a versus game and a huge board
+        std::vector<Bytes> seeds() {
+            std::vector<Bytes> result;
+            headless::Game menu;
+            result.push_back(of(menu));
+            headless::Game game;
+            game.start({});
+            game.popAny();
+            result.push_back(of(game));
+            headless::Game versus;
+            versus.start({ .appleCountX = 12, .appleCountY = 8, .playerCount = 3 });
+            versus.popAny(1);
+            result.push_back(of(versus));
+            headless::Game huge;
+            huge.start({ .appleCountX = 60, .appleCountY = 40, .hugeBoard = true });
+            result.push_back(of(huge));
+            return result;
+        }
+    } // namespace snapshots
+
+    // spectator target: a stream decoded by a viewer that joined at its start
+    namespace spectators {
+        Cost run(const Bytes& input) {
+            Cost cost;
+            headless::Game viewer;
+            spectator::Decoder decoder;
+            measure(cost, [&]() { decoder.apply(input.data(), input.size(), viewer.state); });
+            return cost;
+        }
+
+        // a single game with pops, a reset and a settings change, and a versus game
+        std::vector<Bytes> seeds() {
+            std::vector<Bytes> result;
+            for (INT players : { 1, 2 }) {
+                headless::Game game;
+                spectator::Encoder encoder;
+                Bytes stream;
+                game.afterFrame = [&]() { encoder.encode(game.state, stream); };
+                game.start({ .appleCountX = 10, .appleCountY = 6, .playerCount = players });
+                game.popAny();
+                game.tap('R');
+                game.popAny(players - 1);
+                for (int i = 0; i < 30; i++) { game.frame(); }
+                result.push_back(stream);
+            }
+            return result;
+        }
+    } // namespace spectators
+
+    // telemetry target: a session log read back and aggregated
+    namespace telemetryLogs {
+        Cost run(const Bytes& input) {
+            Cost cost;
+            const std::filesystem::path path = scratchFile();
+            writeBytes(path, input);
+            measure(cost, [&]() {
+                std::vector<telemetry::Event> events;
+                std::map<uint64_t, telemetry::Stats> stats;
+                if (telemetry::readFile(path, events)) { telemetry::accumulate(events, stats); }
+            });
+            return cost;
+        }
+
+        // a session with a single and a versus game
+        std::vector<Bytes> seeds() {
+            const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("apples_fuzz_logs_" + std::to_string(::getpid()));
+            std::filesystem::create_directories(directory);
+            telemetry::start(directory);
+            headless::Game game;
+            game.state.instrumented = true;
+            game.start({ .appleCountX = 10, .appleCountY = 6, .playTime = gamestate::MIN_PLAY_TIME_SECONDS });
+            game.popAny();
+            game.drag(0, 0, 0, 0);
+            for (int i = 0; i < 400; i++) { game.frame(); }
+            game.start({ .appleCountX = 10, .appleCountY = 6, .playerCount = 2, .playTime = gamestate::MIN_PLAY_TIME_SECONDS });
+            game.popAny(1);
+            for (int i = 0; i < 400; i++) { game.frame(); }
+            telemetry::stop();
+
+            std::vector<Bytes> result;
+            for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+                Bytes bytes;
+                if (readBytes(entry.path(), bytes)) { result.push_back(std::move(bytes)); }
+            }
+            std::filesystem::remove_all(directory);
+            return result;
+        }
+    } // namespace telemetryLogs
+
+    // library target: a board library opened, every group counted and picked from
+    namespace libraries {
+        const INT SIZES[][2] = { { 8, 6 }, { 12, 8 } };
+        uint64_t valuesRead = 0; // so the picked values are read
+
+        Cost run(const Bytes& input) {
+            Cost cost;
+            const std::filesystem::path path = scratchFile();
+            writeBytes(path, input);
+            measure(cost, [&]() {
+                boards::Library library;
+                if (!library.open(path)) { return; }
+                uint64_t sum = 0;
+                for (const auto& size : SIZES) {
+                    for (int variant = 0; variant < static_cast<int>(rules::Variant::COUNT); variant++) {
+                        for (int difficulty = 0; difficulty < static_cast<int>(boards::Difficulty::COUNT); difficulty++) {
+                            auto v = static_cast<rules::Variant>(variant);
+                            auto d = static_cast<boards::Difficulty>(difficulty);
+                            sum += library.boardCount(size[0], size[1], v, d);
+                            boards::BoardInfo board;
+                            for (uint64_t choice : { 0ull, 7ull }) {
+                                if (!library.pick(size[0], size[1], v, d, choice, board)) { continue; }
+                                for (INT i = 0; i < size[0] * size[1]; i++) { sum += board.values[i]; }
+                            }
+                        }
+                    }
+                }
+                valuesRead += sum;
+            });
+            return cost;
+        }
+
+        std::vector<Bytes> seeds() {
+            const std::filesystem::path path = scratchFile();
+            std::vector<boards::BuildSpec> specs;
+            for (const auto& size : SIZES) {
+                specs.push_back({ .sizeX = size[0], .sizeY = size[1], .variant = rules::Variant::CLASSIC, .candidates = 12 });
+            }
+            specs.push_back({ .sizeX = 8, .sizeY = 6, .variant = rules::Variant::LINES, .candidates = 12 });
+            Bytes bytes;
+            if (!boards::build(path, specs, 1) || !readBytes(path, bytes)) { return {}; }
+            return { bytes };
+        }
+    } // namespace libraries
+
+    struct Target {
+        const char* name;
+        Cost (*run)(const Bytes& input);
+        std::vector<Bytes> (*seeds)();
+        void (*fix)(Bytes& input);
+        size_t maxSize;
+    };
+
+    const Target TARGETS[] = {
+        { "frames", frames::run, frames::seeds, nullptr, frames::HEADER_SIZE + 4 * frames::MAX_OPS },
+        { "snapshot", snapshots::run, snapshots::seeds, snapshots::fix, 1 << 16 },
+        { "spectator", spectators::run, spectators::seeds, nullptr, 1 << 16 },
+        { "telemetry", telemetryLogs::run, telemetryLogs::seeds, nullptr, 1 << 16 },
+        { "library", libraries::run, libraries::seeds, nullptr, 1 << 16 },
+    };
+
+    const uint64_t INTERESTING[] = { 0, 1, 2, 0x7F, 0x80, 0xFF, 0x7FFF, 0x8000, 0xFFFF, 0x7FFFFFFF, 0x80000000,
+        0xFFFFFFFF, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, ~0ull };
+
+    // One to eight byte level changes: bit flips, new and interesting values, ranges erased,
+    // inserted, copied within the input or from another input of the corpus
+    void mutate(Bytes& input, const std::vector<Bytes>& corpus, std::mt19937_64& random, size_t maxSize) {
+        auto below = [&](size_t n) { return n ? static_cast<size_t>(random() % n) : 0; };
+        int count = 1 << below(4);
+        for (int m = 0; m < count; m++) {
+            if (input.empty()) {
+                input.push_back(static_cast<BYTE>(random()));
+                continue;
+            }
+            size_t at = below(input.size());
+            switch (below(9)) {
+            case 0:
+                input[at] ^= static_cast<BYTE>(1 << below(8));
+                break;
+            case 1:
+                input[at] = static_cast<BYTE>(random());
+                break;
+            case 2:
+                input[at] = static_cast<BYTE>(INTERESTING[below(6)]);
+                break;
+            case 3:
+                input[at] = static_cast<BYTE>(input[at] + below(33) - 16);
+                break;
+            case 4: {
+                uint64_t value = INTERESTING[below(std::size(INTERESTING))];
+                size_t width = size_t(2) << below(3);
+                for (size_t i = 0; i < width && at + i < input.size(); i++) { input[at + i] = static_cast<BYTE>(value >> (8 * i)); }
+                break;
+            }
+            case 5:
+                input.erase(input.begin() + at, input.begin() + at + 1 + below(std::min<size_t>(input.size() - at, 64)));
+                break;
+            case 6: {
+                Bytes inserted(1 + below(16));
+                for (BYTE& b : inserted) { b = static_cast<BYTE>(random()); }
+                input.insert(input.begin() + at, inserted.begin(), inserted.end());
+                break;
+            }
+            case 7: {
+                size_t from = below(input.size()), length = 1 + below(std::min<size_t>(input.size() - from, 64));
+                Bytes copied(input.begin() + from, input.begin() + from + length);
+                input.insert(input.begin() + at, copied.begin(), copied.end());
+                break;
+            }
+            case 8: {
+                const Bytes& other = corpus[below(corpus.size())];
+                if (other.empty()) { break; }
+                size_t from = below(other.size()), length = 1 + below(std::min<size_t>(other.size() - from, 256));
+                input.insert(input.begin() + at, other.begin() + from, other.begin() + from + length);
+                break;
+            }
+            }
+        }
+        if (input.size() > maxSize) { input.resize(maxSize); }
+    }
+
+    uint64_t hashOf(const Bytes& input) {
+        uint64_t hash = 14695981039346656037ull;
+        for (BYTE b : input) {
+            hash ^= b;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // A crash writes the input that caused it; only async signal safe calls in the handler
+    const Bytes* currentInput = nullptr;
+    std::string crashPath;
+
+    void onCrash(int signal) {
+        if (currentInput) {
+            int fd = ::open(crashPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                ssize_t written = ::write(fd, currentInput->data(), currentInput->size());
+                (void)written;
+                ::close(fd);
+            }
+            const char message[] = "crashed, input written to the out directory\n";
+            ssize_t written = ::write(STDERR_FILENO, message, sizeof(message) - 1);
+            (void)written;
+        }
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+
+    int replay(const Target& target, const std::vector<std::filesystem::path>& files) {
+        for (const std::filesystem::path& file : files) {
+            Bytes input;
+            if (!readBytes(file, input)) {
+                std::fprintf(stderr, "can't read %s\n", file.string().c_str());
+                return 1;
+            }
+            Cost cost = target.run(input);
+            std::printf("%s: %llu frames, slowest %llu blocks %.1f us, most allocations %llu\n", file.string().c_str(),
+                static_cast<unsigned long long>(cost.frames), static_cast<unsigned long long>(cost.blocks),
+                cost.ns / 1000.0, static_cast<unsigned long long>(cost.allocations));
+        }
+        return 0;
+    }
+
+    void progress(uint64_t runs, size_t corpus, const Cost& worst) {
+        std::printf("runs %8llu  corpus %5zu  edges %6zu  slowest frame %10llu blocks  most allocations %6llu\n",
+            static_cast<unsigned long long>(runs), corpus, edgesSeen(), static_cast<unsigned long long>(worst.blocks),
+            static_cast<unsigned long long>(worst.allocations));
+        std::fflush(stdout);
+    }
+
+    int fuzz(const Target& target, uint64_t runs, uint64_t seed, const std::filesystem::path& corpusDirectory,
+        const std::filesystem::path& outDirectory) {
+        std::error_code error;
+        std::filesystem::create_directories(outDirectory, error);
+        if (!corpusDirectory.empty()) { std::filesystem::create_directories(corpusDirectory, error); }
+        const std::string prefix = std::string(target.name) + "-";
+        crashPath = (outDirectory / (prefix + "crash.bin")).string();
+
+        std::vector<Bytes> corpus = target.seeds();
+        if (!corpusDirectory.empty()) {
+            for (const auto& entry : std::filesystem::directory_iterator(corpusDirectory, error)) {
+                Bytes input;
+                if (entry.is_regular_file() && readBytes(entry.path(), input)) { corpus.push_back(std::move(input)); }
+            }
+        }
+        if (corpus.empty()) { corpus.push_back({}); }
+
+        // what starts are covered with is no find
+        Cost worst;
+        for (const Bytes& input : corpus) {
+            std::memset(edgeHits, 0, sizeof(edgeHits));
+            currentInput = &input;
+            Cost cost = target.run(input);
+            newCoverage();
+            worst.blocks = std::max(worst.blocks, cost.blocks);
+            worst.allocations = std::max(worst.allocations, cost.allocations);
+        }
+        currentInput = nullptr;
+        progress(0, corpus.size(), worst);
+
+        std::mt19937_64 random(seed);
+        for (uint64_t run = 1; run <= runs; run++) {
+            Bytes input = corpus[random() % corpus.size()];
+            mutate(input, corpus, random, target.maxSize);
+            if (target.fix) { target.fix(input); }
+
+            std::memset(edgeHits, 0, sizeof(edgeHits));
+            currentInput = &input;
+            Cost cost = target.run(input);
+            currentInput = nullptr;
+
+            bool covered = newCoverage();
+            bool slowest = cost.blocks > worst.blocks, mostAllocations = cost.allocations > worst.allocations;
+            if (slowest) {
+                worst.blocks = cost.blocks;
+                writeBytes(outDirectory / (prefix + "slowest.bin"), input);
+            }
+            if (mostAllocations) {
+                worst.allocations = cost.allocations;
+                writeBytes(outDirectory / (prefix + "most-allocations.bin"), input);
+            }
+            if (covered && !corpusDirectory.empty()) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hashOf(input)));
+                writeBytes(corpusDirectory / name, input);
+            }
+            if (covered || slowest || mostAllocations) { corpus.push_back(std::move(input)); }
+            if ((run & (run - 1)) == 0 || run == runs) { progress(run, corpus.size(), worst); }
+        }
+        return 0;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const Target* target = nullptr;
+    for (const Target& t : TARGETS) {
+        if (argc > 1 && std::strcmp(argv[1], t.name) == 0) { target = &t; }
+    }
+    if (!target) {
+        usage();
+        return 2;
+    }
+
+    uint64_t runs = 100000, seed = 1;
+    std::filesystem::path corpusDirectory, outDirectory = ".";
+    std::vector<std::filesystem::path> replayFiles;
+    bool replaying = false;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpusDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0) {
+            replaying = true;
+        } else if (replaying && argv[i][0] != '-') {
+            replayFiles.push_back(argv[i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (replaying && replayFiles.empty()) {
+        usage();
+        return 2;
+    }
+
+    for (int signal : { SIGSEGV, SIGFPE, SIGABRT, SIGBUS, SIGILL }) { std::signal(signal, onCrash); }
+    int result = replaying ? replay(*target, replayFiles) : fuzz(*target, runs, seed, corpusDirectory, outDirectory);
+    std::error_code error;
+    std::filesystem::remove(scratchFile(), error);
+    return result;
+}
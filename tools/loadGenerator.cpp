@@ -0,0 +1,168 @@
+// Load on a session host: many sessions played by simple bots, for how many of them a core keeps
+// ticking at the frame rate and how long the ticks take. The bots go through the menus into a game,
+// drag over small rectangles now and then, most of them moves, and sometimes restart, like a crowd
+// of players who aren't very good. Only the ticks are timed, not the bots.
+//
+//   apples_load [--sessions N]... [--ticks N] [--seed N]
+//
+// Without --sessions 64, 256, 1024 and 4096 sessions are run, one host each.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "latency.h"
+#include "sessionHost.h"
+
+namespace {
+    using sessionHost::Input;
+
+    const int DEFAULT_SESSIONS[] = { 64, 256, 1024, 4096 };
+    const int DEFAULT_TICKS = 600;
+    const int WARMUP_TICKS = 120;
+    const uint64_t DEFAULT_SEED = 1;
+    const timeBase::Ns FRAME_NS = timeBase::NS_PER_SECOND / 60;
+    const int MOVE_ATTEMPTS = 8; // random rectangles a bot looks at before dragging over one
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: apples_load [--sessions N]... [--ticks N] [--seed N]\n"
+            "  --sessions  sessions on one host, repeatable (default 64, 256, 1024 and 4096)\n"
+            "  --ticks     timed ticks per host, after %d to get every session into a game (default %d)\n"
+            "  --seed      seed of the boards and the bots (default %llu)\n",
+            WARMUP_TICKS, DEFAULT_TICKS, static_cast<unsigned long long>(DEFAULT_SEED));
+    }
+
+    Input move(FLOAT x, FLOAT y) { return { Input::Type::MOUSE_MOVE, 0, static_cast<INT>(x), static_cast<INT>(y) }; }
+    Input down(UINT8 key = VK_LBUTTON) { return { Input::Type::KEY_DOWN, key, 0, 0 }; }
+    Input up(UINT8 key = VK_LBUTTON) { return { Input::Type::KEY_UP, key, 0, 0 }; }
+
+    bool isMove(rules::Variant variant, const gamestate::AppleGrid& apples, INT x0, INT y0, INT width, INT height) {
+        return rules::visit(variant, [&](auto rules) {
+            rules::Selection<decltype(rules)> selection;
+            for (INT y = y0; y < y0 + height; y++) {
+                for (INT x = x0; x < x0 + width; x++) {
+                    if (!apples.at(x, y).popped) { selection.add(apples.at(x, y).value, x, y); }
+                }
+            }
+            return selection.count() > 0 && selection.valid();
+        });
+    }
+
+    // Decides from the session's state between ticks, sends a drag over three ticks like a mouse would
+    class Bot {
+    private:
+        rng::Stream m_rng;
+        int m_waitTicks;
+        Input m_dragEnd{};
+        int m_dragStep = 0;
+
+    public:
+        // the first bots start at once, the others within a second
+        explicit Bot(rng::Stream stream) : m_rng(stream), m_waitTicks(m_rng.nextInt(0, 60)) {}
+
+        void step(sessionHost::Host& host, sessionHost::SessionId id) {
+            const gamestate::GameState& state = host.state(id);
+            std::vector<Input> batch;
+            if (m_dragStep == 1) {
+                batch = { m_dragEnd };
+                m_dragStep = 2;
+            } else if (m_dragStep == 2) {
+                batch = { up() };
+                m_dragStep = 0;
+            } else if (m_waitTicks > 0) {
+                m_waitTicks--;
+                return;
+            } else if (state.mode == gamestate::GameState::Mode::TITLE_MENU) {
+                batch = { move(100, 100), down(), up() };
+                m_waitTicks = m_rng.nextInt(5, 20);
+            } else if (state.mode == gamestate::GameState::Mode::MAIN_MENU) {
+                const gamestate::Button& start = gamestate::buttonMainMenuStart;
+                batch = { move((start.left + start.right) / 2, (start.top + start.bottom) / 2), down(), up() };
+                m_waitTicks = m_rng.nextInt(5, 20);
+            } else if (state.mode == gamestate::GameState::Mode::PLAYING && m_rng.nextInt(0, 49) == 0) {
+                batch = { down('R'), up('R') };
+                m_waitTicks = m_rng.nextInt(20, 90);
+            } else if (state.mode == gamestate::GameState::Mode::PLAYING) {
+                // one to three cells each way, corner to corner, over a move if one of a few tries finds one
+                const gamestate::GameState::SingletonPlay& play = state.players[0];
+                INT width, height, x, y;
+                for (int attempt = 0; attempt < MOVE_ATTEMPTS; attempt++) {
+                    width = m_rng.nextInt(1, 3), height = m_rng.nextInt(1, 3);
+                    x = m_rng.nextInt(0, state.appleCountX - width), y = m_rng.nextInt(0, state.appleCountY - height);
+                    if (isMove(state.ruleVariant, play.apples, x, y, width, height)) { break; }
+                }
+                auto logicalX = [&](FLOAT cells) { return play.toLogicalX(play.appleMinX + state.appleSize * cells); };
+                auto logicalY = [&](FLOAT cells) { return play.toLogicalY(play.appleMinY + state.appleSize * cells); };
+                batch = { move(logicalX(x + 0.05f), logicalY(y + 0.05f)), down() };
+                m_dragEnd = move(logicalX(x + width - 0.05f), logicalY(y + height - 0.05f));
+                m_dragStep = 1;
+                m_waitTicks = m_rng.nextInt(20, 90);
+            } else {
+                // the help menu, back to the main menu
+                batch = { down(VK_ESCAPE), up(VK_ESCAPE) };
+                m_waitTicks = m_rng.nextInt(20, 90);
+            }
+            host.submit(id, batch.data(), batch.size());
+        }
+    };
+
+    void run(int sessions, int ticks, uint64_t seed, unsigned cores) {
+        sessionHost::Host host(seed);
+        rng::Stream bots(seed);
+        timeBase::Ns timeNs = timeBase::NS_PER_SECOND;
+        std::vector<sessionHost::SessionId> ids;
+        std::vector<Bot> players;
+        for (int i = 0; i < sessions; i++) {
+            ids.push_back(host.open(timeNs));
+            players.emplace_back(bots.split(i));
+        }
+
+        timeBase::MonotonicSource clock;
+        latency::Histogram tickTimes;
+        int scored = 0;
+        for (int tick = 0; tick < WARMUP_TICKS + ticks; tick++) {
+            for (int i = 0; i < sessions; i++) { players[i].step(host, ids[i]); }
+            timeNs += FRAME_NS;
+            timeBase::Ns startNs = clock.now();
+            host.tick(timeNs);
+            if (tick >= WARMUP_TICKS) { tickTimes.add((clock.now() - startNs) / timeBase::NS_PER_US); }
+        }
+        for (sessionHost::SessionId id : ids) { scored += host.state(id).players[0].score > 0; }
+
+        // sessions a core keeps at the frame rate, if a tick took its mean or its 99th percentile
+        const double frameUs = static_cast<double>(FRAME_NS) / timeBase::NS_PER_US;
+        const double p99Us = static_cast<double>(tickTimes.percentileUs(99.0));
+        std::printf("%8d %8d %6u %9.3f %9.3f %9.3f %9.3f %10.0f %10.0f\n", sessions, scored, cores, tickTimes.meanUs() / 1000.0,
+            tickTimes.percentileUs(50.0) / 1000.0, p99Us / 1000.0, tickTimes.maxUs() / 1000.0,
+            sessions * frameUs / tickTimes.meanUs() / cores, p99Us > 0.0 ? sessions * frameUs / p99Us / cores : 0.0);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sessions;
+    int ticks = DEFAULT_TICKS;
+    uint64_t seed = DEFAULT_SEED;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--sessions") == 0 && hasValue && std::atoi(argv[i + 1]) > 0) {
+            sessions.push_back(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue && std::atoi(argv[i + 1]) > 0) {
+            ticks = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (sessions.empty()) { sessions.assign(std::begin(DEFAULT_SESSIONS), std::end(DEFAULT_SESSIONS)); }
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%8s %8s %6s %9s %9s %9s %9s %10s %10s\n", "sessions", "scored", "cores", "mean ms", "p50 ms", "p99 ms",
+        "max ms", "per core", "(p99)");
+    for (int count : sessions) { run(count, ticks, seed, cores); }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Aggregates telemetry session logs into per-settings stats, the files are read and accumulated in
+// parallel and the per-thread results merged at the end.
+//
+//   apples_telemetry [--threads N] PATH...
+//
+// A PATH is a session log or a directory searched for them (session-*.bin).
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <thread>
+#include <vector>
+#include "rules.h"
+#include "telemetry.h"
+
+namespace {
+    void usage() {
+        std::fprintf(stderr,
+            "usage: apples_telemetry [--threads N] PATH...\n"
+            "  PATH       a session log or a directory with session-*.bin logs in it\n"
+            "  --threads  number of threads reading logs (default: one per core)\n");
+    }
+
+    bool isSessionLog(const std::filesystem::path& path) {
+        const std::string name = path.filename().string();
+        return name.starts_with("session-") && path.extension() == ".bin";
+    }
+
+    void collect(const std::filesystem::path& path, std::vector<std::filesystem::path>& files) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error)) {
+            files.push_back(path);
+            return;
+        }
+        for (auto it = std::filesystem::recursive_directory_iterator(path, error);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (error) { break; }
+            if (it->is_regular_file(error) && isSessionLog(it->path())) { files.push_back(it->path()); }
+        }
+    }
+
+    void print(const std::map<uint64_t, telemetry::Stats>& stats) {
+        std::printf("%-9s %5s  %-14s %10s %10s %10s %12s %12s\n", "board", "time", "rules", "games", "finished",
+            "mean score", "failed drags", "think ms");
+        for (const auto& [key, stat] : stats) {
+            unsigned width = static_cast<unsigned>(key >> 48), height = static_cast<unsigned>(key >> 32) & 0xFFFF;
+            unsigned playTime = static_cast<unsigned>(key >> 16) & 0xFFFF, variant = static_cast<unsigned>(key & 0xFFFF);
+            char board[16];
+            std::snprintf(board, sizeof(board), "%ux%u", width, height);
+            const wchar_t* rules = variant < static_cast<unsigned>(rules::Variant::COUNT) ?
+                rules::variantName(static_cast<rules::Variant>(variant)) : L"?";
+            std::printf("%-9s %5u  %-14ls %10llu %10llu %10.1f %11.1f%% %12.0f\n", board, playTime, rules,
+                static_cast<unsigned long long>(stat.games), static_cast<unsigned long long>(stat.finishedGames),
+                stat.meanScore(), stat.failedDragRate() * 100.0, stat.meanThinkTimeUs() / 1000.0);
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::filesystem::path> files;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            collect(argv[i], files);
+        }
+    }
+    if (files.empty()) {
+        usage();
+        return 2;
+    }
+
+    // every thread takes the next file until there are none left, the results are merged at the end
+    threads = std::min(threads, static_cast<unsigned>(files.size()));
+    std::vector<std::map<uint64_t, telemetry::Stats>> partial(threads);
+    std::vector<uint64_t> unreadable(threads, 0);
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::vector<telemetry::Event> events;
+            for (size_t i = next++; i < files.size(); i = next++) {
+                events.clear();
+                if (!telemetry::readFile(files[i], events)) {
+                    unreadable[t]++;
+                    continue;
+                }
+                telemetry::accumulate(events, partial[t]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) { worker.join(); }
+
+    std::map<uint64_t, telemetry::Stats> stats;
+    uint64_t skipped = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        for (const auto& [key, stat] : partial[t]) { stats[key] += stat; }
+        skipped += unreadable[t];
+    }
+
+    print(stats);
+    std::printf("\n%zu session logs, %llu not readable\n", files.size(), static_cast<unsigned long long>(skipped));
+    return 0;
+}